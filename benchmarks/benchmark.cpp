@@ -1,6 +1,34 @@
 // benchmarks/ultra_benchmark.cpp
 #include "order_book.hpp"
+#include "matching/matching_engine.hpp"
+#include "net/arbiter.hpp"
+#include "net/moldudp64.hpp"
+#include "itch/messages.hpp"
+#include "itch/decoder.hpp"
+#include "core/book_router.hpp"
+#include "book/basic_order_book.hpp"
+#include "fix/fix_codec.hpp"
+#include "perf/latency_tracker.hpp"
+#include <arpa/inet.h>
+#include <array>
 #include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+// Counts every heap allocation in the process, so benchmarks can report how
+// many their timed loop performed. Kept out of line: once inlined, GCC sees
+// malloc/free under new/delete expressions and flags them as mismatched.
+static std::atomic<uint64_t> g_heap_allocs{0};
+
+__attribute__((noinline)) void *operator new(size_t size) {
+  g_heap_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { std::free(p); }
 
 // Current vs Ultra comparison
 static void BM_Current_OrderBook_Add(benchmark::State &state) {
@@ -48,20 +76,6 @@ static void BM_Ultra_OrderBook_Add(benchmark::State &state) {
   state.SetItemsProcessed(state.iterations());
 }
 
-// Template specialization benchmark
-static void BM_Template_Buy_OrderBook_Add(benchmark::State &state) {
-  UltraBuyOrderBook book;
-  uint64_t orderId = 1;
-  uint32_t price = 50000;
-
-  for (auto _ : state) {
-    book.addOrder(orderId++, 100, price);
-    benchmark::DoNotOptimize(book);
-  }
-
-  state.SetItemsProcessed(state.iterations());
-}
-
 // Mixed operations - more realistic test
 static void BM_Ultra_Mixed_Operations(benchmark::State &state) {
   UltraOrderBook book;
@@ -169,6 +183,545 @@ static void BM_Ultra_Replace_Only(benchmark::State &state) {
   state.SetItemsProcessed(state.iterations());
 }
 
+// Top-of-book lookup with a sparse, wide book (bitmap + cached best)
+static void BM_Ultra_BestPrice_Lookup(benchmark::State &state) {
+  auto book = std::make_unique<UltraOrderBook>();
+  uint64_t orderId = 1;
+
+  // Bids spread over the lower half, asks over the upper half
+  for (uint32_t i = 0; i < 1000; ++i) {
+    book->ultra_addOrder(orderId++, 'B', 100, 40000 + i * 10);
+    book->ultra_addOrder(orderId++, 'S', 100, 50010 + i * 10);
+  }
+
+  for (auto _ : state) {
+    uint32_t bid = book->ultra_getBestBid();
+    uint32_t ask = book->ultra_getBestAsk();
+    benchmark::DoNotOptimize(bid);
+    benchmark::DoNotOptimize(ask);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Delete at the top of book forces the next-level search every iteration
+static void BM_Ultra_TopLevel_Churn(benchmark::State &state) {
+  auto book = std::make_unique<UltraOrderBook>();
+  uint64_t orderId = 1;
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    book->ultra_addOrder(orderId++, 'B', 100, 40000 + i * 10);
+  }
+
+  const uint32_t top = 40000 + 999 * 10 + 5000;
+  for (auto _ : state) {
+    book->ultra_addOrder(orderId, 'B', 100, top);
+    book->ultra_deleteOrder(orderId++);
+    uint32_t bid = book->ultra_getBestBid();
+    benchmark::DoNotOptimize(bid);
+
+    if ((orderId % 100000) == 0) {
+      state.PauseTiming();
+      book->reset_pool();
+      for (uint32_t i = 0; i < 1000; ++i) {
+        book->ultra_addOrder(orderId++, 'B', 100, 40000 + i * 10);
+      }
+      state.ResumeTiming();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Order index churn with a live set well past the default 64K sizing
+static void BM_Ultra_OrderIndex_Churn(benchmark::State &state) {
+  const uint32_t live = static_cast<uint32_t>(state.range(0));
+  UltraHashTable index;
+  UltraOrder dummy{};
+  uint64_t next_id = 1;
+
+  for (uint32_t i = 0; i < live; ++i) {
+    index.ultra_insert(next_id++, &dummy);
+  }
+
+  // Steady state: oldest order goes away, a new one arrives
+  uint64_t oldest = 1;
+  for (auto _ : state) {
+    index.ultra_remove(oldest++);
+    index.ultra_insert(next_id++, &dummy);
+    benchmark::DoNotOptimize(index.ultra_find(next_id - live / 2));
+  }
+
+  auto st = index.stats();
+  state.counters["capacity"] = st.capacity;
+  state.counters["avg_probe"] = st.lookups ? double(st.probe_groups) / st.lookups : 0.0;
+  state.SetItemsProcessed(state.iterations() * 3);
+}
+
+// Matching engine steady state: one sell rests at the back of the ask queue,
+// one IOC buy takes the order at its front, so the live set stays constant
+template <bool UseSpan>
+static void BM_Matching_ProcessOrder(benchmark::State &state) {
+  using matching::Side;
+  using matching::OrderType;
+  using matching::TimeInForce;
+  matching::MatchingEngine engine;
+  engine.add_symbol(1);
+  matching::OrderId id = 1;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    engine.process_order(matching::Order{id++, 1, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 100, 0, 50100});
+  }
+
+  matching::Fill fills[16];
+  matching::FillSpan span(fills, 16);
+  auto run = [&](const matching::Order &order) {
+    if constexpr (UseSpan) {
+      span.clear();
+      benchmark::DoNotOptimize(engine.process_order(order, span));
+    } else {
+      benchmark::DoNotOptimize(engine.process_order(order));
+    }
+  };
+  // Warm up so parked map nodes and the free-node stash reach steady size
+  for (uint32_t i = 0; i < 1000; ++i) {
+    run(matching::Order{id++, 1, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 100, 0, 50100});
+    run(matching::Order{id++, 1, Side::BUY, OrderType::LIMIT, TimeInForce::IOC, 100, 0, 50100});
+  }
+
+  const uint64_t allocs_before = g_heap_allocs.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    run(matching::Order{id++, 1, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 100, 0, 50100});
+    run(matching::Order{id++, 1, Side::BUY, OrderType::LIMIT, TimeInForce::IOC, 100, 0, 50100});
+  }
+  const uint64_t allocs = g_heap_allocs.load(std::memory_order_relaxed) - allocs_before;
+
+  state.counters["allocs_per_order"] = double(allocs) / (2.0 * state.iterations());
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Depth publishing during churn at the touch: every range(0) orders the
+// book's depth goes out either rebuilt (top 10 levels a side, as a full
+// update) or as the levels changed since the last publish, drained from the
+// book. levels_per_order is the payload each order costs.
+template <bool Incremental>
+static void BM_Level2_Publish(benchmark::State &state) {
+  using matching::Side;
+  using matching::OrderType;
+  using matching::TimeInForce;
+  const uint32_t batch = static_cast<uint32_t>(state.range(0));
+  matching::MatchingEngine engine;
+  engine.track_level_changes(Incremental);
+  engine.add_symbol(1);
+  matching::OrderId id = 1;
+  for (uint32_t i = 0; i < 40; ++i) {
+    for (uint32_t k = 0; k < 4; ++k) {
+      engine.process_order(matching::Order{id++, 1, Side::BUY, OrderType::LIMIT, TimeInForce::DAY, 100, 0, 49990 - i});
+      engine.process_order(matching::Order{id++, 1, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 100, 0, 50010 + i});
+    }
+  }
+  engine.drain_level_changes(1, [](const matching::LevelChange &) {});
+
+  matching::Fill fills[16];
+  matching::FillSpan span(fills, 16);
+  uint64_t levels = 0;
+  uint64_t orders = 0;
+  uint32_t n = 0;
+  for (auto _ : state) {
+    // Add one order near the touch, then cancel the one added 8 orders ago
+    const uint32_t offset = static_cast<uint32_t>(id % 8);
+    const bool buy = id & 1;
+    span.clear();
+    engine.process_order(matching::Order{id, 1, buy ? Side::BUY : Side::SELL, OrderType::LIMIT, TimeInForce::DAY,
+                                         100, 0, buy ? 49990 - offset : 50010 + offset}, span);
+    engine.cancel_order(id - 16);
+    ++id;
+    ++orders;
+    if (++n < batch)
+      continue;
+    n = 0;
+    if constexpr (Incremental) {
+      levels += engine.drain_level_changes(1, [](const matching::LevelChange &change) {
+        benchmark::DoNotOptimize(change);
+      });
+    } else {
+      const matching::Level2Data depth = engine.get_level2_data(1, 10);
+      levels += depth.bids.size() + depth.asks.size();
+      benchmark::DoNotOptimize(depth);
+    }
+  }
+
+  state.counters["levels_per_order"] = double(levels) / double(orders);
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Arbiter recovery burst: feed A loses every 8th message, feed B carries
+// everything but runs 32 packets behind, so most of A's traffic waits in the
+// gap ring until B fills the hole
+static void BM_Arbiter_RecoveryBurst(benchmark::State &state) {
+  constexpr uint32_t MSGS = 32768; // within one 16-bit tracking number cycle
+  constexpr uint32_t PER_PACKET = 4;
+  std::vector<char> bufA, bufB;
+  std::vector<std::pair<size_t, uint32_t>> pktA, pktB;
+  auto build = [](std::vector<char> &buf, std::vector<std::pair<size_t, uint32_t>> &pkts,
+                  bool lossy) {
+    for (uint32_t seq = 1; seq <= MSGS;) {
+      const size_t start = buf.size();
+      for (uint32_t j = 0; j < PER_PACKET && seq <= MSGS; ++j, ++seq) {
+        if (lossy && seq % 8 == 0)
+          continue;
+        OrderDeleteMessage m{};
+        m.messageType = 'D';
+        m.trackingNumber = htons(static_cast<uint16_t>(seq));
+        const char *b = reinterpret_cast<const char *>(&m);
+        buf.insert(buf.end(), b, b + sizeof(m));
+      }
+      pkts.emplace_back(start, static_cast<uint32_t>(buf.size() - start));
+    }
+  };
+  build(bufA, pktA, true);
+  build(bufB, pktB, false);
+
+  uint64_t delivered = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    size_t ia = 0, ib = 0;
+    net::Arbiter arb(
+        [&](core::PacketView &p) {
+          if (ia == pktA.size()) return false;
+          p = {bufA.data() + pktA[ia].first, pktA[ia].second};
+          ++ia;
+          return true;
+        },
+        [&](core::PacketView &p) {
+          if (ib == pktB.size() || (ib + 32 > ia && ia < pktA.size())) return false;
+          p = {bufB.data() + pktB[ib].first, pktB[ib].second};
+          ++ib;
+          return true;
+        });
+    state.ResumeTiming();
+    while (ia < pktA.size() || ib < pktB.size() || arb.buffered()) {
+      if (arb.next_message())
+        ++delivered;
+    }
+  }
+
+  state.counters["ns_per_msg"] = benchmark::Counter(
+      double(delivered), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.SetItemsProcessed(delivered);
+}
+
+// MoldUDP64 A/B feeds in sequence: feed A's packets are drained on the
+// packet fast path and feed B's identical copies are dropped from the header
+static void BM_Arbiter_Mold_InSequence(benchmark::State &state) {
+  constexpr uint32_t PACKETS = 8192;
+  constexpr uint32_t PER_PACKET = 8;
+  std::vector<char> buf(PACKETS * 1024);
+  std::vector<core::PacketView> pkts;
+  uint64_t seq = 1;
+  for (uint32_t p = 0; p < PACKETS; ++p) {
+    net::mold::PacketWriter w(buf.data() + size_t(p) * 1024, 1024);
+    w.begin("BENCH00001", seq);
+    for (uint32_t j = 0; j < PER_PACKET; ++j, ++seq) {
+      OrderDeleteMessage m{};
+      m.messageType = 'D';
+      w.append(&m, sizeof(m));
+    }
+    pkts.push_back(w.view());
+  }
+
+  uint64_t delivered = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    size_t ia = 0, ib = 0;
+    net::Arbiter arb(
+        [&](core::PacketView &p) { return ia < pkts.size() ? (p = pkts[ia++], true) : false; },
+        [&](core::PacketView &p) { return ib < ia && ib < pkts.size() ? (p = pkts[ib++], true) : false; },
+        65536, std::chrono::milliseconds(50), net::Framing::MoldUDP64);
+    state.ResumeTiming();
+    while (arb.next_message())
+      ++delivered;
+  }
+
+  state.counters["ns_per_msg"] = benchmark::Counter(
+      double(delivered), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.SetItemsProcessed(delivered);
+}
+
+// Interleaved A/E/X/U/D stream over four symbols that leaves the books as it
+// found them, so it can be replayed into the same router: each new order is
+// added, executed and cancelled in part, then deleted or replaced (the
+// replacement is deleted later). With `resting` > 0 the prelude adds that many
+// large orders and every step also executes one share of a random one, so
+// lookups stop fitting in cache the way they do on a full trading day.
+struct DecodeStream {
+  std::vector<char> prelude;
+  std::vector<char> stream;
+};
+
+static DecodeStream build_decode_stream(uint64_t resting) {
+  constexpr uint64_t N = 4096;
+  constexpr uint64_t RESTING_BASE = 1ull << 24;
+  const char *syms[] = {"AAPL    ", "MSFT    ", "GOOG    ", "TSLA    "};
+  DecodeStream ds;
+  std::vector<char> *out = &ds.prelude;
+  auto put = [&](const auto &m) {
+    const char *b = reinterpret_cast<const char *>(&m);
+    out->insert(out->end(), b, b + sizeof(m));
+  };
+  auto add = [&](uint64_t id, uint32_t shares, uint32_t price) {
+    AddOrderMessage m{};
+    m.messageType = 'A';
+    m.orderReferenceNumber = __builtin_bswap64(id);
+    m.buySellIndicator = (id & 1) ? 'B' : 'S';
+    m.shares = htonl(shares);
+    std::memcpy(m.stockSymbol, syms[id & 3], 8);
+    m.price = htonl(price);
+    put(m);
+  };
+  for (uint64_t r = 0; r < resting; ++r) {
+    const uint64_t id = RESTING_BASE + r;
+    add(id, 1u << 30, (id & 1) ? 990000 - (r % 500) * 100 : 1020000 + (r % 500) * 100);
+  }
+
+  out = &ds.stream;
+  uint64_t rng = 88172645463325252ull;
+  auto valid = [&](int64_t j) { return j >= 1 && j <= int64_t(N); };
+  for (int64_t i = 1; i <= int64_t(N) + 40; ++i) {
+    if (valid(i))
+      add(uint64_t(i), 500, (i & 1) ? 1000000 - (i % 50) * 100 : 1010000 + (i % 50) * 100);
+    if (valid(i - 8)) {
+      OrderExecutedMessage m{};
+      m.messageType = 'E';
+      m.orderReferenceNumber = __builtin_bswap64(uint64_t(i - 8));
+      m.executedShares = htonl(10);
+      put(m);
+    }
+    if (resting) {
+      rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+      OrderExecutedMessage m{};
+      m.messageType = 'E';
+      m.orderReferenceNumber = __builtin_bswap64(RESTING_BASE + rng % resting);
+      m.executedShares = htonl(1);
+      put(m);
+    }
+    if (valid(i - 16)) {
+      OrderCancelMessage m{};
+      m.messageType = 'X';
+      m.orderReferenceNumber = __builtin_bswap64(uint64_t(i - 16));
+      m.canceledShares = htonl(10);
+      put(m);
+    }
+    if (valid(i - 24)) {
+      const uint64_t j = uint64_t(i - 24);
+      if (j % 4 == 0) {
+        OrderReplaceMessage m{};
+        m.messageType = 'U';
+        m.originalOrderReferenceNumber = __builtin_bswap64(j);
+        m.newOrderReferenceNumber = __builtin_bswap64(j + N);
+        m.shares = htonl(300);
+        m.price = htonl((j & 1) ? 999000 : 1011000);
+        put(m);
+      } else {
+        OrderDeleteMessage m{};
+        m.messageType = 'D';
+        m.orderReferenceNumber = __builtin_bswap64(j);
+        put(m);
+      }
+    }
+    if (valid(i - 40) && (i - 40) % 4 == 0) {
+      OrderDeleteMessage m{};
+      m.messageType = 'D';
+      m.orderReferenceNumber = __builtin_bswap64(uint64_t(i - 40) + N);
+      put(m);
+    }
+  }
+  return ds;
+}
+
+// Decode + book update: decode_one with variant dispatch vs decode_batch into
+// an EventBlock applied run by run
+template <bool Batch> static void BM_Decode_Apply(benchmark::State &state) {
+  const DecodeStream ds = build_decode_stream(uint64_t(state.range(0)));
+  core::SymbolTable symtab;
+  itch::Decoder decoder(symtab);
+  auto books = std::make_unique<core::BookRouter<UltraOrderBook>>();
+  auto block = std::make_unique<core::EventBlock>();
+  auto replay = [&](const std::vector<char> &buf) {
+    uint64_t msgs = 0;
+    const char *cur = buf.data();
+    const char *end = cur + buf.size();
+    while (cur < end) {
+      if (Batch) {
+        const size_t used = decoder.decode_batch(cur, size_t(end - cur), *block);
+        books->apply(*block);
+        msgs += block->messages;
+        cur += used;
+      } else {
+        auto res = decoder.decode_one(cur, size_t(end - cur));
+        if (res.event)
+          books->apply(*res.event);
+        ++msgs;
+        cur += res.message_size;
+      }
+    }
+    return msgs;
+  };
+  replay(ds.prelude);
+
+  uint64_t msgs = 0;
+  for (auto _ : state) {
+    msgs += replay(ds.stream);
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["ns_per_msg"] =
+      benchmark::Counter(double(msgs), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.SetItemsProcessed(msgs);
+}
+
+// Batch replay of the same stream into books specialised by policy: the
+// Ultra book against an L1 book without queues and a policy-built FIFO book
+template <typename OB> static void BM_Policy_Book_Apply(benchmark::State &state) {
+  const DecodeStream ds = build_decode_stream(uint64_t(state.range(0)));
+  core::SymbolTable symtab;
+  itch::Decoder decoder(symtab);
+  auto books = std::make_unique<core::BookRouter<OB>>();
+  auto block = std::make_unique<core::EventBlock>();
+  auto replay = [&](const std::vector<char> &buf) {
+    uint64_t msgs = 0;
+    for (const char *cur = buf.data(), *end = cur + buf.size(); cur < end;) {
+      cur += decoder.decode_batch(cur, size_t(end - cur), *block);
+      books->apply(*block);
+      msgs += block->messages;
+    }
+    return msgs;
+  };
+  replay(ds.prelude);
+
+  uint64_t msgs = 0;
+  for (auto _ : state) {
+    msgs += replay(ds.stream);
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["ns_per_msg"] =
+      benchmark::Counter(double(msgs), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.SetItemsProcessed(msgs);
+}
+
+// Symbol resolution on Add: 8-byte key through the flat hash (Arg 0) vs the
+// stock locate array (Arg 1), over a day-sized universe of 8000 symbols
+static void BM_SymbolTable_Resolve(benchmark::State &state) {
+  constexpr size_t SYMBOLS = 8000;
+  std::vector<std::array<char, 8>> names(SYMBOLS);
+  for (size_t i = 0; i < SYMBOLS; ++i) {
+    char buf[9];
+    snprintf(buf, sizeof(buf), "S%-7zu", i);
+    std::memcpy(names[i].data(), buf, 8);
+  }
+  core::SymbolTable symtab;
+  const bool by_locate = state.range(0) != 0;
+  for (size_t i = 0; i < SYMBOLS; ++i)
+    symtab.get_or_intern(uint16_t(i + 1), names[i].data());
+
+  uint64_t rng = 88172645463325252ull;
+  for (auto _ : state) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    const size_t i = rng % SYMBOLS;
+    const auto id = by_locate ? symtab.get_or_intern(uint16_t(i + 1), names[i].data())
+                              : symtab.get_or_intern(names[i].data());
+    benchmark::DoNotOptimize(id);
+  }
+}
+
+// Cost of one measured interval: two cycle-counter reads plus the histogram
+// update. Arg(1) records through the shared, atomic-add tracker.
+static void BM_LatencyTracker_Record(benchmark::State &state) {
+  perf::LatencyTracker local;
+  perf::SharedLatencyTracker shared;
+  const bool use_shared = state.range(0) != 0;
+  for (auto _ : state) {
+    if (use_shared) {
+      MEASURE_LATENCY(shared);
+      benchmark::ClobberMemory();
+    } else {
+      MEASURE_LATENCY(local);
+      benchmark::ClobberMemory();
+    }
+  }
+  const auto stats = use_shared ? shared.get_stats() : local.get_stats();
+  state.counters["p50_ns"] = static_cast<double>(stats.p50_ns);
+  state.counters["p99_ns"] = static_cast<double>(stats.p99_ns);
+}
+
+// Gateway decode of a NewOrderSingle: FixParser into the string map plus
+// the typed getters (false) vs FixView over the buffer (true)
+template <bool InPlace>
+static void BM_Fix_NewOrder_Parse(benchmark::State &state) {
+  const std::string wire = fix::FixMessageBuilder::create_new_order_single(
+      "CLIENT1", "GATEWAY", 1234, "ORD-000123", "AAPL", fix::Side::BUY, 100,
+      fix::OrdType::LIMIT, 150.25).to_fix_string();
+  for (auto _ : state) {
+    if constexpr (InPlace) {
+      fix::FixView view;
+      uint64_t qty = 0, px = 0;
+      const bool ok = fix::checksum_ok(wire.data(), wire.size()) && view.parse(wire.data(), wire.size()) &&
+                      view.get_price(fix::FixTag::OrderQty, qty) && view.get_price(fix::FixTag::Price, px);
+      benchmark::DoNotOptimize(ok);
+      benchmark::DoNotOptimize(view.get(fix::FixTag::ClOrdID).data());
+      benchmark::DoNotOptimize(view.get_char(fix::FixTag::Side));
+    } else {
+      auto msg = fix::FixParser::parse(wire);
+      const bool ok = fix::FixParser::validate_checksum(wire);
+      auto qty = msg->get_field_as<double>(fix::FixTag::OrderQty);
+      auto px = msg->get_field_as<double>(fix::FixTag::Price);
+      auto side = msg->get_field_as<char>(fix::FixTag::Side);
+      auto cl_ord_id = msg->get_field(fix::FixTag::ClOrdID);
+      benchmark::DoNotOptimize(ok);
+      benchmark::DoNotOptimize(qty);
+      benchmark::DoNotOptimize(px);
+      benchmark::DoNotOptimize(side);
+      benchmark::DoNotOptimize(cl_ord_id);
+    }
+  }
+}
+
+// Fill report encoding: FixMessageBuilder plus to_fix_string (false) vs
+// the pre-built ExecReportEncoder template (true)
+template <bool Template>
+static void BM_Fix_ExecReport_Encode(benchmark::State &state) {
+  fix::ExecReportEncoder encoder("GATEWAY", "CLIENT1");
+  fix::ExecReport report;
+  report.order_id = 987654;
+  report.cl_ord_id = "ORD-000123";
+  report.exec_type = fix::ExecType::PARTIAL_FILL;
+  report.ord_status = fix::OrdStatus::PARTIALLY_FILLED;
+  report.symbol = "AAPL";
+  report.leaves_qty = 60;
+  report.cum_qty = 40;
+  report.avg_px = 1502500;
+  report.last_shares = 40;
+  report.last_px = 1502500;
+  uint64_t seq = 1;
+  for (auto _ : state) {
+    if constexpr (Template) {
+      report.exec_id = seq;
+      auto out = encoder.encode(report, seq++, perf::wall_ns());
+      benchmark::DoNotOptimize(out.data());
+    } else {
+      auto msg = fix::FixMessageBuilder::create_execution_report(
+          "GATEWAY", "CLIENT1", static_cast<int>(seq), "987654", "ORD-000123", "E" + std::to_string(seq),
+          fix::ExecType::PARTIAL_FILL, fix::OrdStatus::PARTIALLY_FILLED, "AAPL", fix::Side::BUY,
+          60, 40, 150.25, 40, 150.25);
+      ++seq;
+      auto out = msg.to_fix_string();
+      benchmark::DoNotOptimize(out.data());
+    }
+  }
+}
+
 // Register benchmarks - only test working implementations for now
 BENCHMARK(BM_Current_OrderBook_Add)->Unit(benchmark::kNanosecond)->MinTime(1.0);
 
@@ -179,7 +732,47 @@ BENCHMARK(BM_Ultra_OrderBook_Add)->Unit(benchmark::kNanosecond)->MinTime(1.0);
 BENCHMARK(BM_Ultra_Replace_Add_Then_Replace)->Unit(benchmark::kNanosecond)->MinTime(1.0);
 BENCHMARK(BM_Ultra_Replace_Only)->Unit(benchmark::kNanosecond)->MinTime(1.0);
 
-// BENCHMARK(BM_Template_Buy_OrderBook_Add)->Unit(benchmark::kNanosecond)->MinTime(2.0);
+// Top-of-book benchmarks
+BENCHMARK(BM_Ultra_BestPrice_Lookup)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+BENCHMARK(BM_Ultra_TopLevel_Churn)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+
+// Order index benchmarks
+BENCHMARK(BM_Ultra_OrderIndex_Churn)->Arg(10000)->Arg(200000)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+
+// Matching engine benchmarks (MatchResult vector vs caller-owned FillSpan)
+BENCHMARK_TEMPLATE(BM_Matching_ProcessOrder, false)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Matching_ProcessOrder, true)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+
+// Depth publishing (rebuilt top 10 vs drained level changes), per 1 and 16 orders
+BENCHMARK_TEMPLATE(BM_Level2_Publish, false)->Arg(1)->Arg(16)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Level2_Publish, true)->Arg(1)->Arg(16)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+
+// Feed arbitration benchmarks
+BENCHMARK(BM_Arbiter_RecoveryBurst)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+BENCHMARK(BM_Arbiter_Mold_InSequence)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+
+// Decoder benchmarks (per-message variant vs struct-of-arrays batch)
+BENCHMARK_TEMPLATE(BM_Decode_Apply, false)->Arg(0)->Arg(1 << 20)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Decode_Apply, true)->Arg(0)->Arg(1 << 20)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+
+// Policy-built books against UltraOrderBook on the same replay
+BENCHMARK_TEMPLATE(BM_Policy_Book_Apply, UltraOrderBook)->Arg(1 << 20)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Policy_Book_Apply, book::L1Book)->Arg(1 << 20)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Policy_Book_Apply, book::FifoBook)->Arg(1 << 20)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Policy_Book_Apply, book::ReferenceBook)->Arg(1 << 20)->Unit(benchmark::kMicrosecond)->MinTime(1.0);
+
+// Symbol table benchmarks (hash lookup vs stock locate)
+BENCHMARK(BM_SymbolTable_Resolve)->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+
+// Latency tracker overhead (single-writer vs shared)
+BENCHMARK(BM_LatencyTracker_Record)->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+
+// FIX codec benchmarks (string map vs in-place view; builder vs template)
+BENCHMARK_TEMPLATE(BM_Fix_NewOrder_Parse, false)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Fix_NewOrder_Parse, true)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Fix_ExecReport_Encode, false)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_Fix_ExecReport_Encode, true)->Unit(benchmark::kNanosecond)->MinTime(1.0);
+
 // BENCHMARK(BM_Ultra_Mixed_Operations)->Unit(benchmark::kNanosecond)->MinTime(2.0);
 // BENCHMARK(BM_Cache_Performance_Test)->Unit(benchmark::kNanosecond)->MinTime(2.0);
 
@@ -0,0 +1,648 @@
+// benchmarks/pipeline_benchmark.cpp
+//
+// End-to-end pipeline benchmarks over one ITCH sample:
+//   DecodeBook         decode_batch -> BookRouter<UltraOrderBook>
+//   ArbiterDecodeBook  MoldUDP64 A/B feeds -> Arbiter -> decode_one -> books
+//   RouterEngine       SymbolRouter -> MatchingEngine -> MarketDataPublisher
+// Each reports throughput, per-stage latency percentiles from the TSC
+// histograms, and hardware/software counters where perf_event_open allows.
+// Full stage histograms are printed once all benchmarks have run. The book
+// stages build and first-touch their books in an untimed warm-up pass and
+// reset them between iterations, so their latencies measure book work
+// rather than page faults; RouterEngine still starts each iteration from a
+// fresh engine.
+//
+//   pipeline_benchmark [--capture=PATH] [--messages=N] [benchmark flags]
+//
+// --capture replays a recorded ITCH 5.0 file (bare or length-prefixed).
+// Without one, a synthetic sample of N messages (default 1M) is generated
+// with a trading-day-like mix: ~45% adds, ~40% deletes, replaces,
+// executions and partial cancels, some non-book traffic, Zipf-distributed
+// symbol activity and prices spread geometrically away from the touch.
+#include "core/book_router.hpp"
+#include "core/mapped_file.hpp"
+#include "itch/decoder.hpp"
+#include "itch/messages.hpp"
+#include "market_data/publisher.hpp"
+#include "matching/matching_engine.hpp"
+#include "matching/symbol_manager.hpp"
+#include "net/arbiter.hpp"
+#include "net/moldudp64.hpp"
+#include "perf/latency_tracker.hpp"
+#include "perf/perf_counters.hpp"
+#include "perf/tsc_clock.hpp"
+#include <arpa/inet.h>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// --- The sample ---
+
+struct Sample {
+  std::string source;
+  std::vector<char> bytes;                  // Bare messages, back to back
+  std::vector<std::pair<uint32_t, uint16_t>> messages; // Offset and length in bytes
+  std::map<char, uint64_t> mix;             // Message count per type
+};
+
+std::string g_capture;
+size_t g_synthetic_messages = 1000000;
+
+template <typename Msg> void put(std::vector<char> &out, const Msg &m) {
+  const char *b = reinterpret_cast<const char *>(&m);
+  out.insert(out.end(), b, b + sizeof(m));
+}
+
+template <typename Msg> Msg header(char type, uint16_t locate, uint16_t tracking) {
+  Msg m{};
+  m.messageType = type;
+  m.stockLocate = htons(locate);
+  m.trackingNumber = htons(tracking);
+  return m;
+}
+
+void synthesize(Sample &s, size_t count) {
+  constexpr uint32_t SYMBOLS = 500;
+  constexpr uint32_t TICK = 100; // $0.01
+  std::mt19937_64 rng(20240614);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  std::geometric_distribution<uint32_t> depth(0.25); // ticks behind the touch
+
+  // Zipf(1) activity: the busiest symbol trades ~100x the 100th
+  std::vector<double> cdf(SYMBOLS);
+  double total = 0;
+  for (uint32_t i = 0; i < SYMBOLS; ++i) cdf[i] = (total += 1.0 / (i + 1));
+  for (double &c : cdf) c /= total;
+
+  struct Live { uint64_t id; uint32_t shares; };
+  struct Sym {
+    char name[8];
+    uint32_t mid;
+    std::vector<Live> live;
+  };
+  std::vector<Sym> syms(SYMBOLS);
+  uint16_t tracking = 0;
+  for (uint32_t i = 0; i < SYMBOLS; ++i) {
+    char buf[9];
+    std::snprintf(buf, sizeof(buf), "S%-7u", i);
+    std::memcpy(syms[i].name, buf, 8);
+    syms[i].mid = (10 + static_cast<uint32_t>(uni(rng) * 490)) * 10000; // $10 - $500
+    auto r = header<StockDirectoryMessage>('R', uint16_t(i + 1), ++tracking);
+    std::memcpy(r.stockSymbol, syms[i].name, 8);
+    r.roundLotSize = htonl(100);
+    put(s.bytes, r);
+  }
+
+  uint64_t next_id = 1;
+  while (s.bytes.size() < count * 36) {
+    const uint32_t si = static_cast<uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), uni(rng)) - cdf.begin());
+    Sym &sym = syms[si < SYMBOLS ? si : SYMBOLS - 1];
+    const uint16_t locate = uint16_t(&sym - syms.data() + 1);
+    const double r = uni(rng);
+    const bool buy = rng() & 1;
+    const uint32_t price = buy ? sym.mid - TICK * (1 + depth(rng)) : sym.mid + TICK * (1 + depth(rng));
+    if (r < 0.45 || sym.live.size() < 8) {
+      auto m = header<AddOrderMessage>(r < 0.01 ? 'F' : 'A', locate, ++tracking);
+      m.orderReferenceNumber = __builtin_bswap64(next_id);
+      m.buySellIndicator = buy ? 'B' : 'S';
+      const uint32_t shares = 100 * (1 + depth(rng));
+      m.shares = htonl(shares);
+      std::memcpy(m.stockSymbol, sym.name, 8);
+      m.price = htonl(price);
+      if (m.messageType == 'F') {
+        AddOrderWithMPIDMessage f{};
+        std::memcpy(&f, &m, sizeof(m));
+        std::memcpy(f.attribution, "MPID", 4);
+        put(s.bytes, f);
+      } else {
+        put(s.bytes, m);
+      }
+      sym.live.push_back({next_id++, shares});
+      continue;
+    }
+
+    const size_t k = rng() % sym.live.size();
+    Live &o = sym.live[k];
+    if (r < 0.85) {
+      auto m = header<OrderDeleteMessage>('D', locate, ++tracking);
+      m.orderReferenceNumber = __builtin_bswap64(o.id);
+      put(s.bytes, m);
+      o = sym.live.back();
+      sym.live.pop_back();
+    } else if (r < 0.91) {
+      auto m = header<OrderReplaceMessage>('U', locate, ++tracking);
+      m.originalOrderReferenceNumber = __builtin_bswap64(o.id);
+      m.newOrderReferenceNumber = __builtin_bswap64(next_id);
+      m.shares = htonl(o.shares);
+      m.price = htonl(price);
+      put(s.bytes, m);
+      o.id = next_id++;
+    } else if (r < 0.94 && o.shares > 100) {
+      auto m = header<OrderExecutedMessage>('E', locate, ++tracking);
+      m.orderReferenceNumber = __builtin_bswap64(o.id);
+      m.executedShares = htonl(100);
+      put(s.bytes, m);
+      o.shares -= 100;
+    } else if (r < 0.96 && o.shares > 100) {
+      auto m = header<OrderCancelMessage>('X', locate, ++tracking);
+      m.orderReferenceNumber = __builtin_bswap64(o.id);
+      m.canceledShares = htonl(100);
+      put(s.bytes, m);
+      o.shares -= 100;
+    } else if (r < 0.98) {
+      auto m = header<TradeMessage>('P', locate, ++tracking);
+      m.buySellIndicator = buy ? 'B' : 'S';
+      m.shares = htonl(100);
+      std::memcpy(m.stockSymbol, sym.name, 8);
+      m.price = htonl(sym.mid);
+      put(s.bytes, m);
+    } else {
+      auto m = header<NOIIMessage>('I', locate, ++tracking);
+      std::memcpy(m.stockSymbol, sym.name, 8);
+      put(s.bytes, m);
+    }
+  }
+}
+
+// Indexes the messages, converting a length-prefixed capture to bare
+// messages on the way (the arbiter stage writes its own framing)
+bool index_messages(Sample &s, const char *data, size_t size) {
+  const itch::Framing framing = itch::detect_framing(data, size);
+  std::vector<char> bare;
+  size_t pos = 0;
+  while (pos < size) {
+    const char *msg = data + pos;
+    size_t len;
+    if (framing == itch::Framing::LengthPrefixed) {
+      if (pos + 2 > size) break;
+      len = (uint8_t(msg[0]) << 8) | uint8_t(msg[1]);
+      msg += 2;
+      pos += 2;
+    } else {
+      len = itch_message_size(msg[0]);
+    }
+    if (len == 0 || pos + len > size) break;
+    s.messages.emplace_back(static_cast<uint32_t>(bare.size()), static_cast<uint16_t>(len));
+    bare.insert(bare.end(), msg, msg + len);
+    ++s.mix[msg[0]];
+    pos += len;
+  }
+  s.bytes.swap(bare);
+  return !s.messages.empty();
+}
+
+const Sample &sample() {
+  static const Sample s = [] {
+    Sample out;
+    if (!g_capture.empty()) {
+      core::MappedFile file;
+      if (file.open(g_capture.c_str()) && index_messages(out, file.data(), file.size())) {
+        out.source = g_capture;
+        return out;
+      }
+      std::cerr << "Could not read ITCH capture " << g_capture << ", using a synthetic sample" << std::endl;
+      out = Sample{};
+    }
+    Sample gen;
+    synthesize(gen, g_synthetic_messages);
+    index_messages(out, gen.bytes.data(), gen.bytes.size());
+    out.source = "synthetic";
+    return out;
+  }();
+  return s;
+}
+
+// --- Reporting ---
+
+// Stage histograms of the last run of each benchmark, printed at exit
+std::vector<std::pair<std::string, std::unique_ptr<perf::LatencyTracker>>> &stage_registry() {
+  static std::vector<std::pair<std::string, std::unique_ptr<perf::LatencyTracker>>> stages;
+  return stages;
+}
+
+perf::LatencyTracker &stage(const std::string &name) {
+  for (auto &s : stage_registry())
+    if (s.first == name) return *s.second;
+  stage_registry().emplace_back(name, std::make_unique<perf::LatencyTracker>());
+  return *stage_registry().back().second;
+}
+
+// Counters accumulated over the timed part of every iteration
+struct CounterTotals {
+  perf::PerfCounters counters;
+  perf::PerfCounters::Sample sum;
+
+  CounterTotals() { counters.open(); }
+  void start() { counters.start(); }
+  void stop() {
+    const perf::PerfCounters::Sample s = counters.stop();
+    for (uint32_t e = 0; e < perf::PerfCounters::EVENT_COUNT; ++e) {
+      sum.values[e] += s.values[e];
+      sum.valid[e] = s.valid[e];
+    }
+  }
+};
+
+void report(benchmark::State &state, uint64_t msgs, const CounterTotals &totals,
+            std::initializer_list<const char *> stages) {
+  state.SetItemsProcessed(static_cast<int64_t>(msgs));
+  state.counters["ns_per_msg"] =
+      benchmark::Counter(double(msgs), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  for (const char *name : stages) {
+    const auto st = stage(name).get_stats();
+    state.counters[std::string(name) + "_p50"] = double(st.p50_ns);
+    state.counters[std::string(name) + "_p99"] = double(st.p99_ns);
+    state.counters[std::string(name) + "_p999"] = double(st.p999_ns);
+  }
+
+  using PC = perf::PerfCounters;
+  const PC::Sample &s = totals.sum;
+  const double per_msg = msgs ? 1.0 / double(msgs) : 0.0;
+  if (s.has(PC::CYCLES) && s.has(PC::INSTRUCTIONS)) state.counters["ipc"] = s.ipc();
+  for (PC::Event e : {PC::CACHE_MISSES, PC::L1D_READ_MISSES, PC::BRANCH_MISSES}) {
+    if (s.has(e)) state.counters[std::string(PC::name(e)) + "_per_msg"] = double(s[e]) * per_msg;
+  }
+  for (PC::Event e : {PC::PAGE_FAULTS, PC::CONTEXT_SWITCHES}) {
+    if (s.has(e)) state.counters[PC::name(e)] = double(s[e]) / double(state.iterations());
+  }
+}
+
+// --- Stage 1: decode_batch -> books ---
+
+using Books = core::BookRouter<UltraOrderBook>;
+
+// Runs the whole sample through `books` once, untimed, so every book the
+// sample needs exists and its pages are resident, then empties them again.
+// The decoder keeps its symbol ids, so later passes map to the same books.
+void warm_up(itch::Decoder &decoder, Books &books, core::EventBlock &block) {
+  const Sample &s = sample();
+  const char *cur = s.bytes.data();
+  const char *end = cur + s.bytes.size();
+  while (cur < end) {
+    const size_t used = decoder.decode_batch(cur, size_t(end - cur), block);
+    if (used == 0) break;
+    books.apply(block);
+    cur += used;
+  }
+  books.reset();
+}
+
+void BM_Pipeline_DecodeBook(benchmark::State &state) {
+  const Sample &s = sample();
+  perf::LatencyTracker &decode = stage("decode");
+  perf::LatencyTracker &book = stage("book");
+  decode.reset();
+  book.reset();
+  CounterTotals totals;
+  auto block = std::make_unique<core::EventBlock>();
+  uint64_t msgs = 0;
+  core::SymbolTable symtab;
+  itch::Decoder decoder(symtab);
+  auto books = std::make_unique<Books>();
+  warm_up(decoder, *books, *block);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    books->reset();
+    state.ResumeTiming();
+
+    // Latency per EventBlock batch, as the file replay runs it
+    totals.start();
+    const char *cur = s.bytes.data();
+    const char *end = cur + s.bytes.size();
+    while (cur < end) {
+      const uint64_t t0 = perf::tsc().now();
+      const size_t used = decoder.decode_batch(cur, size_t(end - cur), *block);
+      const uint64_t t1 = perf::tsc().now();
+      if (used == 0) break;
+      books->apply(*block);
+      const uint64_t t2 = perf::tsc().now();
+      decode.record_ticks(t0, t1);
+      book.record_ticks(t1, t2);
+      msgs += block->messages;
+      cur += used;
+    }
+    totals.stop();
+  }
+  report(state, msgs, totals, {"decode", "book"});
+}
+
+// --- Stage 2: A/B MoldUDP64 -> arbiter -> decode -> books ---
+
+struct MoldFeeds {
+  std::vector<char> buf;
+  std::vector<core::PacketView> a, b;
+  std::vector<uint32_t> a_index; // Position in b of each packet in a
+};
+
+// Packs the sample into MoldUDP64 packets of up to 1400 bytes. Feed B
+// carries every packet; with `loss`, feed A drops one in 64 and the
+// arbiter fills the hole from B.
+const MoldFeeds &mold_feeds(bool loss) {
+  static MoldFeeds feeds[2];
+  MoldFeeds &f = feeds[loss];
+  if (!f.a.empty()) return f;
+  const Sample &s = sample();
+  constexpr size_t MTU = 1400;
+  f.buf.resize((s.bytes.size() / (MTU - 200) + 2) * MTU + s.messages.size() * 2);
+  size_t used = 0, p = 0;
+  uint64_t seq = 1;
+  while (p < s.messages.size()) {
+    net::mold::PacketWriter w(f.buf.data() + used, MTU);
+    w.begin("PIPE000001", seq);
+    while (p < s.messages.size() && w.append(s.bytes.data() + s.messages[p].first, s.messages[p].second)) {
+      ++p;
+      ++seq;
+    }
+    const core::PacketView v = w.view();
+    used += MTU;
+    f.b.push_back(v);
+    if (!loss || f.b.size() % 64 != 0) {
+      f.a.push_back(v);
+      f.a_index.push_back(static_cast<uint32_t>(f.b.size() - 1));
+    }
+  }
+  return f;
+}
+
+void BM_Pipeline_ArbiterDecodeBook(benchmark::State &state) {
+  const bool loss = state.range(0) != 0;
+  const MoldFeeds &feeds = mold_feeds(loss);
+  perf::LatencyTracker &arbitrate = stage(loss ? "arbiter_lossy" : "arbiter");
+  perf::LatencyTracker &decode = stage(loss ? "arb_decode_lossy" : "arb_decode");
+  perf::LatencyTracker &book = stage(loss ? "arb_book_lossy" : "arb_book");
+  arbitrate.reset();
+  decode.reset();
+  book.reset();
+  CounterTotals totals;
+  uint64_t msgs = 0;
+  uint64_t gaps_filled = 0;
+  core::SymbolTable symtab;
+  itch::Decoder decoder(symtab);
+  auto books = std::make_unique<Books>();
+  warm_up(decoder, *books, *std::make_unique<core::EventBlock>());
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    books->reset();
+    // B trails A by 8 to 16 packets, as a slower path would; A never gets
+    // further ahead, so a hole stays open for about 8 packets
+    size_t ia = 0, ib = 0;
+    auto a_pos = [&] { return ia < feeds.a.size() ? size_t(feeds.a_index[ia]) : feeds.b.size() + 8; };
+    net::Arbiter arb(
+        [&](core::PacketView &p) { return ia < feeds.a.size() && a_pos() <= ib + 16 ? (p = feeds.a[ia++], true) : false; },
+        [&](core::PacketView &p) { return ib < feeds.b.size() && ib + 8 <= a_pos() ? (p = feeds.b[ib++], true) : false; },
+        65536, std::chrono::milliseconds(50), net::Framing::MoldUDP64);
+    state.ResumeTiming();
+
+    // Latency per message
+    totals.start();
+    for (;;) {
+      const uint64_t t0 = perf::tsc().now();
+      auto pkt = arb.next_message();
+      const uint64_t t1 = perf::tsc().now();
+      if (!pkt) {
+        if (ia == feeds.a.size() && ib == feeds.b.size()) break;
+        continue;
+      }
+      const itch::DecodeResult res = decoder.decode_one(pkt->data, pkt->len);
+      const uint64_t t2 = perf::tsc().now();
+      if (res.event) books->apply(*res.event);
+      const uint64_t t3 = perf::tsc().now();
+      arbitrate.record_ticks(t0, t1);
+      decode.record_ticks(t1, t2);
+      book.record_ticks(t2, t3);
+      ++msgs;
+    }
+    totals.stop();
+    gaps_filled = arb.metrics().gap_filled;
+  }
+  if (loss) {
+    report(state, msgs, totals, {"arbiter_lossy", "arb_decode_lossy", "arb_book_lossy"});
+  } else {
+    report(state, msgs, totals, {"arbiter", "arb_decode", "arb_book"});
+  }
+  state.counters["gaps_filled"] = double(gaps_filled);
+}
+
+// --- Stage 3: SymbolRouter -> MatchingEngine -> publisher ---
+
+// The sample as engine commands: adds rest as day limit orders, deletes
+// cancel, replaces replace, and each execution becomes an IOC order from
+// the other side at the resting order's price, so the engine matches as
+// much volume as the feed printed. Partial cancels have no engine
+// counterpart and are left out.
+struct EngineCommands {
+  enum Kind : uint8_t { NEW, CANCEL, REPLACE };
+  struct Command {
+    Kind kind;
+    matching::OrderId old_id;
+    matching::Order order;
+  };
+  std::vector<std::string> symbols; // SymbolManager ids are index + 1
+  std::vector<Command> commands;
+};
+
+const EngineCommands &engine_commands() {
+  static const EngineCommands ec = [] {
+    using matching::Order;
+    using matching::OrderId;
+    using matching::OrderType;
+    using matching::Price;
+    using matching::Side;
+    using matching::SymbolId;
+    using matching::TimeInForce;
+    EngineCommands out;
+    const Sample &s = sample();
+    core::SymbolTable symtab;
+    itch::Decoder decoder(symtab);
+    std::vector<SymbolId> ids; // SymbolTable id -> manager id
+    struct Resting { SymbolId symbol; Side side; Price price; };
+    std::unordered_map<uint64_t, Resting> resting;
+    auto symbol_of = [&](uint16_t sym_id) {
+      if (sym_id >= ids.size()) ids.resize(sym_id + 1, 0);
+      if (!ids[sym_id]) {
+        std::string name(symtab.view(sym_id));
+        while (!name.empty() && name.back() == ' ') name.pop_back();
+        out.symbols.push_back(name);
+        ids[sym_id] = static_cast<SymbolId>(out.symbols.size());
+      }
+      return ids[sym_id];
+    };
+    OrderId next_ioc = 1ull << 62;
+    for (const auto &m : s.messages) {
+      const itch::DecodeResult res = decoder.decode_one(s.bytes.data() + m.first, m.second);
+      if (!res.event) continue;
+      std::visit([&](const auto &e) {
+        using E = std::decay_t<decltype(e)>;
+        if constexpr (std::is_same_v<E, core::AddEvt>) {
+          const Side side = e.side == 'B' ? Side::BUY : Side::SELL;
+          const SymbolId sym = symbol_of(e.sym_id);
+          out.commands.push_back({EngineCommands::NEW, 0,
+                                  Order{e.id, sym, side, OrderType::LIMIT, TimeInForce::DAY, e.qty, 0, e.px}});
+          resting[e.id] = {sym, side, e.px};
+        } else if constexpr (std::is_same_v<E, core::ExecEvt>) {
+          auto it = resting.find(e.id);
+          if (it == resting.end()) return;
+          const Side side = it->second.side == Side::BUY ? Side::SELL : Side::BUY;
+          out.commands.push_back({EngineCommands::NEW, 0,
+                                  Order{next_ioc++, it->second.symbol, side, OrderType::LIMIT, TimeInForce::IOC,
+                                        e.exec_qty, 0, it->second.price}});
+        } else if constexpr (std::is_same_v<E, core::DeleteEvt>) {
+          auto it = resting.find(e.id);
+          if (it == resting.end()) return;
+          out.commands.push_back({EngineCommands::CANCEL, 0, Order{e.id, it->second.symbol}});
+          resting.erase(it);
+        } else if constexpr (std::is_same_v<E, core::ReplaceEvt>) {
+          auto it = resting.find(e.old_id);
+          if (it == resting.end()) return;
+          const Resting r{it->second.symbol, it->second.side, e.px};
+          out.commands.push_back({EngineCommands::REPLACE, e.old_id,
+                                  Order{e.new_id, r.symbol, r.side, OrderType::LIMIT, TimeInForce::DAY, e.qty, 0, e.px}});
+          resting.erase(it);
+          resting[e.new_id] = r;
+        }
+      }, *res.event);
+    }
+    return out;
+  }();
+  return ec;
+}
+
+class CountingSubscriber : public market_data::MarketDataSubscriber {
+public:
+  void on_market_data(const market_data::MarketDataMessage &) override { ++messages; }
+  std::string get_subscriber_id() const override { return "bench"; }
+  std::atomic<uint64_t> messages{0};
+};
+
+void BM_Pipeline_RouterEngine(benchmark::State &state) {
+  using namespace matching;
+  const EngineCommands &ec = engine_commands();
+  perf::LatencyTracker &route = stage("route_match");
+  perf::LatencyTracker &publish = stage("publish");
+  route.reset();
+  publish.reset();
+  CounterTotals totals;
+  uint64_t commands = 0, fills = 0, published = 0, delivered = 0, dropped = 0;
+  perf::Histogram delivery;
+
+  std::vector<Fill> pending;
+  pending.reserve(256);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto symbols = std::make_unique<SymbolManager>();
+    std::vector<SymbolManager::SymbolConfig> configs;
+    for (const std::string &name : ec.symbols)
+      configs.push_back({name, 1, 1, 0x7FFFFFFFu, SymbolState::OPEN});
+    symbols->load_symbols(configs);
+    auto engine = std::make_unique<MatchingEngine>();
+    for (SymbolId id = 1; id <= ec.symbols.size(); ++id) {
+      symbols->set_symbol_state(id, SymbolState::OPEN);
+      engine->add_symbol(id, symbols->get_symbol_info(id)->book_config());
+    }
+    engine->set_fill_callback([&](const Fill &fill) { pending.push_back(fill); });
+    auto router = std::make_unique<SymbolRouter>(*symbols, *engine);
+    auto publisher = std::make_unique<market_data::MarketDataPublisher>(*symbols, *engine);
+    auto subscriber = std::make_shared<CountingSubscriber>();
+    publisher->start();
+    publisher->add_subscriber(subscriber);
+    // Every symbol, unthrottled, so the subscriber sees the whole stream
+    for (auto type : {market_data::MessageType::TRADE_REPORT, market_data::MessageType::LEVEL1_UPDATE,
+                      market_data::MessageType::LEVEL2_UPDATE})
+      publisher->subscribe("bench", 0, type, 10, std::chrono::milliseconds(0));
+    state.ResumeTiming();
+
+    totals.start();
+    for (const EngineCommands::Command &c : ec.commands) {
+      const uint64_t t0 = perf::tsc().now();
+      switch (c.kind) {
+      case EngineCommands::NEW: router->route_order(c.order); break;
+      case EngineCommands::CANCEL: router->route_cancel(c.order.id); break;
+      case EngineCommands::REPLACE: router->route_replace(c.old_id, c.order); break;
+      }
+      const uint64_t t1 = perf::tsc().now();
+      for (const Fill &fill : pending) publisher->publish_trade(fill);
+      publisher->publish_book_changes(c.order.symbol);
+      const uint64_t t2 = perf::tsc().now();
+      route.record_ticks(t0, t1);
+      publish.record_ticks(t1, t2);
+      fills += pending.size();
+      pending.clear();
+    }
+    totals.stop();
+    commands += ec.commands.size();
+
+    state.PauseTiming();
+    // Let the delivery thread catch up before counting what arrived
+    for (uint64_t seen = ~0ull; seen != subscriber->messages.load();) {
+      seen = subscriber->messages.load();
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    publisher->stop();
+    delivered += subscriber->messages.load();
+    published += publisher->get_stats().total_messages;
+    dropped += publisher->get_stats().dropped_messages;
+    delivery += publisher->delivery_latency().snapshot();
+    state.ResumeTiming();
+  }
+  report(state, commands, totals, {"route_match", "publish"});
+  state.counters["fills_per_iter"] = double(fills) / double(state.iterations());
+  state.counters["published_per_iter"] = double(published) / double(state.iterations());
+  state.counters["delivered_per_iter"] = double(delivered) / double(state.iterations());
+  state.counters["dropped_per_iter"] = double(dropped) / double(state.iterations());
+  state.counters["delivery_p99"] = double(delivery.stats().p99_ns);
+}
+
+} // namespace
+
+BENCHMARK(BM_Pipeline_DecodeBook)->Unit(benchmark::kMillisecond)->MinTime(2.0);
+BENCHMARK(BM_Pipeline_ArbiterDecodeBook)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->MinTime(2.0);
+BENCHMARK(BM_Pipeline_RouterEngine)->Unit(benchmark::kMillisecond)->MinTime(2.0);
+
+int main(int argc, char **argv) {
+  // Our flags first; the rest go to Google Benchmark
+  std::vector<char *> args;
+  for (int i = 0; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a.rfind("--capture=", 0) == 0) g_capture = a.substr(10);
+    else if (a.rfind("--messages=", 0) == 0) g_synthetic_messages = std::stoul(a.substr(11));
+    else args.push_back(argv[i]);
+  }
+  int n = static_cast<int>(args.size());
+  benchmark::Initialize(&n, args.data());
+  if (benchmark::ReportUnrecognizedArguments(n, args.data())) return 1;
+
+  const Sample &s = sample();
+  std::cout << "Sample: " << s.source << ", " << s.messages.size() << " messages, " << s.bytes.size()
+            << " bytes; mix:";
+  for (const auto &m : s.mix)
+    std::cout << ' ' << m.first << '=' << std::fixed << std::setprecision(1)
+              << 100.0 * double(m.second) / double(s.messages.size()) << '%';
+  std::cout << std::defaultfloat << std::endl;
+  perf::PerfCounters probe;
+  std::cout << "perf counters:";
+  probe.open();
+  for (uint32_t e = 0; e < perf::PerfCounters::EVENT_COUNT; ++e) {
+    const auto ev = static_cast<perf::PerfCounters::Event>(e);
+    std::cout << ' ' << perf::PerfCounters::name(ev) << (probe.available(ev) ? "" : "(n/a)");
+  }
+  std::cout << std::endl;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  std::cout << "\nStage latency (last run of each benchmark; decode/book per batch, others per message)\n";
+  for (const auto &st : stage_registry()) st.second->print_stats(st.first);
+  return 0;
+}
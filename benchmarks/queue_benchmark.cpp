@@ -5,6 +5,9 @@
 #include <thread>
 #include <vector>
 
+#include "lock_free_queue.hpp"
+#include "object_pool.hpp"
+
 // --- Rakip 1: Standart Mutex Korumalı Kuyruk ---
 std::queue<int> g_mutex_queue;
 std::mutex g_mutex;
@@ -45,9 +48,9 @@ BENCHMARK(BM_Mutex_Queue)->Arg(10000); // 10,000 eleman ile test et
 
 // --- Rakip 2: Basit bir Lock-Free Kuyruk (SPSC - Tek Üretici, Tek Tüketici)
 // ---
-template <typename T> class LockFreeQueue {
+template <typename T> class SimpleLockFreeQueue {
 public:
-  LockFreeQueue(size_t capacity) : buffer_(capacity), head_(0), tail_(0) {}
+  SimpleLockFreeQueue(size_t capacity) : buffer_(capacity), head_(0), tail_(0) {}
 
   bool push(const T &value) {
     size_t tail = tail_.load(std::memory_order_relaxed);
@@ -79,7 +82,7 @@ private:
 static void BM_LockFree_Queue(benchmark::State &state) {
   for (auto _ : state) {
     state.PauseTiming();
-    LockFreeQueue<int> queue(state.range(0) + 1);
+    SimpleLockFreeQueue<int> queue(state.range(0) + 1);
     state.ResumeTiming();
 
     std::thread producer([&] {
@@ -102,4 +105,81 @@ static void BM_LockFree_Queue(benchmark::State &state) {
 }
 BENCHMARK(BM_LockFree_Queue)->Arg(10000);
 
+// --- Rakip 3: Cache-line ayrılmış, 2'nin kuvveti SPSC kuyruk ---
+static void BM_Spsc_Queue(benchmark::State &state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    SpscQueue<int> queue(state.range(0) + 1);
+    state.ResumeTiming();
+
+    std::thread producer([&] {
+      for (int i = 0; i < state.range(0); ++i) {
+        while (!queue.push(i))
+          ;
+      }
+    });
+
+    std::thread consumer([&] {
+      int val;
+      for (int i = 0; i < state.range(0); ++i) {
+        while (!queue.pop(val))
+          ;
+      }
+    });
+    producer.join();
+    consumer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Spsc_Queue)->Arg(10000);
+
+// --- Rakip 4: Aynı kuyruk, recvmmsg gibi 16'lık gruplarla ---
+static void BM_Spsc_Queue_Bulk(benchmark::State &state) {
+  constexpr int BATCH = 16;
+  for (auto _ : state) {
+    state.PauseTiming();
+    SpscQueue<int> queue(state.range(0) + 1);
+    state.ResumeTiming();
+
+    std::thread producer([&] {
+      int items[BATCH];
+      for (int i = 0; i < state.range(0);) {
+        int n = 0;
+        while (n < BATCH && i + n < state.range(0)) { items[n] = i + n; ++n; }
+        int sent = 0;
+        while (sent < n) sent += static_cast<int>(queue.push_bulk(items + sent, n - sent));
+        i += n;
+      }
+    });
+
+    std::thread consumer([&] {
+      int items[BATCH];
+      for (int i = 0; i < state.range(0);)
+        i += static_cast<int>(queue.pop_bulk(items, BATCH));
+    });
+    producer.join();
+    consumer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Spsc_Queue_Bulk)->Arg(10000);
+
+// --- Nesne havuzu: iş parçacığı başına magazin ile acquire/release ---
+struct PoolItem {
+  uint64_t fields[8];
+};
+static OptimizedObjectPool<PoolItem> g_pool(1 << 16);
+
+static void BM_ObjectPool_AcquireRelease(benchmark::State &state) {
+  constexpr int LIVE = 32; // Bir motor vardiyasının aynı anda tuttuğu nesneler
+  PoolItem *items[LIVE];
+  for (auto _ : state) {
+    for (int i = 0; i < LIVE; ++i) items[i] = g_pool.acquire();
+    for (int i = 0; i < LIVE; ++i) g_pool.release(items[i]);
+  }
+  benchmark::DoNotOptimize(items);
+  state.SetItemsProcessed(state.iterations() * LIVE);
+}
+BENCHMARK(BM_ObjectPool_AcquireRelease)->Threads(1)->Threads(4)->Threads(8);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,568 @@
+#ifndef BOOK_BASIC_ORDER_BOOK_HPP
+#define BOOK_BASIC_ORDER_BOOK_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "order_book.hpp"
+
+namespace book {
+
+// Order book assembled at compile time from four policies, so each
+// deployment carries only what it uses:
+//   PriceLadderPolicy  where price levels live (DenseLadder, MapLadder)
+//   OrderIndexPolicy   order id -> resting order (SwissIndex, StdIndex)
+//   AllocatorPolicy    where order nodes come from (SlabAllocator, ChunkAllocator)
+//   DepthTrackingPolicy what a level keeps: totals only (TopOfBook, LevelDepth)
+//                      or a FIFO queue of its orders (OrderDepth)
+// Everything is resolved statically; core::apply dispatches to it without
+// virtual calls. Prices are in ITCH units with a tick of 1.
+
+// -------- Depth tracking --------
+
+// Order node for books without per-level queues: 16 bytes
+struct LeanOrder {
+  uint64_t id_and_side;
+  uint32_t quantity;
+  uint32_t price;
+
+  uint64_t get_id() const { return id_and_side >> 1; }
+  char get_side() const { return (id_and_side & 1) ? 'B' : 'S'; }
+  void set_id_side(uint64_t id, char side) { id_and_side = (id << 1) | (side == 'B' ? 1 : 0); }
+};
+
+struct LevelTotals {
+  uint32_t total_quantity;
+  uint32_t order_count;
+};
+
+// Levels aggregate quantity and order count; orders are only indexed, not
+// queued. Walkable adds depth walks (L2); without it only the touch is
+// exposed (L1).
+template <bool Walkable> struct AggregateDepth {
+  using Node = LeanOrder;
+  using Level = LevelTotals;
+  static constexpr bool WALKABLE = Walkable;
+  static constexpr bool QUEUES = false;
+
+  static void link(Level& level, Node* order) {
+    level.total_quantity += order->quantity;
+    ++level.order_count;
+  }
+  static void unlink(Level& level, Node* order) {
+    level.total_quantity -= order->quantity;
+    --level.order_count;
+  }
+};
+
+using TopOfBook = AggregateDepth<false>;
+using LevelDepth = AggregateDepth<true>;
+
+// Each level is an intrusive FIFO queue of its orders in time priority (L3)
+struct OrderDepth {
+  using Node = UltraOrder;
+  using Level = UltraPriceLevel;
+  static constexpr bool WALKABLE = true;
+  static constexpr bool QUEUES = true;
+
+  static void link(Level& level, Node* order) {
+    level.total_quantity += order->quantity;
+    ++level.order_count;
+    order->next = nullptr;
+    order->prev = level.last_order;
+    if (level.last_order) level.last_order->next = order;
+    else level.first_order = order;
+    level.last_order = order;
+  }
+  static void unlink(Level& level, Node* order) {
+    level.total_quantity -= order->quantity;
+    --level.order_count;
+    if (order->prev) order->prev->next = order->next;
+    else level.first_order = order->next;
+    if (order->next) order->next->prev = order->prev;
+    else level.last_order = order->prev;
+  }
+};
+
+// -------- Price ladders --------
+// Ladder<Level>: get() returns the level at a price, creating it; update()
+// is called after every change to a level so occupancy and the touch stay
+// current (empty levels are dropped). References from get() are valid until
+// the next update().
+
+// A dense window of N ticks, centred on the first price and re-centred when
+// the touch leaves it, with far-away levels in a sparse map per side (the
+// UltraOrderBook layout). Best price is a cached index kept by a bitmap.
+// The window is mapped lazily, so a book only pays for the pages its prices
+// touch; levels are zero whenever they are empty.
+template <uint32_t N = ULTRA_PRICE_LEVELS> struct DenseLadder {
+  template <typename Level> class Ladder {
+  public:
+    Ladder() = default;
+
+    Level& get(bool buy, uint32_t price) {
+      if (__builtin_expect(base_ == UNPLACED, 0)) base_ = base_for(price);
+      const uint32_t i = index_of(price);
+      if (__builtin_expect(i != Bitmap::NONE, 1)) return side(buy).levels[i];
+      return side(buy).far[price];
+    }
+
+    const Level* find(bool buy, uint32_t price) const {
+      const uint32_t i = index_of(price);
+      const Side& s = side(buy);
+      if (__builtin_expect(i != Bitmap::NONE, 1)) return s.bits.test(i) ? &s.levels[i] : nullptr;
+      auto it = s.far.find(price);
+      return it != s.far.end() ? &it->second : nullptr;
+    }
+
+    void update(bool buy, uint32_t price) {
+      const uint32_t i = index_of(price);
+      if (__builtin_expect(i != Bitmap::NONE, 1)) {
+        sync(buy, i);
+        return;
+      }
+      auto& far = side(buy).far;
+      auto it = far.find(price);
+      if (it == far.end()) return;
+      if (it->second.total_quantity == 0) far.erase(it);
+      else maybe_recenter();
+    }
+
+    uint32_t best(bool buy) const {
+      const Side& s = side(buy);
+      uint32_t best = s.best == Bitmap::NONE ? 0 : base_ + s.best;
+      if (__builtin_expect(!s.far.empty(), 0)) {
+        const uint32_t far = buy ? s.far.rbegin()->first : s.far.begin()->first;
+        if (best == 0 || (buy ? far > best : far < best)) best = far;
+      }
+      return best;
+    }
+
+    // fn(price, level) from the touch outwards, up to `depth` levels
+    template <typename Fn> void walk(bool buy, uint32_t depth, Fn&& fn) const {
+      const Side& s = side(buy);
+      if (buy) {
+        auto it = s.far.rbegin();
+        for (; it != s.far.rend() && it->first > base_ && depth > 0; ++it, --depth) fn(it->first, it->second);
+        for (uint32_t i = s.best; i != Bitmap::NONE && depth > 0; --depth) {
+          fn(base_ + i, s.levels[i]);
+          i = i == 0 ? Bitmap::NONE : s.bits.find_prev(i - 1);
+        }
+        for (; it != s.far.rend() && depth > 0; ++it, --depth) fn(it->first, it->second);
+      } else {
+        auto it = s.far.begin();
+        for (; it != s.far.end() && it->first < base_ && depth > 0; ++it, --depth) fn(it->first, it->second);
+        for (uint32_t i = s.best; i != Bitmap::NONE && depth > 0; --depth) {
+          fn(base_ + i, s.levels[i]);
+          i = s.bits.find_next(i + 1);
+        }
+        for (; it != s.far.end() && depth > 0; ++it, --depth) fn(it->first, it->second);
+      }
+    }
+
+    void clear() {
+      for (Side* s : {&bids_, &asks_}) {
+        for (uint32_t i = s->bits.lowest(); i != Bitmap::NONE; i = s->bits.find_next(i + 1)) s->levels[i] = Level{};
+        s->bits.clear();
+        s->best = Bitmap::NONE;
+        s->far.clear();
+      }
+      base_ = UNPLACED;
+    }
+
+  private:
+    using Bitmap = LevelBitmap<N>;
+    static constexpr uint32_t UNPLACED = 0xFFFFFFFFu;
+
+    struct Side {
+      LevelArray<Level, N> levels;
+      Bitmap bits;
+      uint32_t best{Bitmap::NONE};
+      std::map<uint32_t, Level> far; // Never overlaps the window
+    };
+
+    Side& side(bool buy) { return buy ? bids_ : asks_; }
+    const Side& side(bool buy) const { return buy ? bids_ : asks_; }
+
+    uint32_t index_of(uint32_t price) const {
+      if (price < base_) return Bitmap::NONE;
+      const uint32_t i = price - base_;
+      return i < N ? i : Bitmap::NONE;
+    }
+
+    static uint32_t base_for(uint32_t center) {
+      uint64_t lo = center > N / 2 ? center - N / 2 : 1;
+      if (lo + N - 1 > 0xFFFFFFFEull) lo = 0xFFFFFFFFull - N;
+      return static_cast<uint32_t>(lo);
+    }
+
+    void sync(bool buy, uint32_t i) {
+      Side& s = side(buy);
+      if (s.levels[i].total_quantity > 0) {
+        s.bits.set(i);
+        if (s.best == Bitmap::NONE || (buy ? i > s.best : i < s.best)) s.best = i;
+      } else {
+        s.bits.reset(i);
+        if (i == s.best) s.best = buy ? s.bits.find_prev(i) : s.bits.find_next(i);
+      }
+    }
+
+    // A level outside the window is occupied: slide the window onto the mid
+    // (or the single-sided touch) once either touch is no longer dense
+    void maybe_recenter() {
+      const uint32_t bid = best(true), ask = best(false);
+      const bool bid_out = bid && index_of(bid) == Bitmap::NONE;
+      const bool ask_out = ask && index_of(ask) == Bitmap::NONE;
+      if (!bid_out && !ask_out) return;
+      const uint32_t center = (bid && ask) ? static_cast<uint32_t>((uint64_t(bid) + ask) / 2) : (bid ? bid : ask);
+      const uint32_t new_base = base_for(center);
+      if (new_base == base_) return;
+
+      std::vector<std::pair<uint32_t, Level>> moved[2];
+      for (int b = 0; b < 2; ++b) {
+        Side& s = side(b == 0);
+        for (uint32_t i = s.bits.lowest(); i != Bitmap::NONE; i = s.bits.find_next(i + 1)) {
+          moved[b].emplace_back(base_ + i, s.levels[i]);
+          s.levels[i] = Level{};
+        }
+        s.bits.clear();
+        s.best = Bitmap::NONE;
+      }
+      base_ = new_base;
+      for (int b = 0; b < 2; ++b) {
+        Side& s = side(b == 0);
+        for (auto it = s.far.lower_bound(base_); it != s.far.end() && it->first - base_ < N;) {
+          moved[b].emplace_back(it->first, it->second);
+          it = s.far.erase(it);
+        }
+        for (const auto& [price, level] : moved[b]) {
+          const uint32_t i = index_of(price);
+          if (i == Bitmap::NONE) {
+            s.far[price] = level;
+          } else {
+            s.levels[i] = level;
+            sync(b == 0, i);
+          }
+        }
+      }
+    }
+
+    Side bids_;
+    Side asks_;
+    uint32_t base_{UNPLACED};
+  };
+};
+
+// One std::map per side: any price range at a footprint proportional to the
+// occupied levels, for thin symbols and reference runs
+struct MapLadder {
+  template <typename Level> class Ladder {
+  public:
+    Level& get(bool buy, uint32_t price) { return side(buy)[price]; }
+
+    const Level* find(bool buy, uint32_t price) const {
+      const auto& s = buy ? bids_ : asks_;
+      auto it = s.find(price);
+      return it != s.end() ? &it->second : nullptr;
+    }
+
+    void update(bool buy, uint32_t price) {
+      auto& s = side(buy);
+      auto it = s.find(price);
+      if (it != s.end() && it->second.total_quantity == 0) s.erase(it);
+    }
+
+    uint32_t best(bool buy) const {
+      if (buy) return bids_.empty() ? 0 : bids_.rbegin()->first;
+      return asks_.empty() ? 0 : asks_.begin()->first;
+    }
+
+    template <typename Fn> void walk(bool buy, uint32_t depth, Fn&& fn) const {
+      if (buy) {
+        for (auto it = bids_.rbegin(); it != bids_.rend() && depth > 0; ++it, --depth) fn(it->first, it->second);
+      } else {
+        for (auto it = asks_.begin(); it != asks_.end() && depth > 0; ++it, --depth) fn(it->first, it->second);
+      }
+    }
+
+    void clear() {
+      bids_.clear();
+      asks_.clear();
+    }
+
+  private:
+    std::map<uint32_t, Level>& side(bool buy) { return buy ? bids_ : asks_; }
+
+    std::map<uint32_t, Level> bids_;
+    std::map<uint32_t, Level> asks_;
+  };
+};
+
+// -------- Order indexes --------
+
+// Swiss-table index of UltraOrderBook: SIMD probing, incremental rehash
+struct SwissIndex {
+  template <typename Node> class Index {
+  public:
+    explicit Index(uint32_t expected) : table_(expected) {}
+    void insert(uint64_t id, Node* order) { table_.ultra_insert(id, order); }
+    Node* find(uint64_t id) const { return table_.ultra_find(id); }
+    void remove(uint64_t id) { table_.ultra_remove(id); }
+    void prefetch(uint64_t id) const { table_.ultra_prefetch(id); }
+    void clear() { table_.clear(); }
+
+  private:
+    UltraHashIndex<Node> table_;
+  };
+};
+
+struct StdIndex {
+  template <typename Node> class Index {
+  public:
+    explicit Index(uint32_t expected) { map_.reserve(expected); }
+    void insert(uint64_t id, Node* order) { map_[id] = order; }
+    Node* find(uint64_t id) const {
+      auto it = map_.find(id);
+      return it != map_.end() ? it->second : nullptr;
+    }
+    void remove(uint64_t id) { map_.erase(id); }
+    void prefetch(uint64_t) const {}
+    void clear() { map_.clear(); }
+
+  private:
+    std::unordered_map<uint64_t, Node*> map_;
+  };
+};
+
+// -------- Allocators --------
+
+// Recycling pool that doubles from a small heap chunk up to 2 MB huge-page
+// slabs (UltraSlabPool)
+struct SlabAllocator {
+  template <typename Node> class Pool {
+  public:
+    explicit Pool(uint32_t expected) : pool_(expected) {}
+    Node* acquire() { return pool_.ultra_fast_acquire(); }
+    void release(Node* order) { pool_.ultra_release(order); }
+    void clear() { pool_.reset(); }
+    uint32_t live() const { return pool_.live(); }
+
+  private:
+    UltraSlabPool<Node> pool_;
+  };
+};
+
+// Recycling pool over small heap chunks: no 2 MB slab per book, for the
+// many thin symbols of a full feed and for reference runs
+struct ChunkAllocator {
+  template <typename Node> class Pool {
+  public:
+    static_assert(sizeof(Node) >= sizeof(Node*), "free-list link lives in the node");
+    static constexpr uint32_t CHUNK_ORDERS = 256;
+
+    explicit Pool(uint32_t) {}
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    Node* acquire() {
+      Node* order = free_head_;
+      if (order) {
+        std::memcpy(&free_head_, order, sizeof(Node*));
+      } else {
+        if (bump_ == CHUNK_ORDERS * chunks_.size()) chunks_.emplace_back(new Node[CHUNK_ORDERS]);
+        order = &chunks_[bump_ / CHUNK_ORDERS][bump_ % CHUNK_ORDERS];
+        ++bump_;
+      }
+      ++live_;
+      return order;
+    }
+    void release(Node* order) {
+      std::memcpy(order, &free_head_, sizeof(Node*));
+      free_head_ = order;
+      --live_;
+    }
+    // Forgets every outstanding order; chunks stay for reuse
+    void clear() {
+      free_head_ = nullptr;
+      bump_ = 0;
+      live_ = 0;
+    }
+    uint32_t live() const { return live_; }
+
+  private:
+    std::vector<std::unique_ptr<Node[]>> chunks_;
+    Node* free_head_{nullptr};
+    size_t bump_{0};
+    uint32_t live_{0};
+  };
+};
+
+// -------- The book --------
+
+// Initial order index sizing; the index grows with the book, so a full feed
+// of mostly thin symbols starts each one small
+constexpr uint32_t BASIC_BOOK_ORDERS = 1024;
+
+template <typename PriceLadderPolicy, typename OrderIndexPolicy, typename AllocatorPolicy,
+          typename DepthTrackingPolicy>
+class BasicOrderBook {
+public:
+  using Depth = DepthTrackingPolicy;
+  using Node = typename Depth::Node;
+  using Level = typename Depth::Level;
+
+  explicit BasicOrderBook(uint32_t expected_orders = BASIC_BOOK_ORDERS)
+      : index_(expected_orders), pool_(expected_orders) {}
+
+  BasicOrderBook(const BasicOrderBook&) = delete;
+  BasicOrderBook& operator=(const BasicOrderBook&) = delete;
+
+  __attribute__((always_inline)) inline void addOrder(uint64_t orderId, char side, uint32_t quantity,
+                                                      uint32_t price) {
+    if (__builtin_expect(quantity == 0 || price == 0 || price == 0xFFFFFFFFu, 0)) return;
+    if (__builtin_expect(index_.find(orderId) != nullptr, 0)) return; // Order exists
+    Node* order = pool_.acquire();
+    if (__builtin_expect(!order, 0)) return; // Pool exhausted
+    order->set_id_side(orderId, side);
+    order->quantity = quantity;
+    order->price = price;
+    const bool buy = side == 'B';
+    Depth::link(ladder_.get(buy, price), order);
+    index_.insert(orderId, order);
+    ladder_.update(buy, price);
+  }
+
+  // Also used for cancels: both take shares off a resting order
+  __attribute__((always_inline)) inline void executeOrder(uint64_t orderId, uint32_t executed_qty) {
+    Node* order = index_.find(orderId);
+    if (!order) return;
+    const bool buy = order->get_side() == 'B';
+    const uint32_t price = order->price;
+    Level& level = ladder_.get(buy, price);
+    if (executed_qty < order->quantity) {
+      level.total_quantity -= executed_qty;
+      order->quantity -= executed_qty;
+    } else {
+      Depth::unlink(level, order);
+      index_.remove(orderId);
+      pool_.release(order);
+    }
+    ladder_.update(buy, price);
+  }
+
+  __attribute__((always_inline)) inline void deleteOrder(uint64_t orderId) {
+    Node* order = index_.find(orderId);
+    if (!order) return;
+    const bool buy = order->get_side() == 'B';
+    const uint32_t price = order->price;
+    Depth::unlink(ladder_.get(buy, price), order);
+    index_.remove(orderId);
+    pool_.release(order);
+    ladder_.update(buy, price);
+  }
+
+  // The new order keeps the side and loses time priority
+  __attribute__((always_inline)) inline void replaceOrder(uint64_t oldId, uint64_t newId, uint32_t newQty,
+                                                          uint32_t newPrice) {
+    Node* order = index_.find(oldId);
+    if (!order) return;
+    const char side = order->get_side();
+    deleteOrder(oldId);
+    addOrder(newId, side, newQty, newPrice);
+  }
+
+  uint32_t getBestBid() const { return ladder_.best(true); }
+  uint32_t getBestAsk() const { return ladder_.best(false); }
+
+  uint32_t getBestBidQuantity() const { return quantity_at(true, getBestBid()); }
+  uint32_t getBestAskQuantity() const { return quantity_at(false, getBestAsk()); }
+
+  // fn(price, total_quantity, order_count) from the touch outwards (L2 and L3 books)
+  template <typename Fn> void walkBids(uint32_t depth, Fn&& fn) const {
+    static_assert(Depth::WALKABLE, "depth walks need LevelDepth or OrderDepth");
+    ladder_.walk(true, depth, [&](uint32_t price, const Level& l) { fn(price, l.total_quantity, l.order_count); });
+  }
+  template <typename Fn> void walkAsks(uint32_t depth, Fn&& fn) const {
+    static_assert(Depth::WALKABLE, "depth walks need LevelDepth or OrderDepth");
+    ladder_.walk(false, depth, [&](uint32_t price, const Level& l) { fn(price, l.total_quantity, l.order_count); });
+  }
+
+  // Front of the FIFO queue at a price, or nullptr (OrderDepth books);
+  // follow UltraOrder::next towards the back
+  const Node* queueFront(bool is_buy, uint32_t price) const {
+    static_assert(Depth::QUEUES, "queues need OrderDepth");
+    const Level* level = ladder_.find(is_buy, price);
+    return level ? level->first_order : nullptr;
+  }
+
+  // Zero-based queue position of a resting order, -1 if unknown (OrderDepth books)
+  int64_t queuePosition(uint64_t orderId) const {
+    static_assert(Depth::QUEUES, "queues need OrderDepth");
+    const Node* order = index_.find(orderId);
+    if (!order) return -1;
+    int64_t pos = 0;
+    for (const Node* o = order->prev; o; o = o->prev) ++pos;
+    return pos;
+  }
+
+  uint32_t liveOrders() const { return pool_.live(); }
+
+  // Batch consumers (core::BookRouter) call these a few events ahead
+  __attribute__((always_inline)) inline void prefetchOrder(uint64_t orderId) const { index_.prefetch(orderId); }
+  __attribute__((always_inline)) inline void prefetchOrderData(uint64_t orderId) const {
+    if (const Node* o = index_.find(orderId)) __builtin_prefetch(o, 1, 3);
+  }
+
+  void clear() {
+    index_.clear();
+    pool_.clear();
+    ladder_.clear();
+  }
+
+  void display() const {
+    std::cout << "Best Bid: " << (getBestBid() / 10000.0) << " x " << getBestBidQuantity() << std::endl;
+    std::cout << "Best Ask: " << (getBestAsk() / 10000.0) << " x " << getBestAskQuantity() << std::endl;
+    if constexpr (Depth::WALKABLE) {
+      auto print_level = [](uint32_t price, uint32_t qty, uint32_t) {
+        std::cout << "        " << qty << " | " << (price / 10000.0) << std::endl;
+      };
+      std::cout << "--- BIDS ---         QTY | PRICE" << std::endl;
+      walkBids(10, print_level);
+      std::cout << "--- ASKS ---         QTY | PRICE" << std::endl;
+      walkAsks(10, print_level);
+    }
+  }
+
+private:
+  uint32_t quantity_at(bool buy, uint32_t price) const {
+    const Level* level = price ? ladder_.find(buy, price) : nullptr;
+    return level ? level->total_quantity : 0;
+  }
+
+  typename PriceLadderPolicy::template Ladder<Level> ladder_;
+  typename OrderIndexPolicy::template Index<Node> index_;
+  typename AllocatorPolicy::template Pool<Node> pool_;
+};
+
+// -------- Deployments --------
+// The feed-handler books are held one per symbol, so they take their nodes
+// from small heap chunks rather than a 2 MB slab each
+
+// Feed handlers that only publish the touch: no queues, no depth walks
+using L1Book = BasicOrderBook<DenseLadder<>, SwissIndex, ChunkAllocator, TopOfBook>;
+// Full depth by level without per-order queues
+using L2Book = BasicOrderBook<DenseLadder<>, SwissIndex, ChunkAllocator, LevelDepth>;
+// Full-depth FIFO book for matching and queue-position analytics
+using FifoBook = BasicOrderBook<DenseLadder<>, SwissIndex, ChunkAllocator, OrderDepth>;
+// Map-based FIFO book on the standard containers: small, any price range,
+// and a reference to check the faster books against
+using ReferenceBook = BasicOrderBook<MapLadder, StdIndex, ChunkAllocator, OrderDepth>;
+
+} // namespace book
+
+#endif // BOOK_BASIC_ORDER_BOOK_HPP
@@ -3,6 +3,7 @@
 
 #include "core/event.hpp"
 #include "order_book.hpp"
+#include "book/basic_order_book.hpp"
 
 namespace core {
 
@@ -27,6 +28,9 @@ inline void apply(const ItchEvent& evt, OptimizedOrderBook& ob) {
   std::visit([&](auto&& ev){ apply_event(ev, ob); }, evt);
 }
 
+inline uint32_t best_bid(const OptimizedOrderBook& ob) { return ob.getBestBid(); }
+inline uint32_t best_ask(const OptimizedOrderBook& ob) { return ob.getBestAsk(); }
+
 // -------- UltraOrderBook overloads --------
 inline void apply_event(const AddEvt& e, UltraOrderBook& ob) {
   ob.ultra_addOrder(e.id, e.side, e.qty, e.px);
@@ -48,6 +52,41 @@ inline void apply(const ItchEvent& evt, UltraOrderBook& ob) {
   std::visit([&](auto&& ev){ apply_event(ev, ob); }, evt);
 }
 
+inline uint32_t best_bid(const UltraOrderBook& ob) { return ob.ultra_getBestBid(); }
+inline uint32_t best_ask(const UltraOrderBook& ob) { return ob.ultra_getBestAsk(); }
+
+// -------- book::BasicOrderBook overloads (any policy set) --------
+template <typename L, typename I, typename A, typename D>
+inline void apply_event(const AddEvt& e, book::BasicOrderBook<L, I, A, D>& ob) {
+  ob.addOrder(e.id, e.side, e.qty, e.px);
+}
+template <typename L, typename I, typename A, typename D>
+inline void apply_event(const ExecEvt& e, book::BasicOrderBook<L, I, A, D>& ob) {
+  ob.executeOrder(e.id, e.exec_qty);
+}
+template <typename L, typename I, typename A, typename D>
+inline void apply_event(const CancelEvt& e, book::BasicOrderBook<L, I, A, D>& ob) {
+  ob.executeOrder(e.id, e.qty);
+}
+template <typename L, typename I, typename A, typename D>
+inline void apply_event(const DeleteEvt& e, book::BasicOrderBook<L, I, A, D>& ob) {
+  ob.deleteOrder(e.id);
+}
+template <typename L, typename I, typename A, typename D>
+inline void apply_event(const ReplaceEvt& e, book::BasicOrderBook<L, I, A, D>& ob) {
+  ob.replaceOrder(e.old_id, e.new_id, e.qty, e.px);
+}
+
+template <typename L, typename I, typename A, typename D>
+inline void apply(const ItchEvent& evt, book::BasicOrderBook<L, I, A, D>& ob) {
+  std::visit([&](auto&& ev){ apply_event(ev, ob); }, evt);
+}
+
+template <typename L, typename I, typename A, typename D>
+inline uint32_t best_bid(const book::BasicOrderBook<L, I, A, D>& ob) { return ob.getBestBid(); }
+template <typename L, typename I, typename A, typename D>
+inline uint32_t best_ask(const book::BasicOrderBook<L, I, A, D>& ob) { return ob.getBestAsk(); }
+
 } // namespace core
 
 #endif // CORE_APPLY_HPP
@@ -0,0 +1,243 @@
+#ifndef CORE_BOOK_ROUTER_HPP
+#define CORE_BOOK_ROUTER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "core/apply.hpp"
+#include "core/event.hpp"
+#include "core/event_block.hpp"
+#include "core/symbol_table.hpp"
+
+namespace core {
+
+// Order id -> symbol id map for events that only carry the order reference.
+// ITCH order reference numbers are assigned densely through the day, so ids are
+// stored in lazily allocated 64K-entry pages (one shift + one load per lookup).
+// Ids beyond the paged range fall back to a hash map.
+class OrderSymbolIndex {
+public:
+  using SymbolId = SymbolTable::SymbolId;
+
+  static constexpr uint32_t PAGE_BITS = 16;
+  static constexpr uint64_t PAGE_SIZE = 1ull << PAGE_BITS;
+  static constexpr uint64_t PAGE_MASK = PAGE_SIZE - 1;
+  static constexpr uint64_t MAX_PAGES = 1ull << 16; // ids below 2^32 stay paged
+
+  void set(uint64_t order_id, SymbolId sym) {
+    const uint64_t page = order_id >> PAGE_BITS;
+    if (__builtin_expect(page >= MAX_PAGES, 0)) {
+      if (sym == 0) overflow_.erase(order_id); else overflow_[order_id] = sym;
+      return;
+    }
+    if (page >= pages_.size()) pages_.resize(page + 1);
+    auto& p = pages_[page];
+    if (!p) {
+      if (sym == 0) return;
+      p.reset(new SymbolId[PAGE_SIZE]());
+    }
+    p[order_id & PAGE_MASK] = sym;
+  }
+
+  // Returns 0 for unknown order ids
+  SymbolId get(uint64_t order_id) const {
+    const uint64_t page = order_id >> PAGE_BITS;
+    if (__builtin_expect(page >= MAX_PAGES, 0)) {
+      auto it = overflow_.find(order_id);
+      return it != overflow_.end() ? it->second : 0;
+    }
+    if (page >= pages_.size() || !pages_[page]) return 0;
+    return pages_[page][order_id & PAGE_MASK];
+  }
+
+  void erase(uint64_t order_id) { set(order_id, 0); }
+
+  // Forgets every id, keeping the pages allocated
+  void clear() {
+    for (auto& p : pages_)
+      if (p) std::memset(p.get(), 0, PAGE_SIZE * sizeof(SymbolId));
+    overflow_.clear();
+  }
+
+private:
+  std::vector<std::unique_ptr<SymbolId[]>> pages_;
+  std::unordered_map<uint64_t, SymbolId> overflow_;
+};
+
+// Per-symbol book set: a flat array indexed by SymbolId with books allocated on
+// the first Add for that symbol. Order events without a symbol are routed
+// through the OrderSymbolIndex.
+template <typename OB>
+class BookRouter {
+public:
+  using SymbolId = SymbolTable::SymbolId;
+  // Builds the book for a symbol on its first Add, e.g. with a config sized
+  // for a thin name; without one books are default-constructed
+  using Factory = std::function<std::unique_ptr<OB>(SymbolId)>;
+
+  explicit BookRouter(Factory make = nullptr) : books_(MAX_SYMBOLS), make_(std::move(make)) {}
+
+  OB& book_for(SymbolId sym) {
+    auto& slot = books_[sym];
+    if (__builtin_expect(!slot, 0)) {
+      slot = make_ ? make_(sym) : std::make_unique<OB>();
+      ++book_count_;
+    }
+    return *slot;
+  }
+
+  OB* find(SymbolId sym) const { return books_[sym].get(); }
+
+  void apply(const ItchEvent& evt) {
+    std::visit([&](auto&& ev){ route(ev); }, evt);
+  }
+
+  // Applies a decoded batch in feed order, one tight loop per same-type run.
+  // Books with an order prefetch get the order PREFETCH_AHEAD entries further
+  // down the same column requested while the current one is applied.
+  void apply(const EventBlock& blk) {
+    uint16_t at[5] = {};
+    for (uint16_t r = 0; r < blk.run_count; ++r) {
+      const EventBlock::Run run = blk.runs[r];
+      const uint16_t begin = at[run.kind];
+      const uint16_t end = static_cast<uint16_t>(begin + run.count);
+      at[run.kind] = end;
+      switch (run.kind) {
+        case EventBlock::Add:
+          for (uint16_t i = begin; i < end; ++i)
+            route(AddEvt{blk.adds.id[i], blk.adds.side[i], blk.adds.qty[i], blk.adds.px[i], blk.adds.sym[i]});
+          break;
+        case EventBlock::Exec:
+          for (uint16_t i = begin; i < end; ++i) {
+            prefetch_ahead(blk.execs.id, i, blk.count[EventBlock::Exec]);
+            route(ExecEvt{blk.execs.id[i], blk.execs.qty[i]});
+          }
+          break;
+        case EventBlock::Cancel:
+          for (uint16_t i = begin; i < end; ++i) {
+            prefetch_ahead(blk.cancels.id, i, blk.count[EventBlock::Cancel]);
+            route(CancelEvt{blk.cancels.id[i], blk.cancels.qty[i]});
+          }
+          break;
+        case EventBlock::Delete:
+          for (uint16_t i = begin; i < end; ++i) {
+            prefetch_ahead(blk.deletes.id, i, blk.count[EventBlock::Delete]);
+            route(DeleteEvt{blk.deletes.id[i]});
+          }
+          break;
+        case EventBlock::Replace:
+          for (uint16_t i = begin; i < end; ++i) {
+            prefetch_ahead(blk.replaces.old_id, i, blk.count[EventBlock::Replace]);
+            route(ReplaceEvt{blk.replaces.old_id[i], blk.replaces.new_id[i], blk.replaces.qty[i],
+                             blk.replaces.px[i], 0});
+          }
+          break;
+      }
+    }
+  }
+
+  size_t book_count() const { return book_count_; }
+
+  // Empties every book and the order index but keeps them allocated, so a
+  // replay of the same feed reuses memory that is already resident
+  void reset() {
+    for (auto& ob : books_) {
+      if (!ob) continue;
+      if constexpr (has_order_prefetch<OB>::value) ob->reset_pool();
+      else ob->clear();
+    }
+    order_sym_.clear();
+  }
+
+  // Calls fn(SymbolId, const OB&) for every allocated book in id order
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    for (size_t i = 0; i < books_.size(); ++i) {
+      if (books_[i]) fn(static_cast<SymbolId>(i), *books_[i]);
+    }
+  }
+
+private:
+  static constexpr size_t MAX_SYMBOLS = 65536;
+  static constexpr uint16_t PREFETCH_INDEX_AHEAD = 8;
+  static constexpr uint16_t PREFETCH_ORDER_AHEAD = 4;
+
+  template <typename B, typename = void>
+  struct has_order_prefetch : std::false_type {};
+  template <typename B>
+  struct has_order_prefetch<B, std::void_t<decltype(std::declval<const B&>().ultra_prefetchOrder(0))>>
+      : std::true_type {};
+  template <typename B, typename = void>
+  struct has_basic_prefetch : std::false_type {};
+  template <typename B>
+  struct has_basic_prefetch<B, std::void_t<decltype(std::declval<const B&>().prefetchOrder(0))>>
+      : std::true_type {};
+
+  static void prefetch_index(const OB& ob, uint64_t id) {
+    if constexpr (has_order_prefetch<OB>::value) ob.ultra_prefetchOrder(id);
+    else ob.prefetchOrder(id);
+  }
+  static void prefetch_order(const OB& ob, uint64_t id) {
+    if constexpr (has_order_prefetch<OB>::value) ob.ultra_prefetchOrderData(id);
+    else ob.prefetchOrderData(id);
+  }
+
+  void prefetch_ahead(const uint64_t* ids, uint16_t i, uint16_t count) const {
+    if constexpr (has_order_prefetch<OB>::value || has_basic_prefetch<OB>::value) {
+      if (i + PREFETCH_INDEX_AHEAD < count) {
+        const uint64_t id = ids[i + PREFETCH_INDEX_AHEAD];
+        if (const OB* ob = find(order_sym_.get(id))) prefetch_index(*ob, id);
+      }
+      if (i + PREFETCH_ORDER_AHEAD < count) {
+        const uint64_t id = ids[i + PREFETCH_ORDER_AHEAD];
+        if (const OB* ob = find(order_sym_.get(id))) prefetch_order(*ob, id);
+      }
+    }
+  }
+
+  void route(const AddEvt& e) {
+    if (e.sym_id == 0) return;
+    order_sym_.set(e.id, e.sym_id);
+    apply_event(e, book_for(e.sym_id));
+  }
+
+  void route(const ExecEvt& e) {
+    if (OB* ob = find(order_sym_.get(e.id))) apply_event(e, *ob);
+  }
+
+  void route(const CancelEvt& e) {
+    if (OB* ob = find(order_sym_.get(e.id))) apply_event(e, *ob);
+  }
+
+  void route(const DeleteEvt& e) {
+    const SymbolId sym = order_sym_.get(e.id);
+    if (OB* ob = find(sym)) {
+      apply_event(e, *ob);
+      order_sym_.erase(e.id);
+    }
+  }
+
+  void route(const ReplaceEvt& e) {
+    // Replace never changes the symbol: the new id inherits the old mapping
+    const SymbolId sym = order_sym_.get(e.old_id);
+    if (OB* ob = find(sym)) {
+      apply_event(e, *ob);
+      order_sym_.erase(e.old_id);
+      order_sym_.set(e.new_id, sym);
+    }
+  }
+
+  std::vector<std::unique_ptr<OB>> books_;
+  Factory make_;
+  OrderSymbolIndex order_sym_;
+  size_t book_count_{0};
+};
+
+} // namespace core
+
+#endif // CORE_BOOK_ROUTER_HPP
@@ -0,0 +1,81 @@
+#ifndef CORE_EVENT_BLOCK_HPP
+#define CORE_EVENT_BLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace core {
+
+// Struct-of-arrays batch of decoded order events. Every event type has its own
+// columns; `runs` records the original interleaving as consecutive same-type
+// stretches, so a consumer can apply each stretch in a tight loop and still
+// see events in feed order.
+struct EventBlock {
+  static constexpr size_t CAPACITY = 256; // per event type
+  static constexpr size_t MAX_RUNS = 512;
+
+  enum Kind : uint8_t { Add, Exec, Cancel, Delete, Replace };
+
+  struct Run {
+    Kind kind;
+    uint16_t count;
+  };
+
+  struct Adds {
+    uint64_t id[CAPACITY];
+    uint32_t qty[CAPACITY];
+    uint32_t px[CAPACITY];
+    uint16_t sym[CAPACITY];
+    char side[CAPACITY];
+  };
+  struct Quantities { // executions and cancels
+    uint64_t id[CAPACITY];
+    uint32_t qty[CAPACITY];
+  };
+  struct Deletes {
+    uint64_t id[CAPACITY];
+  };
+  struct Replaces {
+    uint64_t old_id[CAPACITY];
+    uint64_t new_id[CAPACITY];
+    uint32_t qty[CAPACITY];
+    uint32_t px[CAPACITY];
+  };
+
+  Adds adds;
+  Quantities execs;
+  Quantities cancels;
+  Deletes deletes;
+  Replaces replaces;
+  uint16_t count[5]{}; // filled entries per Kind
+  Run runs[MAX_RUNS];
+  uint16_t run_count{0};
+  uint32_t messages{0}; // messages consumed, including ones without an event
+
+  void clear() {
+    for (auto& c : count) c = 0;
+    run_count = 0;
+    messages = 0;
+  }
+
+  size_t events() const { return size_t(count[Add]) + count[Exec] + count[Cancel] + count[Delete] + count[Replace]; }
+
+  // Room left for one more event of `kind`
+  bool full(Kind kind) const {
+    return count[kind] == CAPACITY || (run_count == MAX_RUNS && runs[run_count - 1].kind != kind);
+  }
+
+  // Accounts for one more event of `kind`; its column slot is count[kind] - 1
+  uint16_t push(Kind kind) {
+    if (run_count && runs[run_count - 1].kind == kind) {
+      ++runs[run_count - 1].count;
+    } else {
+      runs[run_count++] = Run{kind, 1};
+    }
+    return count[kind]++;
+  }
+};
+
+} // namespace core
+
+#endif // CORE_EVENT_BLOCK_HPP
@@ -0,0 +1,82 @@
+#ifndef CORE_MAPPED_FILE_HPP
+#define CORE_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace core {
+
+// Read-only mapping of a capture for front-to-back replay. Nothing is read
+// up front: the kernel is told the access is sequential, the next WINDOW is
+// requested ahead of the reader, and windows already consumed are dropped so
+// a multi-GB day never has to be resident at once.
+class MappedFile {
+public:
+  static constexpr size_t WINDOW = 64u << 20;
+
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool open(const char* path) {
+    close();
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) { ::close(fd); return true; } // empty: nothing to map
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file referenced
+    if (p == MAP_FAILED) { size_ = 0; return false; }
+    data_ = static_cast<const char*>(p);
+    madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    ahead_ = 0;
+    dropped_ = 0;
+    advance(0);
+    return true;
+  }
+
+  void close() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Tells the mapping the reader has reached `pos`: keeps a window of
+  // readahead in flight and releases pages more than a window behind
+  void advance(size_t pos) {
+    if (!data_) return;
+    while (ahead_ < size_ && ahead_ < pos + 2 * WINDOW) {
+      const size_t len = ahead_ + WINDOW <= size_ ? WINDOW : size_ - ahead_;
+      madvise(const_cast<char*>(data_) + ahead_, len, MADV_WILLNEED);
+      ahead_ += len;
+    }
+    while (dropped_ + 2 * WINDOW <= pos) {
+      madvise(const_cast<char*>(data_) + dropped_, WINDOW, MADV_DONTNEED);
+      dropped_ += WINDOW;
+    }
+  }
+
+private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  size_t ahead_{0};   // readahead requested up to here
+  size_t dropped_{0}; // pages below here have been released
+};
+
+} // namespace core
+
+#endif // CORE_MAPPED_FILE_HPP
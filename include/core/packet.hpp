@@ -10,6 +10,10 @@ namespace core {
 struct PacketView {
   const char* data{nullptr};
   uint32_t len{0};
+  // When the packet was received, CLOCK_REALTIME ns; 0 if not stamped. NIC
+  // hardware stamps are in the PHC domain and only comparable with the host
+  // clock when the two are synchronised (phc2sys).
+  uint64_t rx_ns{0};
 };
 
 // Small inline message storage (enough for largest ITCH message here)
@@ -0,0 +1,287 @@
+#ifndef CORE_SNAPSHOT_HPP
+#define CORE_SNAPSHOT_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "core/book_router.hpp"
+#include "core/event.hpp"
+#include "core/symbol_table.hpp"
+
+namespace core {
+
+// Book checkpoints: the symbol table and every resting order, tagged with
+// the feed position they reflect, so a restart loads the image and replays
+// only what came after it.
+//
+// The image is the books' logical content, not their memory: pool slabs,
+// levels and the order index are all pointer-linked, so they are rebuilt
+// by adding the orders back (in queue order, which keeps every FIFO). The
+// file is fixed-layout and little-endian (x86 native): a Header, then
+// symbol_count Symbols (ids 1..n), book_count Books and order_count Orders,
+// each book's orders following the previous book's. Every section is a
+// multiple of 8 bytes, so a mapping of the file is read in place.
+namespace snapshot {
+
+constexpr char MAGIC[8] = {'O', 'B', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint32_t VERSION = 1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;     // sizeof(Header) of the writer
+  uint64_t sequence;        // Last feed message applied (messages, or arbiter sequence)
+  uint64_t feed_offset;     // File replay: byte offset to continue from
+  uint64_t created_ns;      // Wall clock
+  uint32_t symbol_count;
+  uint32_t book_count;
+  uint64_t order_count;
+  uint64_t file_size;
+  uint64_t checksum;        // Of everything after the header
+};
+
+struct Symbol {
+  char name[8];             // As in the feed, space padded
+};
+
+struct Book {
+  uint16_t symbol;
+  uint16_t reserved0;
+  uint32_t order_count;
+  uint64_t reserved1;
+};
+
+struct Order {
+  uint64_t id;
+  uint32_t quantity;
+  uint32_t price;
+  char side;                // 'B' or 'S'
+  char reserved[7];
+};
+
+static_assert(sizeof(Header) == 72 && sizeof(Symbol) == 8 && sizeof(Book) == 16 && sizeof(Order) == 24,
+              "snapshot layout changed; bump VERSION");
+
+// Word-at-a-time FNV-1a variant; sections are whole words
+inline uint64_t checksum(uint64_t h, const void* data, size_t len) {
+  const char* p = static_cast<const char*>(data);
+  for (size_t i = 0; i + 8 <= len; i += 8) {
+    uint64_t w;
+    std::memcpy(&w, p + i, 8);
+    h = (h ^ w) * 1099511628211ull;
+  }
+  return h;
+}
+constexpr uint64_t CHECKSUM_SEED = 1469598103934665603ull;
+
+// Buffered writes straight to a file descriptor. No allocation and only
+// async-signal-safe calls, so it can run in a child forked from a
+// multithreaded process.
+class FdWriter {
+public:
+  explicit FdWriter(int fd) : fd_(fd) {}
+
+  void put(const void* data, size_t len) {
+    sum_ = checksum(sum_, data, len);
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+      if (n_ == sizeof(buf_)) flush();
+      const size_t chunk = len < sizeof(buf_) - n_ ? len : sizeof(buf_) - n_;
+      std::memcpy(buf_ + n_, p, chunk);
+      n_ += chunk;
+      p += chunk;
+      len -= chunk;
+    }
+  }
+
+  bool flush() {
+    size_t off = 0;
+    while (ok_ && off < n_) {
+      const ssize_t r = ::write(fd_, buf_ + off, n_ - off);
+      if (r < 0 && errno == EINTR) continue;
+      if (r <= 0) { ok_ = false; break; }
+      off += static_cast<size_t>(r);
+    }
+    written_ += n_;
+    n_ = 0;
+    return ok_;
+  }
+
+  uint64_t checksum_value() const { return sum_; }
+  uint64_t bytes() const { return written_ + n_; }
+  bool ok() const { return ok_; }
+
+private:
+  int fd_;
+  char buf_[1 << 16];
+  size_t n_{0};
+  uint64_t written_{0};
+  uint64_t sum_{CHECKSUM_SEED};
+  bool ok_{true};
+};
+
+} // namespace snapshot
+
+// Writes a checkpoint of `books` to tmp_path, then renames it over path,
+// so a reader never sees a partial image. Safe to call in a forked child
+// (see BackgroundSnapshot). Books need ultra_forEachOrder/ultra_liveOrders.
+template <typename OB>
+bool write_snapshot(const char* path, const char* tmp_path, const SymbolTable& symtab,
+                    const BookRouter<OB>& books, uint64_t sequence, uint64_t feed_offset) {
+  using namespace snapshot;
+  const int fd = ::open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) return false;
+
+  Header h{};
+  std::memcpy(h.magic, MAGIC, sizeof(h.magic));
+  h.version = VERSION;
+  h.header_size = sizeof(Header);
+  h.sequence = sequence;
+  h.feed_offset = feed_offset;
+  timespec ts{};
+  clock_gettime(CLOCK_REALTIME, &ts);
+  h.created_ns = uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+  h.symbol_count = static_cast<uint32_t>(symtab.size());
+  books.for_each([&](SymbolTable::SymbolId, const OB& ob) {
+    ++h.book_count;
+    h.order_count += ob.ultra_liveOrders();
+  });
+
+  // The header goes in first as a placeholder and is rewritten at the end
+  FdWriter out(fd);
+  bool ok = ::write(fd, &h, sizeof(h)) == ssize_t(sizeof(h));
+  for (uint32_t id = 1; ok && id <= h.symbol_count; ++id) {
+    Symbol s;
+    std::memset(s.name, ' ', sizeof(s.name));
+    const std::string_view name = symtab.view(static_cast<SymbolTable::SymbolId>(id));
+    std::memcpy(s.name, name.data(), name.size() < sizeof(s.name) ? name.size() : sizeof(s.name));
+    out.put(&s, sizeof(s));
+  }
+  books.for_each([&](SymbolTable::SymbolId sym, const OB& ob) {
+    const Book b{sym, 0, ob.ultra_liveOrders(), 0};
+    out.put(&b, sizeof(b));
+  });
+  uint64_t orders = 0;
+  books.for_each([&](SymbolTable::SymbolId, const OB& ob) {
+    ob.ultra_forEachOrder([&](uint64_t id, char side, uint32_t qty, uint32_t price) {
+      const Order o{id, qty, price, side, {}};
+      out.put(&o, sizeof(o));
+      ++orders;
+    });
+  });
+  ok = ok && out.flush() && orders == h.order_count;
+
+  h.file_size = sizeof(h) + out.bytes();
+  h.checksum = out.checksum_value();
+  ok = ok && ::pwrite(fd, &h, sizeof(h), 0) == ssize_t(sizeof(h)) && ::fsync(fd) == 0;
+  ok = ::close(fd) == 0 && ok;
+  if (ok) ok = ::rename(tmp_path, path) == 0;
+  if (!ok) ::unlink(tmp_path);
+  return ok;
+}
+
+// A checkpoint image, validated and read in place (from a mapping of the file)
+struct SnapshotView {
+  const snapshot::Header* header{nullptr};
+  const snapshot::Symbol* symbols{nullptr};
+  const snapshot::Book* books{nullptr};
+  const snapshot::Order* orders{nullptr};
+
+  // Null on success, otherwise what is wrong with the image
+  const char* parse(const char* data, size_t size) {
+    using namespace snapshot;
+    if (size < sizeof(Header)) return "file too short";
+    header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) return "not a snapshot";
+    if (header->version != VERSION || header->header_size != sizeof(Header)) return "unsupported version";
+    const uint64_t body = uint64_t(header->symbol_count) * sizeof(Symbol) +
+                          uint64_t(header->book_count) * sizeof(Book) + header->order_count * sizeof(Order);
+    if (header->file_size != size || sizeof(Header) + body != size) return "truncated or resized";
+    if (checksum(CHECKSUM_SEED, data + sizeof(Header), body) != header->checksum) return "checksum mismatch";
+    symbols = reinterpret_cast<const Symbol*>(data + sizeof(Header));
+    books = reinterpret_cast<const Book*>(symbols + header->symbol_count);
+    orders = reinterpret_cast<const Order*>(books + header->book_count);
+    return nullptr;
+  }
+};
+
+// Loads an image into an empty symbol table and book set. Returns the
+// number of orders added, or -1 if the symbol ids cannot be reproduced.
+template <typename OB>
+int64_t restore_snapshot(const SnapshotView& snap, SymbolTable& symtab, BookRouter<OB>& books) {
+  for (uint32_t i = 0; i < snap.header->symbol_count; ++i) {
+    if (symtab.get_or_intern(snap.symbols[i].name) != i + 1) return -1;
+  }
+  const snapshot::Order* o = snap.orders;
+  for (uint32_t b = 0; b < snap.header->book_count; ++b) {
+    const snapshot::Book& book = snap.books[b];
+    for (uint32_t i = 0; i < book.order_count; ++i, ++o)
+      books.apply(ItchEvent{AddEvt{o->id, o->side, o->quantity, o->price, book.symbol}});
+  }
+  return static_cast<int64_t>(o - snap.orders);
+}
+
+// Takes checkpoints in a forked child, which writes from its copy-on-write
+// view of memory while the parent keeps applying the feed. The parent pays
+// for the fork (page tables) and copies each page it modifies while the
+// child runs, 2 MB at a time for huge-page slabs, instead of stopping for
+// the write.
+class BackgroundSnapshot {
+public:
+  BackgroundSnapshot() = default;
+  ~BackgroundSnapshot() { wait(); }
+
+  BackgroundSnapshot(const BackgroundSnapshot&) = delete;
+  BackgroundSnapshot& operator=(const BackgroundSnapshot&) = delete;
+
+  // Forks and runs write() in the child, whose result becomes its exit
+  // status. False if a checkpoint is still being written or fork fails.
+  template <typename WriteFn>
+  bool start(WriteFn&& write) {
+    if (busy()) return false;
+    const pid_t pid = ::fork();
+    if (pid < 0) return false;
+    if (pid == 0) ::_exit(write() ? 0 : 1);
+    child_ = pid;
+    return true;
+  }
+
+  // Reaps a finished child; true while one is still writing
+  bool busy() { return child_ > 0 && !reap(WNOHANG); }
+
+  // Blocks until the running checkpoint, if any, is done
+  void wait() {
+    if (child_ > 0) reap(0);
+  }
+
+  uint64_t completed() const { return completed_; }
+  uint64_t failed() const { return failed_; }
+
+private:
+  bool reap(int flags) {
+    int status = 0;
+    pid_t r;
+    do {
+      r = ::waitpid(child_, &status, flags);
+    } while (r < 0 && errno == EINTR);
+    if (r == 0) return false; // still running
+    if (r == child_ && WIFEXITED(status) && WEXITSTATUS(status) == 0) ++completed_; else ++failed_;
+    child_ = -1;
+    return true;
+  }
+
+  pid_t child_{-1};
+  uint64_t completed_{0};
+  uint64_t failed_{0};
+};
+
+} // namespace core
+
+#endif // CORE_SNAPSHOT_HPP
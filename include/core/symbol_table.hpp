@@ -3,52 +3,104 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 
 namespace core {
 
-// Simple symbol table: maps 8-char (padded) symbol to uint16_t id.
+// Maps 8-char (space padded) symbols to uint16_t ids. The symbol bytes are
+// the key as one uint64_t, kept in a small open-addressed table. ITCH also
+// numbers each stock with a stock locate for the day, so the usual lookup is
+// locate -> id straight from an array, confirmed with one 8-byte compare.
 class SymbolTable {
 public:
   using SymbolId = uint16_t;
 
-  SymbolTable() : next_id_(1) {}
+  SymbolTable() : names_(1), keys_(1, 0), slots_(INITIAL_SLOTS) {}
 
-  // Accepts pointer to 8-char array (may be space padded). Returns stable id.
+  // Accepts pointer to 8-char array (may be space padded). Returns stable id,
+  // 0 once all 65535 ids are taken.
   SymbolId get_or_intern(const char* sym8) {
-    // Create trimmed view without allocation
-    std::string_view sv(sym8, 8);
-    while (!sv.empty() && sv.back() == ' ') sv.remove_suffix(1);
-
-    auto it = map_.find(sv);
-    if (it != map_.end()) return it->second;
-
-    SymbolId id = next_id_++;
-    // Store key in storage_ to own the bytes
-    auto& slot = storage_[id];
-    for (size_t i = 0; i < 8; ++i) slot[i] = sym8[i];
-    slot[8] = '\0';
-    map_.emplace(std::string_view(slot.data(), sv.size()), id);
+    const uint64_t key = load_key(sym8);
+    size_t i = hash(key) & (slots_.size() - 1);
+    while (slots_[i].id != 0) {
+      if (slots_[i].key == key) return slots_[i].id;
+      i = (i + 1) & (slots_.size() - 1);
+    }
+    if (keys_.size() > MAX_ID) return 0;
+
+    const SymbolId id = static_cast<SymbolId>(keys_.size());
+    slots_[i] = Slot{key, id};
+    keys_.push_back(key);
+    names_.emplace_back();
+    std::memcpy(names_.back().data(), sym8, 8);
+    if (keys_.size() * 2 > slots_.size()) grow();
+    return id;
+  }
+
+  // Same, with the message's stock locate as the primary path; locate 0
+  // (not set) and locates that changed symbol go through the hash
+  SymbolId get_or_intern(uint16_t locate, const char* sym8) {
+    if (locate != 0 && locate < by_locate_.size()) {
+      const SymbolId id = by_locate_[locate];
+      if (id != 0 && keys_[id] == load_key(sym8)) return id;
+    }
+    const SymbolId id = get_or_intern(sym8);
+    if (locate != 0) {
+      if (locate >= by_locate_.size()) by_locate_.resize(size_t(locate) + 1, 0);
+      by_locate_[locate] = id;
+    }
     return id;
   }
 
   // Read-only view of stored symbol bytes
   std::string_view view(SymbolId id) const {
-    if (id == 0) return {};
-    const auto& slot = storage_[id];
-    std::string_view sv(slot.data());
-    return sv;
+    if (id == 0 || id >= names_.size()) return {};
+    return std::string_view(names_[id].data());
   }
 
+  size_t size() const { return keys_.size() - 1; }
+
 private:
-  // Up to 65535 symbols
-  std::array<std::array<char,9>, 65536> storage_{}; // 8 + NUL
-  std::unordered_map<std::string_view, SymbolId> map_{}; // views into storage_
-  SymbolId next_id_;
+  static constexpr size_t INITIAL_SLOTS = 64;
+  static constexpr size_t MAX_ID = 65535;
+
+  struct Slot {
+    uint64_t key;
+    SymbolId id; // 0: empty
+  };
+
+  static uint64_t load_key(const char* sym8) {
+    uint64_t k;
+    std::memcpy(&k, sym8, sizeof(k));
+    return k;
+  }
+
+  static size_t hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+  }
+
+  void grow() {
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    for (const Slot& s : old) {
+      if (s.id == 0) continue;
+      size_t i = hash(s.key) & (slots_.size() - 1);
+      while (slots_[i].id != 0) i = (i + 1) & (slots_.size() - 1);
+      slots_[i] = s;
+    }
+  }
+
+  std::vector<std::array<char, 9>> names_; // by id: 8 + NUL, [0] unused
+  std::vector<uint64_t> keys_;              // by id, [0] unused
+  std::vector<Slot> slots_;                 // power of two, at most half full
+  std::vector<SymbolId> by_locate_;         // 0: locate not seen yet
 };
 
 } // namespace core
 
 #endif // CORE_SYMBOL_TABLE_HPP
-
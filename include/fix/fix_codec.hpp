@@ -0,0 +1,389 @@
+#ifndef FIX_CODEC_HPP
+#define FIX_CODEC_HPP
+
+#include "fix_protocol.hpp"
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+namespace fix {
+
+// Framing result of frame_length()
+constexpr long FRAME_INCOMPLETE = 0;
+constexpr long FRAME_ERROR = -1;
+
+// Length of the complete message at the start of data, from its BodyLength;
+// FRAME_INCOMPLETE if more bytes are needed, FRAME_ERROR if data does not
+// start with 8=...<SOH>9=<digits><SOH> or the length points past 10=.
+inline long frame_length(const char* data, size_t length) {
+    if (length < 2) return FRAME_INCOMPLETE;
+    if (data[0] != '8' || data[1] != '=') return FRAME_ERROR;
+    const char* end = data + length;
+    const char* p = static_cast<const char*>(std::memchr(data + 2, SOH, length - 2));
+    if (!p) return length > 32 ? FRAME_ERROR : FRAME_INCOMPLETE;
+    ++p;
+    if (end - p < 2) return FRAME_INCOMPLETE;
+    if (p[0] != '9' || p[1] != '=') return FRAME_ERROR;
+    p += 2;
+    size_t body = 0;
+    int digits = 0;
+    for (; p < end && *p != SOH; ++p, ++digits) {
+        if (*p < '0' || *p > '9' || digits == 6) return FRAME_ERROR;
+        body = body * 10 + static_cast<size_t>(*p - '0');
+    }
+    if (p == end) return FRAME_INCOMPLETE;
+    if (digits == 0) return FRAME_ERROR;
+    const size_t total = static_cast<size_t>(p + 1 - data) + body + 7; // 10=xxx<SOH>
+    if (total > length) return FRAME_INCOMPLETE;
+    const char* trailer = data + total - 7;
+    if (trailer[0] != '1' || trailer[1] != '0' || trailer[2] != '=' || trailer[6] != SOH) return FRAME_ERROR;
+    return static_cast<long>(total);
+}
+
+// Sum of the bytes modulo 256
+inline unsigned checksum(const char* data, size_t length) {
+    unsigned sum = 0;
+    for (size_t i = 0; i < length; ++i) sum += static_cast<unsigned char>(data[i]);
+    return sum & 0xFF;
+}
+
+// Checks the 10=xxx<SOH> trailer of one framed message against its bytes
+inline bool checksum_ok(const char* data, size_t length) {
+    if (length < 7) return false;
+    const char* t = data + length - 7;
+    if (t[0] != '1' || t[1] != '0' || t[2] != '=' || t[6] != SOH) return false;
+    unsigned stated = 0;
+    for (int i = 3; i < 6; ++i) {
+        if (t[i] < '0' || t[i] > '9') return false;
+        stated = stated * 10 + static_cast<unsigned>(t[i] - '0');
+    }
+    return checksum(data, length - 7) == stated;
+}
+
+// Field values, parsed in place
+inline bool parse_uint(std::string_view s, uint64_t& out) {
+    if (s.empty() || s.size() > 19) return false;
+    uint64_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    out = v;
+    return true;
+}
+
+// Decimal price in 1/10000 units; digits beyond the fourth decimal are
+// truncated, as the double conversion did
+inline bool parse_price(std::string_view s, uint64_t& out) {
+    if (s.empty() || s.size() > 19) return false;
+    uint64_t whole = 0;
+    size_t i = 0;
+    for (; i < s.size() && s[i] != '.'; ++i) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        whole = whole * 10 + static_cast<uint64_t>(s[i] - '0');
+    }
+    uint64_t frac = 0;
+    int places = 0;
+    if (i < s.size()) {
+        for (++i; i < s.size(); ++i) {
+            if (s[i] < '0' || s[i] > '9') return false;
+            if (places < 4) {
+                frac = frac * 10 + static_cast<uint64_t>(s[i] - '0');
+                ++places;
+            }
+        }
+    }
+    for (; places < 4; ++places) frac *= 10;
+    out = whole * 10000 + frac;
+    return true;
+}
+
+inline char* write_uint(char* p, uint64_t v) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+// Right-aligned, zero-padded to width (FIX ints may carry leading zeros)
+inline void write_padded(char* p, uint64_t v, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    }
+}
+
+// 1/10000 units as a decimal, trailing zeros dropped
+inline char* write_price(char* p, uint64_t fixed4) {
+    p = write_uint(p, fixed4 / 10000);
+    uint64_t frac = fixed4 % 10000;
+    if (frac) {
+        int places = 4;
+        while (frac % 10 == 0) {
+            frac /= 10;
+            --places;
+        }
+        *p++ = '.';
+        write_padded(p, frac, places);
+        p += places;
+    }
+    return p;
+}
+
+// Fields of one received message, indexed in place: a flat array of
+// (tag, offset, length) over the caller's buffer, which must outlive the
+// view. The tags the order path reads are also kept in fixed slots, so
+// looking them up is one load; others are found by a scan of the array.
+class FixView {
+public:
+    static constexpr size_t MAX_FIELDS = 96;
+
+    struct Field {
+        uint32_t tag;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // Indexes one framed message (see frame_length); false if a field is
+    // malformed, there are too many, or MsgType is missing
+    bool parse(const char* data, size_t length) {
+        data_ = data;
+        length_ = length;
+        count_ = 0;
+        std::memset(fast_, 0, sizeof(fast_));
+        const char* p = data;
+        const char* end = data + length;
+        while (p < end) {
+            uint32_t tag = 0;
+            const char* t = p;
+            for (; p < end && *p >= '0' && *p <= '9'; ++p) tag = tag * 10 + static_cast<uint32_t>(*p - '0');
+            if (p == end || *p != '=' || p == t || p - t > 6) return false;
+            const char* value = ++p;
+            const char* soh = static_cast<const char*>(std::memchr(value, SOH, static_cast<size_t>(end - value)));
+            if (!soh || count_ == MAX_FIELDS) return false;
+            fields_[count_] = Field{tag, static_cast<uint32_t>(value - data), static_cast<uint32_t>(soh - value)};
+            const int slot = fast_slot(tag);
+            if (slot >= 0 && fast_[slot] == 0) fast_[slot] = static_cast<uint8_t>(count_ + 1);
+            ++count_;
+            p = soh + 1;
+        }
+        return has(FixTag::MsgType);
+    }
+
+    // Empty if absent
+    std::string_view get(int tag) const {
+        const int slot = fast_slot(static_cast<uint32_t>(tag));
+        if (slot >= 0) {
+            return fast_[slot] ? value(fields_[fast_[slot] - 1]) : std::string_view{};
+        }
+        for (size_t i = 0; i < count_; ++i) {
+            if (fields_[i].tag == static_cast<uint32_t>(tag)) return value(fields_[i]);
+        }
+        return {};
+    }
+
+    std::string_view get(FixTag tag) const { return get(static_cast<int>(tag)); }
+
+    bool has(FixTag tag) const {
+        const int slot = fast_slot(static_cast<uint32_t>(tag));
+        if (slot >= 0) return fast_[slot] != 0;
+        for (size_t i = 0; i < count_; ++i) {
+            if (fields_[i].tag == static_cast<uint32_t>(tag)) return true;
+        }
+        return false;
+    }
+
+    // First character, '\0' if absent
+    char get_char(FixTag tag) const {
+        const std::string_view v = get(tag);
+        return v.empty() ? '\0' : v[0];
+    }
+
+    bool get_uint(FixTag tag, uint64_t& out) const { return parse_uint(get(tag), out); }
+    bool get_price(FixTag tag, uint64_t& out) const { return parse_price(get(tag), out); }
+
+    char msg_type() const { return get_char(FixTag::MsgType); }
+
+    size_t field_count() const { return count_; }
+    const Field& field(size_t i) const { return fields_[i]; }
+    std::string_view value(const Field& f) const { return std::string_view(data_ + f.offset, f.length); }
+    std::string_view raw() const { return std::string_view(data_, length_); }
+
+    // Copies the fields into a FixMessage, for the map-based handlers
+    FixMessage to_message() const {
+        FixMessage message;
+        for (size_t i = 0; i < count_; ++i) {
+            message.add_field(FixField(static_cast<int>(fields_[i].tag), std::string(value(fields_[i]))));
+        }
+        return message;
+    }
+
+private:
+    static constexpr int FAST_SLOTS = 11;
+
+    static int fast_slot(uint32_t tag) {
+        switch (tag) {
+            case 35: return 0;  // MsgType
+            case 34: return 1;  // MsgSeqNum
+            case 49: return 2;  // SenderCompID
+            case 56: return 3;  // TargetCompID
+            case 11: return 4;  // ClOrdID
+            case 55: return 5;  // Symbol
+            case 54: return 6;  // Side
+            case 38: return 7;  // OrderQty
+            case 44: return 8;  // Price
+            case 40: return 9;  // OrdType
+            case 59: return 10; // TimeInForce
+            default: return -1;
+        }
+    }
+
+    const char* data_{nullptr};
+    size_t length_{0};
+    size_t count_{0};
+    uint8_t fast_[FAST_SLOTS]{}; // Index + 1 into fields_, 0 when absent
+    Field fields_[MAX_FIELDS];
+};
+
+// Execution report contents; quantities in shares, prices in 1/10000
+struct ExecReport {
+    uint64_t order_id{0};
+    std::string_view cl_ord_id;
+    uint64_t exec_id{0};
+    ExecType exec_type{ExecType::NEW};
+    OrdStatus ord_status{OrdStatus::NEW};
+    std::string_view symbol;
+    Side side{Side::BUY};
+    uint64_t leaves_qty{0};
+    uint64_t cum_qty{0};
+    uint64_t avg_px{0};
+    uint64_t last_shares{0};  // 0: no LastShares/LastPx
+    uint64_t last_px{0};
+    std::string_view text;    // Empty: no Text
+};
+
+// Encodes execution reports for one session into a buffer that already
+// holds the header, built once from the session's comp ids. Per report
+// only MsgSeqNum, SendingTime, BodyLength and CheckSum are patched in
+// place (the first three are fixed width) and the body is written after
+// the header, so an encode is a few hundred bytes of stores and no
+// allocation. The returned view is valid until the next encode.
+class ExecReportEncoder {
+public:
+    static constexpr size_t MAX_ID = 32;    // Longer comp ids are truncated
+    static constexpr size_t MAX_VALUE = 64; // Longer ClOrdID, Symbol, Text are truncated
+
+    ExecReportEncoder(std::string_view sender, std::string_view target) {
+        char* p = buf_;
+        p = put(p, "8=FIX.4.2\0019=");
+        body_length_at_ = static_cast<size_t>(p - buf_);
+        p = put(p, "0000\00135=8\00149=");
+        body_start_ = body_length_at_ + 5;
+        p = put(p, sender.substr(0, MAX_ID));
+        p = put(p, "\00156=");
+        p = put(p, target.substr(0, MAX_ID));
+        p = put(p, "\00134=");
+        seq_at_ = static_cast<size_t>(p - buf_);
+        p = put(p, "0000000000\00152=");
+        time_at_ = static_cast<size_t>(p - buf_);
+        p = put(p, "00000000-00:00:00.000\001");
+        header_end_ = static_cast<size_t>(p - buf_);
+    }
+
+    std::string_view encode(const ExecReport& r, uint64_t seq_num, uint64_t wall_ns) {
+        write_padded(buf_ + seq_at_, seq_num, 10);
+        write_time(wall_ns);
+
+        char* p = buf_ + header_end_;
+        p = put(p, "37=");
+        p = write_uint(p, r.order_id);
+        p = put(p, "\00111=");
+        p = put(p, r.cl_ord_id.substr(0, MAX_VALUE));
+        p = put(p, "\00117=E");
+        p = write_uint(p, r.exec_id);
+        p = put(p, "\001150=");
+        *p++ = static_cast<char>(r.exec_type);
+        p = put(p, "\00139=");
+        *p++ = static_cast<char>(r.ord_status);
+        p = put(p, "\00155=");
+        p = put(p, r.symbol.substr(0, MAX_VALUE));
+        p = put(p, "\00154=");
+        *p++ = static_cast<char>(r.side);
+        p = put(p, "\001151=");
+        p = write_uint(p, r.leaves_qty);
+        p = put(p, "\00114=");
+        p = write_uint(p, r.cum_qty);
+        p = put(p, "\0016=");
+        p = write_price(p, r.avg_px);
+        *p++ = SOH;
+        if (r.last_shares) {
+            p = put(p, "32=");
+            p = write_uint(p, r.last_shares);
+            p = put(p, "\00131=");
+            p = write_price(p, r.last_px);
+            *p++ = SOH;
+        }
+        if (!r.text.empty()) {
+            p = put(p, "58=");
+            p = put(p, r.text.substr(0, MAX_VALUE));
+            *p++ = SOH;
+        }
+
+        const size_t body_end = static_cast<size_t>(p - buf_);
+        write_padded(buf_ + body_length_at_, body_end - body_start_, 4);
+        p = put(p, "10=");
+        write_padded(p, checksum(buf_, body_end), 3);
+        p += 3;
+        *p++ = SOH;
+        return std::string_view(buf_, static_cast<size_t>(p - buf_));
+    }
+
+private:
+    template <size_t N>
+    static char* put(char* p, const char (&s)[N]) {
+        std::memcpy(p, s, N - 1);
+        return p + N - 1;
+    }
+
+    static char* put(char* p, std::string_view s) {
+        std::memcpy(p, s.data(), s.size());
+        return p + s.size();
+    }
+
+    // YYYYMMDD-HH:MM:SS.sss, reformatting the date and time only when the
+    // second changes
+    void write_time(uint64_t wall_ns) {
+        const time_t second = static_cast<time_t>(wall_ns / 1000000000ull);
+        char* t = buf_ + time_at_;
+        if (second != cached_second_) {
+            cached_second_ = second;
+            std::tm tm{};
+            gmtime_r(&second, &tm);
+            write_padded(t, static_cast<uint64_t>(tm.tm_year + 1900), 4);
+            write_padded(t + 4, static_cast<uint64_t>(tm.tm_mon + 1), 2);
+            write_padded(t + 6, static_cast<uint64_t>(tm.tm_mday), 2);
+            write_padded(t + 9, static_cast<uint64_t>(tm.tm_hour), 2);
+            write_padded(t + 12, static_cast<uint64_t>(tm.tm_min), 2);
+            write_padded(t + 15, static_cast<uint64_t>(tm.tm_sec), 2);
+        }
+        write_padded(t + 18, (wall_ns / 1000000ull) % 1000, 3);
+    }
+
+    // Header at most ~140 bytes, body at most ~400 with every value at its cap
+    char buf_[640];
+    size_t body_length_at_{0};
+    size_t body_start_{0};
+    size_t seq_at_{0};
+    size_t time_at_{0};
+    size_t header_end_{0};
+    time_t cached_second_{-1};
+};
+
+} // namespace fix
+
+#endif // FIX_CODEC_HPP
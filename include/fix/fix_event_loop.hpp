@@ -0,0 +1,182 @@
+#ifndef FIX_EVENT_LOOP_HPP
+#define FIX_EVENT_LOOP_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/uio.h>
+
+namespace fix {
+
+class FixSession;
+
+// Receive buffer of a loop-owned session. Messages are parsed in place, so
+// it is linear; the unparsed tail is moved to the front only when the
+// space behind it runs out.
+class RecvBuffer {
+public:
+    explicit RecvBuffer(size_t capacity) : buf_(new char[capacity]), cap_(capacity) {}
+
+    char* write_ptr() { return buf_.get() + tail_; }
+    size_t writable() const { return cap_ - tail_; }
+    void commit(size_t n) { tail_ += n; }
+
+    const char* read_ptr() const { return buf_.get() + head_; }
+    size_t readable() const { return tail_ - head_; }
+    void consume(size_t n) {
+        head_ += n;
+        if (head_ == tail_) head_ = tail_ = 0;
+    }
+
+    // At least min_free bytes of space, compacting if needed; false if the
+    // buffer is full of one incomplete message
+    bool reserve(size_t min_free) {
+        if (writable() >= min_free) return true;
+        if (head_ > 0) {
+            std::memmove(buf_.get(), read_ptr(), readable());
+            tail_ -= head_;
+            head_ = 0;
+        }
+        return writable() > 0;
+    }
+
+private:
+    std::unique_ptr<char[]> buf_;
+    size_t cap_;
+    size_t head_{0};
+    size_t tail_{0};
+};
+
+// Send ring of a loop-owned session: any thread appends encoded messages
+// under the session's send lock, the loop drains whatever has accumulated
+// with one writev of the ring's (at most two) segments.
+class SendRing {
+public:
+    explicit SendRing(size_t capacity) : buf_(new char[capacity]), mask_(capacity - 1) {}
+
+    // False, writing nothing, if there is no room for all n bytes
+    bool write(const char* data, size_t n) {
+        if (n > mask_ + 1 - size()) return false;
+        const size_t at = tail_ & mask_;
+        const size_t first = n < mask_ + 1 - at ? n : mask_ + 1 - at;
+        std::memcpy(buf_.get() + at, data, first);
+        std::memcpy(buf_.get(), data + first, n - first);
+        tail_ += n;
+        return true;
+    }
+
+    size_t segments(iovec (&out)[2]) const {
+        const size_t n = size();
+        if (n == 0) return 0;
+        const size_t at = head_ & mask_;
+        const size_t first = n < mask_ + 1 - at ? n : mask_ + 1 - at;
+        out[0] = iovec{buf_.get() + at, first};
+        if (first == n) return 1;
+        out[1] = iovec{buf_.get(), n - first};
+        return 2;
+    }
+
+    void consume(size_t n) { head_ += n; }
+    size_t size() const { return static_cast<size_t>(tail_ - head_); }
+    bool empty() const { return head_ == tail_; }
+
+private:
+    std::unique_ptr<char[]> buf_;
+    size_t mask_;       // Capacity is a power of two
+    uint64_t head_{0};
+    uint64_t tail_{0};
+};
+
+// One I/O thread owning any number of sessions through epoll. Reads,
+// message handling, output flushing and heartbeat timers of its sessions
+// all run on this thread; output queued while a batch of events is handled
+// goes out in one writev per session at the end of the batch. Heartbeat
+// checks sit on a wheel of one-second slots, so a tick only visits the
+// sessions due then.
+class FixEventLoop {
+public:
+    static constexpr size_t RECV_BUFFER = 16 * 1024;
+    static constexpr size_t SEND_RING = 64 * 1024;   // A session that fills it is disconnected
+
+    explicit FixEventLoop(int cpu = -1);   // Pinned to cpu; -1 leaves placement to the OS
+    ~FixEventLoop();
+
+    FixEventLoop(const FixEventLoop&) = delete;
+    FixEventLoop& operator=(const FixEventLoop&) = delete;
+
+    // Lifecycle. stop() closes every session the loop owns.
+    bool start();
+    void stop();
+    bool is_running() const { return running_.load(std::memory_order_acquire); }
+
+    // Accepts connections on a listening socket, passing each new client
+    // socket to on_accept on the loop thread. Before start() only.
+    void watch_listener(int listen_fd, std::function<void(int client_fd)> on_accept);
+
+    // Attaches a session to its connected, non-blocking socket and hands it
+    // over. Any thread.
+    void adopt(std::shared_ptr<FixSession> session, int fd);
+
+    // Asks for the session's queued output to be written. Any thread.
+    void request_flush(int fd);
+
+    bool in_loop_thread() const { return std::this_thread::get_id() == thread_id_.load(); }
+    size_t session_count() const { return session_count_.load(std::memory_order_relaxed); }
+    // Times a session's output filled its socket and waited for EPOLLOUT
+    uint64_t write_stalls() const { return write_stalls_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t WHEEL_SLOTS = 64;   // Seconds; longer delays are re-armed
+
+    struct TimerEntry {
+        int fd;
+        uint64_t generation;   // The session's, telling a reused fd apart
+    };
+
+    void run();
+    void drain_pending();
+    void accept_clients();
+    void add_session(std::shared_ptr<FixSession> session);
+    void close_session(int fd);
+    void flush(int fd);
+    void flush_dirty();
+    void update_interest(FixSession& session, bool want_write);
+    void schedule(int fd, uint64_t generation, uint32_t delay_s);
+    void run_timers();
+    static uint64_t now_seconds();
+
+    int cpu_;
+    int epoll_fd_{-1};
+    int wake_fd_{-1};
+    int listen_fd_{-1};
+    std::function<void(int)> on_accept_;
+    std::thread thread_;
+    std::atomic<std::thread::id> thread_id_{};
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> session_count_{0};
+    std::atomic<uint64_t> write_stalls_{0};
+
+    // Handoff from other threads
+    std::mutex pending_mutex_;
+    std::vector<std::shared_ptr<FixSession>> pending_adopt_;
+    std::vector<int> pending_flush_;
+
+    // Loop thread only
+    std::unordered_map<int, std::shared_ptr<FixSession>> sessions_;
+    std::vector<int> dirty_;
+    std::array<std::vector<TimerEntry>, WHEEL_SLOTS> wheel_;
+    uint64_t wheel_second_{0};
+    uint64_t next_generation_{1};
+};
+
+} // namespace fix
+
+#endif // FIX_EVENT_LOOP_HPP
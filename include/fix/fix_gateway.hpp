@@ -5,19 +5,23 @@
 #include "matching/matching_engine.hpp"
 #include "matching/symbol_manager.hpp"
 #include "market_data/publisher.hpp"
+#include "perf/latency_tracker.hpp"
 #include <unordered_map>
 #include <atomic>
+#include <vector>
 
 namespace fix {
 
 // Order tracking for FIX client orders
 struct ClientOrder {
-    std::string cl_ord_id;           // Client order ID
-    std::string session_id;          // Which FIX session
+    std::string cl_ord_id;           // Client order ID, copied once at entry
+    uint32_t session{0};             // Handle into the gateway's session table
     matching::OrderId engine_order_id; // Order ID in matching engine
     matching::SymbolId symbol;
-    double quantity;
-    double filled_quantity{0};
+    fix::Side side{fix::Side::BUY};
+    uint64_t quantity{0};
+    uint64_t filled_quantity{0};
+    uint64_t filled_notional{0};     // Sum of fill quantity * price, for AvgPx
     bool is_active{true};
     std::chrono::high_resolution_clock::time_point creation_time;
 };
@@ -41,7 +45,6 @@ public:
         switch (fix_tif) {
             case fix::TimeInForce::IMMEDIATE_OR_CANCEL: return matching::TimeInForce::IOC;
             case fix::TimeInForce::FILL_OR_KILL: return matching::TimeInForce::FOK;
-            case fix::TimeInForce::GOOD_TILL_CANCEL: return matching::TimeInForce::GTC;
             default: return matching::TimeInForce::DAY;
         }
     }
@@ -51,7 +54,7 @@ public:
             case matching::OrderStatus::NEW: return fix::ExecType::NEW;
             case matching::OrderStatus::FILLED: return fix::ExecType::FILL;
             case matching::OrderStatus::PARTIALLY_FILLED: return fix::ExecType::PARTIAL_FILL;
-            case matching::OrderStatus::CANCELLED: return fix::ExecType::CANCELED;
+            case matching::OrderStatus::CANCELED: return fix::ExecType::CANCELED;
             case matching::OrderStatus::REJECTED: return fix::ExecType::REJECTED;
             default: return fix::ExecType::NEW;
         }
@@ -62,15 +65,26 @@ public:
             case matching::OrderStatus::NEW: return fix::OrdStatus::NEW;
             case matching::OrderStatus::FILLED: return fix::OrdStatus::FILLED;
             case matching::OrderStatus::PARTIALLY_FILLED: return fix::OrdStatus::PARTIALLY_FILLED;
-            case matching::OrderStatus::CANCELLED: return fix::OrdStatus::CANCELED;
+            case matching::OrderStatus::CANCELED: return fix::OrdStatus::CANCELED;
             case matching::OrderStatus::REJECTED: return fix::OrdStatus::REJECTED;
             default: return fix::OrdStatus::NEW;
         }
     }
 };
 
-// Main FIX Gateway class
+// Main FIX Gateway class. Sessions and orders are identified by integers
+// once they are in: a session gets a handle into the session table when it
+// connects, and an order's engine id, assigned by the gateway, indexes the
+// order slab, so execution reports reach the client without hashing a
+// string. All of this is touched only on the FIX I/O thread (the gateway
+// runs a single event loop, and fills come back inside process_order), so
+// it takes no lock.
 class FixGateway {
+public:
+    // Engine order ids the gateway assigns start here; ids below it belong
+    // to orders entered some other way
+    static constexpr matching::OrderId ORDER_ID_BASE = matching::OrderId(1) << 48;
+    
 private:
     // Core components
     matching::SymbolManager& symbol_manager_;
@@ -80,18 +94,29 @@ private:
     // FIX server
     std::unique_ptr<FixServer> fix_server_;
     int port_;
+    int io_cpu_;
     
-    // Order tracking
-    std::unordered_map<std::string, ClientOrder> client_orders_; // cl_ord_id -> order
-    std::unordered_map<matching::OrderId, std::string> engine_to_client_orders_; // engine_id -> cl_ord_id
-    std::mutex orders_mutex_;
+    // Order tracking: orders_[id - ORDER_ID_BASE]
+    std::vector<ClientOrder> orders_;
+    std::vector<matching::Fill> fill_scratch_;   // Fills of the order being entered
     
     // Execution ID generation
     std::atomic<uint64_t> next_exec_id_{1};
     
-    // Session tracking
-    std::unordered_map<std::string, std::shared_ptr<FixSession>> active_sessions_;
-    std::mutex sessions_mutex_;
+    // Session tracking. The I/O thread reads the table without the lock;
+    // it also is the only writer, and locks so get_active_session_ids()
+    // can read from other threads.
+    struct SessionEntry {
+        std::string id;
+        std::shared_ptr<FixSession> session;
+        std::unordered_map<std::string, uint32_t> cl_ord_ids;   // ClOrdID -> order slot
+    };
+    std::vector<SessionEntry> sessions_;
+    std::unordered_map<const FixSession*, uint32_t> session_handles_;
+    mutable std::mutex sessions_mutex_;
+    
+    // Symbol names for reports, by SymbolId
+    std::vector<std::string> symbol_names_;
     
     // Statistics
     struct Stats {
@@ -102,13 +127,17 @@ private:
         uint64_t active_sessions{0};
         uint64_t total_volume{0};
     } stats_;
-    std::mutex stats_mutex_;
+    mutable std::mutex stats_mutex_;
+    
+    // NewOrderSingle handling time, recorded on the I/O thread
+    perf::SharedLatencyTracker order_latency_;
     
 public:
     FixGateway(matching::SymbolManager& symbol_manager, 
                matching::MatchingEngine& matching_engine,
                market_data::MarketDataPublisher& market_data_publisher,
-               int port = 9878);
+               int port = 9878,
+               int io_cpu = -1);   // CPU for the FIX I/O thread; -1 leaves placement to the OS
     
     ~FixGateway();
     
@@ -120,6 +149,7 @@ public:
     // Statistics
     Stats get_stats() const;
     void reset_stats();
+    const perf::SharedLatencyTracker& order_latency() const { return order_latency_; }
     
     // Session management
     std::vector<std::string> get_active_session_ids() const;
@@ -127,26 +157,31 @@ public:
 private:
     // FIX message handlers
     void handle_new_session(std::shared_ptr<FixSession> session);
-    void handle_fix_message(FixSession* session, const FixMessage& message);
-    void handle_logon(FixSession* session, const FixMessage& message);
-    void handle_new_order_single(FixSession* session, const FixMessage& message);
-    void handle_order_cancel_request(FixSession* session, const FixMessage& message);
-    void handle_market_data_request(FixSession* session, const FixMessage& message);
-    
-    // Order management
-    std::string process_new_order(FixSession* session, const FixMessage& message);
-    void send_execution_report(const std::string& session_id, const ClientOrder& client_order,
+    // Messages are read in place from the session's receive buffer. Only
+    // application messages arrive here; the session answers logons itself.
+    void handle_fix_message(FixSession* session, const FixView& message);
+    void handle_new_order_single(FixSession* session, const FixView& message);
+    void handle_order_cancel_request(FixSession* session, const FixView& message);
+    void handle_market_data_request(FixSession* session, const FixView& message);
+    
+    // Order management. Prices are in 1/10000, as in the engine.
+    std::string process_new_order(uint32_t session, const FixView& message);
+    ClientOrder* find_order(matching::OrderId order_id);
+    void apply_fill(ClientOrder& client_order, matching::Quantity quantity, matching::Price price);
+    void send_execution_report(const ClientOrder& client_order,
                               fix::ExecType exec_type, fix::OrdStatus ord_status,
-                              double last_shares = 0, double last_px = 0);
-    void send_order_reject(FixSession* session, const std::string& cl_ord_id, const std::string& reason);
+                              uint64_t last_shares = 0, uint64_t last_px = 0);
+    void send_order_reject(FixSession* session, std::string_view cl_ord_id, const std::string& reason);
     
     // Fill callback from matching engine
     void on_fill(const matching::Fill& fill);
     
     // Utility methods
-    std::string generate_exec_id();
+    uint64_t generate_exec_id();
     std::string session_key(FixSession* session);
-    matching::SymbolId resolve_symbol(const std::string& symbol_name);
+    bool find_session(const FixSession* session, uint32_t& handle) const;
+    matching::SymbolId resolve_symbol(std::string_view symbol_name);
+    const std::string& symbol_name(matching::SymbolId symbol) const;
     void update_order_stats(bool accepted);
     
     // Market data forwarding
@@ -72,7 +72,7 @@ enum class FixTag : int {
 
 // FIX Message Types
 enum class MsgType {
-    HEARTBEAT = 'A',
+    HEARTBEAT = '0',
     TEST_REQUEST = '1',
     RESEND_REQUEST = '2',
     REJECT = '3',
@@ -145,7 +145,9 @@ struct FixField {
     
     template<typename T>
     FixField(FixTag t, T val) : tag(static_cast<int>(t)) {
-        if constexpr (std::is_arithmetic_v<T>) {
+        if constexpr (std::is_same_v<T, char>) {
+            value = std::string(1, val); // Enum codes such as MsgType
+        } else if constexpr (std::is_arithmetic_v<T>) {
             value = std::to_string(val);
         } else {
             value = std::string(val);
@@ -219,10 +221,9 @@ public:
     
     // Serialize to FIX string
     std::string to_fix_string() const {
-        std::ostringstream oss;
-        
-        // Build message without checksum first
+        // Body first, without BeginString, BodyLength and CheckSum
         std::string body;
+        body.reserve(256);
         for (int tag : field_order_) {
             if (tag == static_cast<int>(FixTag::BeginString) || 
                 tag == static_cast<int>(FixTag::BodyLength) ||
@@ -231,33 +232,37 @@ public:
             }
             auto it = fields_.find(tag);
             if (it != fields_.end()) {
-                body += std::to_string(tag) + "=" + it->second + SOH;
+                body += std::to_string(tag);
+                body += '=';
+                body += it->second;
+                body += SOH;
             }
         }
         
-        // Add BeginString
-        auto begin_string = get_field(FixTag::BeginString);
-        if (begin_string) {
-            oss << static_cast<int>(FixTag::BeginString) << "=" << *begin_string << SOH;
+        std::string msg;
+        msg.reserve(body.size() + 48);
+        auto begin_string = fields_.find(static_cast<int>(FixTag::BeginString));
+        if (begin_string != fields_.end()) {
+            msg += "8=";
+            msg += begin_string->second;
+            msg += SOH;
         }
+        msg += "9=";
+        msg += std::to_string(body.size());
+        msg += SOH;
+        msg += body;
         
-        // Add BodyLength
-        oss << static_cast<int>(FixTag::BodyLength) << "=" << body.length() << SOH;
-        
-        // Add body
-        oss << body;
-        
-        // Calculate and add checksum
-        std::string msg = oss.str();
-        unsigned char checksum = 0;
+        unsigned checksum = 0;
         for (char c : msg) {
-            checksum += c;
+            checksum += static_cast<unsigned char>(c);
         }
-        checksum %= 256;
+        checksum &= 0xFF;
         
-        oss << static_cast<int>(FixTag::CheckSum) << "=" << std::setfill('0') << std::setw(3) << static_cast<int>(checksum) << SOH;
-        
-        return oss.str();
+        const char trailer[] = {'1', '0', '=', static_cast<char>('0' + checksum / 100),
+                                static_cast<char>('0' + checksum / 10 % 10),
+                                static_cast<char>('0' + checksum % 10), SOH};
+        msg.append(trailer, sizeof(trailer));
+        return msg;
     }
     
     // Get all fields
@@ -276,7 +281,8 @@ public:
     }
 };
 
-// FIX Message Parser
+// FIX Message Parser, into the map-based FixMessage. fix_codec.hpp has
+// the in-place FixView for hot paths.
 class FixParser {
 public:
     static std::optional<FixMessage> parse(const std::string& fix_string) {
@@ -285,25 +291,23 @@ public:
         }
         
         FixMessage message;
-        std::istringstream stream(fix_string);
-        std::string field;
-        
-        while (std::getline(stream, field, SOH)) {
-            if (field.empty()) continue;
-            
-            size_t eq_pos = field.find('=');
-            if (eq_pos == std::string::npos) {
-                continue; // Invalid field format
+        size_t pos = 0;
+        while (pos < fix_string.size()) {
+            size_t end = fix_string.find(SOH, pos);
+            if (end == std::string::npos) {
+                end = fix_string.size();
             }
             
-            try {
-                int tag = std::stoi(field.substr(0, eq_pos));
-                std::string value = field.substr(eq_pos + 1);
-                message.add_field(FixField(tag, value));
-            } catch (const std::exception&) {
-                // Skip invalid fields
-                continue;
+            // Fields without a numeric tag and '=' are skipped
+            int tag = 0;
+            size_t i = pos;
+            for (; i < end && fix_string[i] >= '0' && fix_string[i] <= '9' && i - pos < 9; ++i) {
+                tag = tag * 10 + (fix_string[i] - '0');
+            }
+            if (i > pos && i < end && fix_string[i] == '=') {
+                message.add_field(FixField(tag, fix_string.substr(i + 1, end - i - 1)));
             }
+            pos = end + 1;
         }
         
         // Validate required fields
@@ -318,28 +322,26 @@ public:
     // Validate message checksum
     static bool validate_checksum(const std::string& fix_string) {
         size_t checksum_pos = fix_string.rfind("10=");
-        if (checksum_pos == std::string::npos) {
+        if (checksum_pos == std::string::npos || checksum_pos + 6 > fix_string.size()) {
             return false;
         }
         
-        // Extract stated checksum
-        std::string checksum_str = fix_string.substr(checksum_pos + 3, 3);
-        int stated_checksum;
-        try {
-            stated_checksum = std::stoi(checksum_str);
-        } catch (const std::exception&) {
-            return false;
+        // Stated checksum, three digits
+        int stated_checksum = 0;
+        for (size_t i = checksum_pos + 3; i < checksum_pos + 6; ++i) {
+            if (fix_string[i] < '0' || fix_string[i] > '9') {
+                return false;
+            }
+            stated_checksum = stated_checksum * 10 + (fix_string[i] - '0');
         }
         
-        // Calculate actual checksum
-        std::string message_part = fix_string.substr(0, checksum_pos + 3);
-        unsigned char calculated_checksum = 0;
-        for (char c : message_part) {
-            calculated_checksum += c;
+        // Everything before the CheckSum field
+        unsigned calculated_checksum = 0;
+        for (size_t i = 0; i < checksum_pos; ++i) {
+            calculated_checksum += static_cast<unsigned char>(fix_string[i]);
         }
-        calculated_checksum %= 256;
         
-        return calculated_checksum == stated_checksum;
+        return static_cast<int>(calculated_checksum & 0xFF) == stated_checksum;
     }
 };
 
@@ -2,6 +2,8 @@
 #define FIX_SESSION_HPP
 
 #include "fix_protocol.hpp"
+#include "fix_codec.hpp"
+#include "fix_event_loop.hpp"
 #include <functional>
 #include <thread>
 #include <atomic>
@@ -22,6 +24,7 @@ class FixSession;
 
 // Callback types
 using MessageCallback = std::function<void(FixSession*, const FixMessage&)>;
+using ViewCallback = std::function<void(FixSession*, const FixView&)>; // View valid for the call only
 using StateChangeCallback = std::function<void(FixSession*, bool connected)>;
 
 // Session state
@@ -34,9 +37,14 @@ enum class SessionState {
     ERROR
 };
 
-// FIX Session class - handles connection and protocol state
+// FIX Session class - handles connection and protocol state. A session
+// either runs its own receiver, sender and heartbeat threads (connect(),
+// the initiator side) or, accepted by a FixServer, is owned by one
+// FixEventLoop that does all of its I/O and timers.
 class FixSession {
 private:
+    friend class FixEventLoop;
+    
     // Session identifiers
     std::string sender_comp_id_;
     std::string target_comp_id_;
@@ -48,7 +56,7 @@ private:
     
     // Session state
     SessionState state_{SessionState::DISCONNECTED};
-    std::mutex state_mutex_;
+    mutable std::mutex state_mutex_;
     
     // Sequence numbers
     std::atomic<int> outgoing_seq_num_{1};
@@ -70,15 +78,26 @@ private:
     std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
     std::thread sender_thread_;
+    std::mutex send_mutex_;              // Orders MsgSeqNum assignment with the write
+    std::unique_ptr<ExecReportEncoder> exec_encoder_; // Guarded by send_mutex_
     
     // Callbacks
     MessageCallback message_callback_;
+    ViewCallback view_callback_;
     StateChangeCallback state_callback_;
     
     // Buffer for receiving partial messages
     std::string receive_buffer_;
     std::mutex receive_mutex_;
     
+    // Event loop mode: buffers, and the send ring guarded by send_mutex_
+    FixEventLoop* loop_{nullptr};
+    std::unique_ptr<RecvBuffer> recv_buffer_;
+    std::unique_ptr<SendRing> send_ring_;
+    std::atomic<bool> flush_requested_{false};
+    bool want_write_{false};     // Loop thread: waiting for EPOLLOUT
+    uint64_t loop_generation_{0}; // Loop thread: numbers the loop's sessions, for its timers
+    
     // Statistics
     struct Stats {
         uint64_t messages_sent{0};
@@ -88,7 +107,7 @@ private:
         uint64_t sequence_errors{0};
         std::chrono::steady_clock::time_point session_start_time;
     } stats_;
-    std::mutex stats_mutex_;
+    mutable std::mutex stats_mutex_;
     
 public:
     FixSession(const std::string& sender_comp_id, const std::string& target_comp_id);
@@ -107,10 +126,19 @@ public:
     bool send_message(const FixMessage& message);
     bool send_raw_message(const std::string& fix_string);
     
+    // Encodes an execution report on the calling thread, taking the next
+    // outgoing sequence number, and writes it (or, for a loop-owned session,
+    // queues it); no FixMessage is built
+    bool send_execution_report(const ExecReport& report);
+    
     // Callbacks
     void set_message_callback(MessageCallback callback) { message_callback_ = callback; }
     void set_state_callback(StateChangeCallback callback) { state_callback_ = callback; }
     
+    // Application messages go to the view callback when one is set, else
+    // to the message callback as a FixMessage
+    void set_view_callback(ViewCallback callback) { view_callback_ = callback; }
+    
     // Session info
     SessionState get_state() const;
     std::string get_sender_comp_id() const { return sender_comp_id_; }
@@ -129,7 +157,7 @@ private:
     void heartbeat_loop();
     
     void set_state(SessionState new_state);
-    void handle_message(const FixMessage& message);
+    void handle_message(const FixView& view);
     void handle_logon(const FixMessage& message);
     void handle_logout(const FixMessage& message);
     void handle_heartbeat(const FixMessage& message);
@@ -140,9 +168,19 @@ private:
     bool send_logout_response(const std::string& reason = "");
     
     void process_received_data(const char* data, size_t length);
-    std::vector<std::string> extract_complete_messages();
-    
-    bool validate_sequence_number(const FixMessage& message);
+    size_t process_messages(const char* data, size_t length);
+    bool write_all(const char* data, size_t length);
+    bool queue_output(const char* data, size_t length); // Caller holds send_mutex_
+    bool write_ring(bool& blocked);      // Caller holds send_mutex_; false: write error
+    
+    // Event loop mode, called by the owning loop on its thread
+    void attach(int fd, FixEventLoop* loop);
+    bool on_readable();                    // false: close the session
+    bool flush_output(bool& blocked);      // false: write error
+    int on_timer();                        // Seconds to the next check; -1: timed out
+    void on_closed();
+    
+    bool validate_sequence_number(const FixView& view);
     void update_last_received_time() { last_received_time_ = std::chrono::steady_clock::now(); }
     void update_last_sent_time() { last_sent_time_ = std::chrono::steady_clock::now(); }
     
@@ -157,24 +195,35 @@ private:
     }
 };
 
-// FIX Server - accepts multiple client connections
+struct FixServerConfig {
+    int port{9878};
+    uint32_t loops{1};     // I/O threads; sessions are spread over them round robin
+    int first_cpu{-1};     // loop i is pinned to first_cpu + i; -1 leaves placement to the OS
+};
+
+// FIX Server - accepts multiple client connections. The first event loop
+// also watches the listening socket. Session callbacks run on the thread
+// of the loop that owns the session.
 class FixServer {
 private:
     int server_socket_{-1};
-    int port_;
+    FixServerConfig config_;
     std::atomic<bool> running_{false};
-    std::thread accept_thread_;
+    std::vector<std::unique_ptr<FixEventLoop>> loops_;
+    uint32_t next_loop_{0};
     
     // Client sessions
     std::vector<std::shared_ptr<FixSession>> client_sessions_;
-    std::mutex sessions_mutex_;
+    mutable std::mutex sessions_mutex_;
     
     // Callbacks
     std::function<void(std::shared_ptr<FixSession>)> new_session_callback_;
     MessageCallback message_callback_;
+    ViewCallback view_callback_;
     
 public:
-    FixServer(int port);
+    explicit FixServer(int port);
+    explicit FixServer(const FixServerConfig& config);
     ~FixServer();
     
     bool start();
@@ -188,6 +237,10 @@ public:
         message_callback_ = callback;
     }
     
+    void set_view_callback(ViewCallback callback) {
+        view_callback_ = callback;
+    }
+    
     // Broadcast message to all connected clients
     void broadcast_message(const FixMessage& message);
     
@@ -195,7 +248,6 @@ public:
     std::vector<std::shared_ptr<FixSession>> get_active_sessions() const;
     
 private:
-    void accept_loop();
     void handle_new_client(int client_socket);
 };
 
@@ -6,10 +6,17 @@
 #include <optional>
 #include "itch/messages.hpp"
 #include "core/event.hpp"
+#include "core/event_block.hpp"
 #include "core/symbol_table.hpp"
 
 namespace itch {
 
+// How messages follow each other in a buffer
+enum class Framing : uint8_t {
+  Bare,           // back to back, sized by type (this repo's captures, ITCH packets)
+  LengthPrefixed  // 2-byte big-endian length before each (ITCH 5.0 files, MoldUDP64 blocks)
+};
+
 struct DecodeResult {
   std::optional<core::ItchEvent> event; // empty for non-order events
   uint32_t message_size{0};             // bytes consumed
@@ -22,10 +29,25 @@ public:
   // Decodes a single message at ptr (size >= minimal). Always returns message_size.
   DecodeResult decode_one(const char* ptr, size_t size) const;
 
+  // Decodes messages into `out` (cleared first) until the buffer ends, a
+  // message is malformed (or, bare, of unknown type) or a column fills up.
+  // Returns the bytes consumed; 0 means the first message could not be decoded.
+  size_t decode_batch(const char* ptr, size_t size, core::EventBlock& out,
+                      Framing framing = Framing::Bare) const;
+
+  // Appends the single message at ptr (`avail` readable bytes from there) to
+  // `out` without clearing it; false, with nothing added, if its column is full
+  bool decode_into(const char* ptr, size_t avail, core::EventBlock& out) const;
+
 private:
+  bool batch_one(const char* p, bool wide, core::EventBlock& out) const;
+
   core::SymbolTable& symtab_;
 };
 
+// Guesses the framing of a capture from its first messages
+Framing detect_framing(const char* ptr, size_t size);
+
 } // namespace itch
 
 #endif // ITCH_DECODER_HPP
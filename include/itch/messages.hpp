@@ -116,22 +116,224 @@ struct OrderReplaceMessage {
   uint32_t price;
 };
 
+struct StockTradingActionMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char stockSymbol[8];
+  char tradingState;
+  char reserved;
+  char reason[4];
+};
+
+struct RegSHORestrictionMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char stockSymbol[8];
+  char regSHOAction;
+};
+
+struct MarketParticipantPositionMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char mpid[4];
+  char stockSymbol[8];
+  char primaryMarketMaker;
+  char marketMakerMode;
+  char marketParticipantState;
+};
+
+struct MWCBDeclineLevelMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  uint64_t level1;
+  uint64_t level2;
+  uint64_t level3;
+};
+
+struct MWCBStatusMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char breachedLevel;
+};
+
+struct IPOQuotingPeriodUpdateMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char stockSymbol[8];
+  uint32_t ipoQuotationReleaseTime;
+  char ipoQuotationReleaseQualifier;
+  uint32_t ipoPrice;
+};
+
+struct LULDAuctionCollarMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char stockSymbol[8];
+  uint32_t auctionCollarReferencePrice;
+  uint32_t upperAuctionCollarPrice;
+  uint32_t lowerAuctionCollarPrice;
+  uint32_t auctionCollarExtension;
+};
+
+struct OperationalHaltMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char stockSymbol[8];
+  char marketCode;
+  char operationalHaltAction;
+};
+
+struct TradeMessage { // non-cross trade against a non-displayed order
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  uint64_t orderReferenceNumber;
+  char buySellIndicator;
+  uint32_t shares;
+  char stockSymbol[8];
+  uint32_t price;
+  uint64_t matchNumber;
+};
+
+struct CrossTradeMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  uint64_t shares;
+  char stockSymbol[8];
+  uint32_t crossPrice;
+  uint64_t matchNumber;
+  char crossType;
+};
+
+struct BrokenTradeMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  uint64_t matchNumber;
+};
+
+struct NOIIMessage { // net order imbalance indicator
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  uint64_t pairedShares;
+  uint64_t imbalanceShares;
+  char imbalanceDirection;
+  char stockSymbol[8];
+  uint32_t farPrice;
+  uint32_t nearPrice;
+  uint32_t currentReferencePrice;
+  char crossType;
+  char priceVariationIndicator;
+};
+
+struct RetailPriceImprovementMessage {
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char stockSymbol[8];
+  char interestFlag;
+};
+
+struct DirectListingPriceDiscoveryMessage { // direct listing with capital raise
+  char messageType;
+  uint16_t stockLocate;
+  uint16_t trackingNumber;
+  uint8_t timestamp[6];
+  char stockSymbol[8];
+  char openEligibilityStatus;
+  uint32_t minimumAllowablePrice;
+  uint32_t maximumAllowablePrice;
+  uint32_t nearExecutionPrice;
+  uint64_t nearExecutionTime;
+  uint32_t lowerPriceRangeCollar;
+  uint32_t upperPriceRangeCollar;
+};
+
 #pragma pack(pop)
 
+// Per type byte: message length for the full ITCH 5.0 set (0 for bytes that
+// are not a message type) and whether it changes an order book. One load
+// instead of a switch, on every message.
+struct ItchTypeTable {
+  uint8_t size[256];
+  bool order[256];
+};
+
+static constexpr ItchTypeTable make_itch_type_table() {
+  ItchTypeTable t{};
+  t.size['S'] = sizeof(SystemEventMessage);
+  t.size['R'] = sizeof(StockDirectoryMessage);
+  t.size['H'] = sizeof(StockTradingActionMessage);
+  t.size['Y'] = sizeof(RegSHORestrictionMessage);
+  t.size['L'] = sizeof(MarketParticipantPositionMessage);
+  t.size['V'] = sizeof(MWCBDeclineLevelMessage);
+  t.size['W'] = sizeof(MWCBStatusMessage);
+  t.size['K'] = sizeof(IPOQuotingPeriodUpdateMessage);
+  t.size['J'] = sizeof(LULDAuctionCollarMessage);
+  t.size['h'] = sizeof(OperationalHaltMessage);
+  t.size['A'] = sizeof(AddOrderMessage);
+  t.size['F'] = sizeof(AddOrderWithMPIDMessage);
+  t.size['E'] = sizeof(OrderExecutedMessage);
+  t.size['C'] = sizeof(OrderExecutedWithPriceMessage);
+  t.size['X'] = sizeof(OrderCancelMessage);
+  t.size['D'] = sizeof(OrderDeleteMessage);
+  t.size['U'] = sizeof(OrderReplaceMessage);
+  t.size['P'] = sizeof(TradeMessage);
+  t.size['Q'] = sizeof(CrossTradeMessage);
+  t.size['B'] = sizeof(BrokenTradeMessage);
+  t.size['I'] = sizeof(NOIIMessage);
+  t.size['N'] = sizeof(RetailPriceImprovementMessage);
+  t.size['O'] = sizeof(DirectListingPriceDiscoveryMessage);
+  t.order['A'] = t.order['F'] = t.order['E'] = t.order['C'] = true;
+  t.order['X'] = t.order['D'] = t.order['U'] = true;
+  return t;
+}
+
+static constexpr ItchTypeTable ITCH_TYPES = make_itch_type_table();
+
+// Lengths from the ITCH 5.0 specification
+static_assert(ITCH_TYPES.size['S'] == 12 && ITCH_TYPES.size['R'] == 39 && ITCH_TYPES.size['H'] == 25 &&
+              ITCH_TYPES.size['Y'] == 20 && ITCH_TYPES.size['L'] == 26 && ITCH_TYPES.size['V'] == 35 &&
+              ITCH_TYPES.size['W'] == 12 && ITCH_TYPES.size['K'] == 28 && ITCH_TYPES.size['J'] == 35 &&
+              ITCH_TYPES.size['h'] == 21 && ITCH_TYPES.size['A'] == 36 && ITCH_TYPES.size['F'] == 40 &&
+              ITCH_TYPES.size['E'] == 31 && ITCH_TYPES.size['C'] == 36 && ITCH_TYPES.size['X'] == 23 &&
+              ITCH_TYPES.size['D'] == 19 && ITCH_TYPES.size['U'] == 35 && ITCH_TYPES.size['P'] == 44 &&
+              ITCH_TYPES.size['Q'] == 40 && ITCH_TYPES.size['B'] == 19 && ITCH_TYPES.size['I'] == 50 &&
+              ITCH_TYPES.size['N'] == 20 && ITCH_TYPES.size['O'] == 48,
+              "ITCH 5.0 message layouts");
+
 // Helper: return size of message for type (0 if unknown)
 static inline uint32_t itch_message_size(char type) {
-  switch (type) {
-    case 'S': return sizeof(SystemEventMessage);
-    case 'R': return sizeof(StockDirectoryMessage);
-    case 'A': return sizeof(AddOrderMessage);
-    case 'F': return sizeof(AddOrderWithMPIDMessage);
-    case 'E': return sizeof(OrderExecutedMessage);
-    case 'C': return sizeof(OrderExecutedWithPriceMessage);
-    case 'X': return sizeof(OrderCancelMessage);
-    case 'D': return sizeof(OrderDeleteMessage);
-    case 'U': return sizeof(OrderReplaceMessage);
-    default:  return 0u;
-  }
+  return ITCH_TYPES.size[static_cast<uint8_t>(type)];
+}
+
+// Adds, executions, cancels, deletes and replaces; every other type only
+// needs its size to be skipped
+static inline bool itch_is_order_message(char type) {
+  return ITCH_TYPES.order[static_cast<uint8_t>(type)];
 }
 
 #endif // ITCH_MESSAGES_HPP
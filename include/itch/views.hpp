@@ -0,0 +1,97 @@
+#ifndef ITCH_VIEWS_HPP
+#define ITCH_VIEWS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "itch/messages.hpp"
+
+namespace itch {
+
+static inline uint16_t load_be16(const char* p) { uint16_t v; std::memcpy(&v, p, 2); return __builtin_bswap16(v); }
+static inline uint32_t load_be32(const char* p) { uint32_t v; std::memcpy(&v, p, 4); return __builtin_bswap32(v); }
+static inline uint64_t load_be64(const char* p) { uint64_t v; std::memcpy(&v, p, 8); return __builtin_bswap64(v); }
+
+// Zero-copy accessors over a message in its wire buffer. The packed structs
+// in messages.hpp only supply offsets; each field is loaded and byte-swapped
+// when it is read, so parsing touches exactly the fields a consumer uses.
+// Views do not check the length: the type table has done that by the time
+// one is made.
+class MessageView {
+public:
+  explicit MessageView(const char* p) : p_(p) {}
+
+  const char* data() const { return p_; }
+  char type() const { return *p_; }
+  uint32_t size() const { return itch_message_size(*p_); }
+  uint16_t stock_locate() const { return load_be16(p_ + offsetof(CommonHeader, stockLocate)); }
+  uint16_t tracking_number() const { return load_be16(p_ + offsetof(CommonHeader, trackingNumber)); }
+
+  // Nanoseconds since midnight (6 bytes)
+  uint64_t timestamp() const {
+    const char* t = p_ + offsetof(SystemEventMessage, timestamp);
+    return (uint64_t(load_be16(t)) << 32) | load_be32(t + 2);
+  }
+
+protected:
+  const char* p_;
+};
+
+class StockDirectoryView : public MessageView {
+public:
+  using MessageView::MessageView;
+  const char* symbol() const { return p_ + offsetof(StockDirectoryMessage, stockSymbol); } // 8, space padded
+};
+
+// 'A' and 'F': the MPID variant only appends the attribution
+class AddOrderView : public MessageView {
+public:
+  using MessageView::MessageView;
+  uint64_t order_ref() const { return load_be64(p_ + offsetof(AddOrderMessage, orderReferenceNumber)); }
+  char side() const { return p_[offsetof(AddOrderMessage, buySellIndicator)]; }
+  uint32_t shares() const { return load_be32(p_ + offsetof(AddOrderMessage, shares)); }
+  const char* symbol() const { return p_ + offsetof(AddOrderMessage, stockSymbol); } // 8, space padded
+  uint32_t price() const { return load_be32(p_ + offsetof(AddOrderMessage, price)); }
+};
+
+// 'E' and 'C': the with-price variant appends printable and price
+class OrderExecutedView : public MessageView {
+public:
+  using MessageView::MessageView;
+  uint64_t order_ref() const { return load_be64(p_ + offsetof(OrderExecutedMessage, orderReferenceNumber)); }
+  uint32_t executed_shares() const { return load_be32(p_ + offsetof(OrderExecutedMessage, executedShares)); }
+  uint64_t match_number() const { return load_be64(p_ + offsetof(OrderExecutedMessage, matchNumber)); }
+  // 'C' only
+  char printable() const { return p_[offsetof(OrderExecutedWithPriceMessage, printable)]; }
+  uint32_t execution_price() const {
+    return load_be32(p_ + offsetof(OrderExecutedWithPriceMessage, executionPrice));
+  }
+};
+
+class OrderCancelView : public MessageView {
+public:
+  using MessageView::MessageView;
+  uint64_t order_ref() const { return load_be64(p_ + offsetof(OrderCancelMessage, orderReferenceNumber)); }
+  uint32_t canceled_shares() const { return load_be32(p_ + offsetof(OrderCancelMessage, canceledShares)); }
+};
+
+class OrderDeleteView : public MessageView {
+public:
+  using MessageView::MessageView;
+  uint64_t order_ref() const { return load_be64(p_ + offsetof(OrderDeleteMessage, orderReferenceNumber)); }
+};
+
+class OrderReplaceView : public MessageView {
+public:
+  using MessageView::MessageView;
+  uint64_t original_order_ref() const {
+    return load_be64(p_ + offsetof(OrderReplaceMessage, originalOrderReferenceNumber));
+  }
+  uint64_t new_order_ref() const { return load_be64(p_ + offsetof(OrderReplaceMessage, newOrderReferenceNumber)); }
+  uint32_t shares() const { return load_be32(p_ + offsetof(OrderReplaceMessage, shares)); }
+  uint32_t price() const { return load_be32(p_ + offsetof(OrderReplaceMessage, price)); }
+};
+
+} // namespace itch
+
+#endif // ITCH_VIEWS_HPP
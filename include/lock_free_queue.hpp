@@ -3,6 +3,9 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
 template <typename T> class LockFreeQueue {
@@ -36,4 +39,158 @@ private:
   std::atomic<size_t> tail_;
 };
 
+// Single-producer/single-consumer queue for hot paths. Capacity is rounded up
+// to a power of two and indices run freely, masked on access. Each side owns a
+// cache line holding its index and a cached copy of the other side's, so the
+// shared line is only reloaded when the cached view says full (or empty).
+template <typename T> class SpscQueue {
+public:
+  explicit SpscQueue(size_t capacity) {
+    size_t cap = 2;
+    while (cap < capacity) cap <<= 1;
+    buffer_.resize(cap);
+    mask_ = cap - 1;
+  }
+
+  bool push(const T &value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ > mask_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ > mask_) return false; // Full
+    }
+    buffer_[tail & mask_] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pushes as many of the n items as fit, publishing them at once
+  size_t push_bulk(const T *items, size_t n) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t room = buffer_.size() - (tail - head_cache_);
+    if (room < n) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      room = buffer_.size() - (tail - head_cache_);
+      if (n > room) n = room;
+    }
+    for (size_t i = 0; i < n; ++i) buffer_[(tail + i) & mask_] = items[i];
+    if (n) tail_.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  bool pop(T &value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) return false; // Empty
+    }
+    value = std::move(buffer_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pops up to max items, freeing their slots at once
+  size_t pop_bulk(T *out, size_t max) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    size_t avail = tail_cache_ - head;
+    if (avail < max) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      avail = tail_cache_ - head;
+    }
+    const size_t n = avail < max ? avail : max;
+    for (size_t i = 0; i < n; ++i) out[i] = buffer_[(head + i) & mask_];
+    if (n) head_.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  size_t capacity() const { return buffer_.size(); }
+  size_t size_approx() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+private:
+  std::vector<T> buffer_;
+  size_t mask_;
+
+  // Consumer line
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t tail_cache_{0};
+
+  // Producer line
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t head_cache_{0};
+};
+
+// Bounded multi-producer/single-consumer queue. Each cell carries a sequence
+// number: a producer claims a slot with one CAS on tail_ and publishes it by
+// bumping the cell's sequence, so producers never wait on each other's copy
+// and the consumer needs no atomic read-modify-write at all.
+template <typename T> class MpscQueue {
+public:
+  explicit MpscQueue(size_t capacity) {
+    size_t cap = 2;
+    while (cap < capacity) cap <<= 1;
+    cells_.reset(new Cell[cap]);
+    mask_ = cap - 1;
+    for (size_t i = 0; i < cap; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  bool push(const T &value) {
+    size_t pos;
+    Cell *cell = claim(pos);
+    if (!cell) return false; // Full
+    cell->value = value;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool push(T &&value) {
+    size_t pos;
+    Cell *cell = claim(pos);
+    if (!cell) return false; // Full
+    cell->value = std::move(value);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only
+  bool pop(T &value) {
+    Cell &cell = cells_[head_ & mask_];
+    if (cell.seq.load(std::memory_order_acquire) != head_ + 1) return false; // Empty
+    value = std::move(cell.value);
+    cell.seq.store(head_ + mask_ + 1, std::memory_order_release);
+    ++head_;
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  Cell *claim(size_t &pos) {
+    pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell *cell = &cells_[pos & mask_];
+      const size_t seq = cell->seq.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return cell;
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+
+  alignas(64) std::atomic<size_t> tail_{0}; // Producers
+  alignas(64) size_t head_{0};              // Consumer
+};
+
 #endif // LOCK_FREE_QUEUE_HPP
@@ -0,0 +1,86 @@
+#ifndef MARKET_DATA_MULTICAST_PUBLISHER_HPP
+#define MARKET_DATA_MULTICAST_PUBLISHER_HPP
+
+#include "market_data/publisher.hpp"
+#include "market_data/wire.hpp"
+#include "net/moldudp64.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace market_data {
+
+struct MulticastConfig {
+    std::string group{"239.1.1.1"};
+    uint16_t port{30001};
+    std::string interface{"0.0.0.0"};     // Outgoing interface address
+    int ttl{1};
+    bool loopback{false};                 // Deliver to listeners on this host too
+    std::string session{"MDFEED0001"};    // MoldUDP64 session, padded to 10 characters
+    size_t max_datagram{1400};            // Packet size limit, below the path MTU
+    size_t batch_packets{16};             // Packets per sendmmsg call
+};
+
+// Subscriber that republishes the feed as wire messages over UDP multicast.
+// Messages are packed into MoldUDP64 packets, whose sequence numbers count
+// wire messages, a packet is closed when the next message would not fit,
+// and closed packets go out batch_packets at a time in one sendmmsg call.
+// Whatever is buffered is also sent whenever the delivery thread catches up
+// (on_batch_end), so a quiet feed is not held back waiting for a full batch.
+class MulticastPublisher : public MarketDataSubscriber {
+public:
+    struct Stats {
+        uint64_t messages{0};     // Wire messages packed
+        uint64_t packets{0};
+        uint64_t send_calls{0};
+        uint64_t send_errors{0};  // Packets the kernel refused
+    };
+
+    MulticastPublisher(const std::string& id, const MulticastConfig& config = {});
+    ~MulticastPublisher() override;
+
+    MulticastPublisher(const MulticastPublisher&) = delete;
+    MulticastPublisher& operator=(const MulticastPublisher&) = delete;
+
+    bool open();
+    void close();
+    bool is_open() const { return sock_ >= 0; }
+
+    void on_market_data(const MarketDataMessage& message) override;
+    void on_batch_end() override { flush(); }
+    std::string get_subscriber_id() const override { return subscriber_id_; }
+
+    // Sends every buffered packet, including the one being filled
+    void flush();
+
+    // Mold sequence number the next wire message will carry
+    uint64_t next_sequence() const { return next_sequence_; }
+
+    Stats get_stats() const;
+
+private:
+    void append(const void* msg, uint16_t len);
+    void begin_packet();
+    void close_packet();
+
+    std::string subscriber_id_;
+    MulticastConfig config_;
+    char session_[net::mold::SESSION_LEN + 1]{};
+    int sock_{-1};
+
+    std::vector<char> buffers_;             // batch_packets slots of max_datagram bytes
+    std::vector<size_t> lengths_;           // Closed packets ready to send
+    net::mold::PacketWriter writer_{nullptr, 0};
+    bool packet_open_{false};
+    uint64_t next_sequence_{1};
+
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> send_calls_{0};
+    std::atomic<uint64_t> send_errors_{0};
+};
+
+} // namespace market_data
+
+#endif // MARKET_DATA_MULTICAST_PUBLISHER_HPP
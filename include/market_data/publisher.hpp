@@ -3,6 +3,8 @@
 
 #include "matching/matching_engine.hpp"
 #include "matching/symbol_manager.hpp"
+#include "perf/latency_tracker.hpp"
+#include "lock_free_queue.hpp"
 #include <functional>
 #include <vector>
 #include <unordered_map>
@@ -10,8 +12,7 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
-#include <condition_variable>
-#include <queue>
+#include <optional>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
@@ -56,7 +57,9 @@ struct Level2PriceLevel {
     char action{'A'}; // 'A' = add/update, 'D' = delete, 'M' = modify
 };
 
-// Level 2 market data update
+// Level 2 market data update. Snapshots carry the top levels of each side;
+// incremental updates carry only the levels that changed since the previous
+// update for the symbol ('A' with the level's new totals, or 'D').
 struct Level2Update {
     SymbolId symbol{0};
     std::vector<Level2PriceLevel> price_levels;
@@ -93,6 +96,10 @@ struct MarketDataMessage {
     MessageType type{MessageType::LEVEL1_UPDATE};
     uint64_t sequence_number{0};
     std::chrono::high_resolution_clock::time_point timestamp{};
+    // Messages this subscriber lost to a full queue since the previous one
+    // it was given; a level 2 subscriber that sees one should resync from a
+    // snapshot. Set per subscriber at delivery.
+    uint64_t gap{0};
     
     // Separate storage for different message types
     struct {
@@ -116,7 +123,7 @@ struct Subscription {
     MessageType message_type{MessageType::LEVEL1_UPDATE};
     bool enabled{true};
     uint32_t max_depth{10};       // For Level 2 data
-    std::chrono::milliseconds throttle_ms{0}; // Minimum time between updates
+    std::chrono::milliseconds throttle_ms{0}; // Minimum time between updates; L2 deltas are never throttled
     std::chrono::high_resolution_clock::time_point last_sent{};
 };
 
@@ -131,10 +138,36 @@ public:
     // Called when subscription status changes
     virtual void on_subscription_status(SymbolId symbol, MessageType type, bool active) {}
     
+    // Called when the subscriber has caught up with its queue, after one or
+    // more on_market_data() calls; buffering subscribers flush here
+    virtual void on_batch_end() {}
+    
     // Get subscriber ID for management
     virtual std::string get_subscriber_id() const = 0;
 };
 
+// What happens to a message for a subscriber whose queue is full
+enum class OverflowPolicy : uint8_t {
+    DROP,       // The message is dropped, and counted in the gap of the
+                // next message the subscriber gets
+    CONFLATE    // Level 1 updates are held back, latest per symbol, until the
+                // subscriber catches up; other messages are dropped
+};
+
+// Per-subscriber delivery settings, fixed when the subscriber is added
+struct SubscriberOptions {
+    size_t queue_capacity{4096};
+    OverflowPolicy overflow{OverflowPolicy::DROP};
+};
+
+// Per-subscriber delivery counters
+struct SubscriberStats {
+    uint64_t delivered{0};
+    uint64_t dropped{0};      // Queue full (DROP, or a non-L1 message under CONFLATE)
+    uint64_t conflated{0};    // Level 1 updates that went through the conflation table
+    perf::Histogram::Stats latency; // Enqueue to on_market_data() return
+};
+
 // Market data publisher
 class MarketDataPublisher {
 private:
@@ -144,19 +177,82 @@ private:
     // Sequence number generation
     std::atomic<uint64_t> sequence_number_{1};
     
-    // Subscribers
-    struct SubscriberInfo {
+    // Subscribers. Each one owns a slot with its own queue and delivery
+    // thread, so a slow subscriber only ever holds up itself.
+    static constexpr size_t MAX_SUBSCRIBERS = 64;
+    static constexpr size_t MESSAGE_TYPES = 7; // Indexed by MessageType value
+    
+    struct SubscriberSlot {
+        SubscriberSlot(std::shared_ptr<MarketDataSubscriber> sub, const SubscriberOptions& opts, uint64_t gen)
+            : subscriber(std::move(sub)), options(opts), generation(gen), queue(opts.queue_capacity) {}
+        
         std::shared_ptr<MarketDataSubscriber> subscriber;
+        const SubscriberOptions options;
+        const uint64_t generation;                 // Tells a reused slot from its predecessor
+        SpscQueue<MarketDataMessage> queue;        // Publisher thread -> delivery thread
+        
+        std::mutex mutex;                          // Guards subscriptions and conflated
         std::vector<Subscription> subscriptions;
-        bool active{true};
+        std::unordered_map<SymbolId, MarketDataMessage> conflated;
+        std::atomic<bool> conflating{false};       // conflated is non-empty
+        
+        std::thread thread;
+        std::atomic<bool> running{false};
+        std::atomic<uint64_t> delivered{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> conflated_count{0};
+        uint64_t lost{0};                          // Drops not yet carried by a queued message; publisher thread only
+        perf::LatencyTracker latency;              // Recorded by the delivery thread
     };
-    std::unordered_map<std::string, SubscriberInfo> subscribers_;
+    
+    // Management state, under subscribers_mutex_; subscriber id -> slot
+    std::unordered_map<std::string, uint32_t> subscribers_;
     mutable std::mutex subscribers_mutex_;
+    uint64_t next_generation_{1};
     
-    // Message queue for async publishing
-    std::queue<MarketDataMessage> message_queue_;
-    std::mutex queue_mutex_;
-    std::condition_variable queue_cv_;
+    // Slots and the subscription index, read without locks by the publisher
+    // thread. A bit per slot for every (message type, symbol) pair, in pages
+    // of 256 symbols allocated on first use, plus one mask per type for
+    // all-symbol subscriptions. A slot is freed only once the publisher
+    // thread has finished any fan-out that might still have seen its bits.
+    std::atomic<SubscriberSlot*> slots_[MAX_SUBSCRIBERS]{};
+    struct IndexPage {
+        std::atomic<uint64_t> masks[256][MESSAGE_TYPES]{};
+    };
+    static constexpr size_t INDEX_PAGE_BITS = 8;
+    static constexpr size_t INDEX_PAGES = (size_t(1) << 16) >> INDEX_PAGE_BITS;
+    std::atomic<IndexPage*> index_pages_[INDEX_PAGES]{};
+    std::atomic<uint64_t> all_symbols_masks_[MESSAGE_TYPES]{};
+    std::atomic<uint64_t> fanout_epoch_{0};        // Bumped after every publisher loop iteration
+    std::atomic<bool> publisher_active_{false};
+    
+    // Configuration
+    struct Config {
+        size_t max_queue_size{10000};  // Queue capacity, fixed at construction
+        bool enable_level1{true};
+        bool enable_level2{true};
+        bool enable_trades{true};
+        bool enable_status{true};
+        uint32_t default_l2_depth{10};
+        std::chrono::milliseconds default_throttle{1}; // 1ms minimum between updates
+    } config_;
+    
+    // Messages for the publisher thread, from any publishing thread.
+    // Snapshots name the one slot they are for.
+    struct QueuedMessage {
+        static constexpr uint32_t ALL = 0xFFFFFFFFu;
+        MarketDataMessage message;
+        uint32_t target{ALL};
+        uint64_t target_generation{0};
+    };
+    MpscQueue<QueuedMessage> message_queue_;
+    
+    // Last top of book sent per symbol, so unchanged tops are not re-sent
+    struct TopOfBook {
+        Level1Data data;
+        bool sent{false};
+    };
+    std::vector<TopOfBook> last_level1_;
     
     // Publishing thread
     std::thread publisher_thread_;
@@ -174,16 +270,8 @@ private:
     } stats_;
     mutable std::mutex stats_mutex_;
     
-    // Configuration
-    struct Config {
-        size_t max_queue_size{10000};
-        bool enable_level1{true};
-        bool enable_level2{true};
-        bool enable_trades{true};
-        bool enable_status{true};
-        uint32_t default_l2_depth{10};
-        std::chrono::milliseconds default_throttle{1}; // 1ms minimum between updates
-    } config_;
+    // Enqueue-to-fan-out time, recorded by the publisher thread
+    perf::LatencyTracker delivery_latency_;
     
 public:
     MarketDataPublisher(SymbolManager& sym_mgr, MatchingEngine& engine);
@@ -194,9 +282,12 @@ public:
     void stop();
     bool is_running() const { return running_.load(); }
     
-    // Subscriber management
-    bool add_subscriber(std::shared_ptr<MarketDataSubscriber> subscriber);
+    // Subscriber management. A subscriber's callbacks run on its own
+    // delivery thread, one at a time; at most MAX_SUBSCRIBERS at once.
+    bool add_subscriber(std::shared_ptr<MarketDataSubscriber> subscriber,
+                        const SubscriberOptions& options = {});
     bool remove_subscriber(const std::string& subscriber_id);
+    std::optional<SubscriberStats> get_subscriber_stats(const std::string& subscriber_id) const;
     
     // Subscription management
     bool subscribe(const std::string& subscriber_id, SymbolId symbol, MessageType type, 
@@ -207,19 +298,28 @@ public:
     bool subscribe_all_symbols(const std::string& subscriber_id, MessageType type);
     bool subscribe_symbol_list(const std::string& subscriber_id, const std::vector<SymbolId>& symbols, MessageType type);
     
-    // Manual data publishing (usually called by matching engine callbacks)
+    // Manual data publishing (usually called by matching engine callbacks).
+    // The book-driven updates read the engine's books, so they belong on the
+    // thread that drives the engine. publish_level1_update() sends only when
+    // the top of book differs from the last one sent; publish_level2_update()
+    // sends the levels changed since its previous call, all coalesced into
+    // one update, and nothing when none changed. publish_book_changes() does
+    // both, once per batch of orders.
     void publish_level1_update(SymbolId symbol);
     void publish_level2_update(SymbolId symbol);
+    void publish_book_changes(SymbolId symbol);
     void publish_trade(const Fill& fill);
     void publish_symbol_status(SymbolId symbol, SymbolState old_state, SymbolState new_state, const std::string& reason = "");
     
-    // Snapshot requests
+    // Snapshot requests, built now and delivered through the subscriber's
+    // queue, in order with its other messages
     void send_level1_snapshot(const std::string& subscriber_id, SymbolId symbol);
     void send_level2_snapshot(const std::string& subscriber_id, SymbolId symbol, uint32_t depth = 10);
     
     // Statistics and monitoring
     Stats get_stats() const;
     void reset_stats();
+    const perf::LatencyTracker& delivery_latency() const { return delivery_latency_; }
     
     // Configuration
     void set_config(const Config& config) { config_ = config; }
@@ -232,13 +332,29 @@ public:
 private:
     // Internal publishing methods
     void enqueue_message(MarketDataMessage&& message);
+    void enqueue_snapshot(const std::string& subscriber_id, MarketDataMessage&& message);
     void publisher_loop();
     void deliver_message(const MarketDataMessage& message);
-    bool should_deliver(const SubscriberInfo& sub_info, const MarketDataMessage& message);
+    void enqueue_for(SubscriberSlot& slot, const MarketDataMessage& message);
+    bool push_to(SubscriberSlot& slot, const MarketDataMessage& message);
+    
+    // Delivery threads
+    void start_delivery(SubscriberSlot& slot);
+    void stop_delivery(SubscriberSlot& slot);
+    void delivery_loop(SubscriberSlot& slot);
+    bool deliver_to(SubscriberSlot& slot, const MarketDataMessage& message, bool filter);
+    bool should_deliver(SubscriberSlot& slot, const MarketDataMessage& message);
+    
+    // Subscription index
+    std::atomic<uint64_t>& index_mask(SymbolId symbol, MessageType type);
+    uint64_t subscriber_mask(SymbolId symbol, MessageType type) const;
+    void wait_for_fanout();
+    static SymbolId message_symbol(const MarketDataMessage& message);
     
     // Data builders
     Level1Update build_level1_update(SymbolId symbol);
-    Level2Update build_level2_update(SymbolId symbol, bool is_snapshot = false);
+    Level2Update build_level2_snapshot(SymbolId symbol, uint32_t depth);
+    Level2Update build_level2_changes(SymbolId symbol);
     TradeReport build_trade_report(const Fill& fill);
     SymbolStatus build_symbol_status(SymbolId symbol, SymbolState old_state, SymbolState new_state, const std::string& reason);
     
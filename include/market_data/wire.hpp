@@ -0,0 +1,162 @@
+#ifndef MARKET_DATA_WIRE_HPP
+#define MARKET_DATA_WIRE_HPP
+
+#include "market_data/publisher.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace market_data {
+
+// Binary market data format for downstream consumers. Every message is a
+// fixed-layout, packed, trivially copyable struct starting with a Header;
+// multi-byte fields are little-endian (x86 native, as in SBE). Messages are
+// framed into MoldUDP64 packets, so net::mold and the feed arbiter read
+// them like any other Mold feed. A Level 2 update becomes one LevelUpdate
+// per price level, sharing the update's sequence number; the last carries
+// FLAG_END_OF_UPDATE.
+namespace wire {
+
+enum class Type : uint8_t {
+    LEVEL1 = 'Q',      // Top of book
+    LEVEL2 = 'L',      // One price level
+    TRADE = 'T',
+    STATUS = 'H'       // Symbol state change
+};
+
+constexpr uint8_t FLAG_SNAPSHOT = 0x01;
+constexpr uint8_t FLAG_END_OF_UPDATE = 0x02;
+
+#pragma pack(push, 1)
+
+struct Header {
+    Type type;
+    uint8_t flags;
+    uint16_t symbol;
+    uint64_t sequence;        // MarketDataMessage::sequence_number
+    uint64_t timestamp_ns;    // Publish time, ns since the epoch
+};
+
+struct Level1 {
+    Header header;
+    uint32_t bid_price;       // 0: no bid
+    uint32_t bid_quantity;
+    uint32_t ask_price;       // 0: no ask
+    uint32_t ask_quantity;
+};
+
+struct LevelUpdate {
+    Header header;
+    uint32_t price;
+    uint32_t quantity;        // New total; 0 with action 'D'
+    uint32_t order_count;
+    char side;                // 'B' or 'A'
+    char action;              // 'A' add/update, 'D' delete
+};
+
+struct Trade {
+    Header header;
+    uint64_t trade_id;
+    uint64_t aggressive_order_id;
+    uint64_t passive_order_id;
+    uint32_t price;
+    uint32_t quantity;
+    char aggressive_side;
+};
+
+struct Status {
+    Header header;
+    uint8_t old_state;        // SymbolState
+    uint8_t new_state;
+    char reason[16];          // Truncated, NUL padded
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 20 && sizeof(Level1) == 36 && sizeof(LevelUpdate) == 34 &&
+              sizeof(Trade) == 53 && sizeof(Status) == 38, "wire layout changed");
+static_assert(std::is_trivially_copyable<Level1>::value && std::is_trivially_copyable<LevelUpdate>::value &&
+              std::is_trivially_copyable<Trade>::value && std::is_trivially_copyable<Status>::value,
+              "wire messages are copied as bytes");
+
+inline uint64_t to_ns(const std::chrono::high_resolution_clock::time_point& t) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+inline Header make_header(Type type, uint8_t flags, SymbolId symbol, const MarketDataMessage& message) {
+    return Header{type, flags, symbol, message.sequence_number, to_ns(message.timestamp)};
+}
+
+// Encodes a message as one or more wire messages, passing each to
+// emit(const void* bytes, uint16_t length). Returns how many were emitted.
+template <typename Emit>
+size_t encode(const MarketDataMessage& message, Emit&& emit) {
+    switch (message.type) {
+        case MessageType::LEVEL1_UPDATE:
+        case MessageType::SNAPSHOT_L1: {
+            const Level1Update& l1 = message.data.level1;
+            const uint8_t flags = message.type == MessageType::SNAPSHOT_L1 ? FLAG_SNAPSHOT : 0;
+            const Level1 out{make_header(Type::LEVEL1, flags, l1.symbol, message),
+                             l1.best_bid_price, l1.best_bid_quantity, l1.best_ask_price, l1.best_ask_quantity};
+            emit(&out, static_cast<uint16_t>(sizeof(out)));
+            return 1;
+        }
+
+        case MessageType::LEVEL2_UPDATE:
+        case MessageType::SNAPSHOT_L2: {
+            const Level2Update& l2 = message.data.level2;
+            const uint8_t flags = l2.is_snapshot ? FLAG_SNAPSHOT : 0;
+            const size_t n = l2.price_levels.size();
+            for (size_t i = 0; i < n; ++i) {
+                const Level2PriceLevel& level = l2.price_levels[i];
+                const uint8_t end = (i + 1 == n) ? FLAG_END_OF_UPDATE : 0;
+                const LevelUpdate out{make_header(Type::LEVEL2, uint8_t(flags | end), l2.symbol, message),
+                                      level.price, level.quantity, level.order_count, level.side, level.action};
+                emit(&out, static_cast<uint16_t>(sizeof(out)));
+            }
+            return n;
+        }
+
+        case MessageType::TRADE_REPORT: {
+            const TradeReport& trade = message.data.trade;
+            const Trade out{make_header(Type::TRADE, 0, trade.symbol, message), trade.trade_id,
+                            trade.aggressive_order_id, trade.passive_order_id,
+                            trade.execution_price, trade.execution_quantity, trade.aggressive_side};
+            emit(&out, static_cast<uint16_t>(sizeof(out)));
+            return 1;
+        }
+
+        case MessageType::SYMBOL_STATUS: {
+            const SymbolStatus& status = message.data.status;
+            Status out{make_header(Type::STATUS, 0, status.symbol, message),
+                       static_cast<uint8_t>(status.old_state), static_cast<uint8_t>(status.new_state), {}};
+            std::memcpy(out.reason, status.reason.data(), std::min(status.reason.size(), sizeof(out.reason)));
+            emit(&out, static_cast<uint16_t>(sizeof(out)));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Reads the header of a wire message; false if it is too short to hold one
+inline bool parse_header(const char* data, size_t len, Header& out) {
+    if (len < sizeof(Header)) return false;
+    std::memcpy(&out, data, sizeof(out));
+    return true;
+}
+
+// Copies a whole wire message of type T out of a packet; false if short
+template <typename T>
+bool parse(const char* data, size_t len, T& out) {
+    if (len < sizeof(T)) return false;
+    std::memcpy(&out, data, sizeof(T));
+    return true;
+}
+
+} // namespace wire
+} // namespace market_data
+
+#endif // MARKET_DATA_WIRE_HPP
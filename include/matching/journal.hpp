@@ -0,0 +1,198 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include "matching/sharded_engine.hpp"
+#include "core/mapped_file.hpp"
+#include "lock_free_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace matching {
+
+// One journaled engine input or output, one cache line each
+struct JournalRecord {
+    enum class Type : uint8_t {
+        NONE = 0,        // Preallocated space nothing was written to yet
+        ADD_SYMBOL,      // Commands, in the order the shard executed them
+        NEW_ORDER,
+        CANCEL,
+        REPLACE,
+        ACK,             // Events, as the shard emitted them
+        FILL,
+        CANCELED,
+        CANCEL_REJECT
+    };
+
+    Type type{Type::NONE};
+    char side{0};
+    char order_type{0};
+    char tif{0};
+    char status{0};
+    uint8_t flags{0};        // ADD_SYMBOL: owns_orders, track_changes
+    uint16_t symbol{0};
+    uint32_t shard{0};
+    uint32_t quantity{0};    // ADD_SYMBOL: tick size
+    uint64_t sequence{0};    // Commands: the shard's command count; events: EngineEvent::sequence
+    uint64_t order_id{0};
+    uint64_t other_id{0};    // REPLACE: the replaced order; FILL: the passive order;
+                             // ADD_SYMBOL: expected orders
+    uint64_t trade_id{0};
+    uint32_t price{0};       // ADD_SYMBOL: min price
+    uint32_t filled{0};      // ADD_SYMBOL: max price
+    uint64_t time_ns{0};     // Order or execution time
+
+    bool is_command() const { return type >= Type::ADD_SYMBOL && type <= Type::REPLACE; }
+    bool is_event() const { return type >= Type::ACK; }
+
+    static JournalRecord from_command(const EngineCommand& command, uint32_t shard, uint64_t sequence);
+    static JournalRecord from_event(const EngineEvent& event);
+    EngineCommand to_command() const;
+    EngineEvent to_event() const;
+};
+static_assert(sizeof(JournalRecord) == 64, "journal records are one cache line");
+
+struct JournalConfig {
+    std::string path;
+    uint32_t producers{1};             // One SPSC ring per appending thread, e.g. per engine shard
+    size_t ring_capacity{1 << 16};     // Records per producer
+    size_t segment_bytes{64u << 20};   // Preallocated and mapped at a time
+    int cpu{-1};                       // Writer thread's cpu; -1 leaves placement to the OS
+    bool sync{true};                   // false: commits skip msync and leave write-back to the kernel
+    bool spin{true};                   // Idle writer spins on pause; false yields instead
+};
+
+// Append-only binary log of engine records with its own writer thread.
+// Producers hand records over through their SPSC ring and never touch the
+// file; the writer pops them straight into a preallocated, mapped segment
+// of the file and commits whatever one pass over the rings collected with a
+// single msync (group commit), so durability costs one flush per batch
+// rather than one per record. The file is a 4 KB header followed by records;
+// unwritten preallocated space reads back as Type::NONE.
+class Journal {
+public:
+    static constexpr size_t HEADER_BYTES = 4096;
+
+    explicit Journal(const JournalConfig& config);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Creates (or truncates) the file and starts the writer. close() commits
+    // everything appended before it and trims the file to what was written.
+    bool open();
+    void close();
+    bool is_open() const { return running_.load(std::memory_order_acquire); }
+
+    uint32_t producers() const { return static_cast<uint32_t>(producers_.size()); }
+
+    // From producer thread `producer` only. try_append fails if its ring is
+    // full; append waits for the writer instead, counting a stall.
+    bool try_append(uint32_t producer, const JournalRecord& record) {
+        Producer& p = *producers_[producer];
+        if (!p.ring.push(record)) {
+            return false;
+        }
+        ++p.appended;
+        return true;
+    }
+    void append(uint32_t producer, const JournalRecord& record);
+
+    // Records a producer has appended so far; from its own thread only. The
+    // record just appended is durable once durable_records(producer) reaches
+    // this count.
+    uint64_t appended(uint32_t producer) const { return producers_[producer]->appended; }
+
+    // Records committed so far (written to the mapping when sync is off), in
+    // total and of one producer
+    uint64_t durable_records() const { return durable_.load(std::memory_order_acquire); }
+    uint64_t durable_records(uint32_t producer) const {
+        return producers_[producer]->durable.load(std::memory_order_acquire);
+    }
+
+    struct Stats {
+        uint64_t records{0};
+        uint64_t commits{0};
+        uint64_t max_batch{0};     // Most records one commit covered
+        uint64_t segments{0};
+        uint64_t stalls{0};        // append() calls that found their ring full
+        uint64_t errors{0};        // Failed allocations, mappings or syncs
+    };
+    Stats get_stats() const;
+
+private:
+    struct Producer {
+        explicit Producer(size_t capacity) : ring(capacity) {}
+        SpscQueue<JournalRecord> ring;
+        alignas(64) std::atomic<uint64_t> stalls{0};
+        uint64_t appended{0};               // Producer thread only
+        alignas(64) uint64_t written{0};    // Writer thread only: popped into the file
+        std::atomic<uint64_t> durable{0};   // Of those, committed
+    };
+
+    void run();
+    size_t drain();
+    void commit();
+    bool map_segment(uint64_t offset);
+    void unmap_segment();
+
+    JournalConfig config_;
+    std::vector<std::unique_ptr<Producer>> producers_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> durable_{0};
+
+    // Writer thread only (and open/close)
+    int fd_{-1};
+    JournalRecord* segment_{nullptr};
+    uint64_t segment_offset_{0};       // File offset of segment_
+    uint64_t next_offset_{0};          // Where the following segment goes
+    size_t segment_records_{0};        // Capacity of the mapped segment
+    size_t written_{0};                // Records in the segment so far
+    size_t synced_{0};                 // Of which committed
+    uint64_t records_{0};
+
+    std::atomic<uint64_t> commits_{0};
+    std::atomic<uint64_t> max_batch_{0};
+    std::atomic<uint64_t> segments_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+// A journal file mapped for reading, e.g. after a restart
+class JournalReader {
+public:
+    // false if the file is missing or not a journal
+    bool open(const std::string& path);
+
+    // Records up to the first unwritten one
+    const JournalRecord* begin() const { return records_; }
+    const JournalRecord* end() const { return records_ + count_; }
+    size_t size() const { return count_; }
+
+private:
+    core::MappedFile file_;
+    const JournalRecord* records_{nullptr};
+    size_t count_{0};
+};
+
+struct ReplayResult {
+    uint64_t commands{0};      // Re-executed
+    uint64_t events{0};        // Regenerated and compared with the journaled ones
+    uint64_t mismatches{0};    // Of those, differing from the journal
+};
+
+// Rebuilds one shard by re-executing its journaled commands, in order, on
+// `engine` (which should start empty, and is given the shard's trade id
+// range), through the same execute_command() the shard ran. Every
+// regenerated event is checked against the event the shard journaled at that
+// position, so replay doubles as a determinism test; events the journal never
+// got (a crash after the command) are not counted as mismatches.
+ReplayResult replay_journal(const JournalReader& journal, uint32_t shard, MatchingEngine& engine);
+
+} // namespace matching
+
+#endif // JOURNAL_HPP
@@ -2,6 +2,8 @@
 #define MATCHING_ENGINE_HPP
 
 #include "order_book.hpp"
+#include "matching/order_store.hpp"
+#include "perf/latency_tracker.hpp"
 #include <cstdint>
 #include <vector>
 #include <memory>
@@ -10,6 +12,8 @@
 #include <optional>
 #include <unordered_map>
 #include <atomic>
+#include <limits>
+#include <algorithm>
 
 namespace matching {
 
@@ -94,6 +98,44 @@ struct MatchResult {
 // Callback for when fills occur
 using FillCallback = std::function<void(const Fill& fill)>;
 
+// Outcome of the sink-based process_order; fills go to the caller's sink
+struct MatchSummary {
+    OrderStatus final_status{OrderStatus::NEW};
+    Quantity total_filled{0};
+    uint32_t fill_count{0};
+};
+
+// Outcome of an auction uncross
+struct AuctionSummary {
+    Price price{0};              // 0: nothing crossed
+    uint64_t volume{0};
+    int64_t imbalance{0};        // Buy minus sell interest left at price
+    uint32_t fill_count{0};
+};
+
+// Fill sink over caller-owned storage. Fills beyond capacity are counted in
+// `dropped` but not stored, so the caller can size the buffer once for the
+// deepest sweep it expects.
+struct FillSpan {
+    Fill* data{nullptr};
+    size_t capacity{0};
+    size_t size{0};
+    size_t dropped{0};
+    
+    FillSpan(Fill* buffer, size_t cap) : data(buffer), capacity(cap) {}
+    
+    void operator()(const Fill& fill) {
+        if (size < capacity) {
+            data[size++] = fill;
+        } else {
+            ++dropped;
+        }
+    }
+    void clear() { size = 0; dropped = 0; }
+    const Fill* begin() const { return data; }
+    const Fill* end() const { return data + size; }
+};
+
 // Market data snapshot
 struct Level1Data {
     SymbolId symbol{0};
@@ -118,14 +160,23 @@ struct Level2Data {
     Timestamp update_time{};
 };
 
+// A price level's state after it changed; quantity 0 means it emptied
+struct LevelChange {
+    Side side{Side::BUY};
+    Price price{0};
+    Quantity quantity{0};
+    uint32_t order_count{0};
+};
+
 // Main Matching Engine class
 class MatchingEngine {
 private:
     // Symbol-specific order books  
     std::unordered_map<SymbolId, std::unique_ptr<UltraOrderBook>> order_books_;
     
-    // Order tracking
-    std::unordered_map<OrderId, Order> active_orders_;
+    // Resting orders. Each is one OrderRecord whose node sits directly in
+    // its book's level queue; the books keep no order index of their own.
+    OrderStore orders_;
     
     // Trade ID generation
     std::atomic<uint64_t> next_trade_id_{1};
@@ -133,13 +184,27 @@ private:
     // Callbacks
     FillCallback fill_callback_;
     
+    // process_order() time, recorded by the engine thread
+    perf::LatencyTracker order_latency_;
+    
+    // Symbols collecting orders for an auction, by id
+    std::vector<uint8_t> in_auction_;
+    std::vector<std::pair<OrderId, Quantity>> auction_buys_;  // uncross scratch
+    std::vector<std::pair<OrderId, Quantity>> auction_sells_;
+    
+    // Books record changed levels for drain_level_changes()
+    bool track_level_changes_{false};
+    
     // Internal helper methods
-    MatchResult process_market_order(Order& order);
-    MatchResult process_limit_order(Order& order);
-    MatchResult attempt_cross(Order& aggressive_order, UltraOrderBook& book);
-    Fill create_fill(const Order& aggressive, const Order& passive, Price price, Quantity qty);
+    template <typename FillSink>
+    MatchSummary attempt_cross(Order& aggressive_order, UltraOrderBook& book, FillSink& sink);
+    Fill create_fill(const Order& aggressive, OrderId passive_id, Price price, Quantity qty);
+    void record_passive_fill(UltraOrder& passive, Quantity qty);
+    void rest_order(const Order& order, UltraOrderBook& book);
     void update_order_status(Order& order);
     UltraOrderBook* get_or_create_book(SymbolId symbol);
+    UltraOrderBook* find_book(SymbolId symbol) const;
+    static Order to_order(const OrderRecord& rec);
     
 public:
     explicit MatchingEngine(FillCallback callback = nullptr);
@@ -147,11 +212,32 @@ public:
     
     // Core order processing
     MatchResult process_order(Order order);
+    
+    // Allocation-free variant: each fill is passed to sink(const Fill&) (e.g.
+    // a FillSpan) instead of being collected in a vector, and the registered
+    // FillCallback is not invoked. Neither the order nor the orders it
+    // fills are looked up by id.
+    template <typename FillSink>
+    MatchSummary process_order(Order order, FillSink&& sink);
     bool cancel_order(OrderId order_id);
     bool replace_order(OrderId old_id, Order new_order);
     
+    // Auctions. While a symbol is in auction its day limit orders rest
+    // without matching (market, IOC and FOK orders are rejected). uncross()
+    // executes everything that crosses at the single equilibrium price in
+    // one pass, pairing buys and sells in price-time priority on each side,
+    // and returns the symbol to continuous matching. Fills go to sink, with
+    // the buy order as aggressive_order_id.
+    void begin_auction(SymbolId symbol);
+    bool in_auction(SymbolId symbol) const {
+        return symbol < in_auction_.size() && in_auction_[symbol];
+    }
+    template <typename FillSink>
+    AuctionSummary uncross(SymbolId symbol, FillSink&& sink);
+    
     // Symbol management
     void add_symbol(SymbolId symbol);
+    void add_symbol(SymbolId symbol, const UltraBookConfig& config);
     void remove_symbol(SymbolId symbol);
     std::vector<SymbolId> get_active_symbols() const;
     
@@ -159,6 +245,14 @@ public:
     Level1Data get_level1_data(SymbolId symbol) const;
     Level2Data get_level2_data(SymbolId symbol, uint32_t depth = 10) const;
     
+    // Incremental depth. Once tracking is on, each book notes the levels
+    // its adds, fills and cancels touch, and drain_level_changes() hands
+    // each changed level over once, with its current totals, as
+    // fn(const LevelChange&). Returns the number of levels drained.
+    void track_level_changes(bool on);
+    template <typename Fn>
+    uint32_t drain_level_changes(SymbolId symbol, Fn&& fn);
+    
     // Order query
     std::optional<Order> get_order(OrderId order_id) const;
     std::vector<Order> get_orders_for_symbol(SymbolId symbol) const;
@@ -172,11 +266,167 @@ public:
         uint32_t active_orders{0};
     };
     Stats get_stats() const;
+    const perf::LatencyTracker& order_latency() const { return order_latency_; }
+    
+    // Trade ids count up from here (1 by default). Engines whose fills share
+    // one id space, such as ShardedEngine shards, each start in their own range.
+    void set_next_trade_id(uint64_t id) { next_trade_id_.store(id, std::memory_order_relaxed); }
     
     // Callback management
     void set_fill_callback(FillCallback callback) { fill_callback_ = std::move(callback); }
+    const FillCallback& get_fill_callback() const { return fill_callback_; }
 };
 
+// =============================================================================
+// Template implementations
+// =============================================================================
+
+template <typename FillSink>
+MatchSummary MatchingEngine::process_order(Order order, FillSink&& sink) {
+    MEASURE_LATENCY(order_latency_);
+    
+    // Set timestamp and validate
+    order.timestamp = std::chrono::high_resolution_clock::now();
+    
+    if (order.quantity == 0) {
+        return {OrderStatus::REJECTED, 0, 0};
+    }
+    
+    UltraOrderBook* book = get_or_create_book(order.symbol);
+    if (!book) {
+        return {OrderStatus::REJECTED, 0, 0};
+    }
+    
+    if (__builtin_expect(in_auction(order.symbol), 0)) {
+        if (order.type != OrderType::LIMIT || order.tif != TimeInForce::DAY) {
+            return {OrderStatus::REJECTED, 0, 0};
+        }
+        rest_order(order, *book);
+        return {OrderStatus::NEW, 0, 0};
+    }
+    
+    // Cross first; whatever is left either rests or is canceled
+    MatchSummary summary = attempt_cross(order, *book, sink);
+    update_order_status(order);
+    if (order.is_fully_filled()) {
+        return summary;
+    }
+    
+    if (order.tif == TimeInForce::FOK) {
+        // attempt_cross only fills FOK orders it can fill completely
+        summary.final_status = OrderStatus::CANCELED;
+    } else if (order.type == OrderType::LIMIT && order.tif == TimeInForce::DAY) {
+        rest_order(order, *book);
+    }
+    // Market and IOC remainders are dropped; the order never becomes active
+    
+    return summary;
+}
+
+template <typename FillSink>
+AuctionSummary MatchingEngine::uncross(SymbolId symbol, FillSink&& sink) {
+    AuctionSummary summary;
+    if (symbol < in_auction_.size()) {
+        in_auction_[symbol] = 0;
+    }
+    UltraOrderBook* book = find_book(symbol);
+    if (!book) {
+        return summary;
+    }
+    
+    const UltraOrderBook::UltraCross cross = book->ultra_equilibrium();
+    summary.price = cross.price;
+    summary.imbalance = cross.imbalance;
+    if (cross.volume == 0) {
+        return summary;
+    }
+    summary.volume = cross.volume;
+    
+    // Each side gives up exactly the crossed volume, front of queue first
+    const Quantity volume = static_cast<Quantity>(cross.volume);
+    auction_buys_.clear();
+    auction_sells_.clear();
+    book->ultra_sweep(false, cross.price, volume, [&](UltraOrder& passive, Price, Quantity qty) {
+        auction_buys_.emplace_back(passive.get_id(), qty);
+        record_passive_fill(passive, qty);
+    });
+    book->ultra_sweep(true, cross.price, volume, [&](UltraOrder& passive, Price, Quantity qty) {
+        auction_sells_.emplace_back(passive.get_id(), qty);
+        record_passive_fill(passive, qty);
+    });
+    
+    // Pair the two queues into fills at the one price
+    const auto now = std::chrono::high_resolution_clock::now();
+    size_t b = 0, s = 0;
+    while (b < auction_buys_.size() && s < auction_sells_.size()) {
+        const Quantity qty = std::min(auction_buys_[b].second, auction_sells_[s].second);
+        Fill fill;
+        fill.aggressive_order_id = auction_buys_[b].first;
+        fill.passive_order_id = auction_sells_[s].first;
+        fill.symbol = symbol;
+        fill.execution_price = cross.price;
+        fill.execution_quantity = qty;
+        fill.execution_time = now;
+        fill.trade_id = next_trade_id_.fetch_add(1);
+        sink(fill);
+        ++summary.fill_count;
+        if ((auction_buys_[b].second -= qty) == 0) ++b;
+        if ((auction_sells_[s].second -= qty) == 0) ++s;
+    }
+    
+    return summary;
+}
+
+template <typename Fn>
+uint32_t MatchingEngine::drain_level_changes(SymbolId symbol, Fn&& fn) {
+    UltraOrderBook* book = find_book(symbol);
+    if (!book) {
+        return 0;
+    }
+    return book->ultra_drainChanges([&](bool is_buy, Price price, Quantity qty, uint32_t count) {
+        fn(LevelChange{is_buy ? Side::BUY : Side::SELL, price, qty, count});
+    });
+}
+
+template <typename FillSink>
+MatchSummary MatchingEngine::attempt_cross(Order& aggressive_order, UltraOrderBook& book,
+                                           FillSink& sink) {
+    MatchSummary summary;
+    const bool is_buy = aggressive_order.is_buy();
+    const Quantity wanted = aggressive_order.remaining_quantity();
+    
+    // Market orders take any price; limit orders cross at their price or better
+    Price limit = aggressive_order.price;
+    if (aggressive_order.type == OrderType::MARKET) {
+        limit = is_buy ? std::numeric_limits<Price>::max() : 0;
+    }
+    
+    // Fill-or-kill is decided before touching the book, so fills never need reversing
+    if (aggressive_order.tif == TimeInForce::FOK &&
+        book.ultra_crossableQuantity(is_buy, limit, wanted) < wanted) {
+        return summary;
+    }
+    
+    // Sweep resting orders level by level in price-time priority
+    summary.total_filled = book.ultra_sweep(is_buy, limit, wanted,
+        [&](UltraOrder& passive, Price price, Quantity qty) {
+            const OrderId passive_id = passive.get_id();
+            record_passive_fill(passive, qty);
+            sink(create_fill(aggressive_order, passive_id, price, qty));
+            ++summary.fill_count;
+        });
+    aggressive_order.filled_quantity += summary.total_filled;
+    
+    // Set final status
+    if (aggressive_order.is_fully_filled()) {
+        summary.final_status = OrderStatus::FILLED;
+    } else if (summary.total_filled > 0) {
+        summary.final_status = OrderStatus::PARTIALLY_FILLED;
+    }
+    
+    return summary;
+}
+
 } // namespace matching
 
 #endif // MATCHING_ENGINE_HPP
@@ -0,0 +1,213 @@
+#ifndef ORDER_STORE_HPP
+#define ORDER_STORE_HPP
+
+#include "order_book.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace matching {
+
+// The one record of a resting order. Its book links `node` into the price
+// level queue (node.quantity is what is left to trade); the engine keeps
+// the rest. Only day limit orders ever rest, so type and time in force are
+// implied.
+struct OrderRecord {
+    UltraOrder node;           // First member: the book hands back &node
+    int64_t timestamp{0};      // Order creation time, high_resolution_clock ticks
+    uint32_t quantity{0};      // As entered
+    uint32_t filled{0};
+    uint16_t symbol{0};
+    char status{'0'};          // OrderStatus
+    uint32_t handle{0};
+    uint32_t symbol_next{0};   // Per-symbol list (arrival order); free list link when released
+    uint32_t symbol_prev{0};
+};
+
+static_assert(std::is_standard_layout<OrderRecord>::value && offsetof(OrderRecord, node) == 0,
+              "OrderRecord must start with its book node");
+static_assert(sizeof(OrderRecord) == 64, "OrderRecord should fill exactly one cache line");
+
+// Pool of OrderRecords addressed by 32-bit handle, with a flat open-addressed
+// index from order id and an intrusive list per symbol. Records live in
+// fixed chunks, so their addresses (which the books hold) never move.
+class OrderStore {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    OrderStore() : slots_(INITIAL_SLOTS) {}
+
+    OrderStore(const OrderStore&) = delete;
+    OrderStore& operator=(const OrderStore&) = delete;
+
+    // New record for id on symbol, linked at the back of the symbol's list;
+    // nullptr if the id is already live
+    OrderRecord* insert(uint64_t id, uint16_t symbol) {
+        size_t i = slot_for(id);
+        for (; slots_[i].handle != NONE; i = (i + 1) & mask()) {
+            if (slots_[i].id == id) return nullptr;
+        }
+
+        OrderRecord* rec = acquire();
+        rec->symbol = symbol;
+        slots_[i] = Slot{id, rec->handle};
+        link(*rec);
+        if (++size_ * 2 > slots_.size()) grow();
+        return rec;
+    }
+
+    OrderRecord* find(uint64_t id) {
+        for (size_t i = slot_for(id); slots_[i].handle != NONE; i = (i + 1) & mask()) {
+            if (slots_[i].id == id) return &at(slots_[i].handle);
+        }
+        return nullptr;
+    }
+
+    const OrderRecord* find(uint64_t id) const { return const_cast<OrderStore*>(this)->find(id); }
+
+    // Unlinks the record from its symbol and the index and frees its handle
+    void erase(OrderRecord* rec) {
+        unlink(*rec);
+        erase_slot(rec->node.get_id());
+        rec->symbol_next = free_head_;
+        free_head_ = rec->handle;
+        --size_;
+    }
+
+    static OrderRecord* from_node(UltraOrder* node) { return reinterpret_cast<OrderRecord*>(node); }
+
+    // fn(const OrderRecord&) for each live order of symbol, oldest first.
+    // fn may erase the record it is given.
+    template <typename Fn>
+    void for_each_in_symbol(uint16_t symbol, Fn&& fn) {
+        uint32_t h = symbol < heads_.size() ? heads_[symbol].first : NONE;
+        while (h != NONE) {
+            OrderRecord& rec = at(h);
+            h = rec.symbol_next;
+            fn(rec);
+        }
+    }
+
+    template <typename Fn>
+    void for_each_in_symbol(uint16_t symbol, Fn&& fn) const {
+        uint32_t h = symbol < heads_.size() ? heads_[symbol].first : NONE;
+        while (h != NONE) {
+            const OrderRecord& rec = at(h);
+            h = rec.symbol_next;
+            fn(rec);
+        }
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    static constexpr uint32_t CHUNK_BITS = 12; // 4096 records, 256 KB per chunk
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static constexpr size_t INITIAL_SLOTS = 1024;
+
+    struct Slot {
+        uint64_t id{0};
+        uint32_t handle{NONE}; // NONE: empty
+    };
+
+    struct SymbolList {
+        uint32_t first{NONE};
+        uint32_t last{NONE};
+    };
+
+    OrderRecord& at(uint32_t h) { return chunks_[h >> CHUNK_BITS][h & (CHUNK_SIZE - 1)]; }
+    const OrderRecord& at(uint32_t h) const { return chunks_[h >> CHUNK_BITS][h & (CHUNK_SIZE - 1)]; }
+
+    size_t mask() const { return slots_.size() - 1; }
+
+    static size_t hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    size_t slot_for(uint64_t id) const { return hash(id) & mask(); }
+
+    OrderRecord* acquire() {
+        uint32_t h = free_head_;
+        if (h != NONE) {
+            free_head_ = at(h).symbol_next;
+        } else {
+            if ((next_handle_ & (CHUNK_SIZE - 1)) == 0) {
+                chunks_.emplace_back(new OrderRecord[CHUNK_SIZE]);
+            }
+            h = next_handle_++;
+        }
+        OrderRecord* rec = &at(h);
+        *rec = OrderRecord{};
+        rec->handle = h;
+        return rec;
+    }
+
+    void link(OrderRecord& rec) {
+        if (rec.symbol >= heads_.size()) heads_.resize(size_t(rec.symbol) + 1);
+        SymbolList& list = heads_[rec.symbol];
+        rec.symbol_next = NONE;
+        rec.symbol_prev = list.last;
+        if (list.last != NONE) {
+            at(list.last).symbol_next = rec.handle;
+        } else {
+            list.first = rec.handle;
+        }
+        list.last = rec.handle;
+    }
+
+    void unlink(OrderRecord& rec) {
+        SymbolList& list = heads_[rec.symbol];
+        if (rec.symbol_prev != NONE) {
+            at(rec.symbol_prev).symbol_next = rec.symbol_next;
+        } else {
+            list.first = rec.symbol_next;
+        }
+        if (rec.symbol_next != NONE) {
+            at(rec.symbol_next).symbol_prev = rec.symbol_prev;
+        } else {
+            list.last = rec.symbol_prev;
+        }
+    }
+
+    // Linear probing with backward-shift deletion, so there are no tombstones
+    void erase_slot(uint64_t id) {
+        size_t i = slot_for(id);
+        while (slots_[i].id != id || slots_[i].handle == NONE) i = (i + 1) & mask();
+        for (size_t j = (i + 1) & mask(); slots_[j].handle != NONE; j = (j + 1) & mask()) {
+            const size_t home = slot_for(slots_[j].id);
+            // Move j back into the hole unless its home lies in (i, j]
+            if (((j - home) & mask()) >= ((j - i) & mask())) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i] = Slot{};
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots_.size() * 2);
+        old.swap(slots_);
+        for (const Slot& s : old) {
+            if (s.handle == NONE) continue;
+            size_t i = slot_for(s.id);
+            while (slots_[i].handle != NONE) i = (i + 1) & mask();
+            slots_[i] = s;
+        }
+    }
+
+    std::vector<std::unique_ptr<OrderRecord[]>> chunks_;
+    std::vector<Slot> slots_;       // Power of two, at most half full
+    std::vector<SymbolList> heads_; // By symbol id
+    uint32_t next_handle_{0};
+    uint32_t free_head_{NONE};
+    size_t size_{0};
+};
+
+} // namespace matching
+
+#endif // ORDER_STORE_HPP
@@ -0,0 +1,223 @@
+#ifndef SHARDED_ENGINE_HPP
+#define SHARDED_ENGINE_HPP
+
+#include "matching/matching_engine.hpp"
+#include "lock_free_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace matching {
+
+class Journal;
+
+// Request to an engine shard
+struct EngineCommand {
+    enum class Kind : uint8_t {
+        ADD_SYMBOL,
+        NEW_ORDER,
+        CANCEL,
+        REPLACE
+    };
+
+    Kind kind{Kind::NEW_ORDER};
+    Order order;             // NEW_ORDER/REPLACE: the order; CANCEL: id and symbol
+    OrderId target_id{0};    // REPLACE: the order being replaced
+    UltraBookConfig config;  // ADD_SYMBOL
+};
+
+// Result from an engine shard. Sequence numbers count a shard's events
+// without gaps, in the order the shard produced them.
+struct EngineEvent {
+    enum class Kind : uint8_t {
+        ACK,            // Order processed; status and filled are final for this pass
+        FILL,
+        CANCELED,
+        CANCEL_REJECT   // Unknown order (or replace target)
+    };
+
+    Kind kind{Kind::ACK};
+    OrderStatus status{OrderStatus::NEW};
+    uint32_t shard{0};
+    uint64_t sequence{0};
+    OrderId order_id{0};
+    Quantity filled{0};
+    Fill fill;               // FILL only
+};
+
+struct ShardedEngineConfig {
+    uint32_t shards{1};
+    int first_cpu{-1};                 // shard i is pinned to first_cpu + i; -1 leaves placement to the OS
+    size_t inbound_capacity{1 << 14};  // commands per shard
+    size_t outbound_capacity{1 << 16}; // events per shard
+    bool spin{true};                   // idle shards spin on pause; false yields instead
+    Journal* journal{nullptr};         // open journal with a producer per shard: records every
+                                       // command before it runs and every event it produces;
+                                       // events reach poll() only once their record is durable,
+                                       // so stop() the engine before closing the journal
+};
+
+// First trade id of a shard's engine. The shard index sits in the top 16
+// bits, so trade ids stay unique across shards, in their TradeReports and in
+// the journal, and shard 0 counts from 1 like a standalone engine.
+constexpr uint32_t TRADE_ID_SHARD_SHIFT = 48;
+inline uint64_t first_trade_id(uint32_t shard) {
+    return (static_cast<uint64_t>(shard) << TRADE_ID_SHARD_SHIFT) + 1;
+}
+
+// Runs one command on an engine, passing each resulting event to
+// emit(const EngineEvent&) without shard or sequence. Shards and journal
+// replay both execute through here, so a replay takes the same path.
+template <typename EmitFn>
+void execute_command(MatchingEngine& engine, const EngineCommand& command, EmitFn&& emit);
+
+// Engine runtime with one thread per shard. A symbol belongs to exactly one
+// shard, which owns its book and resting orders, so matching takes no locks.
+// Any thread may submit; commands travel over a bounded MPSC ring per shard
+// and results come back over an SPSC ring per shard, drained by poll().
+// Commands for one symbol from one submitting thread are processed, and
+// their events emitted, in submission order.
+class ShardedEngine {
+public:
+    explicit ShardedEngine(const ShardedEngineConfig& config = {});
+    ~ShardedEngine();
+
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    // Lifecycle. stop() processes whatever was submitted before it returns.
+    bool start();
+    void stop();
+    bool is_running() const { return running_.load(std::memory_order_acquire); }
+
+    uint32_t shard_count() const { return static_cast<uint32_t>(shards_.size()); }
+    uint32_t shard_of(SymbolId symbol) const { return symbol % shard_count(); }
+
+    // Submission, from any thread. false if the shard's inbound ring is full.
+    bool add_symbol(SymbolId symbol, const UltraBookConfig& config = {});
+    bool submit(const Order& order);
+    bool cancel(SymbolId symbol, OrderId order_id);
+    bool replace(OrderId old_id, const Order& new_order);
+
+    // Drains up to max_per_shard events from every shard into fn(const EngineEvent&).
+    // One consumer thread only. Returns the number of events handled.
+    template <typename EventFn>
+    size_t poll(EventFn&& fn, size_t max_per_shard = 256);
+
+    // Per-shard counters, readable while running
+    struct ShardStats {
+        uint64_t commands{0};
+        uint64_t events{0};
+        uint64_t dropped_events{0}; // Outbound ring full at stop()
+    };
+    ShardStats get_shard_stats(uint32_t shard) const;
+
+    // The shard's engine, e.g. for book queries once stopped. While running
+    // only its order_latency() tracker may be read.
+    const MatchingEngine& engine(uint32_t shard) const { return shards_[shard]->engine; }
+
+private:
+    // A journaled event and the journal record count that makes it durable
+    struct HeldEvent {
+        uint64_t durable_at;
+        EngineEvent event;
+    };
+
+    struct Shard {
+        Shard(size_t in_cap, size_t out_cap) : inbound(in_cap), outbound(out_cap) {}
+
+        MatchingEngine engine;
+        MpscQueue<EngineCommand> inbound;
+        SpscQueue<EngineEvent> outbound;
+        std::thread thread;
+        uint64_t next_sequence{1};
+        std::vector<HeldEvent> held;  // Journaled events awaiting commit, oldest from held_head
+        size_t held_head{0};
+        std::atomic<uint64_t> commands{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> dropped_events{0};
+    };
+
+    bool enqueue(SymbolId symbol, const EngineCommand& command);
+    void run_shard(uint32_t index);
+    void execute(uint32_t index, Shard& shard, EngineCommand& command);
+    void emit(Shard& shard, uint32_t index, EngineEvent event);
+    size_t release_durable(Shard& shard, uint32_t index);
+    void push_outbound(Shard& shard, const EngineEvent& event);
+
+    ShardedEngineConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> running_{false};
+};
+
+template <typename EmitFn>
+void execute_command(MatchingEngine& engine, const EngineCommand& command, EmitFn&& emit) {
+    EngineEvent event;
+    event.order_id = command.order.id;
+
+    switch (command.kind) {
+        case EngineCommand::Kind::ADD_SYMBOL:
+            engine.add_symbol(command.order.symbol, command.config);
+            return;
+
+        case EngineCommand::Kind::CANCEL:
+            event.kind = engine.cancel_order(command.order.id) ? EngineEvent::Kind::CANCELED
+                                                               : EngineEvent::Kind::CANCEL_REJECT;
+            event.status = event.kind == EngineEvent::Kind::CANCELED ? OrderStatus::CANCELED
+                                                                     : OrderStatus::REJECTED;
+            emit(event);
+            return;
+
+        case EngineCommand::Kind::REPLACE:
+            if (!engine.cancel_order(command.target_id)) {
+                event.kind = EngineEvent::Kind::CANCEL_REJECT;
+                event.status = OrderStatus::REJECTED;
+                event.order_id = command.target_id;
+                emit(event);
+                return;
+            }
+            break;
+
+        case EngineCommand::Kind::NEW_ORDER:
+            break;
+    }
+
+    // Fills are emitted as the sweep produces them, ahead of the order's ack
+    MatchSummary summary = engine.process_order(command.order, [&](const Fill& fill) {
+        EngineEvent fill_event;
+        fill_event.kind = EngineEvent::Kind::FILL;
+        fill_event.order_id = fill.aggressive_order_id;
+        fill_event.filled = fill.execution_quantity;
+        fill_event.fill = fill;
+        emit(fill_event);
+    });
+
+    event.kind = EngineEvent::Kind::ACK;
+    event.status = summary.final_status;
+    event.filled = summary.total_filled;
+    emit(event);
+}
+
+template <typename EventFn>
+size_t ShardedEngine::poll(EventFn&& fn, size_t max_per_shard) {
+    constexpr size_t BULK = 64;
+    EngineEvent batch[BULK];
+    size_t handled = 0;
+    for (auto& shard : shards_) {
+        size_t left = max_per_shard;
+        while (left > 0) {
+            const size_t n = shard->outbound.pop_bulk(batch, left < BULK ? left : BULK);
+            if (n == 0) break;
+            for (size_t i = 0; i < n; ++i) fn(batch[i]);
+            handled += n;
+            left -= n;
+        }
+    }
+    return handled;
+}
+
+} // namespace matching
+
+#endif // SHARDED_ENGINE_HPP
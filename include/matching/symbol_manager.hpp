@@ -61,6 +61,54 @@ struct SymbolInfo {
     bool accepts_orders() const {
         return state == SymbolState::PRE_OPEN || state == SymbolState::OPEN;
     }
+    
+    // Price parameters for the symbol's order book
+    UltraBookConfig book_config() const {
+        return UltraBookConfig{tick_size, min_price, max_price};
+    }
+};
+
+// Outcome of validating an order against its symbol's rules
+enum class RouteResult {
+    SUCCESS,
+    INVALID_SYMBOL,
+    MARKET_CLOSED,
+    INVALID_PRICE,
+    INVALID_QUANTITY,
+    REJECTED
+};
+
+// The parts of SymbolInfo the order path checks, as one flat record
+struct SymbolRules {
+    uint32_t tick_size{1};
+    uint32_t min_quantity{1};
+    uint32_t max_quantity{1000000};
+    uint32_t lot_size{100};
+    uint32_t min_price{1000};
+    uint32_t max_price{999999};
+    SymbolState state{SymbolState::INACTIVE};
+    bool valid{false};           // false: no such symbol
+    
+    bool accepts_orders() const {
+        return state == SymbolState::PRE_OPEN || state == SymbolState::OPEN;
+    }
+    
+    // Price (limit orders) and quantity checks, then tick and lot rounding
+    // on success; symbol and state are the caller's to check
+    RouteResult check_order(Order& order) const {
+        if (order.type == OrderType::LIMIT &&
+            (order.price < min_price || order.price > max_price || order.price % tick_size != 0)) {
+            return RouteResult::INVALID_PRICE;
+        }
+        if (order.quantity < min_quantity || order.quantity > max_quantity) {
+            return RouteResult::INVALID_QUANTITY;
+        }
+        if (order.type == OrderType::LIMIT) {
+            order.price = (order.price / tick_size) * tick_size;
+        }
+        order.quantity = (order.quantity / lot_size) * lot_size;
+        return RouteResult::SUCCESS;
+    }
 };
 
 // Symbol routing and management
@@ -76,6 +124,26 @@ private:
     // Thread safety
     mutable std::shared_mutex mutex_;
     
+    // Order-path view of every symbol, indexed by id. Writers (under mutex_)
+    // republish a symbol's slot under its seqlock; readers copy the slot
+    // and retry if a write overlapped, so validation never takes mutex_.
+    // Pages are allocated on first use and live as long as the manager.
+    struct alignas(64) RulesSlot {
+        static constexpr size_t WORDS = (sizeof(SymbolRules) + 7) / 8;
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint64_t> words[WORDS]{};
+    };
+    static constexpr size_t RULES_PAGE_BITS = 8;
+    static constexpr size_t RULES_PAGE_SIZE = size_t(1) << RULES_PAGE_BITS;
+    static constexpr size_t RULES_PAGES = (size_t(1) << 16) / RULES_PAGE_SIZE;
+    std::atomic<RulesSlot*> rules_pages_[RULES_PAGES]{};
+    
+public:
+    using StateListener = std::function<void(SymbolId symbol, SymbolState old_state, SymbolState new_state)>;
+    
+private:
+    StateListener state_listener_;
+    
     // Statistics
     struct Stats {
         uint32_t total_symbols{0};
@@ -87,7 +155,10 @@ private:
 
 public:
     SymbolManager() = default;
-    ~SymbolManager() = default;
+    ~SymbolManager();
+    
+    SymbolManager(const SymbolManager&) = delete;
+    SymbolManager& operator=(const SymbolManager&) = delete;
     
     // Symbol registration and lifecycle
     SymbolId add_symbol(const std::string& symbol_name, 
@@ -119,6 +190,13 @@ public:
     bool is_valid_symbol(const std::string& symbol_name) const;
     bool can_trade_symbol(SymbolId symbol_id) const;
     
+    // Order validation, lock-free. validate_order checks symbol, state,
+    // price (limit orders) and quantity against one consistent snapshot of
+    // the symbol's rules, and on success rounds the order's price to the
+    // tick and its quantity to the lot.
+    RouteResult validate_order(Order& order) const;
+    SymbolRules get_rules(SymbolId symbol_id) const;
+    
     // Order validation helpers
     bool validate_price(SymbolId symbol_id, uint32_t price) const;
     bool validate_quantity(SymbolId symbol_id, uint32_t quantity) const;
@@ -132,8 +210,13 @@ public:
     
     // Statistics and monitoring
     void update_symbol_stats(SymbolId symbol_id, uint32_t volume, bool is_trade = false);
+    void add_symbol_trades(SymbolId symbol_id, uint64_t volume, uint32_t trades);
     Stats get_stats() const;
     
+    // Called after each symbol state change, outside the manager's lock,
+    // on the thread that made the change
+    void set_state_listener(StateListener listener);
+    
     // Market hours management (simplified)
     void open_market();
     void close_market();
@@ -155,6 +238,10 @@ public:
     
 private:
     void update_stats();
+    void publish_rules(const SymbolInfo& info);
+    void retract_rules(SymbolId symbol_id);
+    void store_rules(SymbolId symbol_id, const SymbolRules& rules);
+    void notify_state_changes(const std::vector<std::pair<SymbolId, SymbolState>>& changes, SymbolState new_state);
 };
 
 // Multi-Symbol Order Router
@@ -170,21 +257,26 @@ private:
         uint64_t rejected_orders{0};
         uint64_t invalid_symbol_orders{0};
         uint64_t market_closed_orders{0};
+        uint64_t auction_uncrosses{0};
+        uint64_t auction_volume{0};
     } stats_;
     
+    std::vector<uint32_t> batch_order_; // route_orders scratch: indices grouped by symbol
+    
 public:
-    SymbolRouter(SymbolManager& sym_mgr, MatchingEngine& engine)
-        : symbol_manager_(sym_mgr), matching_engine_(engine) {}
+    // The router drives the engine's auctions from the manager's symbol
+    // states: entering PRE_OPEN or HALTED starts collecting, entering OPEN
+    // uncrosses. It takes over the manager's state listener while it lives.
+    SymbolRouter(SymbolManager& sym_mgr, MatchingEngine& engine);
+    ~SymbolRouter();
+    
+    SymbolRouter(const SymbolRouter&) = delete;
+    SymbolRouter& operator=(const SymbolRouter&) = delete;
+    
+    void on_symbol_state(SymbolId symbol, SymbolState old_state, SymbolState new_state);
     
     // Route order to appropriate symbol
-    enum class RouteResult {
-        SUCCESS,
-        INVALID_SYMBOL,
-        MARKET_CLOSED,
-        INVALID_PRICE,
-        INVALID_QUANTITY,
-        REJECTED
-    };
+    using RouteResult = matching::RouteResult;
     
     struct RoutedOrder {
         Order order;
@@ -203,6 +295,13 @@ public:
     // Bulk routing for market data feeds
     std::vector<RoutedOrder> route_orders(const std::vector<Order>& orders);
     
+    // Batch routing without per-order allocation: results[i] receives the
+    // outcome of orders[i]. Orders are grouped by symbol (keeping each
+    // symbol's orders in their given order), each symbol's rules are read
+    // once, and its run goes to the engine back to back. Fills still reach
+    // the engine's FillCallback. Returns the number of orders routed.
+    size_t route_orders(const Order* orders, size_t count, RouteResult* results);
+    
     // Cancel/replace routing
     bool route_cancel(OrderId order_id);
     RoutedOrder route_replace(OrderId old_id, const Order& new_order);
@@ -2,11 +2,10 @@
 #define NET_ARBITER_HPP
 
 #include <cstdint>
-#include <map>
 #include <optional>
 #include <functional>
 #include <chrono>
-#include <deque>
+#include <vector>
 #include "core/packet.hpp"
 
 namespace net {
@@ -15,48 +14,103 @@ struct ArbiterMetrics {
   uint64_t gap_detected{0};
   uint64_t gap_filled{0};
   uint64_t dup_dropped{0};
-  uint64_t gap_dropped_ttl{0};
-  uint64_t gap_dropped_capacity{0};
+  uint64_t gap_dropped_ttl{0};      // sequence numbers given up on after the TTL
+  uint64_t gap_dropped_capacity{0}; // sequence numbers given up on when the ring filled
+  uint64_t dup_packets{0};          // MoldUDP64 packets dropped whole as duplicates
+  uint64_t session_mismatch{0};     // MoldUDP64 packets from a different session
+  uint64_t end_of_session{0};
+  uint64_t holes_recovered{0};      // holes closed by the missing message arriving
+  uint64_t hole_wait_ns{0};         // how long those stayed open, in total
+  uint64_t hole_wait_max_ns{0};
 };
 
-// Arbiter: merges two feeds by tracking number with bounded TTL gap buffering
+// How feed packets are framed
+enum class Framing : uint8_t {
+  Itch,      // bare ITCH messages, sequenced by the 16-bit tracking number
+  MoldUDP64  // MoldUDP64 packets, sequenced by the 64-bit packet sequence
+};
+
+// Arbiter: merges two feeds by sequence number with bounded TTL gap buffering.
+// Out-of-order messages wait in a power-of-two ring indexed by seq & mask,
+// as views into the feed's packet buffers (no copies). Feeds with release
+// callbacks get each packet back once the arbiter holds no view into it;
+// others must keep popped bytes alive for at least the TTL plus the ring span.
+//
+// With MoldUDP64 framing, decisions are made per packet while the feeds are
+// in sequence: a packet starting at the expected sequence is drained without
+// looking at the other feed, and the other feed's copy is dropped whole from
+// its header. Per-message arbitration only happens while a gap is open.
 class Arbiter {
 public:
   // Feeds are polled via provided callbacks; return false if empty
   using PopFn = std::function<bool(core::PacketView&)>;
+  // Returns a popped packet, and every packet popped before it, to its feed
+  using ReleaseFn = std::function<void(const core::PacketView&)>;
 
   Arbiter(PopFn popA, PopFn popB, size_t gap_capacity = 65536,
-          std::chrono::milliseconds ttl = std::chrono::milliseconds(50))
-      : popA_(std::move(popA)), popB_(std::move(popB)),
-        gap_capacity_(gap_capacity), ttl_(ttl) {}
+          std::chrono::milliseconds ttl = std::chrono::milliseconds(50),
+          Framing framing = Framing::Itch);
 
-  // Message-level arbitration: returns next in-order ITCH message as PacketView
-  std::optional<core::PacketView> next_message();
+  void set_release(ReleaseFn releaseA, ReleaseFn releaseB);
 
+  // Message-level arbitration: returns next in-order ITCH message as PacketView,
+  // valid until the following call
+  std::optional<core::PacketView> next_message();
 
   const ArbiterMetrics& metrics() const { return metrics_; }
+  uint64_t expected_sequence() const { return expected_; }
+
+  // Starts after `sequence` (e.g. a restored checkpoint's): earlier messages
+  // are dropped as duplicates. Before the first next_message() only.
+  void resume_after(uint64_t sequence) { expected_ = sequence + 1; }
+  size_t buffered() const { return buffered_; }
 
 private:
   using Clock = std::chrono::steady_clock;
-  struct GapItem { core::SmallMsg pkt; Clock::time_point ts; };
 
-  void prune_expired();
-  void load_feed_messages(PopFn& pop, std::deque<core::PacketView>& buf);
+  static constexpr uint64_t UNSEQUENCED = ~0ull; // Itch messages without a tracking number
+
+  // Unconsumed remainder of the last packet popped from a feed
+  struct FeedCursor {
+    PopFn pop;
+    core::PacketView pkt;
+    uint32_t off{0};
+    uint64_t seq{0};   // MoldUDP64: sequence of the message at off
+    uint32_t left{0};  // MoldUDP64: messages left in pkt
+    ReleaseFn release;
+    core::PacketView done; // newest finished packet not released yet
+  };
+
+  bool peek(FeedCursor& feed, core::PacketView& msg, uint64_t& seq);
+  bool peek_itch(FeedCursor& feed, core::PacketView& msg, uint64_t& seq);
+  bool peek_mold(FeedCursor& feed, core::PacketView& msg, uint64_t& seq);
+  bool pull(FeedCursor& feed);
+  void release_done();
+  void consume(FeedCursor& feed, const core::PacketView& msg);
+  uint64_t sequence_of(const core::PacketView& msg) const;
+  bool take_ready(core::PacketView& msg);
+  uint64_t skip_hole();
+
+  bool occupied(uint64_t seq) const { return (occ_[(seq & mask_) >> 6] >> (seq & 63)) & 1; }
+  void set_occupied(uint64_t seq) { occ_[(seq & mask_) >> 6] |= 1ull << (seq & 63); }
+  void clear_occupied(uint64_t seq) { occ_[(seq & mask_) >> 6] &= ~(1ull << (seq & 63)); }
 
   uint64_t expected_{1};
-  std::map<uint64_t, GapItem> gap_; // ordered for draining
-  size_t gap_capacity_;
+  std::vector<core::PacketView> gap_; // slot seq & mask_
+  std::vector<uint64_t> occ_;         // one bit per slot
+  uint64_t mask_;
+  size_t buffered_{0};
+  Clock::time_point gap_opened_{};    // when the hole at expected_ was first seen
   std::chrono::milliseconds ttl_;
   ArbiterMetrics metrics_{};
-  PopFn popA_;
-  PopFn popB_;
-  std::deque<core::PacketView> bufA_;
-  std::deque<core::PacketView> bufB_;
-  std::deque<core::SmallMsg> ready_; // in-order messages drained from gap (owned)
-  core::SmallMsg staging_; // staging buffer to expose ready_ as PacketView
+  Framing framing_;
+  FeedCursor feedA_;
+  FeedCursor feedB_;
+  FeedCursor* fast_{nullptr};         // feed whose current packet is in sequence
+  char session_[10]{};
+  bool has_session_{false};
 };
 
 } // namespace net
 
 #endif // NET_ARBITER_HPP
-
@@ -0,0 +1,164 @@
+#ifndef NET_FEED_GENERATOR_HPP
+#define NET_FEED_GENERATOR_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "core/packet.hpp"
+#include "net/moldudp64.hpp"
+
+namespace net {
+
+// Building blocks for synthetic A/B feeds (feed_replay, tests): ITCH messages
+// packed into MoldUDP64 packets, and a seeded, repeatable per-feed schedule
+// of which packets go out, in what order and how late.
+
+// One run of packets for both feeds; A and B send the same packets
+class MoldFeedBuilder {
+public:
+  struct Packet {
+    uint64_t offset;      // Into the packet buffer; see view()
+    uint32_t len;
+    uint64_t sequence;    // Of the first message
+    uint16_t count;
+  };
+
+  MoldFeedBuilder(const std::string& session, size_t max_datagram = 1400, uint16_t max_messages = 0xFFFE)
+      : max_messages_(max_messages), staging_(max_datagram), writer_(staging_.data(), max_datagram) {
+    std::memset(session_, ' ', mold::SESSION_LEN);
+    std::memcpy(session_, session.data(), std::min(session.size(), mold::SESSION_LEN));
+  }
+
+  MoldFeedBuilder(const MoldFeedBuilder&) = delete;
+  MoldFeedBuilder& operator=(const MoldFeedBuilder&) = delete;
+
+  void add(const void* msg, uint16_t len) {
+    if (!open_ || writer_.count() == max_messages_ || !writer_.append(msg, len)) {
+      close_packet();
+      begin_packet();
+      writer_.append(msg, len);
+    }
+    ++next_sequence_;
+  }
+
+  // Closes the last packet and appends the end-of-session marker
+  void finish() {
+    close_packet();
+    begin_packet();
+    writer_.end_session();
+    close_packet();
+  }
+
+  const std::vector<Packet>& packets() const { return packets_; }
+  core::PacketView view(const Packet& p) const { return core::PacketView{buffer_.data() + p.offset, p.len}; }
+  uint64_t messages() const { return next_sequence_ - 1; }
+
+private:
+  void begin_packet() {
+    writer_.begin(session_, next_sequence_);
+    open_ = true;
+  }
+
+  void close_packet() {
+    if (!open_) return;
+    const uint16_t count = writer_.count();
+    packets_.push_back(Packet{buffer_.size(), static_cast<uint32_t>(writer_.size()),
+                              next_sequence_ - (count == mold::END_OF_SESSION ? 0 : count), count});
+    buffer_.insert(buffer_.end(), staging_.data(), staging_.data() + writer_.size());
+    open_ = false;
+  }
+
+  char session_[mold::SESSION_LEN + 1]{};
+  uint16_t max_messages_;
+  std::vector<char> staging_;   // The open packet
+  mold::PacketWriter writer_;
+  std::vector<char> buffer_;    // Closed packets, back to back
+  std::vector<Packet> packets_;
+  uint64_t next_sequence_{1};
+  bool open_{false};
+};
+
+// What happens to one feed's packets on the way out
+struct FeedImpairment {
+  double loss{0};              // Chance a packet is never sent
+  double duplicate{0};         // Chance it is sent twice in a row
+  double reorder{0};           // Chance it is held back behind later packets
+  uint32_t reorder_depth{4};   // by 1..depth packets
+  uint64_t delay_ns{0};        // Lag behind the nominal send time
+  uint64_t jitter_ns{0};       // plus 0..jitter, uniformly; can reorder on its own
+};
+
+struct ImpairmentStats {
+  uint64_t sent{0};
+  uint64_t lost{0};
+  uint64_t duplicated{0};
+  uint64_t reordered{0};
+};
+
+// One transmission on a feed
+struct ScheduledSend {
+  uint32_t packet;   // Index into the builder's packets
+  uint32_t slot;     // Packet whose nominal send time it goes out at
+  uint64_t lag_ns;   // Added to that time
+};
+
+// Applies `imp` to packets 0..count-1 and returns the sends by slot; a
+// held-back packet takes the slot of the one it is released behind. Sort by
+// nominal time of the slot plus lag for the transmit order (jitter can
+// reorder on its own). The same seed gives the same schedule, so a gap
+// pattern that exposed a problem can be replayed exactly. The last packet
+// (end of session) is never lost and lags the most, so receivers always see
+// the session close after everything else.
+inline std::vector<ScheduledSend> schedule_feed(size_t count, const FeedImpairment& imp, uint64_t seed,
+                                                ImpairmentStats& stats) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  auto lag = [&] { return imp.delay_ns + (imp.jitter_ns ? rng() % (imp.jitter_ns + 1) : 0); };
+
+  struct Held { uint32_t packet; size_t release_after; };
+  std::vector<Held> held;
+  std::vector<ScheduledSend> out;
+  out.reserve(count + count / 8);
+  auto release = [&](size_t position) {
+    for (size_t i = 0; i < held.size();) {
+      if (held[i].release_after <= position) {
+        out.push_back({held[i].packet, static_cast<uint32_t>(position), lag()});
+        held.erase(held.begin() + static_cast<std::ptrdiff_t>(i));
+      } else {
+        ++i;
+      }
+    }
+  };
+
+  for (size_t p = 0; p < count; ++p) {
+    const bool last = p + 1 == count;
+    if (!last && imp.loss > 0 && uni(rng) < imp.loss) {
+      ++stats.lost;
+    } else if (!last && imp.reorder > 0 && uni(rng) < imp.reorder) {
+      held.push_back({static_cast<uint32_t>(p), p + 1 + rng() % std::max<uint32_t>(imp.reorder_depth, 1)});
+      ++stats.reordered;
+    } else {
+      if (last) {
+        for (const Held& h : held) out.push_back({h.packet, static_cast<uint32_t>(p), lag()});
+        held.clear(); // Nothing trails the session end
+        out.push_back({static_cast<uint32_t>(p), static_cast<uint32_t>(p), imp.delay_ns + imp.jitter_ns});
+        break;
+      }
+      out.push_back({static_cast<uint32_t>(p), static_cast<uint32_t>(p), lag()});
+      if (imp.duplicate > 0 && uni(rng) < imp.duplicate) {
+        out.push_back({static_cast<uint32_t>(p), static_cast<uint32_t>(p), lag()});
+        ++stats.duplicated;
+      }
+    }
+    release(p);
+  }
+  stats.sent = out.size();
+  return out;
+}
+
+} // namespace net
+
+#endif // NET_FEED_GENERATOR_HPP
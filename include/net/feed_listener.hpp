@@ -4,37 +4,69 @@
 #include <atomic>
 #include <thread>
 #include <string>
-#include <vector>
-#include <array>
-#include "lock_free_queue.hpp"
 #include "core/packet.hpp"
+#include "net/packet_ring.hpp"
+#include "net/rx_backend.hpp"
 
 namespace net {
 
+struct FeedStats {
+  uint64_t packets{0};   // packets handed to the consumer
+  uint64_t bytes{0};
+  uint64_t stalls{0};    // receive passes skipped because the ring was near full
+  uint64_t dropped{0};   // packets that did not fit the ring
+};
+
 class FeedListener {
 public:
-  FeedListener(const std::string& mcast_group, int port, size_t q_capacity)
-      : mcast_group_(mcast_group), port_(port), queue_(q_capacity), ring_(q_capacity) {}
+  FeedListener(const std::string& mcast_group, int port, size_t ring_bytes = DEFAULT_RING_BYTES)
+      : FeedListener(make_config(mcast_group, port), ring_bytes) {}
+
+  // cfg.kind selects the receive backend; AF_XDP falls back to the socket
+  // backend when this build lacks it or the interface cannot be bound
+  explicit FeedListener(const RxConfig& cfg, size_t ring_bytes = DEFAULT_RING_BYTES)
+      : cfg_(cfg), ring_(ring_bytes) {}
 
   bool start();
   void stop();
 
-  // Non-blocking pop; returns false if empty
-  bool pop(core::PacketView& pkt) { return queue_.pop(pkt); }
+  // Non-blocking pop; returns false if empty. The packet's bytes stay valid
+  // until it (or a later packet) is passed to release().
+  bool pop(core::PacketView& pkt) { return ring_.pop(pkt); }
+  void release(const core::PacketView& pkt) { ring_.release(pkt); }
+
+  FeedStats stats() const {
+    FeedStats s;
+    s.packets = packets_.load(std::memory_order_relaxed);
+    s.bytes = bytes_.load(std::memory_order_relaxed);
+    s.stalls = stalls_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    return s;
+  }
+  size_t backlog_bytes() const { return ring_.used_bytes(); }
+
+  static constexpr size_t DEFAULT_RING_BYTES = 64u << 20;
 
 private:
+  static RxConfig make_config(const std::string& mcast_group, int port) {
+    RxConfig cfg;
+    cfg.mcast_group = mcast_group;
+    cfg.port = port;
+    return cfg;
+  }
+
   void run();
 
-  std::string mcast_group_;
-  int port_;
+  RxConfig cfg_;
   std::atomic<bool> running_{false};
   std::thread th_;
-  LockFreeQueue<core::PacketView> queue_;
-  std::vector<std::array<char, 4096>> ring_;
-  size_t ring_idx_{0};
+  PacketRing ring_;
+  std::atomic<uint64_t> packets_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> stalls_{0};
+  std::atomic<uint64_t> dropped_{0};
 };
 
 } // namespace net
 
 #endif // NET_FEED_LISTENER_HPP
-
@@ -0,0 +1,101 @@
+#ifndef NET_MOLDUDP64_HPP
+#define NET_MOLDUDP64_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include "core/packet.hpp"
+
+namespace net {
+
+// MoldUDP64 downstream packet:
+//   Session(10, ASCII) | Sequence(8, BE) | MessageCount(2, BE)
+//   then MessageCount x { Length(2, BE) | Message(Length) }
+// Sequence is that of the first message; count 0 is a heartbeat and
+// 0xFFFF marks the end of the session.
+namespace mold {
+
+constexpr size_t SESSION_LEN = 10;
+constexpr size_t HEADER_SIZE = 20;
+constexpr uint16_t END_OF_SESSION = 0xFFFF;
+
+struct Header {
+  char session[SESSION_LEN];
+  uint64_t sequence{0};
+  uint16_t count{0};
+
+  bool is_heartbeat() const { return count == 0; }
+  bool is_end_of_session() const { return count == END_OF_SESSION; }
+};
+
+static inline uint16_t load_be16(const char* p) {
+  const auto* u = reinterpret_cast<const unsigned char*>(p);
+  return static_cast<uint16_t>((u[0] << 8) | u[1]);
+}
+
+static inline uint64_t load_be64(const char* p) {
+  uint64_t v; std::memcpy(&v, p, sizeof(v));
+  return __builtin_bswap64(v);
+}
+
+static inline bool parse_header(const core::PacketView& pkt, Header& out) {
+  if (pkt.len < HEADER_SIZE) return false;
+  std::memcpy(out.session, pkt.data, SESSION_LEN);
+  out.sequence = load_be64(pkt.data + 10);
+  out.count = load_be16(pkt.data + 18);
+  return true;
+}
+
+// Builds a downstream packet into a caller-owned buffer (feed generators, tests)
+class PacketWriter {
+public:
+  PacketWriter(char* buf, size_t cap) : buf_(buf), cap_(cap) {}
+
+  void begin(const char (&session)[SESSION_LEN + 1], uint64_t sequence) {
+    std::memcpy(buf_, session, SESSION_LEN);
+    const uint64_t be = __builtin_bswap64(sequence);
+    std::memcpy(buf_ + 10, &be, sizeof(be));
+    len_ = HEADER_SIZE;
+    count_ = 0;
+    store_count();
+  }
+
+  // False if the message does not fit; the packet is left unchanged
+  bool append(const void* msg, uint16_t len) {
+    if (len_ + 2 + len > cap_) return false;
+    buf_[len_] = static_cast<char>(len >> 8);
+    buf_[len_ + 1] = static_cast<char>(len & 0xFF);
+    std::memcpy(buf_ + len_ + 2, msg, len);
+    len_ += 2 + len;
+    ++count_;
+    store_count();
+    return true;
+  }
+
+  // Makes the packet begun last the end-of-session marker, dropping any messages
+  void end_session() {
+    len_ = HEADER_SIZE;
+    count_ = END_OF_SESSION;
+    store_count();
+  }
+
+  uint16_t count() const { return count_; }
+  size_t size() const { return len_; }
+  core::PacketView view() const { return core::PacketView{buf_, static_cast<uint32_t>(len_)}; }
+
+private:
+  void store_count() {
+    buf_[18] = static_cast<char>(count_ >> 8);
+    buf_[19] = static_cast<char>(count_ & 0xFF);
+  }
+
+  char* buf_;
+  size_t cap_;
+  size_t len_{0};
+  uint16_t count_{0};
+};
+
+} // namespace mold
+} // namespace net
+
+#endif // NET_MOLDUDP64_HPP
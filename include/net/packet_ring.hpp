@@ -0,0 +1,160 @@
+#ifndef NET_PACKET_RING_HPP
+#define NET_PACKET_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include "core/packet.hpp"
+
+namespace net {
+
+// Single-producer/single-consumer ring of variable-length packets packed into
+// one hugepage-backed buffer. Each packet is a 16-byte header followed by its
+// payload, rounded up to 16 bytes, so a 100-byte datagram takes 128 bytes
+// rather than a whole slot.
+//
+// The consumer owns what it pops until it calls release(); releases are FIFO
+// and free the given packet together with every packet popped before it. The
+// producer never overwrites unreleased bytes: push() fails instead.
+class PacketRing {
+public:
+  static constexpr size_t HEADER_SIZE = 16;
+
+  explicit PacketRing(size_t bytes) {
+    cap_ = 2u << 20; // at least one 2 MB huge page
+    while (cap_ < bytes) cap_ <<= 1;
+    mask_ = cap_ - 1;
+    void* p = mmap(nullptr, cap_, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    hugepages_ = p != MAP_FAILED;
+    if (!hugepages_) {
+      p = mmap(nullptr, cap_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+      madvise(p, cap_, MADV_HUGEPAGE);
+#endif
+    }
+    buf_ = static_cast<char*>(p);
+  }
+
+  ~PacketRing() { munmap(buf_, cap_); }
+
+  PacketRing(const PacketRing&) = delete;
+  PacketRing& operator=(const PacketRing&) = delete;
+
+  // Producer: copies one packet in; false if the consumer has not released
+  // enough space yet
+  bool push(const char* data, uint32_t len, uint64_t rx_ns) {
+    if (!put(data, len, rx_ns)) return false;
+    head_.store(write_, std::memory_order_release);
+    return true;
+  }
+
+  // Producer: copies packets in until one does not fit and publishes them
+  // together; returns how many went in
+  size_t push_bulk(const core::PacketView* pkts, size_t n) {
+    size_t i = 0;
+    while (i < n && put(pkts[i].data, pkts[i].len, pkts[i].rx_ns)) ++i;
+    if (i) head_.store(write_, std::memory_order_release);
+    return i;
+  }
+
+  // Producer: free bytes as last seen; a lower bound of what push() can use
+  size_t free_bytes() {
+    cached_released_ = released_.load(std::memory_order_acquire);
+    return cap_ - (write_ - cached_released_);
+  }
+
+  // Consumer: next packet, still owned by the ring's consumer until released
+  bool pop(core::PacketView& pkt) {
+    while (true) {
+      if (read_ == cached_head_) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (read_ == cached_head_) return false;
+      }
+      Header h;
+      std::memcpy(&h, buf_ + (read_ & mask_), sizeof(h));
+      if (h.len == PAD) { read_ += h.size; continue; }
+      pkt = core::PacketView{buf_ + (read_ & mask_) + HEADER_SIZE, h.len, h.rx_ns};
+      read_ += h.size;
+      return true;
+    }
+  }
+
+  // Consumer: returns `pkt` and everything popped before it to the producer
+  void release(const core::PacketView& pkt) {
+    const uint64_t off = static_cast<uint64_t>(pkt.data - buf_) - HEADER_SIZE;
+    Header h;
+    std::memcpy(&h, buf_ + off, sizeof(h));
+    const uint64_t released = released_.load(std::memory_order_relaxed);
+    uint64_t ahead = (off + h.size - released) & mask_;
+    if (ahead == 0) ahead = cap_; // the whole ring was outstanding
+    released_.store(released + ahead, std::memory_order_release);
+  }
+
+  // Bytes popped or waiting to be popped that have not been released yet
+  size_t used_bytes() const {
+    return head_.load(std::memory_order_acquire) - released_.load(std::memory_order_acquire);
+  }
+  size_t capacity() const { return cap_; }
+  bool hugepages() const { return hugepages_; }
+
+private:
+  static constexpr uint32_t PAD = ~0u;
+
+  struct Header {
+    uint32_t size;   // record bytes including this header
+    uint32_t len;    // payload bytes, PAD for filler up to the end of the buffer
+    uint64_t rx_ns;
+  };
+  static_assert(sizeof(Header) == HEADER_SIZE, "record header must stay 16 bytes");
+
+  static uint64_t record_size(uint32_t len) { return HEADER_SIZE + ((uint64_t(len) + 15) & ~uint64_t(15)); }
+
+  // Writes one record (plus filler at the wrap) without publishing it
+  bool put(const char* data, uint32_t len, uint64_t rx_ns) {
+    const uint64_t rec = record_size(len);
+    uint64_t pos = write_;
+    const uint64_t room = cap_ - (pos & mask_); // contiguous bytes before the end
+    const uint64_t need = rec <= room ? rec : room + rec;
+    if (need > cap_ - (pos - cached_released_)) {
+      cached_released_ = released_.load(std::memory_order_acquire);
+      if (need > cap_ - (pos - cached_released_)) return false;
+    }
+    if (rec > room) { // pad to the end and start over at offset 0
+      store_header(pos, static_cast<uint32_t>(room), PAD, 0);
+      pos += room;
+    }
+    store_header(pos, static_cast<uint32_t>(rec), len, rx_ns);
+    std::memcpy(buf_ + (pos & mask_) + HEADER_SIZE, data, len);
+    write_ = pos + rec;
+    return true;
+  }
+
+  void store_header(uint64_t pos, uint32_t size, uint32_t len, uint64_t rx_ns) {
+    const Header h{size, len, rx_ns};
+    std::memcpy(buf_ + (pos & mask_), &h, sizeof(h));
+  }
+
+  char* buf_{nullptr};
+  size_t cap_{0};
+  uint64_t mask_{0};
+  bool hugepages_{false};
+
+  // Producer side
+  alignas(64) std::atomic<uint64_t> head_{0};
+  uint64_t write_{0};
+  uint64_t cached_released_{0};
+
+  // Consumer side
+  alignas(64) std::atomic<uint64_t> released_{0};
+  uint64_t read_{0};
+  uint64_t cached_head_{0};
+};
+
+} // namespace net
+
+#endif // NET_PACKET_RING_HPP
@@ -0,0 +1,53 @@
+#ifndef NET_RX_BACKEND_HPP
+#define NET_RX_BACKEND_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "core/packet.hpp"
+
+namespace net {
+
+enum class RxBackendKind : uint8_t {
+  Socket, // kernel UDP socket, recvmmsg batches
+  AfXdp   // AF_XDP UMEM rings, busy-polled (needs a build with NASDAQ_AF_XDP)
+};
+
+struct RxConfig {
+  std::string mcast_group;
+  int port{0};
+  RxBackendKind kind{RxBackendKind::Socket};
+  // Sockets: enables NIC hardware RX timestamps on this interface.
+  // AF_XDP: binds here, to the NIC queue the feed is steered to (e.g. an
+  // ethtool ntuple rule on the UDP port); every frame on that queue is taken.
+  std::string ifname;
+  uint32_t queue_id{0};
+  int cpu{-1};             // pin the receive thread; -1 leaves it unpinned
+  bool busy_poll{false};   // never sleep waiting for traffic: receive() returns at once and the thread spins
+};
+
+// Receive side of a feed. A backend owns its packet memory: views returned by
+// receive() stay valid until the next receive() call, which is long enough to
+// copy them into the listener's PacketRing.
+// Views carry the receive timestamp (PacketView::rx_ns) where one is available.
+class RxBackend {
+public:
+  virtual ~RxBackend() = default;
+
+  virtual bool open(const RxConfig& cfg) = 0;
+  // Returns up to `max` UDP payloads. May wait briefly for traffic (bounded,
+  // well under 100ms) so the caller can react to stop requests; with
+  // cfg.busy_poll it returns 0 at once instead.
+  virtual size_t receive(core::PacketView* out, size_t max) = 0;
+  virtual void close() = 0;
+  virtual const char* name() const = 0;
+};
+
+std::unique_ptr<RxBackend> make_socket_backend();
+// nullptr when this build has no AF_XDP support
+std::unique_ptr<RxBackend> make_af_xdp_backend();
+
+} // namespace net
+
+#endif // NET_RX_BACKEND_HPP
@@ -3,86 +3,77 @@
 
 #include <atomic>
 #include <cstddef>
-#include <immintrin.h>
-
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "perf/cpu.hpp"
+
+// Fixed-capacity pool of T-sized slots (raw storage: construct with placement
+// new) shared by several threads, e.g. engine orders, fills or market-data
+// messages across shard threads.
+//
+// All slots live in one contiguous 64-byte aligned slab, so the owner of a
+// pointer is plain address arithmetic: slot = (p - slab) and its free bit is
+// slot % 64 of bitmap word slot / 64. Each thread works out of a magazine, a
+// small local stack of free slots it takes from and releases into without
+// touching shared state. An empty magazine is refilled with up to half its
+// size from one bitmap word in a single CAS; a full one flushes half its
+// slots back, one fetch_or per run of slots in the same word.
+//
+// Threads map onto magazines by a per-process thread index; a thread whose
+// magazine is in use by another (more threads than MAGAZINES) goes straight
+// to the bitmap. Slots parked in magazines are invisible to other threads,
+// so up to MAGAZINES * MAGAZINE_SIZE slots may sit idle: size pools with
+// that headroom.
 template <typename T> class OptimizedObjectPool {
-private:
-  // Cache-aligned blocks to reduce false sharing
-  struct alignas(64) PoolBlock {
-    T objects[64]; // 64 objects per cache-aligned block
-    std::atomic<uint64_t> free_mask{~0ULL}; // All initially free
-  };
-
-  alignas(64) PoolBlock *blocks_;
-  size_t num_blocks_;
-  std::atomic<size_t> current_block_{0};
-
 public:
-  OptimizedObjectPool(size_t total_objects) {
-    num_blocks_ = (total_objects + 63) / 64; // Round up to blocks
-
-    // Allocate cache-aligned memory
-    blocks_ = static_cast<PoolBlock *>(
-        aligned_alloc(64, num_blocks_ * sizeof(PoolBlock)));
+  static constexpr size_t MAGAZINES = 16;
+  static constexpr uint32_t MAGAZINE_SIZE = 64;
+
+  explicit OptimizedObjectPool(size_t total_objects) {
+    num_words_ = (total_objects + 63) / 64; // Round up to whole bitmap words
+    if (num_words_ == 0) num_words_ = 1;
+    const size_t bytes = (num_words_ * 64 * sizeof(T) + 63) & ~size_t(63);
+    slab_ = static_cast<T *>(aligned_alloc(64, bytes));
+    free_ = static_cast<FreeWord *>(aligned_alloc(64, num_words_ * sizeof(FreeWord)));
+    for (size_t i = 0; i < num_words_; ++i) new (&free_[i]) FreeWord{};
+  }
 
-    // Initialize all blocks
-    for (size_t i = 0; i < num_blocks_; ++i) {
-      blocks_[i].free_mask.store(~0ULL, std::memory_order_relaxed);
-    }
+  ~OptimizedObjectPool() {
+    free(free_);
+    free(slab_);
   }
 
-  ~OptimizedObjectPool() { free(blocks_); }
+  OptimizedObjectPool(const OptimizedObjectPool &) = delete;
+  OptimizedObjectPool &operator=(const OptimizedObjectPool &) = delete;
 
+  // A free slot, or nullptr when none is left outside other magazines
   __attribute__((always_inline)) inline T *acquire() {
-    size_t start_block = current_block_.load(std::memory_order_relaxed);
-
-    for (size_t attempts = 0; attempts < num_blocks_; ++attempts) {
-      size_t block_idx = (start_block + attempts) % num_blocks_;
-      PoolBlock &block = blocks_[block_idx];
-
-      uint64_t mask = block.free_mask.load(std::memory_order_acquire);
-
-      while (mask != 0) {
-        // Find first free slot using builtin
-        int slot = __builtin_ctzll(mask); // Count trailing zeros
-        uint64_t slot_bit = 1ULL << slot;
-
-        // Try to claim this slot atomically
-        uint64_t expected = mask;
-        uint64_t desired = mask & ~slot_bit;
-
-        if (block.free_mask.compare_exchange_weak(expected, desired,
-                                                  std::memory_order_acq_rel,
-                                                  std::memory_order_acquire)) {
-
-          // Successfully claimed slot
-          current_block_.store(block_idx, std::memory_order_relaxed);
-          return &block.objects[slot];
-        }
-
-        // Reload mask and retry
-        mask = expected;
-      }
-    }
-
-    // Pool exhausted - should handle this gracefully
-    return nullptr;
+    const unsigned slot = perf::thread_index() % MAGAZINES;
+    Magazine &mag = magazines_[slot];
+    if (!mag.lock()) return acquire_shared(slot * num_words_ / MAGAZINES); // Spread over the bitmap
+    if (mag.count == 0) refill(mag);
+    T *obj = mag.count ? mag.objs[--mag.count] : nullptr;
+    mag.unlock();
+    return obj;
   }
 
+  // `object` must have come from this pool
   __attribute__((always_inline)) inline void release(T *object) {
-    // Find which block this object belongs to
-    for (size_t block_idx = 0; block_idx < num_blocks_; ++block_idx) {
-      PoolBlock &block = blocks_[block_idx];
-
-      if (object >= &block.objects[0] && object < &block.objects[64]) {
-        size_t slot = object - &block.objects[0];
-        uint64_t slot_bit = 1ULL << slot;
-
-        // Mark slot as free
-        block.free_mask.fetch_or(slot_bit, std::memory_order_acq_rel);
-        return;
-      }
+    Magazine &mag = magazines_[perf::thread_index() % MAGAZINES];
+    if (!mag.lock()) {
+      release_shared(&object, 1);
+      return;
+    }
+    if (mag.count == MAGAZINE_SIZE) {
+      // Oldest half goes back; the recently freed, cache-warm ones stay
+      release_shared(mag.objs, MAGAZINE_SIZE / 2);
+      for (uint32_t i = 0; i < MAGAZINE_SIZE / 2; ++i)
+        mag.objs[i] = mag.objs[i + MAGAZINE_SIZE / 2];
+      mag.count = MAGAZINE_SIZE / 2;
     }
+    mag.objs[mag.count++] = object;
+    mag.unlock();
   }
 
   // Batch allocation for better cache utilization
@@ -99,6 +90,80 @@ public:
 
     return acquired;
   }
+
+  bool owns(const T *object) const {
+    return object >= slab_ && object < slab_ + capacity();
+  }
+  size_t capacity() const { return num_words_ * 64; }
+
+private:
+  struct alignas(64) FreeWord {
+    std::atomic<uint64_t> mask{~0ULL}; // Bit set: slot free
+  };
+
+  struct alignas(64) Magazine {
+    std::atomic<bool> busy{false};
+    uint32_t count{0};
+    size_t hint{0}; // Bitmap word this thread last refilled from
+    T *objs[MAGAZINE_SIZE];
+
+    bool lock() { return !busy.exchange(true, std::memory_order_acquire); }
+    void unlock() { busy.store(false, std::memory_order_release); }
+  };
+
+  // Claims up to half a magazine from the first word with free slots,
+  // starting at the hint
+  void refill(Magazine &mag) {
+    for (size_t attempts = 0; attempts < num_words_; ++attempts) {
+      const size_t w = (mag.hint + attempts) % num_words_;
+      uint64_t mask = free_[w].mask.load(std::memory_order_relaxed);
+      while (mask != 0) {
+        uint64_t take = mask;
+        for (int n = __builtin_popcountll(take); n > int(MAGAZINE_SIZE / 2); --n)
+          take &= take - 1; // Leave the lowest slots for others
+        if (free_[w].mask.compare_exchange_weak(mask, mask & ~take, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+          while (take) {
+            mag.objs[mag.count++] = slab_ + w * 64 + __builtin_ctzll(take);
+            take &= take - 1;
+          }
+          mag.hint = w;
+          return;
+        }
+      }
+    }
+  }
+
+  T *acquire_shared(size_t start) {
+    for (size_t attempts = 0; attempts < num_words_; ++attempts) {
+      const size_t w = (start + attempts) % num_words_;
+      uint64_t mask = free_[w].mask.load(std::memory_order_relaxed);
+      while (mask != 0) {
+        const uint64_t bit = mask & -mask;
+        if (free_[w].mask.compare_exchange_weak(mask, mask & ~bit, std::memory_order_acquire,
+                                                std::memory_order_relaxed))
+          return slab_ + w * 64 + __builtin_ctzll(bit);
+      }
+    }
+    return nullptr;
+  }
+
+  // Sets the free bits of `count` slots, one fetch_or per run in the same word
+  void release_shared(T *const *objects, size_t count) {
+    size_t i = 0;
+    while (i < count) {
+      const size_t w = static_cast<size_t>(objects[i] - slab_) / 64;
+      uint64_t bits = 0;
+      for (; i < count && static_cast<size_t>(objects[i] - slab_) / 64 == w; ++i)
+        bits |= 1ULL << (static_cast<size_t>(objects[i] - slab_) % 64);
+      free_[w].mask.fetch_or(bits, std::memory_order_release);
+    }
+  }
+
+  T *slab_;
+  FreeWord *free_;
+  size_t num_words_;
+  Magazine magazines_[MAGAZINES];
 };
 
 #endif // OPTIMIZED_OBJECT_POOL_HPP
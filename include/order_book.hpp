@@ -8,11 +8,14 @@
 #include <unordered_map>
 #include <map>
 #include <memory>
+#include <new>
 #include <string>
+#include <vector>
 #include <immintrin.h>
 #include <x86intrin.h>
 #include <cstdlib>
 #include <iostream>
+#include <sys/mman.h>
 
 // Forward declarations
 struct Order;
@@ -140,16 +143,13 @@ extern OrderBookManager g_orderBookManager;
 // EXTREME OPTIMIZATIONS - 100-200ns Target
 // =============================================================================
 
-// Smaller price range for better cache utilization
-static constexpr uint32_t ULTRA_MIN_PRICE = 40000; // $4.00
-static constexpr uint32_t ULTRA_MAX_PRICE = 60000; // $6.00
-static constexpr uint32_t ULTRA_PRICE_LEVELS =
-    ULTRA_MAX_PRICE - ULTRA_MIN_PRICE + 1;
+// Dense price window width (in ticks) - small for better cache utilization.
+// The window floats per book; see UltraOrderBook below.
+static constexpr uint32_t ULTRA_PRICE_LEVELS = 20001; // +/- 10K ticks
 static constexpr uint32_t ULTRA_TICK_SIZE = 1; // 0.0001 units
 
-// Much smaller hash table - better cache hit rate
+// Default expected live orders per book; the order index grows past it
 static constexpr uint32_t ULTRA_HASH_SIZE = 65536; // 64K entries
-static constexpr uint32_t ULTRA_HASH_MASK = ULTRA_HASH_SIZE - 1;
 
 // =============================================================================
 // REGISTER-OPTIMIZED ORDER STRUCTURE
@@ -160,8 +160,8 @@ struct alignas(32) UltraOrder {
   uint64_t id_and_side; // Pack ID + side in one 64-bit value
   uint32_t quantity;
   uint32_t price;
-  UltraOrder *next; // Only forward pointer - no prev
-  uint64_t padding; // Align to 32 bytes
+  UltraOrder *next; // Towards the back of the level queue
+  UltraOrder *prev; // Towards the front of the level queue
 
   // Inline accessors
   __attribute__((always_inline)) inline uint64_t get_id() const {
@@ -179,179 +179,966 @@ struct alignas(32) UltraOrder {
 };
 
 // =============================================================================
-// ULTRA-FAST PRICE LEVEL (No linked list overhead)
+// ULTRA-FAST PRICE LEVEL (Intrusive FIFO queue)
 // =============================================================================
 
+// Resting orders in price-time priority: first_order is the front of the
+// queue, new orders are appended at last_order.
 struct alignas(32) UltraPriceLevel {
   uint32_t total_quantity;
-  uint16_t order_count;
-  uint16_t padding;
-  UltraOrder *first_order; // Stack-based allocation
-  uint64_t padding2;
+  uint32_t order_count;
+  UltraOrder *first_order; // Oldest order, next to trade
+  UltraOrder *last_order;  // Newest order
 };
 
 // =============================================================================
-// LOCK-FREE STACK-BASED ORDER POOL
+// RECYCLING SLAB ORDER POOL
 // =============================================================================
 
-class UltraFastOrderPool {
+// Single-threaded order pool. Released orders go onto an intrusive free list
+// (threaded through the first pointer-sized bytes of each released node, so
+// any node type of at least that size fits) and are handed out again before any
+// fresh slot, so a book's footprint tracks its peak live order count rather
+// than the number of adds in the session. Fresh slots are bumped out of
+// chunks: the first is a heap chunk sized to the requested capacity, and
+// each one added after doubles the pool, so a thin book stays a few pages.
+// Once the pool holds a whole slab's worth of orders it grows by 2 MB slabs,
+// requested as explicit huge pages with a fallback to transparent huge pages.
+// Only reserve() and chunk growth touch the allocator or the OS.
+template <typename Node> class UltraSlabPool {
+public:
+  static_assert(sizeof(Node) >= sizeof(Node *), "free-list link lives in the node");
+  static constexpr size_t SLAB_BYTES = size_t(2) << 20; // One 2 MB page
+  static constexpr uint32_t SLAB_ORDERS = SLAB_BYTES / sizeof(Node); // 65536 UltraOrders
+  static constexpr uint32_t MIN_CHUNK_ORDERS = 64;
+
+  // Preallocates chunks for `capacity` orders; capacity beyond the first
+  // chunk is mapped as slabs, which stay non-resident until bumped into. A
+  // growable pool adds chunks on demand once those are used up; a fixed one
+  // returns nullptr.
+  explicit UltraSlabPool(uint32_t capacity = 1000000, bool growable = true)
+      : growable_(growable) {
+    chunks_.reserve(32);
+    reserve(capacity);
+    if (!chunks_.empty())
+      start_chunk(0);
+  }
+
+  ~UltraSlabPool() {
+    for (const Chunk &c : chunks_) {
+      if (c.kind == Chunk::Heap)
+        std::free(c.base);
+      else
+        munmap(c.base, SLAB_BYTES);
+    }
+  }
+
+  UltraSlabPool(const UltraSlabPool &) = delete;
+  UltraSlabPool &operator=(const UltraSlabPool &) = delete;
+
+  __attribute__((always_inline)) inline Node *ultra_fast_acquire() {
+    Node *order = free_head_;
+    if (__builtin_expect(order != nullptr, 1)) {
+      std::memcpy(&free_head_, order, sizeof(Node *));
+    } else {
+      if (__builtin_expect(bump_ == bump_end_, 0) && !next_chunk())
+        return nullptr;
+      order = bump_++;
+    }
+    ++live_;
+    return order;
+  }
+
+  __attribute__((always_inline)) inline void ultra_release(Node *order) {
+    std::memcpy(order, &free_head_, sizeof(Node *));
+    free_head_ = order;
+    --live_;
+  }
+
+  // Allocates chunks up front so the hot path never has to; false if the
+  // allocator or the OS refuses
+  bool reserve(uint32_t capacity) {
+    while (capacity_ < capacity) {
+      if (!add_chunk(capacity))
+        return false;
+    }
+    return true;
+  }
+
+  // Forgets every outstanding order; chunks stay allocated for reuse
+  inline void reset() {
+    free_head_ = nullptr;
+    live_ = 0;
+    if (!chunks_.empty())
+      start_chunk(0);
+  }
+
+  inline uint32_t live() const { return live_; }
+  inline uint32_t capacity() const { return capacity_; }
+  inline size_t slab_count() const {
+    return static_cast<size_t>(
+        std::count_if(chunks_.begin(), chunks_.end(), [](const Chunk &c) { return c.kind != Chunk::Heap; }));
+  }
+  inline size_t hugepage_slabs() const {
+    return static_cast<size_t>(
+        std::count_if(chunks_.begin(), chunks_.end(), [](const Chunk &c) { return c.kind == Chunk::Huge; }));
+  }
+
 private:
-  UltraOrder *pool_{nullptr};
+  struct Chunk {
+    enum Kind : uint8_t { Heap, Huge, Transparent };
+    Node *base;
+    uint32_t orders;
+    Kind kind;
+  };
+
+  Node *free_head_{nullptr};
+  Node *bump_{nullptr};
+  Node *bump_end_{nullptr};
+  size_t current_chunk_{0};
+  uint32_t live_{0};
   uint32_t capacity_{0};
-  std::atomic<uint32_t> stack_top_{0};
+  bool growable_;
+  std::vector<Chunk> chunks_;
 
-public:
-  explicit UltraFastOrderPool(uint32_t capacity = 1000000) : capacity_(capacity) {
-    // 64-byte aligned allocation for cache friendliness
-    pool_ = static_cast<UltraOrder *>(std::aligned_alloc(64, sizeof(UltraOrder) * capacity_));
-    if (!pool_) {
-      // Fallback to unaligned new if aligned_alloc is unavailable
-      pool_ = reinterpret_cast<UltraOrder *>(::operator new[](sizeof(UltraOrder) * capacity_));
-    }
+  inline void start_chunk(size_t i) {
+    current_chunk_ = i;
+    bump_ = chunks_[i].base;
+    bump_end_ = bump_ + chunks_[i].orders;
   }
 
-  ~UltraFastOrderPool() {
-    if (pool_) {
-#if defined(__GLIBC__)
-      std::free(pool_);
-#else
-      ::operator delete[](pool_);
-#endif
-      pool_ = nullptr;
+  // Cold path: move to the next allocated chunk (after a reset) or add one
+  __attribute__((noinline)) bool next_chunk() {
+    if (!chunks_.empty() && current_chunk_ + 1 < chunks_.size()) {
+      start_chunk(current_chunk_ + 1);
+      return true;
     }
+    if ((!growable_ && !chunks_.empty()) || !add_chunk(capacity_ + 1))
+      return false;
+    start_chunk(chunks_.size() - 1);
+    return true;
   }
 
-  __attribute__((always_inline)) inline UltraOrder *ultra_fast_acquire() {
-    uint32_t top = stack_top_.load(std::memory_order_relaxed);
-    if (top >= capacity_)
-      return nullptr;
-    UltraOrder *order = &pool_[top];
-    stack_top_.store(top + 1, std::memory_order_relaxed);
-    return order;
+  // The first chunk covers `want` (up to a slab); later ones double the pool
+  bool add_chunk(uint32_t want) {
+    uint32_t orders = chunks_.empty() ? want : capacity_;
+    orders = std::min(std::max(orders, MIN_CHUNK_ORDERS), SLAB_ORDERS);
+    if (capacity_ > 0xFFFFFFFFu - orders)
+      return false;
+    if (orders == SLAB_ORDERS && !chunks_.empty())
+      return map_slab();
+    const size_t bytes = (size_t(orders) * sizeof(Node) + 63) & ~size_t(63);
+    void *p = std::aligned_alloc(64, bytes);
+    if (!p)
+      return false;
+    chunks_.push_back(Chunk{static_cast<Node *>(p), orders, Chunk::Heap});
+    capacity_ += orders;
+    return true;
   }
 
-  inline void reset() { stack_top_.store(0, std::memory_order_relaxed); }
+  bool map_slab() {
+    typename Chunk::Kind kind = Chunk::Huge;
+    void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    p = mmap(nullptr, SLAB_BYTES, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (p == MAP_FAILED) {
+      kind = Chunk::Transparent;
+      p = mmap(nullptr, SLAB_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED)
+        return false;
+#ifdef MADV_HUGEPAGE
+      madvise(p, SLAB_BYTES, MADV_HUGEPAGE);
+#endif
+    }
+    chunks_.push_back(Chunk{static_cast<Node *>(p), SLAB_ORDERS, kind});
+    capacity_ += SLAB_ORDERS;
+    return true;
+  }
 };
 
+using UltraFastOrderPool = UltraSlabPool<UltraOrder>;
+
 // =============================================================================
-// BRANCHLESS HASH TABLE WITH PERFECT HASHING
+// GROWABLE SWISS-TABLE STYLE ORDER INDEX
 // =============================================================================
 
-class UltraHashTable {
-private:
-  static constexpr uint64_t TOMBSTONE = 0xFFFFFFFFFFFFFFFFULL;
-  struct Entry { uint64_t order_id; UltraOrder *order; };
-  Entry *entries_{nullptr};
-
-  __attribute__((always_inline)) inline uint32_t
-  ultra_hash(uint64_t order_id) const {
-    return static_cast<uint32_t>(order_id * 0x9e3779b97f4a7c15ULL >> 32) &
-           ULTRA_HASH_MASK;
+// Open addressing with one control byte per slot, probed 16 slots at a time
+// with SSE2 compares. Control encoding keeps EMPTY == 0 so fresh tables come
+// straight from calloc (lazily zeroed pages, no init pass):
+//   EMPTY = 0x00, DELETED = 0x01, FULL = 0x80 | h2 (7 hash bits)
+// Growth and tombstone compaction rehash incrementally: the previous table is
+// drained a few groups per mutation while lookups consult both tables.
+template <typename Node> class UltraHashIndex {
+public:
+  struct Stats {
+    uint32_t capacity{0};
+    uint32_t size{0};
+    uint32_t tombstones{0};
+    double load_factor{0.0};
+    uint64_t lookups{0};
+    uint64_t probe_groups{0};    // groups touched across all lookups
+    uint32_t max_probe_groups{0};
+    uint32_t rehashes{0};
+    bool migrating{false};
+  };
+
+  explicit UltraHashIndex(uint32_t expected_orders = ULTRA_HASH_SIZE) {
+    // Size so the expected live set stays under the max load factor
+    uint64_t want = uint64_t(expected_orders) * MAX_LOAD_DEN / MAX_LOAD_NUM + 1;
+    uint32_t cap = GROUP_WIDTH;
+    while (cap < want && cap < (1u << 31))
+      cap <<= 1;
+    table_alloc(cur_, cap);
   }
 
-public:
-  UltraHashTable() {
-    entries_ = static_cast<Entry *>(std::calloc(ULTRA_HASH_SIZE, sizeof(Entry)));
+  ~UltraHashIndex() {
+    table_free(cur_);
+    table_free(old_);
   }
-  ~UltraHashTable() { std::free(entries_); }
 
+  UltraHashIndex(const UltraHashIndex &) = delete;
+  UltraHashIndex &operator=(const UltraHashIndex &) = delete;
+
+  // Insert or update
   __attribute__((always_inline)) inline void ultra_insert(uint64_t order_id,
-                                                          UltraOrder *order) {
-    uint32_t h = ultra_hash(order_id);
-    int first_tomb = -1;
-    for (uint32_t i = 0; i < 64; ++i) { // probe up to 64 slots
-      uint32_t idx = (h + i) & ULTRA_HASH_MASK;
-      uint64_t k = entries_[idx].order_id;
-      if (k == 0) {
-        uint32_t target = (first_tomb >= 0) ? static_cast<uint32_t>(first_tomb) : idx;
-        entries_[target].order_id = order_id;
-        entries_[target].order = order;
-        return;
-      }
-      if (k == TOMBSTONE && first_tomb < 0) first_tomb = static_cast<int>(idx);
-      if (k == order_id) {
-        entries_[idx].order = order;
-        return;
-      }
+                                                          Node *order) {
+    if (__builtin_expect(old_.ctrl != nullptr, 0)) {
+      table_erase(old_, order_id);
+      migrate_step();
     }
-    uint32_t idx = (first_tomb >= 0) ? static_cast<uint32_t>(first_tomb) : (h & ULTRA_HASH_MASK);
-    entries_[idx].order_id = order_id;
-    entries_[idx].order = order;
+    const uint64_t h = hash(order_id);
+    if (Entry *e = table_find(cur_, order_id, h)) {
+      e->order = order;
+      return;
+    }
+    if (__builtin_expect(cur_.size + cur_.tombstones + 1 > max_used(cur_), 0)) {
+      start_rehash();
+    }
+    table_insert_new(cur_, order_id, order, h);
   }
 
-  __attribute__((always_inline)) inline UltraOrder *
+  __attribute__((always_inline)) inline Node *
   ultra_find(uint64_t order_id) const {
-    uint32_t h = ultra_hash(order_id);
-    for (uint32_t i = 0; i < 64; ++i) {
-      uint32_t idx = (h + i) & ULTRA_HASH_MASK;
-      uint64_t k = entries_[idx].order_id;
-      if (k == order_id) return entries_[idx].order;
-      if (k == 0) break; // empty slot -> not found
-      if (k == TOMBSTONE) continue; // tombstone - keep probing
+    const uint64_t h = hash(order_id);
+    if (const Entry *e = table_find(cur_, order_id, h))
+      return e->order;
+    if (__builtin_expect(old_.ctrl != nullptr, 0)) {
+      if (const Entry *e = table_find(old_, order_id, h))
+        return e->order;
     }
     return nullptr;
   }
 
   __attribute__((always_inline)) inline void ultra_remove(uint64_t order_id) {
-    uint32_t h = ultra_hash(order_id);
-    for (uint32_t i = 0; i < 64; ++i) {
-      uint32_t idx = (h + i) & ULTRA_HASH_MASK;
-      uint64_t k = entries_[idx].order_id;
-      if (k == order_id) {
-        entries_[idx].order_id = TOMBSTONE;
-        entries_[idx].order = nullptr;
+    if (!table_erase(cur_, order_id) && old_.ctrl != nullptr)
+      table_erase(old_, order_id);
+    if (__builtin_expect(old_.ctrl != nullptr, 0))
+      migrate_step();
+  }
+
+  // Pulls the first probe group of order_id toward L1 ahead of a lookup
+  __attribute__((always_inline)) inline void ultra_prefetch(uint64_t order_id) const {
+    const uint32_t pos = h1(hash(order_id)) & cur_.mask;
+    __builtin_prefetch(cur_.ctrl + pos, 0, 3);
+    __builtin_prefetch(cur_.slots + pos, 0, 3);
+  }
+
+  inline uint32_t size() const { return cur_.size + old_.size; }
+
+  // Drops every entry, keeping the current capacity
+  void clear() {
+    table_free(old_);
+    migrate_pos_ = 0;
+    std::memset(cur_.ctrl, CTRL_EMPTY, cur_.capacity + GROUP_WIDTH);
+    cur_.size = 0;
+    cur_.tombstones = 0;
+  }
+
+  Stats stats() const {
+    Stats st;
+    st.capacity = cur_.capacity;
+    st.size = size();
+    st.tombstones = cur_.tombstones + old_.tombstones;
+    st.load_factor = cur_.capacity ? double(cur_.size + cur_.tombstones) / cur_.capacity : 0.0;
+    st.lookups = lookups_;
+    st.probe_groups = probe_groups_;
+    st.max_probe_groups = max_probe_groups_;
+    st.rehashes = rehashes_;
+    st.migrating = old_.ctrl != nullptr;
+    return st;
+  }
+
+private:
+  static constexpr uint32_t GROUP_WIDTH = 16;
+  static constexpr uint8_t CTRL_EMPTY = 0x00;
+  static constexpr uint8_t CTRL_DELETED = 0x01;
+  static constexpr uint8_t CTRL_FULL = 0x80;
+  static constexpr uint32_t MAX_LOAD_NUM = 7; // max load factor 7/8
+  static constexpr uint32_t MAX_LOAD_DEN = 8;
+  static constexpr uint32_t MIGRATE_SLOTS = 64; // old slots drained per mutation
+
+  struct Entry { uint64_t order_id; Node *order; };
+
+  struct Table {
+    uint8_t *ctrl{nullptr}; // capacity + GROUP_WIDTH bytes (tail mirrors head)
+    Entry *slots{nullptr};
+    uint32_t capacity{0};
+    uint32_t mask{0};
+    uint32_t size{0};
+    uint32_t tombstones{0};
+  };
+
+  Table cur_;
+  Table old_;
+  uint32_t migrate_pos_{0};
+
+  mutable uint64_t lookups_{0};
+  mutable uint64_t probe_groups_{0};
+  mutable uint32_t max_probe_groups_{0};
+  uint32_t rehashes_{0};
+
+  __attribute__((always_inline)) static inline uint64_t hash(uint64_t order_id) {
+    return order_id * 0x9e3779b97f4a7c15ULL;
+  }
+  // Upper product bits are the well-mixed ones: h2 from the top 7, position
+  // from the 32 below (no overlap for tables up to 2^25 slots)
+  __attribute__((always_inline)) static inline uint8_t h2(uint64_t h) {
+    return static_cast<uint8_t>(CTRL_FULL | (h >> 57));
+  }
+  __attribute__((always_inline)) static inline uint32_t h1(uint64_t h) {
+    return static_cast<uint32_t>(h >> 32);
+  }
+
+  static inline uint32_t max_used(const Table &t) {
+    return static_cast<uint32_t>(uint64_t(t.capacity) * MAX_LOAD_NUM / MAX_LOAD_DEN);
+  }
+
+  static void table_alloc(Table &t, uint32_t capacity) {
+    t.capacity = capacity;
+    t.mask = capacity - 1;
+    t.size = 0;
+    t.tombstones = 0;
+    t.ctrl = static_cast<uint8_t *>(std::calloc(capacity + GROUP_WIDTH, 1));
+    t.slots = static_cast<Entry *>(std::malloc(sizeof(Entry) * capacity));
+  }
+
+  static void table_free(Table &t) {
+    std::free(t.ctrl);
+    std::free(t.slots);
+    t = Table{};
+  }
+
+  __attribute__((always_inline)) static inline void set_ctrl(Table &t, uint32_t idx,
+                                                             uint8_t v) {
+    t.ctrl[idx] = v;
+    if (idx < GROUP_WIDTH)
+      t.ctrl[t.capacity + idx] = v; // mirrored tail for wrap-free group loads
+  }
+
+  __attribute__((always_inline)) static inline __m128i load_group(const Table &t,
+                                                                  uint32_t pos) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(t.ctrl + pos));
+  }
+
+  __attribute__((always_inline)) static inline uint32_t match_byte(__m128i g,
+                                                                   uint8_t v) {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(static_cast<char>(v)))));
+  }
+
+  __attribute__((always_inline)) inline Entry *table_find(const Table &t, uint64_t order_id,
+                                                          uint64_t h) const {
+    const uint8_t tag = h2(h);
+    uint32_t pos = h1(h) & t.mask;
+    uint32_t stride = 0;
+    uint32_t groups = 1;
+    for (;; ++groups) {
+      const __m128i g = load_group(t, pos);
+      for (uint32_t m = match_byte(g, tag); m; m &= m - 1) {
+        const uint32_t idx = (pos + __builtin_ctz(m)) & t.mask;
+        if (t.slots[idx].order_id == order_id) {
+          note_probe(groups);
+          return &t.slots[idx];
+        }
+      }
+      if (match_byte(g, CTRL_EMPTY)) {
+        note_probe(groups);
+        return nullptr;
+      }
+      stride += GROUP_WIDTH;
+      pos = (pos + stride) & t.mask;
+    }
+  }
+
+  __attribute__((always_inline)) inline void note_probe(uint32_t groups) const {
+    ++lookups_;
+    probe_groups_ += groups;
+    if (__builtin_expect(groups > max_probe_groups_, 0))
+      max_probe_groups_ = groups;
+  }
+
+  // Key must not be present in t
+  __attribute__((always_inline)) static inline void
+  table_insert_new(Table &t, uint64_t order_id, Node *order, uint64_t h) {
+    uint32_t pos = h1(h) & t.mask;
+    uint32_t stride = 0;
+    for (;;) {
+      const __m128i g = load_group(t, pos);
+      // Free slots (EMPTY or DELETED) have the sign bit clear
+      const uint32_t free_mask = ~static_cast<uint32_t>(_mm_movemask_epi8(g)) & 0xFFFFu;
+      if (free_mask) {
+        const uint32_t idx = (pos + __builtin_ctz(free_mask)) & t.mask;
+        if (t.ctrl[idx] == CTRL_DELETED)
+          --t.tombstones;
+        set_ctrl(t, idx, h2(h));
+        t.slots[idx] = Entry{order_id, order};
+        ++t.size;
         return;
       }
-      if (k == 0) break;
+      stride += GROUP_WIDTH;
+      pos = (pos + stride) & t.mask;
+    }
+  }
+
+  inline bool table_erase(Table &t, uint64_t order_id) {
+    Entry *e = table_find(t, order_id, hash(order_id));
+    if (!e)
+      return false;
+    const uint32_t idx = static_cast<uint32_t>(e - t.slots);
+    // If every 16-wide window through idx still contains an EMPTY, no probe
+    // ever walked past this slot and it can go straight back to EMPTY.
+    const uint32_t empty_after = match_byte(load_group(t, idx), CTRL_EMPTY);
+    const uint32_t empty_before =
+        match_byte(load_group(t, (idx - GROUP_WIDTH) & t.mask), CTRL_EMPTY);
+    const bool reclaim = empty_after && empty_before &&
+                         (uint32_t(__builtin_ctz(empty_after)) +
+                          (uint32_t(__builtin_clz(empty_before)) - 16)) < GROUP_WIDTH;
+    if (reclaim) {
+      set_ctrl(t, idx, CTRL_EMPTY);
+    } else {
+      set_ctrl(t, idx, CTRL_DELETED);
+      ++t.tombstones;
+    }
+    --t.size;
+    return true;
+  }
+
+  // Doubles when genuinely full, otherwise rebuilds at the same size to drop
+  // tombstones. The old table is drained incrementally by migrate_step().
+  void start_rehash() {
+    if (old_.ctrl != nullptr)
+      finish_migration(); // should not happen with MIGRATE_SLOTS sizing
+    const bool grow = cur_.size >= max_used(cur_) / 2;
+    const uint32_t new_cap = grow ? cur_.capacity * 2 : cur_.capacity;
+    old_ = cur_;
+    table_alloc(cur_, new_cap);
+    migrate_pos_ = 0;
+    ++rehashes_;
+    migrate_step();
+  }
+
+  inline void migrate_step() {
+    const uint32_t end = (migrate_pos_ + MIGRATE_SLOTS < old_.capacity)
+                             ? migrate_pos_ + MIGRATE_SLOTS
+                             : old_.capacity;
+    for (uint32_t i = migrate_pos_; i < end; ++i) {
+      if (old_.ctrl[i] & CTRL_FULL) {
+        const Entry &e = old_.slots[i];
+        table_insert_new(cur_, e.order_id, e.order, hash(e.order_id));
+        // Tombstone rather than EMPTY: keeps probe chains of undrained keys
+        set_ctrl(old_, i, CTRL_DELETED);
+        --old_.size;
+      }
     }
+    migrate_pos_ = end;
+    if (migrate_pos_ >= old_.capacity)
+      table_free(old_);
+  }
+
+  void finish_migration() {
+    while (old_.ctrl != nullptr)
+      migrate_step();
   }
 };
 
+using UltraHashTable = UltraHashIndex<UltraOrder>;
+
+// =============================================================================
+// HIERARCHICAL PRICE LEVEL OCCUPANCY BITMAP
+// =============================================================================
+
+// Two-level bitset over level indices: one bit per level plus one summary bit
+// per 64-level word. Best/next-level searches touch at most a couple of words
+// and resolve with lzcnt/tzcnt (__builtin_clzll/ctzll under -march=native).
+template <uint32_t N> class LevelBitmap {
+public:
+  static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+  LevelBitmap() { clear(); }
+
+  inline void clear() {
+    memset(words_, 0, sizeof(words_));
+    memset(summary_, 0, sizeof(summary_));
+  }
+
+  __attribute__((always_inline)) inline bool test(uint32_t i) const {
+    return (words_[i >> 6] >> (i & 63)) & 1;
+  }
+
+  __attribute__((always_inline)) inline void set(uint32_t i) {
+    const uint32_t w = i >> 6;
+    words_[w] |= 1ULL << (i & 63);
+    summary_[w >> 6] |= 1ULL << (w & 63);
+  }
+
+  __attribute__((always_inline)) inline void reset(uint32_t i) {
+    const uint32_t w = i >> 6;
+    words_[w] &= ~(1ULL << (i & 63));
+    if (words_[w] == 0)
+      summary_[w >> 6] &= ~(1ULL << (w & 63));
+  }
+
+  // Highest set index <= i, or NONE
+  __attribute__((always_inline)) inline uint32_t find_prev(uint32_t i) const {
+    if (i >= N)
+      i = N - 1;
+    uint32_t w = i >> 6;
+    uint64_t m = words_[w] & (~0ULL >> (63 - (i & 63)));
+    if (m)
+      return (w << 6) + 63 - __builtin_clzll(m);
+    if (w == 0)
+      return NONE;
+    --w;
+    uint32_t s = w >> 6;
+    uint64_t sm = summary_[s] & (~0ULL >> (63 - (w & 63)));
+    for (;;) {
+      if (sm) {
+        const uint32_t word = (s << 6) + 63 - __builtin_clzll(sm);
+        return (word << 6) + 63 - __builtin_clzll(words_[word]);
+      }
+      if (s == 0)
+        return NONE;
+      sm = summary_[--s];
+    }
+  }
+
+  // Lowest set index >= i, or NONE
+  __attribute__((always_inline)) inline uint32_t find_next(uint32_t i) const {
+    if (i >= N)
+      return NONE;
+    uint32_t w = i >> 6;
+    uint64_t m = words_[w] & (~0ULL << (i & 63));
+    if (m)
+      return (w << 6) + __builtin_ctzll(m);
+    if (++w >= WORDS)
+      return NONE;
+    uint32_t s = w >> 6;
+    uint64_t sm = summary_[s] & (~0ULL << (w & 63));
+    for (;;) {
+      if (sm) {
+        const uint32_t word = (s << 6) + __builtin_ctzll(sm);
+        return (word << 6) + __builtin_ctzll(words_[word]);
+      }
+      if (++s >= SUMMARY_WORDS)
+        return NONE;
+      sm = summary_[s];
+    }
+  }
+
+  inline uint32_t highest() const { return find_prev(N - 1); }
+  inline uint32_t lowest() const { return find_next(0); }
+
+private:
+  static constexpr uint32_t WORDS = (N + 63) / 64;
+  static constexpr uint32_t SUMMARY_WORDS = (WORDS + 63) / 64;
+
+  uint64_t words_[WORDS];
+  uint64_t summary_[SUMMARY_WORDS];
+};
+
+// =============================================================================
+// LAZILY ZEROED DENSE LEVEL ARRAY
+// =============================================================================
+
+// N price levels on their own anonymous mapping. The kernel supplies zeroed
+// pages on first touch, so a book is only resident for the part of its
+// window that has held orders; a full feed's thousands of thin books no
+// longer each memset a whole window up front. Empty levels are all-zero.
+template <typename Level, uint32_t N> class LevelArray {
+public:
+  static constexpr size_t BYTES = sizeof(Level) * N;
+
+  LevelArray() {
+    void *p = mmap(nullptr, BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+      throw std::bad_alloc();
+    levels_ = static_cast<Level *>(p);
+  }
+
+  ~LevelArray() { munmap(levels_, BYTES); }
+
+  LevelArray(const LevelArray &) = delete;
+  LevelArray &operator=(const LevelArray &) = delete;
+
+  __attribute__((always_inline)) inline Level &operator[](uint32_t i) { return levels_[i]; }
+  __attribute__((always_inline)) inline const Level &operator[](uint32_t i) const {
+    return levels_[i];
+  }
+  inline const Level *data() const { return levels_; }
+
+private:
+  Level *levels_;
+};
+
 // =============================================================================
 // ULTRA-OPTIMIZED ORDER BOOK - Target: 100-200ns
 // =============================================================================
 
+// Per-symbol book parameters (see matching::SymbolInfo). Prices outside
+// [min_price, max_price] are rejected; the dense window is aligned to tick_size.
+struct UltraBookConfig {
+  uint32_t tick_size{ULTRA_TICK_SIZE};
+  uint32_t min_price{1};
+  uint32_t max_price{0xFFFFFFFEu};
+  uint32_t expected_orders{ULTRA_HASH_SIZE}; // initial order index sizing
+  // false: the book neither allocates nor indexes orders; the owner rests
+  // its own nodes with ultra_addNode() and keeps the order id index itself
+  bool owns_orders{true};
+  // Record which levels change, for ultra_drainChanges()
+  bool track_changes{false};
+};
+
+// Price ladder: a dense window of ULTRA_PRICE_LEVELS ticks, centred on the
+// first print and re-centred whenever the touch leaves it. Levels outside the
+// window live in a sparse std::map per side, so memory per book stays bounded
+// while the hot path remains a plain array index.
 class UltraOrderBook {
 private:
-  alignas(64) UltraPriceLevel bid_levels_[ULTRA_PRICE_LEVELS];
-  alignas(64) UltraPriceLevel ask_levels_[ULTRA_PRICE_LEVELS];
+  LevelArray<UltraPriceLevel, ULTRA_PRICE_LEVELS> bid_levels_;
+  LevelArray<UltraPriceLevel, ULTRA_PRICE_LEVELS> ask_levels_;
   UltraHashTable order_hash_;
   UltraFastOrderPool order_pool_;
 
-  // Optimized price to index conversion (simplified for now)
+  // Non-empty level bitmaps and cached top-of-book indices
+  using Bitmap = LevelBitmap<ULTRA_PRICE_LEVELS>;
+  Bitmap bid_bits_;
+  Bitmap ask_bits_;
+  uint32_t best_bid_idx_{Bitmap::NONE};
+  uint32_t best_ask_idx_{Bitmap::NONE};
+
+  // Dense window placement; UINT32_MAX means "not placed yet"
+  UltraBookConfig config_;
+  uint32_t window_base_{0xFFFFFFFFu};
+  uint64_t window_recenters_{0};
+
+  // Far-away levels, never overlapping the dense window
+  std::map<uint32_t, UltraPriceLevel> bid_overflow_;
+  std::map<uint32_t, UltraPriceLevel> ask_overflow_;
+
+  // Levels changed since the last drain (track_changes only): a bit per
+  // dense index, and prices for overflow levels and for dense levels that
+  // a re-centre moved
+  Bitmap bid_changed_;
+  Bitmap ask_changed_;
+  std::vector<uint32_t> bid_changed_far_;
+  std::vector<uint32_t> ask_changed_far_;
+  bool changes_pending_{false};
+
+  __attribute__((always_inline)) inline uint32_t
+  ultra_index_to_price(uint32_t index) const {
+    return window_base_ + index * config_.tick_size;
+  }
+
+  // Dense index for a price, or Bitmap::NONE when it falls outside the window
   __attribute__((always_inline)) inline uint32_t
   ultra_price_to_index(uint32_t price) const {
-    if (price < ULTRA_MIN_PRICE || price > ULTRA_MAX_PRICE) {
-      return 0;
+    if (price < window_base_)
+      return Bitmap::NONE;
+    const uint32_t offset = price - window_base_;
+    const uint32_t index =
+        (config_.tick_size == 1) ? offset : offset / config_.tick_size;
+    return (index < ULTRA_PRICE_LEVELS) ? index : Bitmap::NONE;
+  }
+
+  inline uint32_t ultra_window_top() const {
+    const uint64_t top =
+        uint64_t(window_base_) + uint64_t(ULTRA_PRICE_LEVELS - 1) * config_.tick_size;
+    return top > 0xFFFFFFFFull ? 0xFFFFFFFFu : static_cast<uint32_t>(top);
+  }
+
+  // Level holding `price`: dense slot when inside the window, overflow otherwise
+  __attribute__((always_inline)) inline UltraPriceLevel &
+  ultra_level_for(bool is_buy, uint32_t price, uint32_t &index) {
+    index = ultra_price_to_index(price);
+    if (__builtin_expect(index != Bitmap::NONE, 1))
+      return (is_buy ? bid_levels_ : ask_levels_)[index];
+    return (is_buy ? bid_overflow_ : ask_overflow_)[price];
+  }
+
+  // Called after every add, fill and removal at a level: notes the change
+  // for the next drain, then syncs bitmaps and top-of-book
+  __attribute__((always_inline)) inline void
+  ultra_level_changed(bool is_buy, uint32_t index, uint32_t price) {
+    if (__builtin_expect(config_.track_changes, 0)) {
+      if (__builtin_expect(index != Bitmap::NONE, 1))
+        (is_buy ? bid_changed_ : ask_changed_).set(index);
+      else
+        (is_buy ? bid_changed_far_ : ask_changed_far_).push_back(price);
+      changes_pending_ = true;
     }
-    return price - ULTRA_MIN_PRICE;
+    ultra_sync_level(is_buy, index, price);
   }
 
-  // Ultra-fast level addition with minimal branching
+  // Keeps bitmaps and cached best indices in sync with a level's contents.
+  // Overflow levels (index == NONE) are dropped from the map once empty.
+  __attribute__((always_inline)) inline void
+  ultra_sync_level(bool is_buy, uint32_t index, uint32_t price) {
+    if (__builtin_expect(index == Bitmap::NONE, 0)) {
+      auto &overflow = is_buy ? bid_overflow_ : ask_overflow_;
+      auto it = overflow.find(price);
+      if (it != overflow.end() && it->second.total_quantity == 0)
+        overflow.erase(it);
+      return;
+    }
+    const bool occupied = (is_buy ? bid_levels_ : ask_levels_)[index].total_quantity > 0;
+    if (is_buy) {
+      if (occupied) {
+        bid_bits_.set(index);
+        if (best_bid_idx_ == Bitmap::NONE || index > best_bid_idx_)
+          best_bid_idx_ = index;
+      } else {
+        bid_bits_.reset(index);
+        if (index == best_bid_idx_)
+          best_bid_idx_ = bid_bits_.find_prev(index);
+      }
+    } else {
+      if (occupied) {
+        ask_bits_.set(index);
+        if (index < best_ask_idx_)
+          best_ask_idx_ = index;
+      } else {
+        ask_bits_.reset(index);
+        if (index == best_ask_idx_)
+          best_ask_idx_ = ask_bits_.find_next(index);
+      }
+    }
+  }
+
+  // Window base that centres `center`, clamped to the symbol's price band
+  inline uint32_t ultra_window_base_for(uint32_t center) const {
+    const uint64_t tick = config_.tick_size;
+    const uint64_t span = uint64_t(ULTRA_PRICE_LEVELS - 1) * tick;
+    uint64_t lo = (center > span / 2) ? center - span / 2 : 0;
+    if (lo + span > config_.max_price)
+      lo = (config_.max_price > span) ? config_.max_price - span : 0;
+    lo = (lo / tick) * tick;
+    if (lo < config_.min_price)
+      lo = ((config_.min_price + tick - 1) / tick) * tick;
+    return static_cast<uint32_t>(lo);
+  }
+
+  inline void ultra_place_level(bool is_buy, uint32_t price,
+                                const UltraPriceLevel &level) {
+    const uint32_t index = ultra_price_to_index(price);
+    if (index == Bitmap::NONE) {
+      (is_buy ? bid_overflow_ : ask_overflow_)[price] = level;
+      return;
+    }
+    (is_buy ? bid_levels_ : ask_levels_)[index] = level;
+    ultra_sync_level(is_buy, index, price);
+  }
+
+  // Slides the dense window so that `center` sits in its middle. Dense levels
+  // that fall out spill into the overflow maps and overflow levels that fall in
+  // move to the array. O(non-empty levels); only runs when the touch moves out.
+  void ultra_recenter(uint32_t center) {
+    const uint32_t new_base = ultra_window_base_for(center);
+    if (new_base == window_base_)
+      return;
+    ++window_recenters_;
+
+    // Pending dense changes are about to change index; keep them by price
+    for (uint32_t i = bid_changed_.lowest(); i != Bitmap::NONE; i = bid_changed_.find_next(i + 1))
+      bid_changed_far_.push_back(ultra_index_to_price(i));
+    for (uint32_t i = ask_changed_.lowest(); i != Bitmap::NONE; i = ask_changed_.find_next(i + 1))
+      ask_changed_far_.push_back(ultra_index_to_price(i));
+    bid_changed_.clear();
+    ask_changed_.clear();
+
+    std::vector<std::pair<uint32_t, UltraPriceLevel>> bids, asks;
+    for (uint32_t i = bid_bits_.lowest(); i != Bitmap::NONE; i = bid_bits_.find_next(i + 1)) {
+      bids.emplace_back(ultra_index_to_price(i), bid_levels_[i]);
+      bid_levels_[i] = UltraPriceLevel{};
+    }
+    for (uint32_t i = ask_bits_.lowest(); i != Bitmap::NONE; i = ask_bits_.find_next(i + 1)) {
+      asks.emplace_back(ultra_index_to_price(i), ask_levels_[i]);
+      ask_levels_[i] = UltraPriceLevel{};
+    }
+    bid_bits_.clear();
+    ask_bits_.clear();
+    best_bid_idx_ = Bitmap::NONE;
+    best_ask_idx_ = Bitmap::NONE;
+    window_base_ = new_base;
+
+    for (const auto &[price, level] : bids)
+      ultra_place_level(true, price, level);
+    for (const auto &[price, level] : asks)
+      ultra_place_level(false, price, level);
+
+    const uint32_t top = ultra_window_top();
+    for (auto *overflow : {&bid_overflow_, &ask_overflow_}) {
+      const bool is_buy = (overflow == &bid_overflow_);
+      auto it = overflow->lower_bound(window_base_);
+      while (it != overflow->end() && it->first <= top) {
+        ultra_place_level(is_buy, it->first, it->second);
+        it = overflow->erase(it);
+      }
+    }
+  }
+
+  // Called after a level was created outside the window: re-centre on the
+  // mid (or the single-sided touch) if either touch is no longer dense.
+  inline void ultra_maybe_recenter() {
+    const uint32_t bid = ultra_getBestBid();
+    const uint32_t ask = ultra_getBestAsk();
+    const bool bid_out = bid && ultra_price_to_index(bid) == Bitmap::NONE;
+    const bool ask_out = ask && ultra_price_to_index(ask) == Bitmap::NONE;
+    if (!bid_out && !ask_out)
+      return;
+    const uint32_t center =
+        (bid && ask) ? static_cast<uint32_t>((uint64_t(bid) + ask) / 2) : (bid ? bid : ask);
+    ultra_recenter(center);
+  }
+
+  // Appends to the back of the level queue (time priority)
   __attribute__((always_inline)) inline void
   ultra_add_to_level(UltraOrder *order, UltraPriceLevel &level) {
     level.total_quantity += order->quantity;
     level.order_count++;
 
-    // Simple stack-based insertion (LIFO)
-    order->next = level.first_order;
-    level.first_order = order;
+    order->next = nullptr;
+    order->prev = level.last_order;
+    if (level.last_order)
+      level.last_order->next = order;
+    else
+      level.first_order = order;
+    level.last_order = order;
+  }
+
+  // Unlinks a resting order, which must be removed from the index before the
+  // slot is handed back to the pool
+  __attribute__((always_inline)) inline void
+  ultra_remove_from_level(UltraOrder *order, UltraPriceLevel &level) {
+    level.total_quantity -= order->quantity;
+    level.order_count--;
+    if (order->prev)
+      order->prev->next = order->next;
+    else
+      level.first_order = order->next;
+    if (order->next)
+      order->next->prev = order->prev;
+    else
+      level.last_order = order->prev;
+  }
+
+  // Read-only level lookup; never creates overflow entries
+  inline const UltraPriceLevel *ultra_find_level(bool is_buy, uint32_t price) const {
+    const uint32_t index = ultra_price_to_index(price);
+    if (__builtin_expect(index != Bitmap::NONE, 1)) {
+      const UltraPriceLevel &level = (is_buy ? bid_levels_ : ask_levels_)[index];
+      return level.first_order ? &level : nullptr;
+    }
+    const auto &overflow = is_buy ? bid_overflow_ : ask_overflow_;
+    auto it = overflow.find(price);
+    return it != overflow.end() ? &it->second : nullptr;
   }
 
   // Prefetch next likely cache lines
   __attribute__((always_inline)) inline void
   ultra_prefetch(uint32_t price) const {
     uint32_t index = ultra_price_to_index(price);
+    if (index == Bitmap::NONE)
+      return;
     __builtin_prefetch(&bid_levels_[index], 1, 3);
     __builtin_prefetch(&ask_levels_[index], 1, 3);
   }
 
+  template <typename Fn>
+  inline void ultra_walk_dense_bids(uint32_t &depth, Fn &fn) const {
+    for (uint32_t i = best_bid_idx_; i != Bitmap::NONE && depth > 0; --depth) {
+      const UltraPriceLevel &level = bid_levels_[i];
+      fn(ultra_index_to_price(i), level.total_quantity, level.order_count);
+      i = (i == 0) ? Bitmap::NONE : bid_bits_.find_prev(i - 1);
+    }
+  }
+
+  template <typename Fn>
+  inline void ultra_walk_dense_asks(uint32_t &depth, Fn &fn) const {
+    for (uint32_t i = best_ask_idx_; i != Bitmap::NONE && depth > 0; --depth) {
+      const UltraPriceLevel &level = ask_levels_[i];
+      fn(ultra_index_to_price(i), level.total_quantity, level.order_count);
+      i = ask_bits_.find_next(i + 1);
+    }
+  }
+
+  inline void ultra_clear_changes() {
+    bid_changed_.clear();
+    ask_changed_.clear();
+    bid_changed_far_.clear();
+    ask_changed_far_.clear();
+    changes_pending_ = false;
+  }
+
+  // One side of ultra_drainChanges(): by-price entries first (skipping any
+  // that also carry a dense bit), then dense bits from the touch outwards
+  template <typename Fn>
+  inline uint32_t ultra_drain_side(bool is_buy, Fn &fn) {
+    Bitmap &changed = is_buy ? bid_changed_ : ask_changed_;
+    std::vector<uint32_t> &far = is_buy ? bid_changed_far_ : ask_changed_far_;
+    uint32_t emitted = 0;
+    if (__builtin_expect(!far.empty(), 0)) {
+      std::sort(far.begin(), far.end());
+      far.erase(std::unique(far.begin(), far.end()), far.end());
+      for (uint32_t price : far) {
+        const uint32_t index = ultra_price_to_index(price);
+        if (index != Bitmap::NONE && changed.test(index))
+          continue;
+        const UltraPriceLevel *level = ultra_find_level(is_buy, price);
+        fn(is_buy, price, level ? level->total_quantity : 0u, level ? level->order_count : 0u);
+        ++emitted;
+      }
+      far.clear();
+    }
+    const UltraPriceLevel *levels = (is_buy ? bid_levels_ : ask_levels_).data();
+    uint32_t i = is_buy ? changed.highest() : changed.lowest();
+    while (i != Bitmap::NONE) {
+      changed.reset(i);
+      fn(is_buy, ultra_index_to_price(i), levels[i].total_quantity, levels[i].order_count);
+      ++emitted;
+      i = is_buy ? (i == 0 ? Bitmap::NONE : changed.find_prev(i - 1)) : changed.find_next(i + 1);
+    }
+    return emitted;
+  }
+
 public:
+  explicit UltraOrderBook(const UltraBookConfig &config = UltraBookConfig{})
+      : order_hash_(config.owns_orders ? config.expected_orders : 0),
+        order_pool_(config.owns_orders ? config.expected_orders : 0), config_(config) {
+    if (config_.tick_size == 0)
+      config_.tick_size = 1;
+  }
+
   // Main optimized addOrder function
   __attribute__((always_inline)) inline void ultra_addOrder(uint64_t orderId,
                                                             char side,
                                                             uint32_t quantity,
                                                             uint32_t price) {
+    // Reject prices outside the symbol's band; empty orders never rest
+    if (__builtin_expect(price < config_.min_price || price > config_.max_price || quantity == 0, 0))
+      return;
+
     // Early prefetch
     ultra_prefetch(price);
 
@@ -369,16 +1156,17 @@ public:
     order->set_id_side(orderId, side);
     order->quantity = quantity;
     order->price = price;
-    order->next = nullptr;
-
-    // Branchless level selection
-    uint32_t index = ultra_price_to_index(price);
-    bool is_buy = (side == 'B');
-    UltraPriceLevel *levels = is_buy ? bid_levels_ : ask_levels_;
 
     // Add to level and hash
-    ultra_add_to_level(order, levels[index]);
+    bool is_buy = (side == 'B');
+    uint32_t index;
+    UltraPriceLevel &level = ultra_level_for(is_buy, price, index);
+    ultra_add_to_level(order, level);
+    ultra_level_changed(is_buy, index, price);
     order_hash_.ultra_insert(orderId, order);
+
+    if (__builtin_expect(index == Bitmap::NONE, 0))
+      ultra_maybe_recenter();
   }
 
   // Simplified execute - remove complexity
@@ -388,18 +1176,21 @@ public:
     if (!order)
       return;
 
-    uint32_t index = ultra_price_to_index(order->price);
     bool is_buy = (order->get_side() == 'B');
-    UltraPriceLevel *levels = is_buy ? bid_levels_ : ask_levels_;
-
-    uint32_t qty_to_remove = (executed_qty < order->quantity) ? executed_qty : order->quantity;
-    levels[index].total_quantity -= qty_to_remove;
-    order->quantity -= qty_to_remove;
-
-    // Simple deletion - no complex list manipulation
-    if (order->quantity == 0) {
-      levels[index].order_count--;
+    uint32_t index;
+    UltraPriceLevel &level = ultra_level_for(is_buy, order->price, index);
+
+    const uint32_t price = order->price;
+    if (executed_qty < order->quantity) {
+      level.total_quantity -= executed_qty;
+      order->quantity -= executed_qty;
+    } else {
+      // Fully filled: unlink and recycle
+      ultra_remove_from_level(order, level);
+      order_hash_.ultra_remove(orderId);
+      order_pool_.ultra_release(order);
     }
+    ultra_level_changed(is_buy, index, price);
   }
 
   // Minimal delete operation
@@ -409,16 +1200,44 @@ public:
     if (!order)
       return;
 
-    uint32_t index = ultra_price_to_index(order->price);
     bool is_buy = (order->get_side() == 'B');
-    UltraPriceLevel *levels = is_buy ? bid_levels_ : ask_levels_;
+    uint32_t index;
+    UltraPriceLevel &level = ultra_level_for(is_buy, order->price, index);
 
-    levels[index].total_quantity -= order->quantity;
-    levels[index].order_count--;
-    // Mark as deleted
-    order->quantity = 0;
-    // Remove from hash
+    const uint32_t price = order->price;
+    ultra_remove_from_level(order, level);
     order_hash_.ultra_remove(orderId);
+    order_pool_.ultra_release(order);
+    ultra_level_changed(is_buy, index, price);
+  }
+
+  // Caller-owned nodes, for books with owns_orders == false. The node's
+  // id, side, quantity and price are set by the caller, and it must stay
+  // put until it is removed or the sweep reports it fully filled. Returns
+  // false (node not rested) for prices outside the band or zero quantity.
+  __attribute__((always_inline)) inline bool ultra_addNode(UltraOrder *order) {
+    const uint32_t price = order->price;
+    if (__builtin_expect(price < config_.min_price || price > config_.max_price || order->quantity == 0, 0))
+      return false;
+
+    const bool is_buy = (order->get_side() == 'B');
+    uint32_t index;
+    UltraPriceLevel &level = ultra_level_for(is_buy, price, index);
+    ultra_add_to_level(order, level);
+    ultra_level_changed(is_buy, index, price);
+
+    if (__builtin_expect(index == Bitmap::NONE, 0))
+      ultra_maybe_recenter();
+    return true;
+  }
+
+  __attribute__((always_inline)) inline void ultra_removeNode(UltraOrder *order) {
+    const bool is_buy = (order->get_side() == 'B');
+    const uint32_t price = order->price;
+    uint32_t index;
+    UltraPriceLevel &level = ultra_level_for(is_buy, price, index);
+    ultra_remove_from_level(order, level);
+    ultra_level_changed(is_buy, index, price);
   }
 
   // Replace operation (delete + add)
@@ -429,111 +1248,381 @@ public:
     char side = oldOrder->get_side();
 
     // Adjust level and remove old mapping
-    uint32_t idx = ultra_price_to_index(oldOrder->price);
-    UltraPriceLevel *levels = (side == 'B') ? bid_levels_ : ask_levels_;
-    levels[idx].total_quantity -= oldOrder->quantity;
-    levels[idx].order_count--;
-    oldOrder->quantity = 0;
+    uint32_t idx;
+    const uint32_t oldPrice = oldOrder->price;
+    UltraPriceLevel &level = ultra_level_for(side == 'B', oldPrice, idx);
+    ultra_remove_from_level(oldOrder, level);
     order_hash_.ultra_remove(oldId);
+    order_pool_.ultra_release(oldOrder);
+    ultra_level_changed(side == 'B', idx, oldPrice);
 
     // Insert new order
     ultra_addOrder(newId, side, newQty, newPrice);
   }
 
-  // Simplified best price finding (safe version for MVP)
-  __attribute__((always_inline)) inline uint32_t ultra_getBestBid() const {
-    // Find highest bid price (iterate from high to low)
-    for (int i = ULTRA_PRICE_LEVELS - 1; i >= 0; --i) {
-      if (bid_levels_[i].total_quantity > 0) {
-        return ULTRA_MIN_PRICE + i;
+  // Matches an aggressor of up to `quantity` against the opposite side in
+  // price-time priority. Buy aggressors take asks priced <= limit_price, sell
+  // aggressors take bids >= limit_price (UINT32_MAX / 0 for market orders).
+  // Passive orders are filled in place at the front of each level; fully
+  // filled ones are recycled, and level totals and top-of-book are updated
+  // once per level. on_fill(passive, price, qty) must not touch this book;
+  // passive has already left the queue when qty is its whole quantity, and
+  // a caller-owned node may be reused from then on.
+  // Returns the quantity filled.
+  template <typename Fn>
+  inline uint32_t ultra_sweep(bool aggressor_is_buy, uint32_t limit_price, uint32_t quantity,
+                              Fn &&on_fill) {
+    const bool passive_is_buy = !aggressor_is_buy;
+    uint32_t remaining = quantity;
+    while (remaining > 0) {
+      const uint32_t price = aggressor_is_buy ? ultra_getBestAsk() : ultra_getBestBid();
+      if (price == 0 || (aggressor_is_buy ? price > limit_price : price < limit_price))
+        break;
+
+      uint32_t index;
+      UltraPriceLevel &level = ultra_level_for(passive_is_buy, price, index);
+      uint32_t level_filled = 0;
+      UltraOrder *o = level.first_order;
+      while (o && remaining > 0) {
+        const uint32_t qty = (o->quantity < remaining) ? o->quantity : remaining;
+        const uint64_t passive_id = o->get_id();
+        remaining -= qty;
+        level_filled += qty;
+        UltraOrder *next = o->next;
+        if (qty == o->quantity) {
+          // Front of the queue is consumed: pop it
+          level.first_order = next;
+          if (next)
+            next->prev = nullptr;
+          else
+            level.last_order = nullptr;
+          level.order_count--;
+          on_fill(*o, price, qty);
+          if (config_.owns_orders) {
+            order_hash_.ultra_remove(passive_id);
+            order_pool_.ultra_release(o);
+          }
+        } else {
+          o->quantity -= qty;
+          on_fill(*o, price, qty);
+        }
+        o = next;
       }
+      level.total_quantity -= level_filled;
+      ultra_level_changed(passive_is_buy, index, price);
     }
-    return 0;
+    return quantity - remaining;
   }
 
-  // Simplified best ask finding (safe version for MVP)
-  __attribute__((always_inline)) inline uint32_t ultra_getBestAsk() const {
-    // Find lowest ask price (iterate from low to high)
-    for (uint32_t i = 0; i < ULTRA_PRICE_LEVELS; ++i) {
-      if (ask_levels_[i].total_quantity > 0) {
-        return ULTRA_MIN_PRICE + i;
+  // Opposite-side quantity an aggressor could take at or through limit_price,
+  // stopping early once `wanted` is reached. Used for fill-or-kill checks.
+  inline uint64_t ultra_crossableQuantity(bool aggressor_is_buy, uint32_t limit_price,
+                                          uint64_t wanted) const {
+    // Walks are depth-bounded; rewalk deeper only while every level seen
+    // still crosses and the wanted size has not been reached
+    for (uint32_t depth = 16;; depth *= 4) {
+      uint64_t total = 0;
+      uint32_t seen = 0;
+      bool done = false;
+      auto count = [&](uint32_t price, uint32_t qty, uint32_t) {
+        ++seen;
+        if (done || (aggressor_is_buy ? price > limit_price : price < limit_price)) {
+          done = true;
+          return;
+        }
+        total += qty;
+        done = total >= wanted;
+      };
+      if (aggressor_is_buy)
+        ultra_walkAsks(depth, count);
+      else
+        ultra_walkBids(depth, count);
+      if (done || seen < depth || depth >= (1u << 28))
+        return total;
+    }
+  }
+
+  // Auction equilibrium of a crossed book: the level price that executes
+  // the most volume, then leaves the smallest imbalance, then lies closest
+  // to `reference` (0: midway between the crossed touches). price == 0 when
+  // the book does not cross. Only levels between the touches matter; when
+  // both touches are dense this is a prefix and a suffix sum over that
+  // stretch of the ladder, otherwise the levels are walked.
+  struct UltraCross {
+    uint32_t price{0};
+    uint64_t volume{0};
+    int64_t imbalance{0}; // Buy minus sell quantity at price
+  };
+
+  inline UltraCross ultra_equilibrium(uint32_t reference = 0) const {
+    const uint32_t bid = ultra_getBestBid();
+    const uint32_t ask = ultra_getBestAsk();
+    if (bid == 0 || ask == 0 || bid < ask)
+      return {};
+    if (reference == 0)
+      reference = static_cast<uint32_t>((uint64_t(bid) + ask) / 2);
+
+    UltraCross best;
+    auto consider = [&](uint32_t price, uint64_t demand, uint64_t supply) {
+      const uint64_t volume = demand < supply ? demand : supply;
+      const int64_t imbalance = int64_t(demand) - int64_t(supply);
+      const uint64_t abs_imb = imbalance < 0 ? uint64_t(-imbalance) : uint64_t(imbalance);
+      const uint64_t best_imb = best.imbalance < 0 ? uint64_t(-best.imbalance) : uint64_t(best.imbalance);
+      const uint64_t dist = price > reference ? price - reference : reference - price;
+      const uint64_t best_dist = best.price > reference ? best.price - reference : reference - best.price;
+      if (best.price == 0 || volume > best.volume ||
+          (volume == best.volume && (abs_imb < best_imb || (abs_imb == best_imb && dist < best_dist))))
+        best = UltraCross{price, volume, imbalance};
+    };
+
+    const uint32_t lo = ultra_price_to_index(ask);
+    const uint32_t hi = ultra_price_to_index(bid);
+    if (lo != Bitmap::NONE && hi != Bitmap::NONE) {
+      // Dense touches leave nothing relevant in the overflow maps
+      const uint32_t n = hi - lo + 1;
+      std::vector<uint64_t> demand(n), supply(n);
+      uint64_t acc = 0;
+      for (uint32_t i = n; i-- > 0;) {
+        acc += bid_levels_[lo + i].total_quantity;
+        demand[i] = acc;
+      }
+      acc = 0;
+      for (uint32_t i = 0; i < n; ++i) {
+        acc += ask_levels_[lo + i].total_quantity;
+        supply[i] = acc;
       }
+      for (uint32_t i = 0; i < n; ++i) {
+        if (bid_levels_[lo + i].total_quantity | ask_levels_[lo + i].total_quantity)
+          consider(ultra_index_to_price(lo + i), demand[i], supply[i]);
+      }
+      return best;
+    }
+
+    // Bids at or above the best ask and asks at or below the best bid
+    std::vector<std::pair<uint32_t, uint64_t>> bids, asks;
+    bool more = true;
+    ultra_walkBids(0xFFFFFFFFu, [&](uint32_t price, uint32_t qty, uint32_t) {
+      more = more && price >= ask;
+      if (more)
+        bids.emplace_back(price, qty);
+    });
+    more = true;
+    ultra_walkAsks(0xFFFFFFFFu, [&](uint32_t price, uint32_t qty, uint32_t) {
+      more = more && price <= bid;
+      if (more)
+        asks.emplace_back(price, qty);
+    });
+    std::vector<uint32_t> prices;
+    prices.reserve(bids.size() + asks.size());
+    for (auto it = bids.rbegin(); it != bids.rend(); ++it)
+      prices.push_back(it->first);
+    const size_t mid = prices.size();
+    for (const auto &level : asks)
+      prices.push_back(level.first);
+    std::inplace_merge(prices.begin(), prices.begin() + mid, prices.end());
+    prices.erase(std::unique(prices.begin(), prices.end()), prices.end());
+
+    std::vector<uint64_t> demand(prices.size());
+    uint64_t acc = 0;
+    size_t b = 0;
+    for (size_t i = prices.size(); i-- > 0;) {
+      while (b < bids.size() && bids[b].first >= prices[i])
+        acc += bids[b++].second;
+      demand[i] = acc;
+    }
+    acc = 0;
+    size_t a = 0;
+    for (size_t i = 0; i < prices.size(); ++i) {
+      while (a < asks.size() && asks[a].first <= prices[i])
+        acc += asks[a++].second;
+      consider(prices[i], demand[i], acc);
     }
-    return 0;
+    return best;
   }
 
+  // Cached dense top-of-book; the overflow maps only matter when the touch
+  // sits outside the window (e.g. one side is far away from the other)
+  __attribute__((always_inline)) inline uint32_t ultra_getBestBid() const {
+    uint32_t best = (best_bid_idx_ == Bitmap::NONE) ? 0 : ultra_index_to_price(best_bid_idx_);
+    if (__builtin_expect(!bid_overflow_.empty(), 0)) {
+      const uint32_t far = bid_overflow_.rbegin()->first;
+      if (far > best)
+        best = far;
+    }
+    return best;
+  }
+
+  __attribute__((always_inline)) inline uint32_t ultra_getBestAsk() const {
+    uint32_t best = (best_ask_idx_ == Bitmap::NONE) ? 0 : ultra_index_to_price(best_ask_idx_);
+    if (__builtin_expect(!ask_overflow_.empty(), 0)) {
+      const uint32_t far = ask_overflow_.begin()->first;
+      if (best == 0 || far < best)
+        best = far;
+    }
+    return best;
+  }
+
+  inline uint32_t ultra_getBestBidQuantity() const {
+    uint32_t qty = 0;
+    ultra_walkBids(1, [&](uint32_t, uint32_t q, uint32_t) { qty = q; });
+    return qty;
+  }
+
+  inline uint32_t ultra_getBestAskQuantity() const {
+    uint32_t qty = 0;
+    ultra_walkAsks(1, [&](uint32_t, uint32_t q, uint32_t) { qty = q; });
+    return qty;
+  }
+
+  // Levels changed since the previous drain (books with track_changes),
+  // each reported once with its current state: fn(is_buy, price,
+  // total_quantity, order_count), quantity 0 meaning the level is gone.
+  // Bids then asks; within a side, re-centred and overflow levels come
+  // first, the dense window follows from the touch outwards. A level that
+  // changed and came back to where it was is still reported. Returns the
+  // number of levels reported.
+  template <typename Fn>
+  inline uint32_t ultra_drainChanges(Fn &&fn) {
+    if (!changes_pending_)
+      return 0;
+    changes_pending_ = false;
+    return ultra_drain_side(true, fn) + ultra_drain_side(false, fn);
+  }
+
+  inline bool ultra_hasChanges() const { return changes_pending_; }
+
+  // Turning tracking off discards whatever is pending
+  inline void ultra_trackChanges(bool on) {
+    config_.track_changes = on;
+    if (!on)
+      ultra_clear_changes();
+  }
+
+  // Depth walks over non-empty levels from the top of book outwards.
+  // fn(price, total_quantity, order_count) is called for up to `depth` levels.
+  template <typename Fn>
+  inline void ultra_walkBids(uint32_t depth, Fn &&fn) const {
+    // Overflow bids above the window, then the dense window, then those below
+    auto it = bid_overflow_.rbegin();
+    for (; it != bid_overflow_.rend() && it->first > window_base_ && depth > 0; ++it, --depth)
+      fn(it->first, it->second.total_quantity, it->second.order_count);
+    ultra_walk_dense_bids(depth, fn);
+    for (; it != bid_overflow_.rend() && depth > 0; ++it, --depth)
+      fn(it->first, it->second.total_quantity, it->second.order_count);
+  }
+
+  template <typename Fn>
+  inline void ultra_walkAsks(uint32_t depth, Fn &&fn) const {
+    // Overflow asks below the window, then the dense window, then those above
+    auto it = ask_overflow_.begin();
+    for (; it != ask_overflow_.end() && it->first < window_base_ && depth > 0; ++it, --depth)
+      fn(it->first, it->second.total_quantity, it->second.order_count);
+    ultra_walk_dense_asks(depth, fn);
+    for (; it != ask_overflow_.end() && depth > 0; ++it, --depth)
+      fn(it->first, it->second.total_quantity, it->second.order_count);
+  }
+
+  // Front of the FIFO queue at a price, or nullptr if nothing rests there.
+  // Follow UltraOrder::next towards the back; the pointers stay valid until
+  // the next mutation of this book.
+  inline const UltraOrder *ultra_queueFront(bool is_buy, uint32_t price) const {
+    const UltraPriceLevel *level = ultra_find_level(is_buy, price);
+    return level ? level->first_order : nullptr;
+  }
+
+  // Zero-based queue position of a resting order (-1 if unknown), optionally
+  // with the number of shares queued ahead of it. O(position).
+  inline int64_t ultra_queuePosition(uint64_t orderId, uint64_t *shares_ahead = nullptr) const {
+    const UltraOrder *order = order_hash_.ultra_find(orderId);
+    if (!order)
+      return -1;
+    int64_t pos = 0;
+    uint64_t ahead = 0;
+    for (const UltraOrder *o = order->prev; o; o = o->prev) {
+      ++pos;
+      ahead += o->quantity;
+    }
+    if (shares_ahead)
+      *shares_ahead = ahead;
+    return pos;
+  }
+
+  // Every resting order as fn(id, side, quantity, price): bids from the top
+  // of book down, then asks from the top up, each level front to back.
+  // Adding them to an empty book in this order rebuilds every queue.
+  template <typename Fn>
+  inline void ultra_forEachOrder(Fn &&fn) const {
+    auto walk_queue = [&](bool is_buy, uint32_t price) {
+      for (const UltraOrder *o = ultra_queueFront(is_buy, price); o; o = o->next)
+        fn(o->get_id(), o->get_side(), o->quantity, o->price);
+    };
+    ultra_walkBids(0xFFFFFFFFu, [&](uint32_t price, uint32_t, uint32_t) { walk_queue(true, price); });
+    ultra_walkAsks(0xFFFFFFFFu, [&](uint32_t price, uint32_t, uint32_t) { walk_queue(false, price); });
+  }
+
+  // Dense window placement, for monitoring
+  inline uint32_t ultra_windowLow() const { return window_base_; }
+  inline uint32_t ultra_windowHigh() const { return ultra_window_top(); }
+  inline uint64_t ultra_windowRecenters() const { return window_recenters_; }
+  inline const UltraBookConfig &config() const { return config_; }
+  inline UltraHashTable::Stats ultra_indexStats() const { return order_hash_.stats(); }
+  inline uint32_t ultra_liveOrders() const { return order_pool_.live(); }
+
+  // Batch consumers call this a few events ahead of touching order_id
+  __attribute__((always_inline)) inline void ultra_prefetchOrder(uint64_t order_id) const {
+    order_hash_.ultra_prefetch(order_id);
+  }
+  // Closer in: resolves the (by now cached) index entry and fetches the order;
+  // this is a real lookup and shows up in the index stats as one
+  __attribute__((always_inline)) inline void ultra_prefetchOrderData(uint64_t order_id) const {
+    if (const UltraOrder *o = order_hash_.ultra_find(order_id))
+      __builtin_prefetch(o, 1, 3);
+  }
+  inline uint32_t ultra_poolCapacity() const { return order_pool_.capacity(); }
+
   // Reset pool for continuous operation
   inline void reset_pool() {
     order_pool_.reset();
-    memset(bid_levels_, 0, sizeof(bid_levels_));
-    memset(ask_levels_, 0, sizeof(ask_levels_));
+    order_hash_.clear();
+    // Empty levels are already zero; the pages stay resident for reuse
+    for (uint32_t i = bid_bits_.lowest(); i != Bitmap::NONE; i = bid_bits_.find_next(i + 1))
+      bid_levels_[i] = UltraPriceLevel{};
+    for (uint32_t i = ask_bits_.lowest(); i != Bitmap::NONE; i = ask_bits_.find_next(i + 1))
+      ask_levels_[i] = UltraPriceLevel{};
+    bid_bits_.clear();
+    ask_bits_.clear();
+    best_bid_idx_ = Bitmap::NONE;
+    best_ask_idx_ = Bitmap::NONE;
+    bid_overflow_.clear();
+    ask_overflow_.clear();
+    window_base_ = 0xFFFFFFFFu;
+    ultra_clear_changes();
   }
 
   // Simple display method for debugging/validation
   void display() const {
     std::cout << "--- ULTRA ORDER BOOK ---" << std::endl;
-    
-    // Find best bid and ask
-    uint32_t best_bid = 0, best_ask = 0;
-    for (int i = ULTRA_PRICE_LEVELS - 1; i >= 0; i--) {
-      if (bid_levels_[i].total_quantity > 0 && best_bid == 0) {
-        best_bid = ULTRA_MIN_PRICE + i;
-        break;
-      }
-    }
-    for (int i = 0; i < ULTRA_PRICE_LEVELS; i++) {
-      if (ask_levels_[i].total_quantity > 0 && best_ask == 0) {
-        best_ask = ULTRA_MIN_PRICE + i;
-        break;
-      }
-    }
-    
-    std::cout << "Best Bid: " << (best_bid / 10000.0) << std::endl;
-    std::cout << "Best Ask: " << (best_ask / 10000.0) << std::endl;
+    std::cout << "Best Bid: " << (ultra_getBestBid() / 10000.0) << std::endl;
+    std::cout << "Best Ask: " << (ultra_getBestAsk() / 10000.0) << std::endl;
     std::cout << std::endl;
-    
+
+    auto print_level = [](uint32_t price, uint32_t qty, uint32_t /*count*/) {
+      std::cout << "        " << qty << " | " << (price / 10000.0) << std::endl;
+    };
+
     // Show top bids (highest first)
     std::cout << "--- BIDS ---         QTY | PRICE" << std::endl;
-    int bid_count = 0;
-    for (int i = ULTRA_PRICE_LEVELS - 1; i >= 0 && bid_count < 10; i--) {
-      if (bid_levels_[i].total_quantity > 0) {
-        uint32_t price = ULTRA_MIN_PRICE + i;
-        std::cout << "        " << bid_levels_[i].total_quantity << " | " << (price / 10000.0) << std::endl;
-        bid_count++;
-      }
-    }
-    
+    ultra_walkBids(10, print_level);
+
     // Show top asks (lowest first)
     std::cout << std::endl << "--- ASKS ---         QTY | PRICE" << std::endl;
-    int ask_count = 0;
-    for (int i = 0; i < ULTRA_PRICE_LEVELS && ask_count < 10; i++) {
-      if (ask_levels_[i].total_quantity > 0) {
-        uint32_t price = ULTRA_MIN_PRICE + i;
-        std::cout << "        " << ask_levels_[i].total_quantity << " | " << (price / 10000.0) << std::endl;
-        ask_count++;
-      }
-    }
+    ultra_walkAsks(10, print_level);
     std::cout << "------------------" << std::endl;
   }
 };
 
-// =============================================================================
-// TEMPLATE-BASED COMPILE-TIME OPTIMIZATION
-// =============================================================================
-
-template <char Side> class TemplatedUltraOrderBook {
-private:
-  UltraOrderBook book_;
-
-public:
-  __attribute__((always_inline)) inline void
-  addOrder(uint64_t orderId, uint32_t quantity, uint32_t price) {
-    book_.ultra_addOrder(orderId, Side, quantity, price);
-  }
-};
-
-using UltraBuyOrderBook = TemplatedUltraOrderBook<'B'>;
-using UltraSellOrderBook = TemplatedUltraOrderBook<'S'>;
+// Books specialised at compile time (L1 feed handlers, FIFO matching books)
+// are built from policies in book/basic_order_book.hpp
 
 #endif // ULTRA_OPTIMIZED_ORDER_BOOK_HPP
 
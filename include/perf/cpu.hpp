@@ -0,0 +1,76 @@
+#ifndef PERF_CPU_HPP
+#define PERF_CPU_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace perf {
+
+// Spin-wait hint: lets the sibling hyperthread run and avoids the memory-order
+// flush when the polled line finally changes
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Small per-process index for the calling thread, assigned on first use
+inline unsigned thread_index() {
+    static std::atomic<unsigned> next{0};
+    thread_local const unsigned index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+// Pins the calling thread to one cpu; false if that is not possible
+inline bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// CPUs the kernel keeps the scheduler off (isolcpus=), in ascending order;
+// empty when none are isolated
+inline std::vector<int> isolated_cpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    FILE* f = std::fopen("/sys/devices/system/cpu/isolated", "r");
+    if (!f) return cpus;
+    char buf[1024];
+    const size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+    std::fclose(f);
+    buf[n] = '\0';
+    // Kernel cpulist format: "2-5,7"
+    for (char* p = buf; *p && *p != '\n';) {
+        char* end;
+        const long lo = std::strtol(p, &end, 10);
+        if (end == p) break;
+        long hi = lo;
+        if (*end == '-') hi = std::strtol(end + 1, &end, 10);
+        for (long c = lo; c <= hi; ++c) cpus.push_back(static_cast<int>(c));
+        p = (*end == ',') ? end + 1 : end;
+    }
+#endif
+    return cpus;
+}
+
+} // namespace perf
+
+#endif // PERF_CPU_HPP
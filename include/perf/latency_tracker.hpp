@@ -1,37 +1,47 @@
 #ifndef PERF_LATENCY_TRACKER_HPP
 #define PERF_LATENCY_TRACKER_HPP
 
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <vector>
-#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <time.h>
+#include <type_traits>
+#include "perf/cpu.hpp"
+#include "perf/tsc_clock.hpp"
 
 namespace perf {
 
 using TimePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
 using Duration = std::chrono::nanoseconds;
 
-class LatencyTracker {
-private:
-    std::vector<uint64_t> samples_;
-    size_t capacity_;
-    size_t count_{0};
-    
+// Log-linear (HDR-style) latency histogram counts. Values below 64 ns get a
+// bucket each; above that every power of two is split into 32 buckets, so a
+// bucket is never wider than ~3% of its value, up to ~18 minutes.
+class Histogram {
 public:
-    explicit LatencyTracker(size_t capacity = 10000) 
-        : capacity_(capacity) {
-        samples_.reserve(capacity_);
+    static constexpr uint32_t SUB_BITS = 5;
+    static constexpr uint32_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr uint32_t MAX_SHIFT = 35; // values up to 2^40 ns
+    static constexpr uint32_t BUCKETS = (MAX_SHIFT + 2) * SUB_COUNT;
+
+    static uint32_t bucket_of(uint64_t ns) {
+        const uint32_t msb = 63 - static_cast<uint32_t>(__builtin_clzll(ns | 1));
+        uint32_t shift = msb > SUB_BITS ? msb - SUB_BITS : 0;
+        if (shift > MAX_SHIFT) return BUCKETS - 1;
+        return shift * SUB_COUNT + static_cast<uint32_t>(ns >> shift);
     }
-    
-    void record(uint64_t latency_ns) {
-        if (samples_.size() < capacity_) {
-            samples_.push_back(latency_ns);
-        } else {
-            samples_[count_ % capacity_] = latency_ns;
-        }
-        count_++;
+
+    // Highest value that falls in bucket b
+    static uint64_t bucket_high(uint32_t b) {
+        if (b < 2 * SUB_COUNT) return b;
+        const uint32_t shift = b / SUB_COUNT - 1;
+        const uint64_t low = uint64_t(b - shift * SUB_COUNT) << shift;
+        return low + (uint64_t(1) << shift) - 1;
     }
-    
+
     struct Stats {
         uint64_t min_ns{0};
         uint64_t max_ns{0};
@@ -39,52 +49,185 @@ public:
         uint64_t p50_ns{0};
         uint64_t p95_ns{0};
         uint64_t p99_ns{0};
+        uint64_t p999_ns{0};
         size_t count{0};
     };
-    
-    Stats get_stats() const {
-        if (samples_.empty()) return {};
-        
-        std::vector<uint64_t> sorted = samples_;
-        std::sort(sorted.begin(), sorted.end());
-        
-        Stats stats;
-        stats.count = samples_.size();
-        stats.min_ns = sorted.front();
-        stats.max_ns = sorted.back();
-        
-        uint64_t total = 0;
-        for (auto ns : sorted) total += ns;
-        stats.avg_ns = static_cast<double>(total) / sorted.size();
-        
-        stats.p50_ns = sorted[sorted.size() * 50 / 100];
-        stats.p95_ns = sorted[sorted.size() * 95 / 100];  
-        stats.p99_ns = sorted[sorted.size() * 99 / 100];
-        
-        return stats;
+
+    Histogram& operator+=(const Histogram& o) {
+        for (uint32_t b = 0; b < BUCKETS; ++b) counts[b] += o.counts[b];
+        count += o.count;
+        total_ns += o.total_ns;
+        if (o.count && (count == o.count || o.min_ns < min_ns)) min_ns = o.min_ns;
+        if (o.max_ns > max_ns) max_ns = o.max_ns;
+        return *this;
+    }
+
+    // Percentiles are bucket upper bounds, capped at the exact max
+    Stats stats() const {
+        Stats s;
+        if (count == 0) return s;
+        s.count = static_cast<size_t>(count);
+        s.min_ns = min_ns;
+        s.max_ns = max_ns;
+        s.avg_ns = static_cast<double>(total_ns) / static_cast<double>(count);
+        s.p50_ns = percentile(0.50);
+        s.p95_ns = percentile(0.95);
+        s.p99_ns = percentile(0.99);
+        s.p999_ns = percentile(0.999);
+        return s;
+    }
+
+    uint64_t percentile(double q) const {
+        const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (uint32_t b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= rank) return bucket_high(b) < max_ns ? bucket_high(b) : max_ns;
+        }
+        return max_ns;
+    }
+
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t count{0};
+    uint64_t total_ns{0};
+    uint64_t min_ns{0};
+    uint64_t max_ns{0};
+};
+
+// Latency histogram for one recording thread. record() is a handful of plain
+// loads and stores (the counters are relaxed atomics only so another thread
+// can read them), so it can stay on in production; nothing is sampled away
+// and the percentiles cover every value since the last reset.
+//
+// Any other thread may take snapshot() / get_stats() at any time, and one may
+// take interval() for per-period deltas. Trackers of different threads are
+// combined by summing their snapshots.
+class LatencyTracker {
+public:
+    using Stats = Histogram::Stats;
+
+    LatencyTracker() = default;
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    // Owning thread only
+    void record(uint64_t latency_ns) {
+        bump(counts_[Histogram::bucket_of(latency_ns)], 1);
+        bump(total_ns_, latency_ns);
+        const uint64_t n = count_.load(std::memory_order_relaxed);
+        if (n == 0 || latency_ns < min_ns_.load(std::memory_order_relaxed))
+            min_ns_.store(latency_ns, std::memory_order_relaxed);
+        if (latency_ns > max_ns_.load(std::memory_order_relaxed))
+            max_ns_.store(latency_ns, std::memory_order_relaxed);
+        count_.store(n + 1, std::memory_order_release);
+    }
+
+    // Safe from any number of threads, at the cost of locked adds
+    void record_concurrent(uint64_t latency_ns) {
+        counts_[Histogram::bucket_of(latency_ns)].fetch_add(1, std::memory_order_relaxed);
+        total_ns_.fetch_add(latency_ns, std::memory_order_relaxed);
+        uint64_t cur = min_ns_.load(std::memory_order_relaxed);
+        while ((cur == 0 || latency_ns < cur) &&
+               !min_ns_.compare_exchange_weak(cur, latency_ns, std::memory_order_relaxed)) {}
+        cur = max_ns_.load(std::memory_order_relaxed);
+        while (latency_ns > cur && !max_ns_.compare_exchange_weak(cur, latency_ns, std::memory_order_relaxed)) {}
+        count_.fetch_add(1, std::memory_order_release);
+    }
+
+    // Cycle-counter interval, converted with the calibrated process clock
+    void record_ticks(uint64_t start, uint64_t end) { record(tsc().elapsed_ns(start, end)); }
+
+    // Counts so far. Taken while the owner records, the sum and min/max may
+    // be a value or two off the buckets; the count is the buckets' total.
+    Histogram snapshot() const {
+        Histogram h;
+        for (uint32_t b = 0; b < Histogram::BUCKETS; ++b) h.counts[b] = counts_[b].load(std::memory_order_relaxed);
+        h.total_ns = total_ns_.load(std::memory_order_relaxed);
+        h.min_ns = min_ns_.load(std::memory_order_relaxed);
+        h.max_ns = max_ns_.load(std::memory_order_relaxed);
+        uint64_t in_buckets = 0;
+        for (uint64_t c : h.counts) in_buckets += c;
+        h.count = in_buckets;
+        return h;
     }
-    
-    void print_stats(const std::string& name) const {
-        auto stats = get_stats();
+
+    // Values recorded since the previous interval() call (one reader only).
+    // Min and max are those of the whole run.
+    Histogram interval() {
+        const Histogram now = snapshot();
+        Histogram d = now;
+        for (uint32_t b = 0; b < Histogram::BUCKETS; ++b) d.counts[b] -= last_.counts[b];
+        d.count -= last_.count;
+        d.total_ns -= last_.total_ns;
+        last_ = now;
+        return d;
+    }
+
+    Stats get_stats() const { return snapshot().stats(); }
+
+    void print_stats(const std::string& name) const { print_stats(name, get_stats()); }
+
+    static void print_stats(const std::string& name, const Stats& stats) {
         if (stats.count == 0) {
             std::cout << name << ": No samples" << std::endl;
             return;
         }
-        
+
         std::cout << "=== " << name << " LATENCY STATS ===\n"
                   << "Samples: " << stats.count << "\n"
                   << "Min:     " << stats.min_ns << " ns\n"
-                  << "Avg:     " << static_cast<int>(stats.avg_ns) << " ns\n" 
+                  << "Avg:     " << static_cast<int>(stats.avg_ns) << " ns\n"
                   << "P50:     " << stats.p50_ns << " ns\n"
                   << "P95:     " << stats.p95_ns << " ns\n"
                   << "P99:     " << stats.p99_ns << " ns\n"
+                  << "P99.9:   " << stats.p999_ns << " ns\n"
                   << "Max:     " << stats.max_ns << " ns\n" << std::endl;
     }
-    
+
+    // Only while nothing records
     void reset() {
-        samples_.clear();
-        count_ = 0;
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        total_ns_.store(0, std::memory_order_relaxed);
+        min_ns_.store(0, std::memory_order_relaxed);
+        max_ns_.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_release);
+        last_ = Histogram{};
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& a, uint64_t by) {
+        a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, Histogram::BUCKETS> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> min_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+    Histogram last_; // interval() baseline
+};
+
+// Latency histogram recorded from several threads, e.g. one per FIX session.
+// Each thread lands on its own slot, so writers do not share counter lines
+// as long as there are no more threads than slots; beyond that slots are
+// shared, which stays correct because slots are recorded with atomic adds.
+class SharedLatencyTracker {
+public:
+    static constexpr unsigned SLOTS = 16;
+
+    void record(uint64_t latency_ns) { slots_[thread_index() % SLOTS].record_concurrent(latency_ns); }
+
+    Histogram snapshot() const {
+        Histogram h;
+        for (const auto& s : slots_) h += s.snapshot();
+        return h;
     }
+
+    Histogram::Stats get_stats() const { return snapshot().stats(); }
+    void print_stats(const std::string& name) const { LatencyTracker::print_stats(name, get_stats()); }
+
+private:
+    std::array<LatencyTracker, SLOTS> slots_;
 };
 
 // High-resolution timer utilities
@@ -100,22 +243,38 @@ inline uint64_t elapsed_ns(TimePoint start) {
     return elapsed_ns(start, now());
 }
 
-// RAII latency measurement
+// CLOCK_REALTIME in ns, the clock packet receive timestamps are taken on
+inline uint64_t wall_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Time since a receive timestamp; false if the packet was not stamped or the
+// stamp is ahead of the host clock (unsynchronised NIC clock)
+inline bool since_rx_ns(uint64_t rx_ns, uint64_t wall, uint64_t& out) {
+    if (rx_ns == 0 || wall < rx_ns) return false;
+    out = wall - rx_ns;
+    return true;
+}
+
+// RAII latency measurement on the cycle counter
+template <typename Tracker>
 class ScopedLatencyMeasurement {
 private:
-    TimePoint start_;
-    LatencyTracker& tracker_;
-    
+    uint64_t start_;
+    Tracker& tracker_;
+
 public:
-    ScopedLatencyMeasurement(LatencyTracker& tracker) 
-        : start_(now()), tracker_(tracker) {}
-    
+    explicit ScopedLatencyMeasurement(Tracker& tracker)
+        : start_(tsc().now()), tracker_(tracker) {}
+
     ~ScopedLatencyMeasurement() {
-        tracker_.record(elapsed_ns(start_));
+        tracker_.record(tsc().elapsed_ns(start_, tsc().now_ordered()));
     }
 };
 
-#define MEASURE_LATENCY(tracker) perf::ScopedLatencyMeasurement _measure(tracker)
+#define MEASURE_LATENCY(tracker) perf::ScopedLatencyMeasurement<std::remove_reference_t<decltype(tracker)>> _measure(tracker)
 
 } // namespace perf
 
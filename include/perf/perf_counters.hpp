@@ -0,0 +1,141 @@
+#ifndef PERF_PERF_COUNTERS_HPP
+#define PERF_PERF_COUNTERS_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+// Hardware and software event counts for the calling thread, user space
+// only, through perf_event_open. Each event is opened on its own, so one
+// the CPU or hypervisor does not expose (VMs often expose no hardware
+// events at all, and perf_event_paranoid may forbid them) just reads as
+// unavailable while the rest still count. Counts are scaled up when the
+// kernel had to multiplex the PMU.
+class PerfCounters {
+public:
+    enum Event : uint32_t {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,      // Last-level cache
+        L1D_READ_MISSES,
+        BRANCH_MISSES,
+        PAGE_FAULTS,       // Software events: always there on Linux
+        CONTEXT_SWITCHES,
+        EVENT_COUNT
+    };
+
+    static const char* name(Event e) {
+        static const char* const names[EVENT_COUNT] = {
+            "cycles", "instructions", "cache_misses", "l1d_read_misses", "branch_misses",
+            "page_faults", "context_switches"};
+        return names[e];
+    }
+
+    struct Sample {
+        std::array<uint64_t, EVENT_COUNT> values{};
+        std::array<bool, EVENT_COUNT> valid{};
+
+        bool has(Event e) const { return valid[e]; }
+        uint64_t operator[](Event e) const { return values[e]; }
+        double ipc() const {
+            return has(CYCLES) && has(INSTRUCTIONS) && values[CYCLES]
+                       ? static_cast<double>(values[INSTRUCTIONS]) / static_cast<double>(values[CYCLES])
+                       : 0.0;
+        }
+    };
+
+    PerfCounters() { fds_.fill(-1); }
+    ~PerfCounters() { close_all(); }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Opens every event it can; returns how many
+    uint32_t open() {
+        close_all();
+        uint32_t opened = 0;
+#ifdef __linux__
+        const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const struct { uint32_t type; uint64_t config; } events[EVENT_COUNT] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HW_CACHE, l1d_read_miss},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+        };
+        for (uint32_t e = 0; e < EVENT_COUNT; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[e].type;
+            attr.config = events[e].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds_[e] >= 0) ++opened;
+        }
+#endif
+        return opened;
+    }
+
+    bool available(Event e) const { return fds_[e] >= 0; }
+
+    // Zeroes and starts every open counter
+    void start() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Stops the counters and reads what they counted since start()
+    Sample stop() {
+        Sample s;
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (uint32_t e = 0; e < EVENT_COUNT; ++e) {
+            uint64_t r[3]; // value, time enabled, time running
+            if (fds_[e] < 0 || ::read(fds_[e], r, sizeof(r)) != static_cast<ssize_t>(sizeof(r))) continue;
+            s.values[e] = r[2] && r[2] < r[1]
+                              ? static_cast<uint64_t>(static_cast<double>(r[0]) * r[1] / r[2])
+                              : r[0];
+            s.valid[e] = true;
+        }
+#endif
+        return s;
+    }
+
+private:
+    void close_all() {
+#ifdef __linux__
+        for (int& fd : fds_) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+
+    std::array<int, EVENT_COUNT> fds_;
+};
+
+} // namespace perf
+
+#endif // PERF_PERF_COUNTERS_HPP
@@ -0,0 +1,94 @@
+#ifndef PERF_TSC_CLOCK_HPP
+#define PERF_TSC_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace perf {
+
+// Cycle-counter clock for per-message timing: a read is one rdtsc instead of
+// a clock_gettime call. Ticks are calibrated against steady_clock once at
+// construction (~10 ms). Without an invariant TSC (or off x86) it falls back
+// to steady_clock nanoseconds, so callers never need to know which they got.
+class TscClock {
+public:
+    TscClock() {
+        if (!invariant_tsc()) return;
+        using namespace std::chrono;
+        const auto w0 = steady_clock::now();
+        const uint64_t t0 = read_tsc();
+        while (steady_clock::now() - w0 < milliseconds(10)) {}
+        const uint64_t t1 = read_tsc();
+        const double ns = static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - w0).count());
+        if (t1 > t0) {
+            ns_per_tick_ = ns / static_cast<double>(t1 - t0);
+            tsc_ = true;
+        }
+    }
+
+    uint64_t now() const {
+        if (tsc_) return read_tsc();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // As now(), but only after every earlier instruction has executed (rdtscp);
+    // use it to close a measured interval
+    uint64_t now_ordered() const {
+#if defined(__x86_64__) || defined(__i386__)
+        if (tsc_) {
+            unsigned aux;
+            return __rdtscp(&aux);
+        }
+#endif
+        return now();
+    }
+
+    uint64_t to_ns(uint64_t ticks) const { return static_cast<uint64_t>(static_cast<double>(ticks) * ns_per_tick_); }
+    uint64_t from_ns(uint64_t ns) const { return static_cast<uint64_t>(static_cast<double>(ns) / ns_per_tick_); }
+    uint64_t elapsed_ns(uint64_t start, uint64_t end) const { return end > start ? to_ns(end - start) : 0; }
+
+    bool uses_tsc() const { return tsc_; }
+
+private:
+    static uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // constant_tsc + nonstop_tsc: the counter ticks at a fixed rate across
+    // frequency changes and idle states, so deltas are comparable anywhere
+    static bool invariant_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 5, "flags") != 0) continue;
+            return line.find(" constant_tsc") != std::string::npos &&
+                   line.find(" nonstop_tsc") != std::string::npos;
+        }
+#endif
+        return false;
+    }
+
+    double ns_per_tick_{1.0};
+    bool tsc_{false};
+};
+
+// Process-wide clock, calibrated on first use
+inline const TscClock& tsc() {
+    static const TscClock clock;
+    return clock;
+}
+
+} // namespace perf
+
+#endif // PERF_TSC_CLOCK_HPP
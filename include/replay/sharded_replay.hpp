@@ -0,0 +1,319 @@
+#ifndef REPLAY_SHARDED_REPLAY_HPP
+#define REPLAY_SHARDED_REPLAY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "lock_free_queue.hpp"
+#include "core/apply.hpp"
+#include "core/book_router.hpp"
+#include "core/event_block.hpp"
+#include "core/mapped_file.hpp"
+#include "core/symbol_table.hpp"
+#include "itch/decoder.hpp"
+#include "itch/messages.hpp"
+#include "itch/views.hpp"
+#include "perf/cpu.hpp"
+
+namespace replay {
+
+// Book output of the replay, tagged with the number of the message (counted
+// from the start of the file) that produced it
+struct ReplayOutput {
+  enum Kind : uint8_t { Trade, Quote };
+
+  uint64_t seq;
+  uint64_t order_id; // Trade: the executed resting order
+  uint32_t qty;      // Trade: executed shares
+  uint32_t bid;      // Quote: new best bid / ask, 0 for an empty side
+  uint32_t ask;
+  uint16_t locate;
+  Kind kind;
+};
+
+// Multi-threaded replay of a capture. The calling thread walks the buffer and
+// hands every order message to shard stockLocate % N; each shard is a pinned
+// worker thread with its own decoder, symbol table and books, so books never
+// cross threads. Every ITCH order message carries the locate of its stock
+// (executions, cancels and replaces included), so each order lives in one shard.
+//
+// With a sink, workers also report trades and best bid/ask changes; a merge
+// thread interleaves them by message number, so the sink sees the same
+// sequence a single-threaded replay would produce for any shard count.
+template <typename OB>
+class ShardedReplay {
+public:
+  using Sink = std::function<void(const ReplayOutput&)>;
+
+  // first_cpu < 0 leaves the workers unpinned; otherwise worker i runs on
+  // cpu (first_cpu + i) modulo the online cpus. `make` builds each shard's
+  // books (see core::BookRouter).
+  explicit ShardedReplay(size_t shards, int first_cpu = -1,
+                         const typename core::BookRouter<OB>::Factory& make = nullptr)
+      : first_cpu_(first_cpu) {
+    if (shards == 0) shards = 1;
+    for (size_t i = 0; i < shards; ++i) shards_.emplace_back(new Shard(make));
+  }
+
+  // Called from the merge thread, in message order
+  void set_sink(Sink sink) { sink_ = std::move(sink); }
+
+  // Replays [data, data + size) and returns the bytes consumed; stops early at
+  // the first message that cannot be framed. `file`, if given, is advanced as
+  // the split progresses.
+  size_t run(const char* data, size_t size, itch::Framing framing, core::MappedFile* file = nullptr) {
+    end_ = data + size;
+    dispatched_.store(0, std::memory_order_relaxed);
+    done_.store(false, std::memory_order_relaxed);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < shards_.size(); ++i) threads.emplace_back(&ShardedReplay::work, this, i);
+    std::thread merger;
+    if (sink_) merger = std::thread(&ShardedReplay::merge, this);
+
+    const size_t used = split(data, size, framing, file);
+
+    for (auto& t : threads) t.join();
+    if (merger.joinable()) merger.join();
+    return used;
+  }
+
+  size_t shard_count() const { return shards_.size(); }
+  uint64_t messages() const { return messages_; }
+
+  uint64_t events() const {
+    uint64_t n = 0;
+    for (const auto& s : shards_) n += s->events;
+    return n;
+  }
+
+  size_t book_count() const {
+    size_t n = 0;
+    for (const auto& s : shards_) n += s->books.book_count();
+    return n;
+  }
+
+  // Calls fn(symbol, const OB&) for every book, shard by shard
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    for (const auto& s : shards_)
+      s->books.for_each([&](core::SymbolTable::SymbolId id, const OB& ob) { fn(s->symtab.view(id), ob); });
+  }
+
+private:
+  static constexpr size_t QUEUE_CAPACITY = 1u << 16;
+  static constexpr size_t BULK = 64;               // messages per split push / worker pop
+  static constexpr uint64_t PUBLISH_EVERY = 4096;  // messages between progress updates
+  static constexpr uint64_t FINISHED = ~0ull;
+
+  struct Message {
+    const char* data;
+    uint64_t seq;
+  };
+
+  struct LocateState { // best prices last reported for a stock
+    OB* book;
+    uint32_t bid;
+    uint32_t ask;
+  };
+
+  struct Shard {
+    explicit Shard(const typename core::BookRouter<OB>::Factory& make)
+        : symtab(), decoder(symtab), books(make), in(QUEUE_CAPACITY), out(QUEUE_CAPACITY) {}
+
+    core::SymbolTable symtab;
+    itch::Decoder decoder;
+    core::BookRouter<OB> books;
+    SpscQueue<Message> in;
+    SpscQueue<ReplayOutput> out;
+    alignas(64) std::atomic<uint64_t> watermark{0}; // every output below this seq is in `out`
+    uint64_t events{0};
+    // Splitter side
+    alignas(64) Message pending[BULK];
+    size_t pending_count{0};
+  };
+
+  void flush(Shard& s) {
+    size_t off = 0;
+    while (off < s.pending_count) {
+      off += s.in.push_bulk(s.pending + off, s.pending_count - off);
+      if (off < s.pending_count) std::this_thread::yield(); // worker is behind
+    }
+    s.pending_count = 0;
+  }
+
+  // Progress: every message below `seq` has been handed to its shard
+  void publish(uint64_t seq) {
+    for (auto& s : shards_) flush(*s);
+    dispatched_.store(seq, std::memory_order_release);
+  }
+
+  size_t split(const char* data, size_t size, itch::Framing framing, core::MappedFile* file) {
+    const size_t n = shards_.size();
+    size_t off = 0;
+    uint64_t seq = 0;
+    while (true) {
+      const char* p;
+      size_t step;
+      if (framing == itch::Framing::Bare) {
+        if (off + sizeof(CommonHeader) > size) break;
+        p = data + off;
+        step = itch_message_size(*p);
+        if (step == 0 || off + step > size) break;
+      } else {
+        if (off + 2 >= size) break;
+        const uint32_t len = (static_cast<uint8_t>(data[off]) << 8) | static_cast<uint8_t>(data[off + 1]);
+        if (len == 0 || off + 2 + len > size) break;
+        p = data + off + 2;
+        if (len < itch_message_size(*p)) break; // shorter than its type: corrupt
+        step = 2 + len;
+      }
+
+      if (itch_is_order_message(*p)) {
+        Shard& s = *shards_[itch::MessageView(p).stock_locate() % n];
+        s.pending[s.pending_count++] = Message{p, seq};
+        if (s.pending_count == BULK) flush(s);
+      }
+      off += step;
+      if ((++seq & (PUBLISH_EVERY - 1)) == 0) {
+        publish(seq);
+        if (file) file->advance(off);
+      }
+    }
+    publish(seq);
+    messages_ = seq;
+    done_.store(true, std::memory_order_release);
+    return off;
+  }
+
+  void work(size_t index) {
+    pin(index);
+    Shard& s = *shards_[index];
+    Message batch[BULK];
+    auto block = std::make_unique<core::EventBlock>();
+    std::vector<LocateState> quotes(sink_ ? 65536 : 0, LocateState{nullptr, 0, 0});
+    while (true) {
+      // Loaded before popping: an empty queue then means this shard has
+      // consumed everything the splitter had handed out by `dispatched`
+      const bool finished = done_.load(std::memory_order_acquire);
+      const uint64_t dispatched = dispatched_.load(std::memory_order_acquire);
+      const size_t got = s.in.pop_bulk(batch, BULK);
+      if (got == 0) {
+        if (finished) break;
+        if (dispatched > s.watermark.load(std::memory_order_relaxed))
+          s.watermark.store(dispatched, std::memory_order_release);
+        std::this_thread::yield();
+        continue;
+      }
+      if (sink_) {
+        for (size_t i = 0; i < got; ++i) apply_reporting(s, batch[i], quotes);
+        s.watermark.store(batch[got - 1].seq + 1, std::memory_order_release);
+      } else {
+        for (size_t i = 0; i < got; ++i) {
+          const char* p = batch[i].data;
+          if (!s.decoder.decode_into(p, static_cast<size_t>(end_ - p), *block)) {
+            drain(s, *block);
+            s.decoder.decode_into(p, static_cast<size_t>(end_ - p), *block);
+          }
+        }
+        drain(s, *block);
+      }
+    }
+    s.watermark.store(FINISHED, std::memory_order_release);
+  }
+
+  void drain(Shard& s, core::EventBlock& block) {
+    s.books.apply(block);
+    s.events += block.events();
+    block.clear();
+  }
+
+  // One message at a time so every trade and quote change keeps its seq
+  void apply_reporting(Shard& s, const Message& m, std::vector<LocateState>& quotes) {
+    const auto res = s.decoder.decode_one(m.data, static_cast<size_t>(end_ - m.data));
+    if (!res.event) return;
+    s.books.apply(*res.event);
+    ++s.events;
+
+    const uint16_t locate = itch::MessageView(m.data).stock_locate();
+    LocateState& q = quotes[locate];
+    if (const auto* add = std::get_if<core::AddEvt>(&*res.event)) {
+      if (!q.book) q.book = s.books.find(add->sym_id);
+    } else if (const auto* exec = std::get_if<core::ExecEvt>(&*res.event)) {
+      emit(s, ReplayOutput{m.seq, exec->id, exec->exec_qty, 0, 0, locate, ReplayOutput::Trade});
+    }
+    if (!q.book) return;
+    const uint32_t bid = core::best_bid(*q.book);
+    const uint32_t ask = core::best_ask(*q.book);
+    if (bid != q.bid || ask != q.ask) {
+      q.bid = bid;
+      q.ask = ask;
+      emit(s, ReplayOutput{m.seq, 0, 0, bid, ask, locate, ReplayOutput::Quote});
+    }
+  }
+
+  void emit(Shard& s, const ReplayOutput& o) {
+    while (!s.out.push(o)) std::this_thread::yield(); // merge thread is behind
+  }
+
+  // Repeatedly hands the sink the lowest-seq output once no shard can still
+  // produce a lower one: each shard either has an output staged or has
+  // published a watermark past the candidate.
+  void merge() {
+    const size_t n = shards_.size();
+    std::vector<ReplayOutput> staged(n);
+    std::vector<bool> has(n, false);
+    while (true) {
+      size_t best = n;
+      bool blocked = false;
+      bool all_finished = true;
+      for (size_t i = 0; i < n; ++i) {
+        if (!has[i]) has[i] = shards_[i]->out.pop(staged[i]);
+        if (has[i] && (best == n || staged[i].seq < staged[best].seq)) best = i;
+      }
+      for (size_t i = 0; i < n; ++i) {
+        if (has[i]) { all_finished = false; continue; }
+        // Watermark first, then look again: anything pushed before the
+        // watermark was stored is visible to this pop
+        const uint64_t w = shards_[i]->watermark.load(std::memory_order_acquire);
+        if ((has[i] = shards_[i]->out.pop(staged[i]))) {
+          all_finished = false;
+          if (best == n || staged[i].seq < staged[best].seq) best = i;
+          continue;
+        }
+        if (w != FINISHED) all_finished = false;
+        if (best != n && w <= staged[best].seq) blocked = true;
+      }
+      if (best == n) {
+        if (all_finished) return;
+        std::this_thread::yield();
+        continue;
+      }
+      if (blocked) { std::this_thread::yield(); continue; }
+      sink_(staged[best]);
+      has[best] = false;
+    }
+  }
+
+  void pin(size_t index) const {
+    if (first_cpu_ < 0) return;
+    const unsigned cpus = std::thread::hardware_concurrency();
+    perf::pin_current_thread(static_cast<int>((static_cast<unsigned>(first_cpu_) + index) % (cpus ? cpus : 1)));
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  int first_cpu_;
+  Sink sink_;
+  const char* end_{nullptr};
+  uint64_t messages_{0};
+  alignas(64) std::atomic<uint64_t> dispatched_{0};
+  std::atomic<bool> done_{false};
+};
+
+} // namespace replay
+
+#endif // REPLAY_SHARDED_REPLAY_HPP
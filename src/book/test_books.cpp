@@ -0,0 +1,183 @@
+#include "book/basic_order_book.hpp"
+#include "core/apply.hpp"
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Differential test: random add/exec/cancel/delete/replace sequences are
+// applied to every book deployment and to UltraOrderBook, and each is
+// compared against ReferenceBook (std::map levels, std::unordered_map index).
+// The mid price jumps every few thousand events so the dense windows
+// re-centre, and some orders rest far from the touch in the sparse levels.
+// Books are cleared and reused between seeds, so clear() is covered too.
+
+namespace {
+
+constexpr int SEEDS = 6;
+constexpr int EVENTS_PER_SEED = 200000;
+constexpr int JUMP_EVERY = 20000;     // Events between mid-price jumps
+constexpr uint32_t JUMP_TICKS = 30000; // Beyond half a dense window
+constexpr int DEPTH_CHECK_EVERY = 97;
+constexpr uint32_t WALK_DEPTH = 100;
+
+using Levels = std::vector<uint64_t>;
+
+// Price, quantity and order count of the top WALK_DEPTH levels per side
+template <typename Book> Levels depth(const Book& b) {
+    Levels v;
+    auto put = [&](uint32_t price, uint32_t qty, uint32_t count) {
+        v.insert(v.end(), {price, qty, count});
+    };
+    b.walkBids(WALK_DEPTH, put);
+    v.push_back(0);
+    b.walkAsks(WALK_DEPTH, put);
+    return v;
+}
+
+Levels depth(const UltraOrderBook& b) {
+    Levels v;
+    auto put = [&](uint32_t price, uint32_t qty, uint32_t count) {
+        v.insert(v.end(), {price, qty, count});
+    };
+    b.ultra_walkBids(WALK_DEPTH, put);
+    v.push_back(0);
+    b.ultra_walkAsks(WALK_DEPTH, put);
+    return v;
+}
+
+struct Books {
+    UltraOrderBook ultra;
+    book::L1Book l1;
+    book::L2Book l2;
+    book::FifoBook fifo;
+    book::ReferenceBook reference;
+
+    void apply(const core::ItchEvent& e) {
+        core::apply(e, ultra);
+        core::apply(e, l1);
+        core::apply(e, l2);
+        core::apply(e, fifo);
+        core::apply(e, reference);
+    }
+
+    void clear() {
+        ultra.reset_pool();
+        l1.clear();
+        l2.clear();
+        fifo.clear();
+        reference.clear();
+    }
+};
+
+struct Mismatches {
+    uint64_t touch{0};
+    uint64_t depth{0};
+    uint64_t queue{0};
+    uint64_t live{0};
+
+    uint64_t total() const { return touch + depth + queue + live; }
+};
+
+// Best prices and quantities of every book against the reference
+bool touch_matches(const Books& b) {
+    const book::ReferenceBook& r = b.reference;
+    const uint32_t bid = r.getBestBid(), ask = r.getBestAsk();
+    const uint32_t bid_qty = r.getBestBidQuantity(), ask_qty = r.getBestAskQuantity();
+    return b.ultra.ultra_getBestBid() == bid && b.ultra.ultra_getBestAsk() == ask &&
+           b.ultra.ultra_getBestBidQuantity() == bid_qty && b.ultra.ultra_getBestAskQuantity() == ask_qty &&
+           b.l1.getBestBid() == bid && b.l1.getBestAsk() == ask &&
+           b.l1.getBestBidQuantity() == bid_qty && b.l1.getBestAskQuantity() == ask_qty &&
+           b.l2.getBestBid() == bid && b.l2.getBestAsk() == ask &&
+           b.fifo.getBestBid() == bid && b.fifo.getBestAsk() == ask;
+}
+
+bool live_matches(const Books& b) {
+    const uint32_t live = b.reference.liveOrders();
+    return b.ultra.ultra_liveOrders() == live && b.l1.liveOrders() == live && b.l2.liveOrders() == live &&
+           b.fifo.liveOrders() == live;
+}
+
+Mismatches run_seed(Books& books, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> live;
+    uint64_t next_id = 1;
+    uint32_t mid = 5000000;
+    Mismatches bad;
+
+    for (int i = 0; i < EVENTS_PER_SEED; ++i) {
+        if (i > 0 && i % JUMP_EVERY == 0) mid = rng() % 2 ? mid + JUMP_TICKS : mid - JUMP_TICKS;
+
+        core::ItchEvent e;
+        const uint32_t op = rng() % 10;
+        if (live.empty() || op < 4) {
+            const char side = rng() % 2 ? 'B' : 'S';
+            uint32_t price = side == 'B' ? mid - uint32_t(rng() % 200) : mid + 1 + uint32_t(rng() % 200);
+            if (rng() % 50 == 0) { // Deep in the book, outside the dense window
+                const uint32_t away = 20000 + uint32_t(rng() % 5000);
+                price = side == 'B' ? mid - away : mid + away;
+            }
+            e = core::AddEvt{next_id, side, uint32_t(1 + rng() % 500), price, 1};
+            live.push_back(next_id++);
+        } else {
+            const size_t k = rng() % live.size();
+            const uint64_t id = live[k];
+            if (op < 6) {
+                e = core::ExecEvt{id, uint32_t(1 + rng() % 300)};
+            } else if (op < 7) {
+                e = core::CancelEvt{id, uint32_t(1 + rng() % 300)};
+            } else if (op < 9) {
+                e = core::DeleteEvt{id};
+                live[k] = live.back();
+                live.pop_back();
+            } else {
+                e = core::ReplaceEvt{id, next_id, uint32_t(1 + rng() % 500), mid - 100 + uint32_t(rng() % 200), 1};
+                live[k] = next_id++;
+            }
+        }
+        books.apply(e);
+
+        if (!touch_matches(books)) ++bad.touch;
+        if (i % DEPTH_CHECK_EVERY != 0) continue;
+
+        const Levels expected = depth(books.reference);
+        if (depth(books.ultra) != expected || depth(books.l2) != expected || depth(books.fifo) != expected)
+            ++bad.depth;
+        if (!live_matches(books)) ++bad.live;
+        if (!live.empty()) {
+            // Executions and cancels can take an order out; unknown ids give -1 everywhere
+            const uint64_t id = live[rng() % live.size()];
+            const int64_t pos = books.reference.queuePosition(id);
+            if (books.fifo.queuePosition(id) != pos || books.ultra.ultra_queuePosition(id) != pos) ++bad.queue;
+        }
+    }
+    if (!live_matches(books)) ++bad.live;
+    return bad;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== ORDER BOOK DIFFERENTIAL TEST ===" << std::endl;
+    std::cout << "UltraOrderBook, L1Book, L2Book and FifoBook against ReferenceBook, " << SEEDS << " seeds x "
+              << EVENTS_PER_SEED << " events" << std::endl;
+
+    auto books = std::make_unique<Books>();
+    uint64_t failures = 0;
+    for (uint64_t seed = 1; seed <= SEEDS; ++seed) {
+        books->clear();
+        const uint64_t recenters = books->ultra.ultra_windowRecenters();
+        const Mismatches bad = run_seed(*books, seed);
+        failures += bad.total();
+        std::cout << "Seed " << seed << ": live=" << books->reference.liveOrders()
+                  << " recenters=" << books->ultra.ultra_windowRecenters() - recenters << " | Touch: "
+                  << (bad.touch ? "NO" : "YES") << " | Depth: " << (bad.depth ? "NO" : "YES")
+                  << " | Queues: " << (bad.queue ? "NO" : "YES") << " | Live orders: " << (bad.live ? "NO" : "YES")
+                  << std::endl;
+    }
+
+    std::cout << "All books match reference: " << (failures == 0 ? "YES" : "NO") << std::endl;
+    std::cout << "\n=== ORDER BOOK DIFFERENTIAL TEST COMPLETED ===" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,310 @@
+#include "fix/fix_event_loop.hpp"
+#include "fix/fix_session.hpp"
+#include "perf/cpu.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fix {
+
+namespace {
+
+constexpr int MAX_EVENTS = 64;
+constexpr uint32_t READ_EVENTS = EPOLLIN | EPOLLRDHUP;
+
+} // namespace
+
+FixEventLoop::FixEventLoop(int cpu) : cpu_(cpu) {}
+
+FixEventLoop::~FixEventLoop() {
+    stop();
+}
+
+bool FixEventLoop::start() {
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        perror("epoll");
+        running_ = false;
+        stop();
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    if (listen_fd_ >= 0) {
+        ev.data.fd = listen_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    }
+
+    wheel_second_ = now_seconds();
+    thread_ = std::thread(&FixEventLoop::run, this);
+    return true;
+}
+
+void FixEventLoop::stop() {
+    running_ = false;
+    if (wake_fd_ >= 0) {
+        const uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = write(wake_fd_, &one, sizeof(one));
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+void FixEventLoop::watch_listener(int listen_fd, std::function<void(int client_fd)> on_accept) {
+    listen_fd_ = listen_fd;
+    on_accept_ = std::move(on_accept);
+}
+
+void FixEventLoop::adopt(std::shared_ptr<FixSession> session, int fd) {
+    session->attach(fd, this);
+    if (in_loop_thread()) {
+        add_session(std::move(session));
+        return;
+    }
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        wake = pending_adopt_.empty() && pending_flush_.empty();
+        pending_adopt_.push_back(std::move(session));
+    }
+    if (wake) {
+        const uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = write(wake_fd_, &one, sizeof(one));
+    }
+}
+
+void FixEventLoop::request_flush(int fd) {
+    if (in_loop_thread()) {
+        dirty_.push_back(fd);
+        return;
+    }
+
+    // Only the first request of a round pays for the wakeup
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        wake = pending_adopt_.empty() && pending_flush_.empty();
+        pending_flush_.push_back(fd);
+    }
+    if (wake) {
+        const uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = write(wake_fd_, &one, sizeof(one));
+    }
+}
+
+void FixEventLoop::run() {
+    thread_id_.store(std::this_thread::get_id());
+    if (cpu_ >= 0 && !perf::pin_current_thread(cpu_)) {
+        std::cerr << "[FIX] Could not pin event loop to CPU " << cpu_ << std::endl;
+    }
+
+    epoll_event events[MAX_EVENTS];
+    while (running_.load(std::memory_order_acquire)) {
+        // Sleep at most until the next second, when timers are due
+        const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+        const int timeout_ms =
+            1000 - static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000);
+
+        const int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                uint64_t count;
+                [[maybe_unused]] ssize_t r = read(wake_fd_, &count, sizeof(count));
+                continue;
+            }
+            if (fd == listen_fd_) {
+                accept_clients();
+                continue;
+            }
+
+            auto it = sessions_.find(fd);
+            if (it == sessions_.end()) {
+                continue;
+            }
+            // Read first even on hangup, so nothing the peer sent is lost
+            if ((events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && !it->second->on_readable()) {
+                close_session(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flush(fd);
+            }
+        }
+
+        drain_pending();
+        run_timers();
+        flush_dirty();
+    }
+
+    // Send what is queued, then close everything
+    drain_pending();
+    flush_dirty();
+    while (!sessions_.empty()) {
+        close_session(sessions_.begin()->first);
+    }
+    thread_id_.store(std::thread::id());
+}
+
+void FixEventLoop::drain_pending() {
+    std::vector<std::shared_ptr<FixSession>> adopted;
+    std::vector<int> flushes;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        adopted.swap(pending_adopt_);
+        flushes.swap(pending_flush_);
+    }
+
+    // Sessions first: their pending flushes may already be queued
+    for (auto& session : adopted) {
+        add_session(std::move(session));
+    }
+    dirty_.insert(dirty_.end(), flushes.begin(), flushes.end());
+}
+
+void FixEventLoop::accept_clients() {
+    while (true) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "[FIX] Accept failed" << std::endl;
+            }
+            return;
+        }
+        if (on_accept_) {
+            on_accept_(fd);
+        } else {
+            close(fd);
+        }
+    }
+}
+
+void FixEventLoop::add_session(std::shared_ptr<FixSession> session) {
+    const int fd = session->socket_fd_;
+    epoll_event ev{};
+    ev.events = READ_EVENTS;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl");
+        session->on_closed();
+        return;
+    }
+
+    session->loop_generation_ = next_generation_++;
+    schedule(fd, session->loop_generation_, 1);
+    sessions_[fd] = std::move(session);
+    session_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FixEventLoop::close_session(int fd) {
+    auto it = sessions_.find(fd);
+    if (it == sessions_.end()) {
+        return;
+    }
+
+    // Removed before the socket is closed and its number can be reused
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    std::shared_ptr<FixSession> session = std::move(it->second);
+    sessions_.erase(it);
+    session_count_.fetch_sub(1, std::memory_order_relaxed);
+    session->on_closed();
+}
+
+void FixEventLoop::flush(int fd) {
+    auto it = sessions_.find(fd);
+    if (it == sessions_.end()) {
+        return;
+    }
+
+    bool blocked = false;
+    if (!it->second->flush_output(blocked)) {
+        close_session(fd);
+        return;
+    }
+    update_interest(*it->second, blocked);
+}
+
+void FixEventLoop::flush_dirty() {
+    // One write per session for everything queued during the batch
+    for (size_t i = 0; i < dirty_.size(); ++i) {
+        flush(dirty_[i]);
+    }
+    dirty_.clear();
+}
+
+void FixEventLoop::update_interest(FixSession& session, bool want_write) {
+    if (session.want_write_ == want_write) {
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = READ_EVENTS | (want_write ? uint32_t(EPOLLOUT) : 0u);
+    ev.data.fd = session.socket_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, session.socket_fd_, &ev);
+    session.want_write_ = want_write;
+    if (want_write) {
+        write_stalls_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FixEventLoop::schedule(int fd, uint64_t generation, uint32_t delay_s) {
+    delay_s = std::min<uint32_t>(std::max<uint32_t>(delay_s, 1), WHEEL_SLOTS - 1);
+    wheel_[(wheel_second_ + delay_s) % WHEEL_SLOTS].push_back(TimerEntry{fd, generation});
+}
+
+void FixEventLoop::run_timers() {
+    const uint64_t now = now_seconds();
+    std::vector<TimerEntry> due;
+    while (wheel_second_ < now) {
+        ++wheel_second_;
+        due.clear();
+        due.swap(wheel_[wheel_second_ % WHEEL_SLOTS]);
+
+        for (const TimerEntry& entry : due) {
+            auto it = sessions_.find(entry.fd);
+            if (it == sessions_.end() || it->second->loop_generation_ != entry.generation) {
+                continue; // Closed since it was scheduled
+            }
+            const int next = it->second->on_timer();
+            if (next < 0) {
+                close_session(entry.fd);
+            } else {
+                schedule(entry.fd, entry.generation, static_cast<uint32_t>(next));
+            }
+        }
+    }
+}
+
+uint64_t FixEventLoop::now_seconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace fix
@@ -7,11 +7,16 @@ namespace fix {
 FixGateway::FixGateway(matching::SymbolManager& symbol_manager, 
                        matching::MatchingEngine& matching_engine,
                        market_data::MarketDataPublisher& market_data_publisher,
-                       int port)
+                       int port,
+                       int io_cpu)
     : symbol_manager_(symbol_manager), 
       matching_engine_(matching_engine),
       market_data_publisher_(market_data_publisher),
-      port_(port) {
+      port_(port),
+      io_cpu_(io_cpu) {
+    
+    orders_.reserve(1 << 16);
+    fill_scratch_.reserve(64);
     
     // Set up fill callback from matching engine
     matching_engine_.set_fill_callback([this](const matching::Fill& fill) {
@@ -27,14 +32,20 @@ bool FixGateway::start() {
     std::cout << "[GATEWAY] Starting FIX Gateway on port " << port_ << std::endl;
     
     // Create and start FIX server
-    fix_server_ = std::make_unique<FixServer>(port_);
+    // One I/O thread for every session: the matching engine is not
+    // thread-safe, and the handlers call it from that thread
+    FixServerConfig config;
+    config.port = port_;
+    config.loops = 1;
+    config.first_cpu = io_cpu_;
+    fix_server_ = std::make_unique<FixServer>(config);
     
     // Set callbacks
     fix_server_->set_new_session_callback([this](std::shared_ptr<FixSession> session) {
         handle_new_session(session);
     });
     
-    fix_server_->set_message_callback([this](FixSession* session, const FixMessage& message) {
+    fix_server_->set_view_callback([this](FixSession* session, const FixView& message) {
         handle_fix_message(session, message);
     });
     
@@ -53,10 +64,13 @@ void FixGateway::stop() {
         fix_server_.reset();
     }
     
-    // Clear order tracking
-    std::lock_guard<std::mutex> lock(orders_mutex_);
-    client_orders_.clear();
-    engine_to_client_orders_.clear();
+    // Clear order tracking; the I/O thread has stopped
+    orders_.clear();
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions_.clear();
+        session_handles_.clear();
+    }
     
     std::cout << "[GATEWAY] FIX Gateway stopped" << std::endl;
 }
@@ -78,11 +92,11 @@ void FixGateway::reset_stats() {
 std::vector<std::string> FixGateway::get_active_session_ids() const {
     std::lock_guard<std::mutex> lock(sessions_mutex_);
     std::vector<std::string> session_ids;
-    session_ids.reserve(active_sessions_.size());
+    session_ids.reserve(sessions_.size());
     
-    for (const auto& [id, session] : active_sessions_) {
-        if (session && session->is_connected()) {
-            session_ids.push_back(id);
+    for (const auto& entry : sessions_) {
+        if (entry.session && entry.session->is_connected()) {
+            session_ids.push_back(entry.id);
         }
     }
     
@@ -94,32 +108,24 @@ std::vector<std::string> FixGateway::get_active_session_ids() const {
 void FixGateway::handle_new_session(std::shared_ptr<FixSession> session) {
     std::cout << "[GATEWAY] New FIX session connected" << std::endl;
     
-    std::string session_id = session_key(session.get());
-    
+    size_t session_count;
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
-        active_sessions_[session_id] = session;
+        const uint32_t handle = static_cast<uint32_t>(sessions_.size());
+        sessions_.push_back(SessionEntry{session_key(session.get()), session, {}});
+        session_handles_[session.get()] = handle;   // A reused address maps to the new session
+        session_count = sessions_.size();
     }
     
     {
         std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.active_sessions = active_sessions_.size();
+        stats_.active_sessions = session_count;
     }
 }
 
-void FixGateway::handle_fix_message(FixSession* session, const FixMessage& message) {
-    auto msg_type = message.get_msg_type();
-    if (!msg_type) {
-        std::cerr << "[GATEWAY] Received message without message type" << std::endl;
-        return;
-    }
-    
-    std::cout << "[GATEWAY] Received FIX message type: " << *msg_type << std::endl;
-    
-    switch (static_cast<MsgType>(*msg_type)) {
-        case MsgType::LOGON:
-            handle_logon(session, message);
-            break;
+void FixGateway::handle_fix_message(FixSession* session, const FixView& message) {
+    const char msg_type = message.msg_type();
+    switch (static_cast<MsgType>(msg_type)) {
         case MsgType::NEW_ORDER_SINGLE:
             handle_new_order_single(session, message);
             break;
@@ -130,141 +136,149 @@ void FixGateway::handle_fix_message(FixSession* session, const FixMessage& messa
             handle_market_data_request(session, message);
             break;
         default:
-            std::cout << "[GATEWAY] Unhandled message type: " << *msg_type << std::endl;
+            std::cout << "[GATEWAY] Unhandled message type: " << msg_type << std::endl;
             break;
     }
 }
 
-void FixGateway::handle_logon(FixSession* session, const FixMessage& message) {
-    std::cout << "[GATEWAY] Processing logon for session" << std::endl;
+void FixGateway::handle_new_order_single(FixSession* session, const FixView& message) {
+    MEASURE_LATENCY(order_latency_);
     
-    // Send logon response
-    auto logon_response = FixMessageBuilder::create_logon(
-        "GATEWAY", session->get_sender_comp_id(), session->get_next_outgoing_seq_num());
-    
-    session->send_message(logon_response);
-    
-    std::cout << "[GATEWAY] Logon successful for session" << std::endl;
-}
-
-void FixGateway::handle_new_order_single(FixSession* session, const FixMessage& message) {
-    std::cout << "[GATEWAY] Processing new order single" << std::endl;
-    
-    update_order_stats(false); // Will be updated to true if accepted
-    
-    auto cl_ord_id = message.get_field(FixTag::ClOrdID);
-    if (!cl_ord_id) {
+    const std::string_view cl_ord_id = message.get(FixTag::ClOrdID);
+    if (cl_ord_id.empty()) {
+        update_order_stats(false);
         send_order_reject(session, "UNKNOWN", "Missing ClOrdID");
         return;
     }
     
-    std::string error_msg = process_new_order(session, message);
+    uint32_t handle;
+    if (!find_session(session, handle)) {
+        update_order_stats(false);
+        send_order_reject(session, cl_ord_id, "Unknown session");
+        return;
+    }
+    
+    std::string error_msg = process_new_order(handle, message);
     
+    update_order_stats(error_msg.empty());
     if (!error_msg.empty()) {
-        send_order_reject(session, *cl_ord_id, error_msg);
-    } else {
-        std::cout << "[GATEWAY] Order " << *cl_ord_id << " accepted and forwarded to matching engine" << std::endl;
-        update_order_stats(true);
+        send_order_reject(session, cl_ord_id, error_msg);
     }
 }
 
-void FixGateway::handle_order_cancel_request(FixSession* session, const FixMessage& message) {
+void FixGateway::handle_order_cancel_request(FixSession* session, const FixView& message) {
     std::cout << "[GATEWAY] Order cancel request - not implemented yet" << std::endl;
     // TODO: Implement order cancellation
 }
 
-void FixGateway::handle_market_data_request(FixSession* session, const FixMessage& message) {
+void FixGateway::handle_market_data_request(FixSession* session, const FixView& message) {
     std::cout << "[GATEWAY] Market data request - not implemented yet" << std::endl;
     // TODO: Implement market data subscription
 }
 
-std::string FixGateway::process_new_order(FixSession* session, const FixMessage& message) {
-    // Extract required fields
-    auto cl_ord_id = message.get_field(FixTag::ClOrdID);
-    auto symbol_name = message.get_field(FixTag::Symbol);
-    auto side_char = message.get_field_as<char>(FixTag::Side);
-    auto quantity = message.get_field_as<double>(FixTag::OrderQty);
-    auto ord_type_char = message.get_field_as<char>(FixTag::OrdType);
-    
-    if (!cl_ord_id || !symbol_name || !side_char || !quantity || !ord_type_char) {
+std::string FixGateway::process_new_order(uint32_t session, const FixView& message) {
+    // Extract required fields. Quantities may be sent as decimals
+    // ("100.000000"), so they are read like prices and truncated.
+    const std::string_view cl_ord_id = message.get(FixTag::ClOrdID);
+    const std::string_view symbol_name = message.get(FixTag::Symbol);
+    const char side_char = message.get_char(FixTag::Side);
+    const char ord_type_char = message.get_char(FixTag::OrdType);
+    uint64_t quantity = 0;
+    
+    if (cl_ord_id.empty() || symbol_name.empty() || !side_char || !ord_type_char ||
+        !message.has(FixTag::OrderQty)) {
         return "Missing required order fields";
     }
     
-    if (*quantity <= 0) {
+    if (!message.get_price(FixTag::OrderQty, quantity) || quantity / 10000 == 0 || quantity / 10000 > UINT32_MAX) {
         return "Invalid quantity";
     }
+    quantity /= 10000;
     
     // Convert FIX types to engine types
-    fix::Side fix_side = static_cast<fix::Side>(*side_char);
-    fix::OrdType fix_ord_type = static_cast<fix::OrdType>(*ord_type_char);
+    fix::Side fix_side = static_cast<fix::Side>(side_char);
+    fix::OrdType fix_ord_type = static_cast<fix::OrdType>(ord_type_char);
     
     auto engine_side = FixConverter::convert_side(fix_side);
     auto engine_ord_type = FixConverter::convert_order_type(fix_ord_type);
     
     // Resolve symbol
-    matching::SymbolId symbol_id = resolve_symbol(*symbol_name);
+    matching::SymbolId symbol_id = resolve_symbol(symbol_name);
     if (symbol_id == 0) {
-        return "Unknown symbol: " + *symbol_name;
+        return "Unknown symbol: " + std::string(symbol_name);
     }
     
     // Get price for limit orders
-    double price = 0.0;
+    uint64_t price = 0;
     if (fix_ord_type == fix::OrdType::LIMIT) {
-        auto price_field = message.get_field_as<double>(FixTag::Price);
-        if (!price_field || *price_field <= 0) {
+        if (!message.get_price(FixTag::Price, price) || price == 0 || price > UINT32_MAX) {
             return "Invalid or missing price for limit order";
         }
-        price = *price_field;
     }
     
     // Get time in force
-    auto tif_char = message.get_field_as<char>(FixTag::TimeInForce);
-    fix::TimeInForce fix_tif = tif_char ? static_cast<fix::TimeInForce>(*tif_char) : fix::TimeInForce::DAY;
+    const char tif_char = message.get_char(FixTag::TimeInForce);
+    fix::TimeInForce fix_tif = tif_char ? static_cast<fix::TimeInForce>(tif_char) : fix::TimeInForce::DAY;
     auto engine_tif = FixConverter::convert_tif(fix_tif);
     
+    // The one string lookup: ClOrdID -> slot, for duplicate detection
+    auto [slot_it, inserted] = sessions_[session].cl_ord_ids.try_emplace(
+        std::string(cl_ord_id), static_cast<uint32_t>(orders_.size()));
+    if (!inserted) {
+        return "Duplicate ClOrdID";
+    }
+    
+    // Track the order before it is entered, so its slot exists when fills
+    // against it come back
+    ClientOrder& client_order = orders_.emplace_back();
+    client_order.cl_ord_id = slot_it->first;
+    client_order.session = session;
+    client_order.engine_order_id = ORDER_ID_BASE + slot_it->second;
+    client_order.symbol = symbol_id;
+    client_order.side = fix_side;
+    client_order.quantity = quantity;
+    client_order.creation_time = std::chrono::high_resolution_clock::now();
+    
     // Create matching engine order
     matching::Order engine_order;
-    engine_order.id = next_exec_id_++; // Use exec_id counter for order IDs
+    engine_order.id = client_order.engine_order_id;
     engine_order.symbol = symbol_id;
     engine_order.side = engine_side;
     engine_order.type = engine_ord_type;
     engine_order.tif = engine_tif;
-    engine_order.quantity = static_cast<uint32_t>(*quantity);
-    engine_order.price = static_cast<uint32_t>(price * 10000); // Convert to fixed-point
-    engine_order.timestamp = std::chrono::high_resolution_clock::now();
+    engine_order.quantity = static_cast<uint32_t>(quantity);
+    engine_order.price = static_cast<uint32_t>(price);
+    engine_order.timestamp = client_order.creation_time;
     engine_order.status = matching::OrderStatus::NEW;
     
-    // Submit to matching engine
-    auto result = matching_engine_.process_order(engine_order);
-    
-    // Track the order
-    std::lock_guard<std::mutex> lock(orders_mutex_);
-    
-    ClientOrder client_order;
-    client_order.cl_ord_id = *cl_ord_id;
-    client_order.session_id = session_key(session);
-    client_order.engine_order_id = engine_order.id;
-    client_order.symbol = symbol_id;
-    client_order.quantity = *quantity;
-    client_order.filled_quantity = result.total_filled;
-    client_order.is_active = !result.is_fully_filled();
-    client_order.creation_time = std::chrono::high_resolution_clock::now();
-    
-    client_orders_[*cl_ord_id] = client_order;
-    engine_to_client_orders_[engine_order.id] = *cl_ord_id;
-    
-    // Send execution report for new order
-    auto exec_type = FixConverter::convert_exec_type(result.final_status);
-    auto ord_status = FixConverter::convert_order_status(result.final_status);
+    // Submit to matching engine. Fills are held back until the order is
+    // acknowledged, so the client sees the ack first.
+    fill_scratch_.clear();
+    const matching::MatchSummary result = matching_engine_.process_order(
+        engine_order, [this](const matching::Fill& fill) { fill_scratch_.push_back(fill); });
     
-    send_execution_report(client_order.session_id, client_order, exec_type, ord_status);
+    if (result.final_status == matching::OrderStatus::REJECTED) {
+        client_order.is_active = false;
+        return "Rejected by matching engine";
+    }
+    send_execution_report(client_order, fix::ExecType::NEW, fix::OrdStatus::NEW);
+    
+    // Report each fill to both sides. The slab may not grow from here on,
+    // so the reference stays valid.
+    for (const matching::Fill& fill : fill_scratch_) {
+        apply_fill(client_order, fill.execution_quantity, fill.execution_price);
+        if (ClientOrder* passive = find_order(fill.passive_order_id)) {
+            apply_fill(*passive, fill.execution_quantity, fill.execution_price);
+        }
+        market_data_publisher_.publish_trade(fill);
+    }
     
-    // Send fill reports for any immediate executions
-    for (const auto& fill : result.fills) {
-        send_execution_report(client_order.session_id, client_order, 
-                            fix::ExecType::PARTIAL_FILL, 
-                            result.is_fully_filled() ? fix::OrdStatus::FILLED : fix::OrdStatus::PARTIALLY_FILLED,
-                            fill.execution_quantity, fill.execution_price / 10000.0);
+    // Whatever an IOC, FOK or market order could not fill is gone: the
+    // engine drops the remainder without resting it
+    const bool immediate = engine_tif != matching::TimeInForce::DAY || engine_ord_type == matching::OrderType::MARKET;
+    if (client_order.is_active && immediate) {
+        client_order.is_active = false;
+        send_execution_report(client_order, fix::ExecType::CANCELED, fix::OrdStatus::CANCELED);
     }
     
     // Trigger market data update
@@ -273,84 +287,73 @@ std::string FixGateway::process_new_order(FixSession* session, const FixMessage&
     return ""; // Success
 }
 
-void FixGateway::send_execution_report(const std::string& session_id, const ClientOrder& client_order,
-                                      fix::ExecType exec_type, fix::OrdStatus ord_status,
-                                      double last_shares, double last_px) {
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    auto it = active_sessions_.find(session_id);
-    if (it == active_sessions_.end() || !it->second->is_connected()) {
-        std::cerr << "[GATEWAY] Session not found for execution report: " << session_id << std::endl;
-        return;
+ClientOrder* FixGateway::find_order(matching::OrderId order_id) {
+    if (order_id < ORDER_ID_BASE || order_id - ORDER_ID_BASE >= orders_.size()) {
+        return nullptr; // Not entered through the gateway
     }
+    return &orders_[order_id - ORDER_ID_BASE];
+}
+
+void FixGateway::apply_fill(ClientOrder& client_order, matching::Quantity quantity, matching::Price price) {
+    client_order.filled_quantity += quantity;
+    client_order.filled_notional += static_cast<uint64_t>(quantity) * price;
     
-    auto session = it->second;
-    auto symbol_name = symbol_manager_.get_symbol_name(client_order.symbol);
-    if (!symbol_name) {
-        std::cerr << "[GATEWAY] Symbol name not found for ID: " << client_order.symbol << std::endl;
-        return;
+    const bool is_fully_filled = client_order.filled_quantity >= client_order.quantity;
+    if (is_fully_filled) {
+        client_order.is_active = false;
+    }
+    send_execution_report(client_order,
+                          is_fully_filled ? fix::ExecType::FILL : fix::ExecType::PARTIAL_FILL,
+                          is_fully_filled ? fix::OrdStatus::FILLED : fix::OrdStatus::PARTIALLY_FILLED,
+                          quantity, price);
+}
+
+void FixGateway::send_execution_report(const ClientOrder& client_order,
+                                      fix::ExecType exec_type, fix::OrdStatus ord_status,
+                                      uint64_t last_shares, uint64_t last_px) {
+    FixSession* session = client_order.session < sessions_.size()
+                          ? sessions_[client_order.session].session.get() : nullptr;
+    if (!session || !session->is_connected()) {
+        return; // The client has gone; the order lives on in the book
     }
     
-    // Calculate cumulative quantities and average price
-    double cum_qty = client_order.filled_quantity + last_shares;
-    double leaves_qty = client_order.quantity - cum_qty;
-    double avg_px = cum_qty > 0 ? last_px : 0.0; // Simplified avg price calculation
-    
-    fix::Side side = fix::Side::BUY; // TODO: Track side in ClientOrder
-    
-    auto exec_report = FixMessageBuilder::create_execution_report(
-        "GATEWAY", 
-        session->get_sender_comp_id(),
-        session->get_next_outgoing_seq_num(),
-        std::to_string(client_order.engine_order_id),
-        client_order.cl_ord_id,
-        generate_exec_id(),
-        exec_type,
-        ord_status,
-        *symbol_name,
-        side,
-        leaves_qty,
-        cum_qty,
-        avg_px,
-        last_shares,
-        last_px
-    );
-    
-    session->send_message(exec_report);
+    ExecReport report;
+    report.order_id = client_order.engine_order_id;
+    report.cl_ord_id = client_order.cl_ord_id;
+    report.exec_id = generate_exec_id();
+    report.exec_type = exec_type;
+    report.ord_status = ord_status;
+    report.symbol = symbol_name(client_order.symbol);
+    report.side = client_order.side;
+    report.cum_qty = client_order.filled_quantity;
+    report.leaves_qty = client_order.is_active && client_order.quantity > report.cum_qty
+                        ? client_order.quantity - report.cum_qty : 0;
+    report.avg_px = report.cum_qty > 0 ? client_order.filled_notional / report.cum_qty : 0;
+    report.last_shares = last_shares;
+    report.last_px = last_px;
+    
+    session->send_execution_report(report);
     
     {
         std::lock_guard<std::mutex> stats_lock(stats_mutex_);
         stats_.executions_sent++;
-        if (last_shares > 0) {
-            stats_.total_volume += static_cast<uint64_t>(last_shares);
-        }
+        stats_.total_volume += last_shares;
     }
-    
-    std::cout << "[GATEWAY] Sent execution report for " << client_order.cl_ord_id 
-              << ", exec_type=" << static_cast<char>(exec_type)
-              << ", status=" << static_cast<char>(ord_status) << std::endl;
 }
 
-void FixGateway::send_order_reject(FixSession* session, const std::string& cl_ord_id, const std::string& reason) {
+void FixGateway::send_order_reject(FixSession* session, std::string_view cl_ord_id, const std::string& reason) {
     std::cout << "[GATEWAY] Rejecting order " << cl_ord_id << ": " << reason << std::endl;
     
-    // Create rejection execution report
-    auto exec_report = FixMessageBuilder::create_execution_report(
-        "GATEWAY",
-        session->get_sender_comp_id(),
-        session->get_next_outgoing_seq_num(),
-        "0", // No order ID for rejected orders
-        cl_ord_id,
-        generate_exec_id(),
-        fix::ExecType::REJECTED,
-        fix::OrdStatus::REJECTED,
-        "UNKNOWN", // Symbol
-        fix::Side::BUY, // Default side
-        0, 0, 0 // No quantities for rejected order
-    );
-    
-    exec_report.add_field(FixTag::Text, reason);
-    
-    session->send_message(exec_report);
+    // Rejection execution report; no order ID or quantities
+    ExecReport report;
+    report.cl_ord_id = cl_ord_id;
+    report.exec_id = generate_exec_id();
+    report.exec_type = fix::ExecType::REJECTED;
+    report.ord_status = fix::OrdStatus::REJECTED;
+    report.symbol = "UNKNOWN";
+    report.text = reason;
+    
+    session->send_execution_report(report);
     
     {
         std::lock_guard<std::mutex> lock(stats_mutex_);
@@ -359,42 +362,21 @@ void FixGateway::send_order_reject(FixSession* session, const std::string& cl_or
 }
 
 void FixGateway::on_fill(const matching::Fill& fill) {
-    std::cout << "[GATEWAY] Received fill: order_id=" << fill.aggressive_order_id 
-              << ", qty=" << fill.execution_quantity 
-              << ", price=" << (fill.execution_price / 10000.0) << std::endl;
-    
-    std::lock_guard<std::mutex> lock(orders_mutex_);
-    
-    // Find client order
-    auto it = engine_to_client_orders_.find(fill.aggressive_order_id);
-    if (it == engine_to_client_orders_.end()) {
-        std::cerr << "[GATEWAY] Fill for unknown order: " << fill.aggressive_order_id << std::endl;
+    // Orders the gateway enters report their fills themselves; this sees
+    // fills of orders entered directly on the engine, which may hit ours
+    ClientOrder* passive = find_order(fill.passive_order_id);
+    ClientOrder* aggressive = find_order(fill.aggressive_order_id);
+    if (!passive && !aggressive) {
         return;
     }
     
-    std::string cl_ord_id = it->second;
-    auto client_it = client_orders_.find(cl_ord_id);
-    if (client_it == client_orders_.end()) {
-        std::cerr << "[GATEWAY] Client order not found: " << cl_ord_id << std::endl;
-        return;
+    if (aggressive) {
+        apply_fill(*aggressive, fill.execution_quantity, fill.execution_price);
     }
-    
-    ClientOrder& client_order = client_it->second;
-    client_order.filled_quantity += fill.execution_quantity;
-    
-    // Determine order status
-    bool is_fully_filled = (client_order.filled_quantity >= client_order.quantity);
-    fix::OrdStatus ord_status = is_fully_filled ? fix::OrdStatus::FILLED : fix::OrdStatus::PARTIALLY_FILLED;
-    fix::ExecType exec_type = is_fully_filled ? fix::ExecType::FILL : fix::ExecType::PARTIAL_FILL;
-    
-    if (is_fully_filled) {
-        client_order.is_active = false;
+    if (passive) {
+        apply_fill(*passive, fill.execution_quantity, fill.execution_price);
     }
     
-    // Send execution report
-    send_execution_report(client_order.session_id, client_order, exec_type, ord_status,
-                         fill.execution_quantity, fill.execution_price / 10000.0);
-    
     // Publish market data update
     market_data_publisher_.publish_level1_update(fill.symbol);
     
@@ -402,8 +384,8 @@ void FixGateway::on_fill(const matching::Fill& fill) {
     market_data_publisher_.publish_trade(fill);
 }
 
-std::string FixGateway::generate_exec_id() {
-    return "E" + std::to_string(next_exec_id_++);
+uint64_t FixGateway::generate_exec_id() {
+    return next_exec_id_++;
 }
 
 std::string FixGateway::session_key(FixSession* session) {
@@ -412,16 +394,43 @@ std::string FixGateway::session_key(FixSession* session) {
     return oss.str();
 }
 
-matching::SymbolId FixGateway::resolve_symbol(const std::string& symbol_name) {
-    auto symbol_id = symbol_manager_.find_symbol(symbol_name);
-    if (!symbol_id) {
+bool FixGateway::find_session(const FixSession* session, uint32_t& handle) const {
+    auto it = session_handles_.find(session);
+    if (it == session_handles_.end()) {
+        return false;
+    }
+    handle = it->second;
+    return true;
+}
+
+matching::SymbolId FixGateway::resolve_symbol(std::string_view symbol_name) {
+    const std::string name(symbol_name);
+    matching::SymbolId symbol_id = 0;
+    if (auto known = symbol_manager_.get_symbol_id(name)) {
+        symbol_id = *known;
+    } else {
         // Try to add new symbol
-        symbol_id = symbol_manager_.add_symbol(symbol_name);
+        symbol_id = symbol_manager_.add_symbol(name);
         if (symbol_id != 0) {
-            std::cout << "[GATEWAY] Added new symbol: " << symbol_name << " (ID=" << symbol_id << ")" << std::endl;
+            std::cout << "[GATEWAY] Added new symbol: " << name << " (ID=" << symbol_id << ")" << std::endl;
+        }
+    }
+    
+    // Remember the name for reports
+    if (symbol_id != 0) {
+        if (symbol_id >= symbol_names_.size()) {
+            symbol_names_.resize(symbol_id + 1);
+        }
+        if (symbol_names_[symbol_id].empty()) {
+            symbol_names_[symbol_id] = name;
         }
     }
-    return symbol_id ? symbol_id : 0;
+    return symbol_id;
+}
+
+const std::string& FixGateway::symbol_name(matching::SymbolId symbol) const {
+    static const std::string unknown = "UNKNOWN";
+    return symbol < symbol_names_.size() && !symbol_names_[symbol].empty() ? symbol_names_[symbol] : unknown;
 }
 
 void FixGateway::update_order_stats(bool accepted) {
@@ -429,8 +438,6 @@ void FixGateway::update_order_stats(bool accepted) {
     stats_.orders_received++;
     if (accepted) {
         stats_.orders_accepted++;
-    } else {
-        stats_.orders_rejected++;
     }
 }
 
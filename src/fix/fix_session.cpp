@@ -2,6 +2,8 @@
 #include <iostream>
 #include <cstring>
 #include <algorithm>
+#include <cerrno>
+#include <netinet/tcp.h>
 
 namespace fix {
 
@@ -78,11 +80,16 @@ void FixSession::disconnect() {
         return;
     }
     
+    if (loop_) {
+        // The owning loop closes the socket once it sees the shutdown
+        ::shutdown(socket_fd_, SHUT_RDWR);
+        return;
+    }
+    
     running_ = false;
     
-    // Close socket to wake up receiver
-    close(socket_fd_);
-    socket_fd_ = -1;
+    // Shut down to wake up the receiver; closing alone leaves recv() blocked
+    ::shutdown(socket_fd_, SHUT_RDWR);
     
     // Wake up sender
     queue_cv_.notify_all();
@@ -98,6 +105,9 @@ void FixSession::disconnect() {
         heartbeat_thread_.join();
     }
     
+    close(socket_fd_);
+    socket_fd_ = -1;
+    
     set_state(SessionState::DISCONNECTED);
     
     if (state_callback_) {
@@ -148,6 +158,15 @@ bool FixSession::send_message(const FixMessage& message) {
         return false;
     }
     
+    if (loop_) {
+        // Encoded here; the loop writes it out with whatever else is queued
+        FixMessage numbered = message;
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        numbered.add_field(FixTag::MsgSeqNum, outgoing_seq_num_.fetch_add(1));
+        const std::string fix_string = numbered.to_fix_string();
+        return queue_output(fix_string.data(), fix_string.length());
+    }
+    
     std::lock_guard<std::mutex> lock(queue_mutex_);
     outgoing_queue_.push(message);
     queue_cv_.notify_one();
@@ -159,17 +178,193 @@ bool FixSession::send_raw_message(const std::string& fix_string) {
         return false;
     }
     
-    ssize_t sent = send(socket_fd_, fix_string.c_str(), fix_string.length(), 0);
-    if (sent != static_cast<ssize_t>(fix_string.length())) {
-        std::cerr << "[FIX] Failed to send message: " << sent << " of " << fix_string.length() << " bytes" << std::endl;
+    if (loop_) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        return queue_output(fix_string.data(), fix_string.length());
+    }
+    
+    if (!write_all(fix_string.data(), fix_string.length())) {
+        return false;
+    }
+    
+    update_last_sent_time();
+    update_stats_sent();
+    return true;
+}
+
+bool FixSession::send_execution_report(const ExecReport& report) {
+    if (socket_fd_ == -1) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (!exec_encoder_) {
+        exec_encoder_ = std::make_unique<ExecReportEncoder>(sender_comp_id_, target_comp_id_);
+    }
+    
+    const auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string_view encoded = exec_encoder_->encode(report, static_cast<uint64_t>(outgoing_seq_num_.fetch_add(1)),
+                                                     static_cast<uint64_t>(now_ns));
+    if (loop_) {
+        return queue_output(encoded.data(), encoded.size());
+    }
+    if (!write_all(encoded.data(), encoded.size())) {
+        return false;
+    }
+    
+    update_last_sent_time();
+    update_stats_sent();
+    return true;
+}
+
+bool FixSession::write_all(const char* data, size_t length) {
+    size_t written = 0;
+    while (written < length) {
+        ssize_t sent = send(socket_fd_, data + written, length - written, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            std::cerr << "[FIX] Failed to send message: " << written << " of " << length << " bytes" << std::endl;
+            return false;
+        }
+        written += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool FixSession::queue_output(const char* data, size_t length) {
+    if (socket_fd_ == -1) {
         return false;
     }
+    if (!send_ring_->write(data, length)) {
+        // Output comes in bursts: write out what is queued before
+        // concluding the client has stopped reading
+        bool blocked = false;
+        if (!write_ring(blocked) || !send_ring_->write(data, length)) {
+            std::cerr << "[FIX] Send buffer full, disconnecting slow client" << std::endl;
+            ::shutdown(socket_fd_, SHUT_RDWR);
+            return false;
+        }
+    }
     
     update_last_sent_time();
     update_stats_sent();
+    if (!flush_requested_.exchange(true, std::memory_order_acq_rel)) {
+        loop_->request_flush(socket_fd_);
+    }
     return true;
 }
 
+// Event loop mode
+
+void FixSession::attach(int fd, FixEventLoop* loop) {
+    recv_buffer_ = std::make_unique<RecvBuffer>(FixEventLoop::RECV_BUFFER);
+    send_ring_ = std::make_unique<SendRing>(FixEventLoop::SEND_RING);
+    socket_fd_ = fd;
+    loop_ = loop;
+    running_ = true;
+    update_last_received_time();
+    update_last_sent_time();
+    set_state(SessionState::CONNECTED);
+}
+
+bool FixSession::on_readable() {
+    // A few reads at most, so one busy client cannot hold up the others;
+    // the socket stays readable and is picked up again next round
+    for (int reads = 0; reads < 4; ++reads) {
+        if (!recv_buffer_->reserve(4096)) {
+            std::cerr << "[FIX] Message larger than the receive buffer" << std::endl;
+            return false;
+        }
+        const size_t space = recv_buffer_->writable();
+        ssize_t received = recv(socket_fd_, recv_buffer_->write_ptr(), space, 0);
+        if (received > 0) {
+            recv_buffer_->commit(static_cast<size_t>(received));
+            recv_buffer_->consume(process_messages(recv_buffer_->read_ptr(), recv_buffer_->readable()));
+            if (static_cast<size_t>(received) < space) {
+                break; // Drained
+            }
+            continue;
+        }
+        if (received == 0) {
+            return false; // Peer closed
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return true;
+}
+
+bool FixSession::flush_output(bool& blocked) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    flush_requested_.store(false, std::memory_order_release);
+    return write_ring(blocked);
+}
+
+bool FixSession::write_ring(bool& blocked) {
+    blocked = false;
+    while (!send_ring_->empty()) {
+        // writev of the ring's segments, as sendmsg for MSG_NOSIGNAL
+        iovec iov[2];
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = send_ring_->segments(iov);
+        ssize_t sent = sendmsg(socket_fd_, &msg, MSG_NOSIGNAL);
+        if (sent > 0) {
+            send_ring_->consume(static_cast<size_t>(sent));
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            blocked = true; // The loop waits for EPOLLOUT
+            return true;
+        }
+        return false;
+    }
+    return true;
+}
+
+int FixSession::on_timer() {
+    auto now = std::chrono::steady_clock::now();
+    int since_sent = static_cast<int>(std::chrono::duration_cast<std::chrono::seconds>(now - last_sent_time_).count());
+    const int since_received = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::seconds>(now - last_received_time_).count());
+    
+    // Same thresholds as heartbeat_loop()
+    if (since_received >= heartbeat_interval_ * 3) {
+        std::cerr << "[FIX] Session timeout, disconnecting" << std::endl;
+        set_state(SessionState::ERROR);
+        return -1;
+    }
+    if (since_sent >= heartbeat_interval_) {
+        send_heartbeat();
+        since_sent = 0;
+    }
+    if (since_received >= heartbeat_interval_ * 2) {
+        std::cout << "[FIX] Heartbeat timeout, sending test request" << std::endl;
+        send_test_request();
+        return std::max(1, std::min(heartbeat_interval_, heartbeat_interval_ * 3 - since_received));
+    }
+    return std::max(1, std::min(heartbeat_interval_ - since_sent, heartbeat_interval_ * 2 - since_received));
+}
+
+void FixSession::on_closed() {
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+    running_ = false;
+    set_state(SessionState::DISCONNECTED);
+    
+    if (state_callback_) {
+        state_callback_(this, false);
+    }
+}
+
 SessionState FixSession::get_state() const {
     std::lock_guard<std::mutex> lock(state_mutex_);
     return state_;
@@ -229,11 +424,14 @@ void FixSession::sender_loop() {
             outgoing_queue_.pop();
             lock.unlock();
             
-            // Set sequence number
-            message.add_field(FixTag::MsgSeqNum, outgoing_seq_num_.fetch_add(1));
-            
-            std::string fix_string = message.to_fix_string();
-            if (!send_raw_message(fix_string)) {
+            // Set sequence number; reports sent directly share the counter
+            bool sent;
+            {
+                std::lock_guard<std::mutex> send_lock(send_mutex_);
+                message.add_field(FixTag::MsgSeqNum, outgoing_seq_num_.fetch_add(1));
+                sent = send_raw_message(message.to_fix_string());
+            }
+            if (!sent) {
                 break;
             }
             
@@ -276,55 +474,49 @@ void FixSession::process_received_data(const char* data, size_t length) {
     std::lock_guard<std::mutex> lock(receive_mutex_);
     receive_buffer_.append(data, length);
     
-    auto messages = extract_complete_messages();
-    for (const auto& msg_str : messages) {
-        auto message = FixParser::parse(msg_str);
-        if (message) {
-            update_last_received_time();
-            handle_message(*message);
-        } else {
-            std::cerr << "[FIX] Failed to parse message: " << msg_str << std::endl;
-        }
-    }
+    // Keep only the incomplete tail
+    receive_buffer_.erase(0, process_messages(receive_buffer_.data(), receive_buffer_.length()));
 }
 
-std::vector<std::string> FixSession::extract_complete_messages() {
-    std::vector<std::string> messages;
-    
+size_t FixSession::process_messages(const char* data, size_t length) {
+    // Messages are framed by BodyLength and parsed in place in the buffer
+    FixView view;
     size_t start = 0;
-    while (start < receive_buffer_.length()) {
-        // Look for SOH after checksum (10=XXX)
-        size_t checksum_pos = receive_buffer_.find("10=", start);
-        if (checksum_pos == std::string::npos) {
-            break; // No complete message yet
+    while (start < length) {
+        const char* msg = data + start;
+        const long framed = frame_length(msg, length - start);
+        if (framed == FRAME_INCOMPLETE) {
+            break;
         }
-        
-        // Find the SOH after checksum value
-        size_t soh_pos = receive_buffer_.find(SOH, checksum_pos + 3);
-        if (soh_pos == std::string::npos) {
-            break; // Incomplete checksum
+        if (framed == FRAME_ERROR) {
+            // Resynchronise on the next BeginString
+            const std::string_view rest(msg, length - start);
+            const size_t next = rest.find("8=FIX", 1);
+            const size_t skip = next == std::string_view::npos ? rest.size() : next;
+            std::cerr << "[FIX] Discarding " << skip << " unframed bytes" << std::endl;
+            start += skip;
+            continue;
         }
         
-        // Extract complete message
-        std::string message = receive_buffer_.substr(start, soh_pos - start + 1);
-        messages.push_back(message);
-        
-        start = soh_pos + 1;
-    }
-    
-    // Remove processed messages from buffer
-    if (start > 0) {
-        receive_buffer_ = receive_buffer_.substr(start);
+        const size_t msg_length = static_cast<size_t>(framed);
+        if (!checksum_ok(msg, msg_length)) {
+            std::cerr << "[FIX] Bad checksum: " << std::string(msg, msg_length) << std::endl;
+        } else if (view.parse(msg, msg_length)) {
+            update_last_received_time();
+            handle_message(view);
+        } else {
+            std::cerr << "[FIX] Failed to parse message: " << std::string(msg, msg_length) << std::endl;
+        }
+        start += msg_length;
     }
-    
-    return messages;
+    return start;
 }
 
-void FixSession::handle_message(const FixMessage& message) {
+void FixSession::handle_message(const FixView& view) {
     update_stats_received();
     
     // Validate sequence number
-    if (!validate_sequence_number(message)) {
+    if (!validate_sequence_number(view)) {
         std::cerr << "[FIX] Sequence number error" << std::endl;
         std::lock_guard<std::mutex> lock(stats_mutex_);
         stats_.sequence_errors++;
@@ -332,29 +524,28 @@ void FixSession::handle_message(const FixMessage& message) {
     }
     
     // Handle session-level messages
-    auto msg_type = message.get_msg_type();
-    if (msg_type) {
-        switch (static_cast<MsgType>(*msg_type)) {
-            case MsgType::LOGON:
-                handle_logon(message);
-                return;
-            case MsgType::LOGOUT:
-                handle_logout(message);
-                return;
-            case MsgType::HEARTBEAT:
-                handle_heartbeat(message);
-                return;
-            case MsgType::TEST_REQUEST:
-                handle_test_request(message);
-                return;
-            default:
-                break; // Application message
-        }
+    switch (static_cast<MsgType>(view.msg_type())) {
+        case MsgType::LOGON:
+            handle_logon(view.to_message());
+            return;
+        case MsgType::LOGOUT:
+            handle_logout(view.to_message());
+            return;
+        case MsgType::HEARTBEAT:
+            handle_heartbeat(view.to_message());
+            return;
+        case MsgType::TEST_REQUEST:
+            handle_test_request(view.to_message());
+            return;
+        default:
+            break; // Application message
     }
     
     // Forward application messages to callback
-    if (message_callback_) {
-        message_callback_(this, message);
+    if (view_callback_) {
+        view_callback_(this, view);
+    } else if (message_callback_) {
+        message_callback_(this, view.to_message());
     }
 }
 
@@ -368,6 +559,11 @@ void FixSession::handle_logon(const FixMessage& message) {
         std::cout << "[FIX] Heartbeat interval set to " << heartbeat_interval_ << " seconds" << std::endl;
     }
     
+    // An accepted session answers the client's logon
+    if (loop_ && get_state() != SessionState::LOGGED_IN) {
+        send_message(FixMessageBuilder::create_logon(sender_comp_id_, target_comp_id_, 0, heartbeat_interval_));
+    }
+    
     set_state(SessionState::LOGGED_IN);
 }
 
@@ -403,8 +599,10 @@ bool FixSession::send_heartbeat(const std::string& test_req_id) {
     auto hb_msg = FixMessageBuilder::create_heartbeat(
         sender_comp_id_, target_comp_id_, outgoing_seq_num_.load(), test_req_id);
     
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.heartbeats_sent++;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.heartbeats_sent++;
+    }
     
     return send_message(hb_msg);
 }
@@ -428,29 +626,32 @@ bool FixSession::send_logout_response(const std::string& reason) {
     return send_message(logout_msg);
 }
 
-bool FixSession::validate_sequence_number(const FixMessage& message) {
-    auto seq_num = message.get_field_as<int>(FixTag::MsgSeqNum);
-    if (!seq_num) {
+bool FixSession::validate_sequence_number(const FixView& view) {
+    uint64_t seq = 0;
+    if (!view.get_uint(FixTag::MsgSeqNum, seq)) {
         return false; // No sequence number
     }
+    const int seq_num = static_cast<int>(seq);
     
     int expected = expected_seq_num_.load();
-    if (*seq_num == expected) {
+    if (seq_num == expected) {
         expected_seq_num_.fetch_add(1);
         return true;
-    } else if (*seq_num > expected) {
-        std::cerr << "[FIX] Sequence gap: expected " << expected << ", got " << *seq_num << std::endl;
-        expected_seq_num_.store(*seq_num + 1);
+    } else if (seq_num > expected) {
+        std::cerr << "[FIX] Sequence gap: expected " << expected << ", got " << seq_num << std::endl;
+        expected_seq_num_.store(seq_num + 1);
         return true; // Accept but note the gap
     } else {
-        std::cerr << "[FIX] Duplicate sequence: expected " << expected << ", got " << *seq_num << std::endl;
+        std::cerr << "[FIX] Duplicate sequence: expected " << expected << ", got " << seq_num << std::endl;
         return false; // Duplicate
     }
 }
 
 // FixServer Implementation
 
-FixServer::FixServer(int port) : port_(port) {}
+FixServer::FixServer(int port) : FixServer(FixServerConfig{port}) {}
+
+FixServer::FixServer(const FixServerConfig& config) : config_(config) {}
 
 FixServer::~FixServer() {
     stop();
@@ -461,7 +662,7 @@ bool FixServer::start() {
         return false; // Already running
     }
     
-    server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    server_socket_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (server_socket_ < 0) {
         std::cerr << "[FIX] Failed to create server socket" << std::endl;
         running_ = false;
@@ -475,25 +676,42 @@ bool FixServer::start() {
     struct sockaddr_in server_addr{};
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(port_);
+    server_addr.sin_port = htons(config_.port);
     
     if (bind(server_socket_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        std::cerr << "[FIX] Failed to bind server socket to port " << port_ << std::endl;
+        std::cerr << "[FIX] Failed to bind server socket to port " << config_.port << std::endl;
         close(server_socket_);
+        server_socket_ = -1;
         running_ = false;
         return false;
     }
     
-    if (listen(server_socket_, 10) < 0) {
+    if (listen(server_socket_, SOMAXCONN) < 0) {
         std::cerr << "[FIX] Failed to listen on socket" << std::endl;
         close(server_socket_);
+        server_socket_ = -1;
         running_ = false;
         return false;
     }
     
-    accept_thread_ = std::thread(&FixServer::accept_loop, this);
+    const uint32_t loop_count = std::max<uint32_t>(config_.loops, 1);
+    for (uint32_t i = 0; i < loop_count; ++i) {
+        const int cpu = config_.first_cpu >= 0 ? config_.first_cpu + static_cast<int>(i) : -1;
+        loops_.push_back(std::make_unique<FixEventLoop>(cpu));
+    }
+    loops_[0]->watch_listener(server_socket_, [this](int client_socket) { handle_new_client(client_socket); });
     
-    std::cout << "[FIX] Server listening on port " << port_ << std::endl;
+    for (auto& loop : loops_) {
+        if (!loop->start()) {
+            std::cerr << "[FIX] Failed to start event loop" << std::endl;
+            running_ = true;
+            stop();
+            return false;
+        }
+    }
+    
+    std::cout << "[FIX] Server listening on port " << config_.port
+              << " (" << loop_count << " I/O thread" << (loop_count > 1 ? "s" : "") << ")" << std::endl;
     return true;
 }
 
@@ -502,22 +720,18 @@ void FixServer::stop() {
         return; // Already stopped
     }
     
-    // Close server socket to stop accepting
+    // Each loop closes the sessions it owns; loop 0 stops accepting
+    for (auto& loop : loops_) {
+        loop->stop();
+    }
+    loops_.clear();
+    
     if (server_socket_ != -1) {
         close(server_socket_);
         server_socket_ = -1;
     }
     
-    // Wait for accept thread
-    if (accept_thread_.joinable()) {
-        accept_thread_.join();
-    }
-    
-    // Disconnect all client sessions
     std::lock_guard<std::mutex> lock(sessions_mutex_);
-    for (auto& session : client_sessions_) {
-        session->disconnect();
-    }
     client_sessions_.clear();
     
     std::cout << "[FIX] Server stopped" << std::endl;
@@ -545,29 +759,11 @@ std::vector<std::shared_ptr<FixSession>> FixServer::get_active_sessions() const
     return active_sessions;
 }
 
-void FixServer::accept_loop() {
-    while (running_) {
-        struct sockaddr_in client_addr{};
-        socklen_t client_len = sizeof(client_addr);
-        
-        int client_socket = accept(server_socket_, (struct sockaddr*)&client_addr, &client_len);
-        if (client_socket < 0) {
-            if (running_) {
-                std::cerr << "[FIX] Accept failed" << std::endl;
-            }
-            break;
-        }
-        
-        if (!running_) {
-            close(client_socket);
-            break;
-        }
-        
-        handle_new_client(client_socket);
-    }
-}
-
 void FixServer::handle_new_client(int client_socket) {
+    // Runs on loop 0; the socket is already non-blocking
+    int nodelay = 1;
+    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    
     // Get client address
     struct sockaddr_in client_addr{};
     socklen_t client_len = sizeof(client_addr);
@@ -581,25 +777,32 @@ void FixServer::handle_new_client(int client_socket) {
     // Create session for this client connection
     auto session = std::make_shared<FixSession>("SERVER", "CLIENT");
     
-    // Since we can't access private members directly, we need a different approach
-    // For now, close the client socket and let the session handle it properly
-    close(client_socket);
-    
     // Set callbacks
     if (message_callback_) {
         session->set_message_callback(message_callback_);
     }
+    if (view_callback_) {
+        session->set_view_callback(view_callback_);
+    }
     
-    // Add to sessions list
+    // Add to sessions list, forgetting the ones that have gone
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
+        client_sessions_.erase(std::remove_if(client_sessions_.begin(), client_sessions_.end(),
+                                              [](const std::shared_ptr<FixSession>& s) {
+                                                  return !s->is_connected();
+                                              }),
+                               client_sessions_.end());
         client_sessions_.push_back(session);
     }
     
-    // Notify callback
+    // Notify callback before the first message can arrive
     if (new_session_callback_) {
         new_session_callback_(session);
     }
+    
+    FixEventLoop& loop = *loops_[next_loop_++ % loops_.size()];
+    loop.adopt(session, client_socket);
 }
 
 } // namespace fix
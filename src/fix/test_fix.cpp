@@ -0,0 +1,485 @@
+#include "fix/fix_codec.hpp"
+#include "fix/fix_event_loop.hpp"
+#include "fix/fix_gateway.hpp"
+#include "market_data/publisher.hpp"
+#include "matching/matching_engine.hpp"
+#include "matching/symbol_manager.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace fix;
+
+namespace {
+
+constexpr int GATEWAY_PORT = 19878;
+constexpr int LOOP_PORT = 19879;
+constexpr auto REPORT_TIMEOUT = std::chrono::seconds(5);
+
+bool check(const char* what, bool ok) {
+    std::cout << what << ": " << (ok ? "YES" : "NO") << std::endl;
+    return ok;
+}
+
+// Execution reports a client session received, in arrival order
+class ReportLog {
+public:
+    void add(const FixMessage& message) {
+        if (message.get_msg_type() != static_cast<char>(MsgType::EXECUTION_REPORT)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        reports_.push_back(message);
+        cv_.notify_all();
+    }
+
+    // The reports for one ClOrdID once there are at least n; fewer on timeout
+    std::vector<FixMessage> wait_for(const std::string& cl_ord_id, size_t n) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::vector<FixMessage> found;
+        cv_.wait_for(lock, REPORT_TIMEOUT, [&] {
+            found.clear();
+            for (const FixMessage& m : reports_) {
+                if (m.get_field(FixTag::ClOrdID) == cl_ord_id) found.push_back(m);
+            }
+            return found.size() >= n;
+        });
+        return found;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<FixMessage> reports_;
+};
+
+struct Expected {
+    ExecType exec_type;
+    OrdStatus ord_status;
+    uint64_t cum_qty;
+    uint64_t leaves_qty;
+};
+
+bool reports_match(const std::vector<FixMessage>& reports, const std::vector<Expected>& expected) {
+    if (reports.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const FixMessage& r = reports[i];
+        if (r.get_field_as<char>(FixTag::ExecType) != static_cast<char>(expected[i].exec_type) ||
+            r.get_field_as<char>(FixTag::OrdStatus) != static_cast<char>(expected[i].ord_status) ||
+            r.get_field(FixTag::CumQty) != std::to_string(expected[i].cum_qty) ||
+            r.get_field(FixTag::LeavesQty) != std::to_string(expected[i].leaves_qty)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A framed FIX 4.2 message around a body written with '|' for SOH
+std::string frame(std::string body) {
+    for (char& c : body) {
+        if (c == '|') c = SOH;
+    }
+    std::string message = "8=FIX.4.2" + std::string(1, SOH) + "9=" + std::to_string(body.size()) + SOH + body;
+    char sum[3];
+    write_padded(sum, checksum(message.data(), message.size()), 3);
+    return message + "10=" + std::string(sum, 3) + SOH;
+}
+
+// Framing, checksums, field indexing and prices of the in-place codec
+bool test_codec() {
+    std::cout << "\n--- Codec ---" << std::endl;
+    bool ok = true;
+
+    // An encoded execution report parses back to what went in
+    ExecReportEncoder encoder("GATEWAY", "CLIENT");
+    ExecReport report;
+    report.order_id = 9001;
+    report.cl_ord_id = "ORD-1";
+    report.exec_id = 7;
+    report.exec_type = ExecType::PARTIAL_FILL;
+    report.ord_status = OrdStatus::PARTIALLY_FILLED;
+    report.symbol = "AAPL";
+    report.side = Side::SELL;
+    report.leaves_qty = 50;
+    report.cum_qty = 150;
+    report.avg_px = 1502500;
+    report.last_shares = 100;
+    report.last_px = 1502501;
+    report.text = "partial";
+    const std::string encoded(encoder.encode(report, 42, 1704164645678000000ull)); // 2024-01-02 03:04:05.678
+    FixView view;
+    uint64_t seq = 0, leaves = 0, cum = 0, avg_px = 0, last_px = 0;
+    ok &= check("Round trip: framed, checksum valid, parsed",
+                frame_length(encoded.data(), encoded.size()) == static_cast<long>(encoded.size()) &&
+                checksum_ok(encoded.data(), encoded.size()) && view.parse(encoded.data(), encoded.size()));
+    ok &= check("Round trip: header fields",
+                view.get(FixTag::BeginString) == "FIX.4.2" && view.msg_type() == '8' &&
+                view.get(FixTag::SenderCompID) == "GATEWAY" && view.get(FixTag::TargetCompID) == "CLIENT" &&
+                view.get_uint(FixTag::MsgSeqNum, seq) && seq == 42 &&
+                view.get(FixTag::SendingTime) == "20240102-03:04:05.678");
+    ok &= check("Round trip: body fields",
+                view.get(FixTag::OrderID) == "9001" && view.get(FixTag::ClOrdID) == "ORD-1" &&
+                view.get(FixTag::ExecID) == "E7" &&
+                view.get_char(FixTag::ExecType) == static_cast<char>(ExecType::PARTIAL_FILL) &&
+                view.get_char(FixTag::OrdStatus) == static_cast<char>(OrdStatus::PARTIALLY_FILLED) &&
+                view.get(FixTag::Symbol) == "AAPL" && view.get_char(FixTag::Side) == static_cast<char>(Side::SELL) &&
+                view.get_uint(FixTag::LeavesQty, leaves) && leaves == 50 && view.get_uint(FixTag::CumQty, cum) &&
+                cum == 150 && view.get(FixTag::AvgPx) == "150.25" && view.get_price(FixTag::AvgPx, avg_px) &&
+                avg_px == 1502500 && view.get(FixTag::LastShares) == "100" &&
+                view.get_price(FixTag::LastPx, last_px) && last_px == 1502501 && view.get(FixTag::Text) == "partial");
+
+    ExecReport bare = report;
+    bare.last_shares = 0;
+    bare.text = {};
+    const std::string encoded_bare(encoder.encode(bare, 43, 1704164645679000000ull));
+    ok &= check("Round trip: no LastShares, LastPx or Text when unset",
+                view.parse(encoded_bare.data(), encoded_bare.size()) &&
+                checksum_ok(encoded_bare.data(), encoded_bare.size()) &&
+                !view.has(FixTag::LastShares) && !view.has(FixTag::LastPx) && !view.has(FixTag::Text));
+
+    // A changed byte or a changed trailer fails the checksum, not the framing
+    std::string corrupted = encoded;
+    corrupted[corrupted.find("AAPL")] = 'B';
+    std::string bad_trailer = encoded;
+    bad_trailer[bad_trailer.size() - 2] = bad_trailer[bad_trailer.size() - 2] == '9' ? '0' : '9';
+    std::string bad_digit = encoded;
+    bad_digit[bad_digit.size() - 3] = 'x';
+    ok &= check("Bad checksum rejected",
+                frame_length(corrupted.data(), corrupted.size()) == static_cast<long>(corrupted.size()) &&
+                !checksum_ok(corrupted.data(), corrupted.size()) &&
+                !checksum_ok(bad_trailer.data(), bad_trailer.size()) &&
+                !checksum_ok(bad_digit.data(), bad_digit.size()));
+
+    // Every prefix of a message, including a partial BodyLength, needs more bytes
+    const std::string heartbeat = frame("35=0|49=CLIENT|56=GATEWAY|34=2|");
+    bool incomplete = true;
+    for (size_t n = 0; n < heartbeat.size(); ++n) {
+        incomplete &= frame_length(heartbeat.data(), n) == FRAME_INCOMPLETE;
+    }
+    const std::string two = heartbeat + heartbeat;
+    ok &= check("Truncated frame incomplete, back-to-back frames split",
+                incomplete && frame_length(heartbeat.data(), heartbeat.size()) == static_cast<long>(heartbeat.size()) &&
+                frame_length(two.data(), two.size()) == static_cast<long>(heartbeat.size()));
+
+    std::string short_length = heartbeat;
+    short_length.replace(short_length.find("9=") + 2, 2, "29"); // One short: 10= is not where it points
+    ok &= check("Malformed frame rejected",
+                frame_length(short_length.data(), short_length.size()) == FRAME_ERROR &&
+                frame_length("9=51", 5) == FRAME_ERROR && frame_length("8=FIX.4.29=1x", 15) == FRAME_ERROR &&
+                frame_length("8=FIX.4.29=", 13) == FRAME_ERROR &&
+                frame_length("8=FIX.4.29=1234567", 20) == FRAME_ERROR);
+
+    // Prices in 1/10000; no sign, digits past the fourth decimal truncated
+    struct PriceCase {
+        const char* text;
+        bool valid;
+        uint64_t value;
+    };
+    const PriceCase prices[] = {{"150.25", true, 1502500}, {"42", true, 420000},     {"0.0001", true, 1},
+                                {"1.23456", true, 12345},  {".5", true, 5000},       {"7.", true, 70000},
+                                {"-1.5", false, 0},        {"-0.0001", false, 0},    {"+1", false, 0},
+                                {"1.2.3", false, 0},       {"1e3", false, 0},        {"", false, 0}};
+    bool prices_ok = true;
+    for (const PriceCase& c : prices) {
+        uint64_t value = 0;
+        const bool valid = parse_price(c.text, value);
+        if (valid != c.valid || (valid && value != c.value)) {
+            std::cout << "  parse_price(\"" << c.text << "\") = " << (valid ? std::to_string(value) : "rejected")
+                      << std::endl;
+            prices_ok = false;
+        }
+    }
+    ok &= check("Prices: fractional parsed, negative rejected", prices_ok);
+
+    // The first of a repeated tag wins, in a fast slot and in the scan alike
+    const std::string repeated = frame("35=D|11=FIRST|11=SECOND|58=ONE|58=TWO|");
+    ok &= check("Repeated tags: first occurrence returned",
+                view.parse(repeated.data(), repeated.size()) && view.field_count() == 8 &&
+                view.get(FixTag::ClOrdID) == "FIRST" && view.get(FixTag::Text) == "ONE");
+
+    const std::string no_type = frame("49=CLIENT|56=GATEWAY|");
+    const std::string bad_tag = frame("35=D|1x=2|");
+    ok &= check("Malformed fields and missing MsgType rejected",
+                !view.parse(no_type.data(), no_type.size()) && !view.parse(bad_tag.data(), bad_tag.size()));
+    return ok;
+}
+
+// Polls until done() holds; false on timeout
+template <typename Done> bool wait_until(Done done) {
+    const auto deadline = std::chrono::steady_clock::now() + REPORT_TIMEOUT;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+// The client end as a plain socket, so the test decides what is sent and
+// when the session's output is read
+class RawClient {
+public:
+    ~RawClient() { close_socket(); }
+
+    bool connect_to(int port, int receive_buffer) {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return fd_ >= 0 && connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    // Header and MsgSeqNum added; fields written with '|' for SOH
+    bool send_message(char msg_type, const std::string& fields) {
+        const std::string message = frame(std::string("35=") + msg_type + "|49=CLIENT|56=SERVER|34=" +
+                                          std::to_string(next_seq_++) + "|" + fields);
+        return send(fd_, message.data(), message.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(message.size());
+    }
+
+    // The next complete message; empty on timeout or close
+    std::string next_message() {
+        const auto deadline = std::chrono::steady_clock::now() + REPORT_TIMEOUT;
+        while (true) {
+            const long length = frame_length(pending_.data(), pending_.size());
+            if (length > 0) {
+                std::string message = pending_.substr(0, static_cast<size_t>(length));
+                pending_.erase(0, static_cast<size_t>(length));
+                return message;
+            }
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            pollfd pfd{fd_, POLLIN, 0};
+            if (length == FRAME_ERROR || left <= 0 || poll(&pfd, 1, static_cast<int>(left)) <= 0) return {};
+            char buf[4096];
+            const ssize_t n = recv(fd_, buf, sizeof(buf), 0);
+            if (n <= 0) return {};
+            pending_.append(buf, static_cast<size_t>(n));
+        }
+    }
+
+    void close_socket() {
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    int fd_{-1};
+    int next_seq_{1};
+    std::string pending_;
+};
+
+int listen_on(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// One loop-owned session against a raw client: the accept path, output
+// that outruns a small socket buffer and resumes on EPOLLOUT, heartbeats
+// from the timer wheel, and the peer closing
+bool test_event_loop() {
+    std::cout << "\n--- Event loop: accept, stalled output, heartbeats, close ---" << std::endl;
+
+    const int listen_fd = listen_on(LOOP_PORT);
+    if (listen_fd < 0) {
+        return check("Listening", false);
+    }
+
+    FixEventLoop loop;
+    std::mutex accepted_mutex;
+    std::vector<std::shared_ptr<FixSession>> accepted;
+    loop.watch_listener(listen_fd, [&](int fd) {
+        const int send_buffer = 4096;   // Small, so the reports below fill it
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &send_buffer, sizeof(send_buffer));
+        auto session = std::make_shared<FixSession>("SERVER", "CLIENT");
+        {
+            std::lock_guard<std::mutex> lock(accepted_mutex);
+            accepted.push_back(session);
+        }
+        loop.adopt(session, fd);
+    });
+
+    RawClient client;
+    bool ok = loop.start() && client.connect_to(LOOP_PORT, 4096);
+    ok = check("Accepted and adopted", ok && wait_until([&] { return loop.session_count() == 1; }));
+    if (!ok) {
+        loop.stop();
+        close(listen_fd);
+        return false;
+    }
+    std::shared_ptr<FixSession> session;
+    {
+        std::lock_guard<std::mutex> lock(accepted_mutex);
+        session = accepted.front();
+    }
+
+    // The session answers a logon itself; 1s heartbeats from here on
+    FixView view;
+    const std::string logon = client.send_message('A', "98=0|108=1|") ? client.next_message() : std::string();
+    ok &= check("Logon answered", !logon.empty() && view.parse(logon.data(), logon.size()) &&
+                                      view.msg_type() == static_cast<char>(MsgType::LOGON) &&
+                                      session->get_state() == SessionState::LOGGED_IN);
+
+    // Several times what the socket buffers hold, queued while the client
+    // is not reading: the loop has to wait for EPOLLOUT to send the rest
+    constexpr uint64_t REPORTS = 200;
+    const std::string text(64, 'x');
+    ExecReport report;
+    report.cl_ord_id = "BULK";
+    report.symbol = "AAPL";
+    report.text = text;
+    bool queued = true;
+    for (uint64_t i = 1; i <= REPORTS; ++i) {
+        report.exec_id = i;
+        queued &= session->send_execution_report(report);
+    }
+    ok &= check("Output stalled on a full socket",
+                queued && wait_until([&] { return loop.write_stalls() > 0; }));
+
+    uint64_t first_seq = 0;
+    bool in_order = true;
+    for (uint64_t i = 1; i <= REPORTS && in_order; ++i) {
+        const std::string message = client.next_message();
+        uint64_t seq = 0;
+        in_order = !message.empty() && checksum_ok(message.data(), message.size()) &&
+                   view.parse(message.data(), message.size()) && view.get_uint(FixTag::MsgSeqNum, seq) &&
+                   view.get(FixTag::ExecID) == "E" + std::to_string(i);
+        if (i == 1) first_seq = seq;
+        in_order &= seq == first_seq + i - 1;
+    }
+    ok &= check("Every report delivered in order after EPOLLOUT", in_order);
+
+    // Keeps the session's receive clock fresh; the wheel then sends a
+    // heartbeat once a second passes without output
+    bool heartbeat = client.send_message('0', "");
+    for (int i = 0; heartbeat && i < 10; ++i) {
+        const std::string message = client.next_message();
+        heartbeat = !message.empty() && view.parse(message.data(), message.size());
+        if (heartbeat && view.msg_type() == static_cast<char>(MsgType::HEARTBEAT)) break;
+    }
+    ok &= check("Heartbeat sent from the timer", heartbeat && view.msg_type() == static_cast<char>(MsgType::HEARTBEAT));
+
+    client.close_socket();
+    ok &= check("Peer close ends the session", wait_until([&] {
+                    return loop.session_count() == 0 && session->get_state() == SessionState::DISCONNECTED;
+                }));
+
+    loop.stop();
+    close(listen_fd);
+    return ok;
+}
+
+// IOC and market orders through the gateway: whatever the engine drops
+// must come back to the client as CANCELED, and engine rejects as REJECTED
+bool test_gateway() {
+    std::cout << "\n--- Gateway: IOC and market remainders ---" << std::endl;
+
+    matching::SymbolManager symbol_manager;
+    matching::MatchingEngine engine;
+    market_data::MarketDataPublisher publisher(symbol_manager, engine);
+    const matching::SymbolId aapl = symbol_manager.add_symbol("AAPL");
+    symbol_manager.add_symbol("MSFT");   // No liquidity
+    const matching::SymbolId ibm = symbol_manager.add_symbol("IBM");
+
+    // Set up before the gateway's I/O thread starts calling the engine
+    matching::Order ask{};
+    ask.id = 1;
+    ask.symbol = aapl;
+    ask.side = matching::Side::SELL;
+    ask.type = matching::OrderType::LIMIT;
+    ask.tif = matching::TimeInForce::DAY;
+    ask.quantity = 100;
+    ask.price = 1502000;
+    engine.process_order(ask);
+    engine.begin_auction(ibm);   // Takes only day limit orders
+
+    FixGateway gateway(symbol_manager, engine, publisher, GATEWAY_PORT);
+    if (!publisher.start() || !gateway.start()) {
+        return check("Gateway started", false);
+    }
+
+    ReportLog log;
+    FixSession client("CLIENT", "GATEWAY");
+    client.set_message_callback([&](FixSession*, const FixMessage& message) { log.add(message); });
+    bool ok = client.connect("127.0.0.1", GATEWAY_PORT) && client.logon();
+    for (int i = 0; ok && i < 500 && client.get_state() != SessionState::LOGGED_IN; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ok = check("Logged on", ok && client.get_state() == SessionState::LOGGED_IN);
+
+    auto send = [&](const std::string& id, const std::string& symbol, double qty, OrdType type, double price,
+                    TimeInForce tif) {
+        client.send_message(FixMessageBuilder::create_new_order_single(
+            "CLIENT", "GATEWAY", 0, id, symbol, Side::BUY, qty, type, price, tif));
+    };
+
+    if (ok) {
+        // 150 against 100 offered: fills 100, the other 50 are dropped
+        send("IOC-PARTIAL", "AAPL", 150, OrdType::LIMIT, 150.20, TimeInForce::IMMEDIATE_OR_CANCEL);
+        ok &= check("IOC partial fill: NEW, PARTIAL_FILL, CANCELED",
+                    reports_match(log.wait_for("IOC-PARTIAL", 3),
+                                  {{ExecType::NEW, OrdStatus::NEW, 0, 150},
+                                   {ExecType::PARTIAL_FILL, OrdStatus::PARTIALLY_FILLED, 100, 50},
+                                   {ExecType::CANCELED, OrdStatus::CANCELED, 100, 0}}));
+
+        // Below the (now empty) offer: nothing fills
+        send("IOC-NONE", "AAPL", 50, OrdType::LIMIT, 149.00, TimeInForce::IMMEDIATE_OR_CANCEL);
+        ok &= check("IOC without fill: NEW, CANCELED",
+                    reports_match(log.wait_for("IOC-NONE", 2),
+                                  {{ExecType::NEW, OrdStatus::NEW, 0, 50},
+                                   {ExecType::CANCELED, OrdStatus::CANCELED, 0, 0}}));
+
+        send("MKT-EMPTY", "MSFT", 25, OrdType::MARKET, 0.0, TimeInForce::DAY);
+        ok &= check("Market order without liquidity: NEW, CANCELED",
+                    reports_match(log.wait_for("MKT-EMPTY", 2),
+                                  {{ExecType::NEW, OrdStatus::NEW, 0, 25},
+                                   {ExecType::CANCELED, OrdStatus::CANCELED, 0, 0}}));
+
+        send("IOC-AUCTION", "IBM", 10, OrdType::LIMIT, 100.00, TimeInForce::IMMEDIATE_OR_CANCEL);
+        const std::vector<FixMessage> rejected = log.wait_for("IOC-AUCTION", 1);
+        ok &= check("Engine reject: REJECTED, not accepted",
+                    reports_match(rejected, {{ExecType::REJECTED, OrdStatus::REJECTED, 0, 0}}) &&
+                    gateway.get_stats().orders_accepted == 3 && gateway.get_stats().orders_rejected == 1);
+    }
+
+    client.disconnect();
+    gateway.stop();
+    publisher.stop();
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== FIX TEST ===" << std::endl;
+
+    bool ok = true;
+    ok &= test_codec();
+    ok &= test_event_loop();
+    ok &= test_gateway();
+
+    std::cout << "\nAll FIX checks passed: " << (ok ? "YES" : "NO") << std::endl;
+    std::cout << "\n=== FIX TEST COMPLETED ===" << std::endl;
+    return ok ? 0 : 1;
+}
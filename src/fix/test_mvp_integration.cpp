@@ -75,24 +75,24 @@ int main() {
     std::cout << "Adding initial market structure..." << std::endl;
     
     // Add some resting orders to create a market
-    std::vector<Order> initial_orders = {
+    std::vector<matching::Order> initial_orders = {
         // AAPL bids
-        {1001, aapl_id, Side::BUY, OrderType::LIMIT, TimeInForce::DAY, 100, 0, 1500000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.00
-        {1002, aapl_id, Side::BUY, OrderType::LIMIT, TimeInForce::DAY, 200, 0, 1499000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $149.90
-        {1003, aapl_id, Side::BUY, OrderType::LIMIT, TimeInForce::DAY, 150, 0, 1498000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $149.80
+        {1001, aapl_id, matching::Side::BUY, OrderType::LIMIT, matching::TimeInForce::DAY, 100, 0, 1500000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.00
+        {1002, aapl_id, matching::Side::BUY, OrderType::LIMIT, matching::TimeInForce::DAY, 200, 0, 1499000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $149.90
+        {1003, aapl_id, matching::Side::BUY, OrderType::LIMIT, matching::TimeInForce::DAY, 150, 0, 1498000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $149.80
         
         // AAPL asks
-        {2001, aapl_id, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 100, 0, 1502000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.20
-        {2002, aapl_id, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 200, 0, 1503000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.30
-        {2003, aapl_id, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 150, 0, 1504000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.40
+        {2001, aapl_id, matching::Side::SELL, OrderType::LIMIT, matching::TimeInForce::DAY, 100, 0, 1502000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.20
+        {2002, aapl_id, matching::Side::SELL, OrderType::LIMIT, matching::TimeInForce::DAY, 200, 0, 1503000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.30
+        {2003, aapl_id, matching::Side::SELL, OrderType::LIMIT, matching::TimeInForce::DAY, 150, 0, 1504000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $150.40
         
         // MSFT bids and asks
-        {3001, msft_id, Side::BUY, OrderType::LIMIT, TimeInForce::DAY, 50, 0, 3000000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $300.00
-        {3002, msft_id, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 50, 0, 3010000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $301.00
+        {3001, msft_id, matching::Side::BUY, OrderType::LIMIT, matching::TimeInForce::DAY, 50, 0, 3000000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $300.00
+        {3002, msft_id, matching::Side::SELL, OrderType::LIMIT, matching::TimeInForce::DAY, 50, 0, 3010000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $301.00
         
         // GOOGL bids and asks
-        {4001, googl_id, Side::BUY, OrderType::LIMIT, TimeInForce::DAY, 25, 0, 2500000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $2500.00
-        {4002, googl_id, Side::SELL, OrderType::LIMIT, TimeInForce::DAY, 25, 0, 2520000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $2520.00
+        {4001, googl_id, matching::Side::BUY, OrderType::LIMIT, matching::TimeInForce::DAY, 25, 0, 2500000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $2500.00
+        {4002, googl_id, matching::Side::SELL, OrderType::LIMIT, matching::TimeInForce::DAY, 25, 0, 2520000, std::chrono::high_resolution_clock::now(), OrderStatus::NEW}, // $2520.00
     };
     
     for (auto& order : initial_orders) {
@@ -1,80 +1,211 @@
 #include "itch/decoder.hpp"
-#include <arpa/inet.h>
-#include <cstring>
+#include "itch/views.hpp"
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 namespace itch {
 
-static inline uint64_t bswap64(uint64_t v) {
-#if defined(__GNUC__)
-  return __builtin_bswap64(v);
-#else
-  return ((v & 0x00000000000000FFull) << 56) |
-         ((v & 0x000000000000FF00ull) << 40) |
-         ((v & 0x0000000000FF0000ull) << 24) |
-         ((v & 0x00000000FF000000ull) << 8)  |
-         ((v & 0x000000FF00000000ull) >> 8)  |
-         ((v & 0x0000FF0000000000ull) >> 24) |
-         ((v & 0x00FF000000000000ull) >> 40) |
-         ((v & 0xFF00000000000000ull) >> 56);
-#endif
-}
-
 DecodeResult Decoder::decode_one(const char* ptr, size_t size) const {
   DecodeResult out;
   if (size < sizeof(CommonHeader)) { return out; }
   const char type = *ptr;
   const uint32_t msize = itch_message_size(type);
   if (msize == 0 || msize > size) { out.message_size = 0; return out; }
+  out.message_size = msize;
 
   switch (type) {
-    case 'A': {
-      AddOrderMessage msg; std::memcpy(&msg, ptr, sizeof(msg));
-      auto sym_id = symtab_.get_or_intern(msg.stockSymbol);
-      core::AddEvt e{ bswap64(msg.orderReferenceNumber), msg.buySellIndicator,
-                      ntohl(msg.shares), ntohl(msg.price), sym_id };
-      out.event = e; out.message_size = msize; return out;
-    }
+    case 'A':
     case 'F': {
-      AddOrderWithMPIDMessage msg; std::memcpy(&msg, ptr, sizeof(msg));
-      auto sym_id = symtab_.get_or_intern(msg.stockSymbol);
-      core::AddEvt e{ bswap64(msg.orderReferenceNumber), msg.buySellIndicator,
-                      ntohl(msg.shares), ntohl(msg.price), sym_id };
-      out.event = e; out.message_size = msize; return out;
-    }
-    case 'E': {
-      OrderExecutedMessage msg; std::memcpy(&msg, ptr, sizeof(msg));
-      core::ExecEvt e{ bswap64(msg.orderReferenceNumber), ntohl(msg.executedShares) };
-      out.event = e; out.message_size = msize; return out;
+      const AddOrderView m(ptr);
+      out.event = core::AddEvt{ m.order_ref(), m.side(), m.shares(), m.price(),
+                                symtab_.get_or_intern(m.stock_locate(), m.symbol()) };
+      return out;
     }
+    case 'E':
     case 'C': {
-      OrderExecutedWithPriceMessage msg; std::memcpy(&msg, ptr, sizeof(msg));
-      core::ExecEvt e{ bswap64(msg.orderReferenceNumber), ntohl(msg.executedShares) };
-      out.event = e; out.message_size = msize; return out;
+      const OrderExecutedView m(ptr);
+      out.event = core::ExecEvt{ m.order_ref(), m.executed_shares() };
+      return out;
     }
     case 'X': {
-      OrderCancelMessage msg; std::memcpy(&msg, ptr, sizeof(msg));
-      core::CancelEvt e{ bswap64(msg.orderReferenceNumber), ntohl(msg.canceledShares) };
-      out.event = e; out.message_size = msize; return out;
+      const OrderCancelView m(ptr);
+      out.event = core::CancelEvt{ m.order_ref(), m.canceled_shares() };
+      return out;
     }
     case 'D': {
-      OrderDeleteMessage msg; std::memcpy(&msg, ptr, sizeof(msg));
-      core::DeleteEvt e{ bswap64(msg.orderReferenceNumber) };
-      out.event = e; out.message_size = msize; return out;
+      out.event = core::DeleteEvt{ OrderDeleteView(ptr).order_ref() };
+      return out;
     }
     case 'U': {
-      OrderReplaceMessage msg; std::memcpy(&msg, ptr, sizeof(msg));
+      const OrderReplaceView m(ptr);
       // Not: stock symbol yok; symbol değişimi yok varsayıyoruz
-      core::ReplaceEvt e{ bswap64(msg.originalOrderReferenceNumber),
-                          bswap64(msg.newOrderReferenceNumber),
-                          ntohl(msg.shares), ntohl(msg.price), /*sym_id*/0 };
-      out.event = e; out.message_size = msize; return out;
+      out.event = core::ReplaceEvt{ m.original_order_ref(), m.new_order_ref(),
+                                    m.shares(), m.price(), /*sym_id*/0 };
+      return out;
     }
-    default: {
-      // Non-order book affecting messages: S, R ...
-      out.event.reset(); out.message_size = msize; return out;
+    default:
+      // Non-order book affecting messages: S, R, P, I ...
+      return out;
+  }
+}
+
+// ---- Batch decoding ----
+// The order reference number always starts at byte 11. With 16 readable bytes
+// from there, one shuffle byte-reverses it together with the share count
+// (or, for U, the new reference number); otherwise fields are swapped one by one.
+
+static constexpr size_t REF_OFFSET = 11;
+static constexpr size_t WIDE_BYTES = REF_OFFSET + 16;
+
+// ref (8) at p, shares (4) at p + shares_at
+template <int SharesAt>
+static inline void load_ref_shares(const char* p, bool wide, uint64_t& ref, uint32_t& shares) {
+#if defined(__SSE4_1__)
+  if (wide) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i m = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                                    SharesAt + 3, SharesAt + 2, SharesAt + 1, SharesAt,
+                                    -1, -1, -1, -1);
+    const __m128i s = _mm_shuffle_epi8(v, m);
+    ref = static_cast<uint64_t>(_mm_cvtsi128_si64(s));
+    shares = static_cast<uint32_t>(_mm_extract_epi32(s, 2));
+    return;
+  }
+#endif
+  (void)wide;
+  ref = load_be64(p);
+  shares = load_be32(p + SharesAt);
+}
+
+// Two consecutive 8-byte reference numbers at p
+static inline void load_ref_pair(const char* p, bool wide, uint64_t& a, uint64_t& b) {
+#if defined(__SSE4_1__)
+  if (wide) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i m = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m128i s = _mm_shuffle_epi8(v, m);
+    a = static_cast<uint64_t>(_mm_cvtsi128_si64(s));
+    b = static_cast<uint64_t>(_mm_extract_epi64(s, 1));
+    return;
+  }
+#endif
+  (void)wide;
+  a = load_be64(p);
+  b = load_be64(p + 8);
+}
+
+// Decodes the order event in the message at p; false if its column is full
+bool Decoder::batch_one(const char* p, bool wide, core::EventBlock& out) const {
+  using Block = core::EventBlock;
+  const char* ref = p + REF_OFFSET;
+  switch (*p) {
+    case 'A':
+    case 'F': { // same layout up to the price
+      if (out.full(Block::Add)) return false;
+      const uint16_t i = out.push(Block::Add);
+      const AddOrderView m(p);
+      load_ref_shares<9>(ref, wide, out.adds.id[i], out.adds.qty[i]);
+      out.adds.side[i] = m.side();
+      out.adds.px[i] = m.price();
+      out.adds.sym[i] = symtab_.get_or_intern(m.stock_locate(), m.symbol());
+      return true;
     }
+    case 'E':
+    case 'C': {
+      if (out.full(Block::Exec)) return false;
+      const uint16_t i = out.push(Block::Exec);
+      load_ref_shares<8>(ref, wide, out.execs.id[i], out.execs.qty[i]);
+      return true;
+    }
+    case 'X': {
+      if (out.full(Block::Cancel)) return false;
+      const uint16_t i = out.push(Block::Cancel);
+      load_ref_shares<8>(ref, wide, out.cancels.id[i], out.cancels.qty[i]);
+      return true;
+    }
+    case 'D': {
+      if (out.full(Block::Delete)) return false;
+      const uint16_t i = out.push(Block::Delete);
+      out.deletes.id[i] = OrderDeleteView(p).order_ref();
+      return true;
+    }
+    case 'U': {
+      if (out.full(Block::Replace)) return false;
+      const uint16_t i = out.push(Block::Replace);
+      const OrderReplaceView m(p);
+      load_ref_pair(ref, wide, out.replaces.old_id[i], out.replaces.new_id[i]);
+      out.replaces.qty[i] = m.shares();
+      out.replaces.px[i] = m.price();
+      return true;
+    }
+    default:
+      return true; // no book event
   }
 }
 
-} // namespace itch
+size_t Decoder::decode_batch(const char* ptr, size_t size, core::EventBlock& out,
+                             Framing framing) const {
+  out.clear();
+  size_t off = 0;
+  if (framing == Framing::Bare) {
+    while (off + sizeof(CommonHeader) <= size) {
+      const char* p = ptr + off;
+      const uint32_t msize = itch_message_size(*p);
+      if (msize == 0 || off + msize > size) break;
+      if (itch_is_order_message(*p) && !batch_one(p, size - off >= WIDE_BYTES, out)) break;
+      off += msize;
+      ++out.messages;
+    }
+    return off;
+  }
 
+  // Length-prefixed: the prefix bounds every message, so types without a
+  // book event (known or not) are skipped by length
+  while (off + 2 < size) {
+    const uint32_t len = (static_cast<uint8_t>(ptr[off]) << 8) | static_cast<uint8_t>(ptr[off + 1]);
+    if (len == 0 || off + 2 + len > size) break;
+    const char* p = ptr + off + 2;
+    const uint32_t msize = itch_message_size(*p);
+    if (len < msize) break; // shorter than its type: corrupt
+    if (itch_is_order_message(*p) && !batch_one(p, size - (off + 2) >= WIDE_BYTES, out)) break;
+    off += 2 + len;
+    ++out.messages;
+  }
+  return off;
+}
+
+bool Decoder::decode_into(const char* ptr, size_t avail, core::EventBlock& out) const {
+  if (!batch_one(ptr, avail >= WIDE_BYTES, out)) return false;
+  ++out.messages;
+  return true;
+}
+
+// Whichever framing parses the first few messages cleanly
+Framing detect_framing(const char* ptr, size_t size) {
+  constexpr int PROBE = 16;
+  auto parses = [&](Framing f) {
+    size_t off = 0;
+    int n = 0;
+    for (; n < PROBE && off < size; ++n) {
+      if (f == Framing::Bare) {
+        const uint32_t msize = itch_message_size(ptr[off]);
+        if (msize == 0 || off + msize > size) return false;
+        off += msize;
+      } else {
+        if (off + 3 > size) return false;
+        const uint32_t len = (static_cast<uint8_t>(ptr[off]) << 8) | static_cast<uint8_t>(ptr[off + 1]);
+        const uint32_t msize = itch_message_size(ptr[off + 2]);
+        if (len == 0 || off + 2 + len > size || (msize != 0 && len != msize)) return false;
+        off += 2 + len;
+      }
+    }
+    return n > 0;
+  };
+  // A bare stream starts with a type letter, a prefixed one with a length's
+  // high byte (0 for every ITCH message), so at most one of these holds
+  if (parses(Framing::LengthPrefixed)) return Framing::LengthPrefixed;
+  return Framing::Bare;
+}
+
+} // namespace itch
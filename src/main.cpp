@@ -2,183 +2,502 @@
 #include "itch/decoder.hpp"
 #include "itch/messages.hpp"
 #include "core/symbol_table.hpp"
+#include "core/mapped_file.hpp"
+#include "replay/sharded_replay.hpp"
 #include "net/feed_listener.hpp"
 #include "net/arbiter.hpp"
 #include "core/apply.hpp"
+#include "core/book_router.hpp"
+#include "core/snapshot.hpp"
+#include "book/basic_order_book.hpp"
 #include "perf/latency_tracker.hpp"
+#include "perf/cpu.hpp"
+#include "perf/tsc_clock.hpp"
 #include <chrono>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+// Debug snapshot: book count plus the first few books by symbol id
+template <typename OB>
+static void print_book_snapshot(const core::BookRouter<OB>& books, const core::SymbolTable& symtab,
+                                size_t max_books = 10) {
+  std::cout << "Books built: " << books.book_count() << std::endl;
+  size_t shown = 0;
+  books.for_each([&](core::SymbolTable::SymbolId id, const OB& ob) {
+    if (shown++ >= max_books) return;
+    std::cout << "\n===== Order Book for: " << symtab.view(id) << " =====" << std::endl;
+    ob.display();
+  });
+}
+
+// Books for a full feed start small: most of its ~8k names only ever rest a
+// handful of orders, and the order index and pool grow with the busy ones
+static constexpr uint32_t REPLAY_BOOK_ORDERS = 1024;
+
+template <typename OB>
+static typename core::BookRouter<OB>::Factory book_factory() {
+  if constexpr (std::is_same_v<OB, UltraOrderBook>) {
+    return [](core::SymbolTable::SymbolId) {
+      UltraBookConfig config;
+      config.expected_orders = REPLAY_BOOK_ORDERS;
+      return std::make_unique<UltraOrderBook>(config);
+    };
+  } else {
+    return nullptr;
+  }
+}
+
+// Book checkpoints (--snapshot=PATH [--snapshot-every=N], --restore=PATH)
+struct CheckpointOptions {
+  std::string snapshot_path; // Empty: none taken
+  uint64_t every{0};         // File mode: messages; net mode: seconds. 0: only at the end
+  std::string restore_path;  // Empty: start from empty books
+};
+
+// Loads a checkpoint into empty books. Ultra books only.
+template <typename OB>
+static bool restore_checkpoint(const std::string& path, core::SymbolTable& symtab, core::BookRouter<OB>& books,
+                               core::snapshot::Header& header) {
+  if constexpr (!std::is_same_v<OB, UltraOrderBook>) {
+    std::cerr << "Checkpoints need --ultra books" << std::endl;
+    return false;
+  } else {
+    const auto t0 = std::chrono::steady_clock::now();
+    core::MappedFile file;
+    if (!file.open(path.c_str())) {
+      std::cerr << "Error: Could not open checkpoint " << path << std::endl;
+      return false;
+    }
+    core::SnapshotView snap;
+    if (const char* error = snap.parse(file.data(), file.size())) {
+      std::cerr << "Error: Checkpoint " << path << ": " << error << std::endl;
+      return false;
+    }
+    const int64_t orders = core::restore_snapshot(snap, symtab, books);
+    if (orders < 0) {
+      std::cerr << "Error: Checkpoint " << path << ": symbol table does not match" << std::endl;
+      return false;
+    }
+    header = *snap.header;
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Restored " << orders << " orders in " << header.book_count << " books from " << path
+              << " (sequence " << header.sequence << ") in " << ms << " ms" << std::endl;
+    return true;
+  }
+}
+
+// Writes a checkpoint, in a forked child when `background` is given
+template <typename OB>
+static bool take_checkpoint(const CheckpointOptions& opts, const core::SymbolTable& symtab,
+                            const core::BookRouter<OB>& books, uint64_t sequence, uint64_t feed_offset,
+                            core::BackgroundSnapshot* background) {
+  if constexpr (!std::is_same_v<OB, UltraOrderBook>) {
+    return false;
+  } else {
+    const std::string tmp = opts.snapshot_path + ".tmp";
+    auto write = [&] {
+      return core::write_snapshot(opts.snapshot_path.c_str(), tmp.c_str(), symtab, books, sequence, feed_offset);
+    };
+    return background ? background->start(write) : write();
+  }
+}
+
 template<typename OB>
-static void run_file_mode_impl(const std::string& path) {
-  std::ifstream file(path, std::ios::binary);
-  if (!file) {
+static void run_file_mode_impl(const std::string& path, const std::string& framing_opt,
+                               const CheckpointOptions& ckpt) {
+  core::MappedFile file;
+  if (!file.open(path.c_str())) {
     std::cerr << "Error: Could not open file " << path << std::endl;
     return;
   }
-  std::vector<char> buffer(std::istreambuf_iterator<char>(file), {});
-  std::cout << "Read " << buffer.size() << " bytes from file." << std::endl;
+  const itch::Framing framing =
+      framing_opt == "bare"     ? itch::Framing::Bare
+      : framing_opt == "prefixed" ? itch::Framing::LengthPrefixed
+                                  : itch::detect_framing(file.data(), file.size());
+  std::cout << "Mapped " << file.size() << " bytes from file ("
+            << (framing == itch::Framing::Bare ? "bare" : "length-prefixed") << " framing)." << std::endl;
 
   core::SymbolTable symtab;
   itch::Decoder decoder(symtab);
 
-  OB ob;
+  auto books = std::make_unique<core::BookRouter<OB>>(book_factory<OB>());
+  auto block = std::make_unique<core::EventBlock>();
   size_t events = 0; size_t msgs = 0;
-  const char* cur = buffer.data();
-  const char* end = cur + buffer.size();
-  while (cur < end) {
-    auto res = decoder.decode_one(cur, static_cast<size_t>(end - cur));
-    if (res.message_size == 0) break;
-    ++msgs;
-    if (res.event.has_value()) {
-      core::apply(*res.event, ob);
-      ++events;
+  const char* begin = file.data();
+  const char* cur = begin;
+  const char* end = cur + file.size();
+  if (!ckpt.restore_path.empty()) {
+    // Resume where the checkpoint was taken
+    core::snapshot::Header header{};
+    if (!restore_checkpoint(ckpt.restore_path, symtab, *books, header)) return;
+    if (header.feed_offset > file.size()) {
+      std::cerr << "Error: Checkpoint is past the end of " << path << std::endl;
+      return;
     }
-    cur += res.message_size;
+    cur = begin + header.feed_offset;
+    msgs = header.sequence;
+  }
+  core::BackgroundSnapshot background;
+  const bool checkpoints = !ckpt.snapshot_path.empty();
+  size_t next_checkpoint = msgs + ckpt.every;
+  const auto t0 = std::chrono::steady_clock::now();
+  while (cur < end) {
+    const size_t used = decoder.decode_batch(cur, static_cast<size_t>(end - cur), *block, framing);
+    if (used == 0) break;
+    books->apply(*block);
+    msgs += block->messages;
+    events += block->events();
+    cur += used;
+    file.advance(static_cast<size_t>(cur - begin));
+    if (checkpoints && ckpt.every && msgs >= next_checkpoint &&
+        take_checkpoint(ckpt, symtab, *books, msgs, static_cast<uint64_t>(cur - begin), &background))
+      next_checkpoint = msgs + ckpt.every;
+  }
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (checkpoints) {
+    background.wait();
+    const auto c0 = std::chrono::steady_clock::now();
+    const bool ok = take_checkpoint(ckpt, symtab, *books, msgs, static_cast<uint64_t>(cur - begin), nullptr);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+    std::cout << "Checkpoints: " << background.completed() << " in the background (" << background.failed()
+              << " failed), final at message " << msgs << (ok ? " written in " : " FAILED after ") << ms << " ms"
+              << std::endl;
   }
+  if (cur < end)
+    std::cerr << "Stopped at byte " << (cur - begin) << ": undecodable message" << std::endl;
   std::cout << "File mode finished: messages=" << msgs << ", events=" << events << std::endl;
-  std::cout << "Top snapshot (debug):" << std::endl; ob.display();
+  if (secs > 0)
+    std::cout << "Replay: " << static_cast<uint64_t>(msgs / secs) << " msg/s, "
+              << static_cast<uint64_t>((cur - begin) / secs / (1 << 20)) << " MB/s" << std::endl;
+  print_book_snapshot(*books, symtab);
   std::cout << "File mode finished: messages=" << msgs << ", events=" << events << std::endl;
 }
 
-static void run_file_mode(const std::string& path, bool ultra = false) {
-  if (ultra) {
-    run_file_mode_impl<UltraOrderBook>(path);
-  } else {
-    run_file_mode_impl<OptimizedOrderBook>(path);
+// Parallel replay: books sharded by stock locate across worker threads. With
+// `outputs`, trades and best bid/ask changes are merged back into feed order
+// and folded into a digest that must not depend on the shard count.
+template<typename OB>
+static void run_sharded_file_mode_impl(const std::string& path, const std::string& framing_opt,
+                                       size_t shards, int first_cpu, bool outputs) {
+  core::MappedFile file;
+  if (!file.open(path.c_str())) {
+    std::cerr << "Error: Could not open file " << path << std::endl;
+    return;
+  }
+  const itch::Framing framing =
+      framing_opt == "bare"     ? itch::Framing::Bare
+      : framing_opt == "prefixed" ? itch::Framing::LengthPrefixed
+                                  : itch::detect_framing(file.data(), file.size());
+  std::cout << "Mapped " << file.size() << " bytes from file ("
+            << (framing == itch::Framing::Bare ? "bare" : "length-prefixed") << " framing), "
+            << shards << " shards." << std::endl;
+
+  auto replay = std::make_unique<replay::ShardedReplay<OB>>(shards, first_cpu, book_factory<OB>());
+  uint64_t trades = 0, quotes = 0, digest = 1469598103934665603ull; // FNV-1a
+  if (outputs) {
+    replay->set_sink([&](const replay::ReplayOutput& o) {
+      (o.kind == replay::ReplayOutput::Trade ? trades : quotes)++;
+      for (const uint64_t v : {o.seq, o.order_id, uint64_t(o.qty), uint64_t(o.bid), uint64_t(o.ask)})
+        digest = (digest ^ v) * 1099511628211ull;
+    });
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const size_t used = replay->run(file.data(), file.size(), framing, &file);
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (used < file.size())
+    std::cerr << "Stopped at byte " << used << ": undecodable message" << std::endl;
+  std::cout << "File mode finished: messages=" << replay->messages() << ", events=" << replay->events()
+            << ", books=" << replay->book_count() << std::endl;
+  if (outputs)
+    std::cout << "Merged outputs: trades=" << trades << ", quotes=" << quotes
+              << ", digest=" << std::hex << digest << std::dec << std::endl;
+  if (secs > 0)
+    std::cout << "Replay: " << static_cast<uint64_t>(replay->messages() / secs) << " msg/s, "
+              << static_cast<uint64_t>(used / secs / (1 << 20)) << " MB/s" << std::endl;
+
+  size_t shown = 0;
+  replay->for_each([&](std::string_view symbol, const OB& ob) {
+    if (shown++ >= 10) return;
+    std::cout << "\n===== Order Book for: " << symbol << " =====" << std::endl;
+    ob.display();
+  });
+}
+
+// Book types by --book (--ultra is --book=ultra); f is called with a null OB*
+template <typename Fn>
+static bool with_book_type(const std::string& book, Fn&& f) {
+  if (book == "optimized") f(static_cast<OptimizedOrderBook*>(nullptr));
+  else if (book == "ultra") f(static_cast<UltraOrderBook*>(nullptr));
+  else if (book == "l1") f(static_cast<book::L1Book*>(nullptr));
+  else if (book == "fifo") f(static_cast<book::FifoBook*>(nullptr));
+  else {
+    std::cerr << "Unknown --book=" << book << " (optimized, ultra, l1, fifo)" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static void run_file_mode(const std::string& path, const std::string& book, const std::string& framing,
+                          size_t shards, int first_cpu, bool outputs, const CheckpointOptions& ckpt) {
+  const bool checkpoints = !ckpt.snapshot_path.empty() || !ckpt.restore_path.empty();
+  if (checkpoints && (book != "ultra" || shards > 0)) {
+    std::cerr << "Checkpoints need --ultra books and a single-threaded replay" << std::endl;
+    return;
   }
+  with_book_type(book, [&](auto* tag) {
+    using OB = std::remove_pointer_t<decltype(tag)>;
+    if (shards > 0) run_sharded_file_mode_impl<OB>(path, framing, shards, first_cpu, outputs);
+    else run_file_mode_impl<OB>(path, framing, ckpt);
+  });
 }
 
 template <typename OB>
-static void run_net_mode_impl(const std::string& mcast, int portA, int portB, std::chrono::seconds duration) {
-  using namespace std::chrono;
+static void run_net_mode_impl(const net::RxConfig& rxA, const net::RxConfig& rxB,
+                              std::chrono::seconds duration, net::Framing framing, bool spin, int book_cpu,
+                              int report_secs, const CheckpointOptions& ckpt) {
   core::SymbolTable symtab;
   itch::Decoder decoder(symtab);
+  auto books = std::make_unique<core::BookRouter<OB>>(book_factory<OB>()); // per-symbol books
+  core::snapshot::Header restored{};
+  if (!ckpt.restore_path.empty() && !restore_checkpoint(ckpt.restore_path, symtab, *books, restored)) return;
 
   // Latency trackers for different pipeline stages
-  perf::LatencyTracker net_to_arbiter_latency(5000);
-  perf::LatencyTracker decode_latency(5000);
-  perf::LatencyTracker orderbook_latency(5000);
-  perf::LatencyTracker end_to_end_latency(5000);
+  perf::LatencyTracker wire_to_arbiter_latency; // rx stamp -> arbiter hands it out
+  perf::LatencyTracker wire_to_book_latency;    // rx stamp -> book updated
+  perf::LatencyTracker net_to_arbiter_latency;
+  perf::LatencyTracker decode_latency;
+  perf::LatencyTracker orderbook_latency;
+  perf::LatencyTracker end_to_end_latency;
 
-  net::FeedListener feedA(mcast, portA, 65536);
-  net::FeedListener feedB(mcast, portB, 65536);
+  net::FeedListener feedA(rxA);
+  net::FeedListener feedB(rxB);
   feedA.start();
   feedB.start();
 
   // Bind arbiter to listeners
   net::Arbiter arb(
     [&](core::PacketView& p){ return feedA.pop(p); },
-    [&](core::PacketView& p){ return feedB.pop(p); }
+    [&](core::PacketView& p){ return feedB.pop(p); },
+    65536, std::chrono::milliseconds(50), framing
+  );
+  if (!ckpt.restore_path.empty()) arb.resume_after(restored.sequence); // only the tail is applied
+  arb.set_release(
+    [&](const core::PacketView& p){ feedA.release(p); },
+    [&](const core::PacketView& p){ feedB.release(p); }
   );
 
-  auto t0 = high_resolution_clock::now();
+  if (book_cpu >= 0 && !perf::pin_current_thread(book_cpu))
+    std::cerr << "book thread: cannot pin to cpu " << book_cpu << std::endl;
+
+  // Stage timestamps are cycle-counter reads; one wall clock read per
+  // message relates the packet's receive stamp to them
+  const perf::TscClock clock;
+  const uint64_t deadline =
+      clock.now() + clock.from_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+  const uint64_t report_ticks = clock.from_ns(uint64_t(report_secs > 0 ? report_secs : 0) * 1000000000ull);
+  uint64_t next_report = clock.now() + report_ticks;
   size_t packets = 0, events = 0;
 
-  OB ob; // OrderBook instance (Optimized or Ultra)
-  while (high_resolution_clock::now() - t0 < duration) {
-    // Start end-to-end timing
-    auto e2e_start = perf::now();
-    
-    // Measure arbiter (network + ordering) latency
-    auto arb_start = perf::now();
+  // Checkpoints tag the books with the last sequence the arbiter handed out
+  core::BackgroundSnapshot background;
+  const uint64_t ckpt_ticks = ckpt.snapshot_path.empty() ? 0 : clock.from_ns(ckpt.every * 1000000000ull);
+  uint64_t next_ckpt = clock.now() + ckpt_ticks;
+
+  uint64_t t_poll = clock.now(); // start of the current arbiter poll
+  while (t_poll < deadline) {
+    if (ckpt_ticks && t_poll >= next_ckpt) {
+      if (!take_checkpoint(ckpt, symtab, *books, arb.expected_sequence() - 1, 0, &background))
+        std::cerr << "checkpoint: previous one still being written" << std::endl;
+      next_ckpt = t_poll + ckpt_ticks;
+    }
+    if (report_ticks && t_poll >= next_report) {
+      // Interval view of the wire-to-book tail; the run totals come at the end
+      const auto iv = wire_to_book_latency.interval().stats();
+      std::cout << "interval: wire-to-book n=" << iv.count << " p50=" << iv.p50_ns << " p99=" << iv.p99_ns
+                << " p99.9=" << iv.p999_ns << " ns, events=" << events << std::endl;
+      next_report = t_poll + report_ticks;
+    }
     auto msg_opt = arb.next_message();
-    if (!msg_opt) { 
-      std::this_thread::sleep_for(std::chrono::microseconds(100)); 
-      continue; 
+    if (!msg_opt) {
+      // Spin: the next message is picked up within one poll, not one sleep
+      if (spin) perf::cpu_relax();
+      else std::this_thread::sleep_for(std::chrono::microseconds(100));
+      t_poll = clock.now();
+      continue;
     }
-    auto arb_end = perf::now();
-    net_to_arbiter_latency.record(perf::elapsed_ns(arb_start, arb_end));
-    
+    const uint64_t t_arb = clock.now();
+    net_to_arbiter_latency.record(clock.elapsed_ns(t_poll, t_arb));
+    uint64_t since_rx = 0;
+    const bool stamped = perf::since_rx_ns(msg_opt->rx_ns, perf::wall_ns(), since_rx);
+    if (stamped) wire_to_arbiter_latency.record(since_rx);
+
     ++packets; // counting messages now
 
-    // Measure decode latency
-    auto decode_start = perf::now();
     auto res = decoder.decode_one(msg_opt->data, msg_opt->len);
-    auto decode_end = perf::now();
-    decode_latency.record(perf::elapsed_ns(decode_start, decode_end));
-    
+    const uint64_t t_decode = clock.now();
+    decode_latency.record(clock.elapsed_ns(t_arb, t_decode));
+
     if (res.event.has_value()) {
-      // Measure order book update latency
-      auto ob_start = perf::now();
-      core::apply(*res.event, ob);
-      auto ob_end = perf::now();
-      orderbook_latency.record(perf::elapsed_ns(ob_start, ob_end));
-      
+      books->apply(*res.event);
+      const uint64_t t_book = clock.now();
+      orderbook_latency.record(clock.elapsed_ns(t_decode, t_book));
       ++events;
-      
-      // Record full end-to-end latency
-      auto e2e_end = perf::now();
-      end_to_end_latency.record(perf::elapsed_ns(e2e_start, e2e_end));
+      end_to_end_latency.record(clock.elapsed_ns(t_poll, t_book));
+      if (stamped) wire_to_book_latency.record(since_rx + clock.elapsed_ns(t_arb, t_book));
+      t_poll = t_book;
+    } else {
+      t_poll = t_decode;
     }
   }
 
   feedA.stop();
   feedB.stop();
+  if (!ckpt.snapshot_path.empty()) {
+    background.wait();
+    const bool ok = take_checkpoint(ckpt, symtab, *books, arb.expected_sequence() - 1, 0, nullptr);
+    std::cout << "Checkpoints: " << background.completed() << " in the background (" << background.failed()
+              << " failed), final at sequence " << arb.expected_sequence() - 1 << (ok ? "" : " FAILED")
+              << std::endl;
+  }
   auto m = arb.metrics();
   std::cout << "Net mode finished: packets=" << packets << ", events=" << events
             << " | gaps: detected=" << m.gap_detected
             << ", filled=" << m.gap_filled
             << ", dropped_ttl=" << m.gap_dropped_ttl
             << ", dup_dropped=" << m.dup_dropped
+            << " | holes recovered=" << m.holes_recovered
+            << ", wait avg=" << (m.holes_recovered ? m.hole_wait_ns / m.holes_recovered : 0)
+            << " ns, max=" << m.hole_wait_max_ns << " ns"
+            << ", books=" << books->book_count()
             << std::endl;
-  
-  std::cout << "\n=== END-TO-END LATENCY BREAKDOWN ===" << std::endl;
-  net_to_arbiter_latency.print_stats("Network + Arbitration");
+  for (const auto* f : {&feedA, &feedB}) {
+    const auto s = f->stats();
+    std::cout << "Feed: packets=" << s.packets << ", bytes=" << s.bytes
+              << ", stalls=" << s.stalls << ", dropped=" << s.dropped << std::endl;
+  }
+
+  std::cout << "\n=== END-TO-END LATENCY BREAKDOWN (" << (spin ? "spin" : "sleep") << " poll, "
+            << (clock.uses_tsc() ? "tsc" : "steady_clock") << " timing) ===" << std::endl;
+  wire_to_arbiter_latency.print_stats("Wire to Arbiter (NIC/kernel + queue)");
+  net_to_arbiter_latency.print_stats("Arbitration");
   decode_latency.print_stats("ITCH Decoding");
   orderbook_latency.print_stats("Order Book Update");
   end_to_end_latency.print_stats("Total End-to-End");
+  wire_to_book_latency.print_stats("Wire to Book");
 }
 
-static void run_net_mode(const std::string& mcast, int portA, int portB, bool ultra, int seconds_param) {
+static void run_net_mode(const net::RxConfig& rxA, const net::RxConfig& rxB, const std::string& book,
+                         int seconds_param, net::Framing framing, bool spin, int book_cpu, int report_secs,
+                         const CheckpointOptions& ckpt) {
   using namespace std::chrono;
   seconds dur = seconds_param > 0 ? seconds(seconds_param) : seconds(10);
-  if (ultra) {
-    run_net_mode_impl<UltraOrderBook>(mcast, portA, portB, dur);
-  } else {
-    run_net_mode_impl<OptimizedOrderBook>(mcast, portA, portB, dur);
+  if (book != "ultra" && (!ckpt.snapshot_path.empty() || !ckpt.restore_path.empty())) {
+    std::cerr << "Checkpoints need --ultra books" << std::endl;
+    return;
   }
+  with_book_type(book, [&](auto* tag) {
+    using OB = std::remove_pointer_t<decltype(tag)>;
+    run_net_mode_impl<OB>(rxA, rxB, dur, framing, spin, book_cpu, report_secs, ckpt);
+  });
 }
 
 int main(int argc, char *argv[]) {
-  // CLI: --mode=net --mcast=239.0.0.1 --port-a=5007 --port-b=5008 | default: file <path>
+  // CLI: --mode=net --mcast=239.0.0.1 --port-a=5007 --port-b=5008 [--mold] [--ultra | --book=KIND] [--rx=xdp --ifname=eth0
+  //        --queue-a=N --queue-b=N] [--cpu-a=N --cpu-b=N --cpu-book=N] [--spin [--isolcpus]] [--report=SECONDS]
+  //        [--snapshot=PATH [--snapshot-every=SECONDS]] [--restore=PATH]
+  //      | default: file <path>
   std::string mode = (argc > 1) ? argv[1] : "";
   if (mode == "--mode=net") {
-    std::string mcast = "239.0.0.1";
-    int portA = 5007, portB = 5008;
-    bool ultra = false;
+    net::RxConfig rxA, rxB;
+    rxA.mcast_group = "239.0.0.1";
+    rxA.port = 5007;
+    rxB.port = 5008;
+    std::string book = "optimized";
     int duration_sec = 10;
+    net::Framing framing = net::Framing::Itch;
+    bool spin = false, isolcpus = false;
+    int book_cpu = -1;
+    int report_secs = 0;
+    CheckpointOptions ckpt; // --snapshot-every in seconds
     // naive parse of args
     for (int i=2;i<argc;i++) {
       std::string a = argv[i];
       auto eq = a.find('=');
-      if (a.rfind("--mcast=",0)==0) mcast = a.substr(eq+1);
-      else if (a.rfind("--port-a=",0)==0) portA = std::stoi(a.substr(eq+1));
-      else if (a.rfind("--port-b=",0)==0) portB = std::stoi(a.substr(eq+1));
+      if (a.rfind("--mcast=",0)==0) rxA.mcast_group = a.substr(eq+1);
+      else if (a.rfind("--port-a=",0)==0) rxA.port = std::stoi(a.substr(eq+1));
+      else if (a.rfind("--port-b=",0)==0) rxB.port = std::stoi(a.substr(eq+1));
+      else if (a == "--rx=xdp") rxA.kind = rxB.kind = net::RxBackendKind::AfXdp;
+      else if (a.rfind("--ifname=",0)==0) rxA.ifname = rxB.ifname = a.substr(eq+1);
+      else if (a.rfind("--queue-a=",0)==0) rxA.queue_id = static_cast<uint32_t>(std::stoul(a.substr(eq+1)));
+      else if (a.rfind("--queue-b=",0)==0) rxB.queue_id = static_cast<uint32_t>(std::stoul(a.substr(eq+1)));
+      else if (a.rfind("--cpu-a=",0)==0) rxA.cpu = std::stoi(a.substr(eq+1));
+      else if (a.rfind("--cpu-b=",0)==0) rxB.cpu = std::stoi(a.substr(eq+1));
+      else if (a.rfind("--cpu-book=",0)==0) book_cpu = std::stoi(a.substr(eq+1));
+      else if (a == "--spin") spin = true;
+      else if (a == "--isolcpus") isolcpus = true;
+      else if (a.rfind("--report=",0)==0) report_secs = std::stoi(a.substr(eq+1));
       else if (a.rfind("--duration=",0)==0) duration_sec = std::stoi(a.substr(eq+1));
-      else if (a == "--ultra") ultra = true;
+      else if (a == "--ultra") book = "ultra";
+      else if (a.rfind("--book=",0)==0) book = a.substr(eq+1);
+      else if (a == "--mold") framing = net::Framing::MoldUDP64;
+      else if (a.rfind("--snapshot=",0)==0) ckpt.snapshot_path = a.substr(eq+1);
+      else if (a.rfind("--snapshot-every=",0)==0) ckpt.every = std::stoull(a.substr(eq+1));
+      else if (a.rfind("--restore=",0)==0) ckpt.restore_path = a.substr(eq+1);
+    }
+    rxB.mcast_group = rxA.mcast_group;
+    rxA.busy_poll = rxB.busy_poll = spin;
+    if (isolcpus) {
+      // Threads without an explicit cpu take the isolated ones in order
+      const std::vector<int> iso = perf::isolated_cpus();
+      size_t next = 0;
+      for (int* cpu : {&rxA.cpu, &rxB.cpu, &book_cpu})
+        if (*cpu < 0 && next < iso.size()) *cpu = iso[next++];
+      if (iso.empty()) std::cerr << "--isolcpus: no isolated cpus, leaving threads unpinned" << std::endl;
+      std::cout << "CPU placement: feed A=" << rxA.cpu << ", feed B=" << rxB.cpu
+                << ", book=" << book_cpu << " (-1: unpinned)" << std::endl;
     }
-    run_net_mode(mcast, portA, portB, ultra, duration_sec);
+    run_net_mode(rxA, rxB, book, duration_sec, framing, spin, book_cpu, report_secs, ckpt);
     return 0;
   }
 
   if (argc >= 2) {
-    bool ultra = false;
-    // Check for --ultra flag in file mode
+    std::string book = "optimized";
+    std::string framing = "auto";
+    size_t shards = 0; // 0: single-threaded replay
+    int first_cpu = -1;
+    bool outputs = false;
+    CheckpointOptions ckpt; // --snapshot-every in messages
+    // File mode flags: --ultra | --book=optimized|ultra|l1|fifo, --framing=auto|bare|prefixed,
+    // --shards=N [--cpu=K --outputs],
+    // --snapshot=PATH [--snapshot-every=N], --restore=PATH
     for (int i = 2; i < argc; i++) {
-      if (std::string(argv[i]) == "--ultra") {
-        ultra = true;
-        break;
-      }
+      const std::string a = argv[i];
+      if (a == "--ultra") book = "ultra";
+      else if (a.rfind("--book=", 0) == 0) book = a.substr(7);
+      else if (a.rfind("--framing=", 0) == 0) framing = a.substr(10);
+      else if (a.rfind("--shards=", 0) == 0) shards = std::stoul(a.substr(9));
+      else if (a.rfind("--cpu=", 0) == 0) first_cpu = std::stoi(a.substr(6));
+      else if (a == "--outputs") outputs = true;
+      else if (a.rfind("--snapshot=", 0) == 0) ckpt.snapshot_path = a.substr(11);
+      else if (a.rfind("--snapshot-every=", 0) == 0) ckpt.every = std::stoull(a.substr(17));
+      else if (a.rfind("--restore=", 0) == 0) ckpt.restore_path = a.substr(10);
     }
-    run_file_mode(argv[1], ultra);
+    run_file_mode(argv[1], book, framing, shards, first_cpu, outputs, ckpt);
     return 0;
   }
 
-  std::cerr << "Usage: " << argv[0] << " <path_to_data.bin> [--ultra]\n"
-            << "   or: " << argv[0] << " --mode=net [--mcast=239.0.0.1 --port-a=5007 --port-b=5008 --ultra --duration=SECONDS]" << std::endl;
+  std::cerr << "Usage: " << argv[0] << " <path_to_data.bin> [--ultra | --book=optimized|ultra|l1|fifo]\n"
+            << "        [--framing=auto|bare|prefixed]\n"
+            << "        [--shards=N --cpu=FIRST_CPU --outputs]\n"
+            << "        [--snapshot=PATH --snapshot-every=MESSAGES --restore=PATH] (with --ultra)\n"
+            << "   or: " << argv[0] << " --mode=net [--mcast=239.0.0.1 --port-a=5007 --port-b=5008 --ultra | --book=KIND --mold\n"
+            << "        --duration=SECONDS]\n"
+            << "        [--rx=xdp --ifname=IF --queue-a=N --queue-b=N --cpu-a=N --cpu-b=N --cpu-book=N]\n"
+            << "        [--spin --isolcpus --report=SECONDS]\n"
+            << "        [--snapshot=PATH --snapshot-every=SECONDS --restore=PATH] (with --ultra)" << std::endl;
   return 1;
 }
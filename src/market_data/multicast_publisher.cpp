@@ -0,0 +1,162 @@
+#include "market_data/multicast_publisher.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace market_data {
+
+MulticastPublisher::MulticastPublisher(const std::string& id, const MulticastConfig& config)
+    : subscriber_id_(id), config_(config) {
+    // Room for at least the largest wire message
+    config_.max_datagram = std::max(config_.max_datagram, net::mold::HEADER_SIZE + 2 + sizeof(wire::Trade));
+    config_.batch_packets = std::max<size_t>(config_.batch_packets, 1);
+    std::memset(session_, ' ', net::mold::SESSION_LEN);
+    std::memcpy(session_, config_.session.data(), std::min(config_.session.size(), net::mold::SESSION_LEN));
+    buffers_.resize(config_.max_datagram * config_.batch_packets);
+    lengths_.reserve(config_.batch_packets);
+}
+
+MulticastPublisher::~MulticastPublisher() {
+    close();
+}
+
+bool MulticastPublisher::open() {
+    if (sock_ >= 0) {
+        return true;
+    }
+
+    sock_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock_ < 0) { perror("socket"); return false; }
+
+    in_addr iface{};
+    iface.s_addr = inet_addr(config_.interface.c_str());
+    const unsigned char ttl = static_cast<unsigned char>(config_.ttl);
+    const unsigned char loop = config_.loopback ? 1 : 0;
+    if (setsockopt(sock_, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0 ||
+        setsockopt(sock_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+        setsockopt(sock_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+        perror("multicast setsockopt");
+        close();
+        return false;
+    }
+
+    // Connected, so sendmmsg needs no per-message address
+    sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = inet_addr(config_.group.c_str());
+    dest.sin_port = htons(config_.port);
+    if (::connect(sock_, reinterpret_cast<sockaddr*>(&dest), sizeof(dest)) < 0) {
+        perror("connect");
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MulticastPublisher::close() {
+    if (sock_ >= 0) {
+        flush();
+        ::close(sock_);
+    }
+    sock_ = -1;
+}
+
+void MulticastPublisher::on_market_data(const MarketDataMessage& message) {
+    if (sock_ < 0) {
+        return;
+    }
+    wire::encode(message, [this](const void* msg, uint16_t len) { append(msg, len); });
+}
+
+void MulticastPublisher::append(const void* msg, uint16_t len) {
+    if (!packet_open_) {
+        begin_packet();
+    }
+    if (!writer_.append(msg, len)) {
+        close_packet();
+        begin_packet();
+        writer_.append(msg, len);
+    }
+    ++next_sequence_;
+}
+
+void MulticastPublisher::begin_packet() {
+    // A full batch goes out before its slots are reused
+    if (lengths_.size() == config_.batch_packets) {
+        flush();
+    }
+    writer_ = net::mold::PacketWriter(buffers_.data() + lengths_.size() * config_.max_datagram,
+                                      config_.max_datagram);
+    writer_.begin(session_, next_sequence_);
+    packet_open_ = true;
+}
+
+void MulticastPublisher::close_packet() {
+    lengths_.push_back(writer_.size());
+    messages_.fetch_add(writer_.count(), std::memory_order_relaxed);
+    packet_open_ = false;
+}
+
+void MulticastPublisher::flush() {
+    if (packet_open_ && writer_.count() > 0) {
+        close_packet();
+    }
+    packet_open_ = false;
+    if (lengths_.empty()) {
+        return;
+    }
+
+    const size_t n = lengths_.size();
+    size_t sent = 0;
+#ifdef __linux__
+    mmsghdr msgs[64];
+    iovec iovs[64];
+    while (sent < n) {
+        const size_t batch = std::min<size_t>(n - sent, 64);
+        for (size_t i = 0; i < batch; ++i) {
+            iovs[i].iov_base = buffers_.data() + (sent + i) * config_.max_datagram;
+            iovs[i].iov_len = lengths_[sent + i];
+            std::memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int r = ::sendmmsg(sock_, msgs, static_cast<unsigned>(batch), 0);
+        send_calls_.fetch_add(1, std::memory_order_relaxed);
+        if (r <= 0) {
+            // The first packet was refused; skip it and carry on with the rest
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+            ++sent;
+            continue;
+        }
+        packets_.fetch_add(static_cast<uint64_t>(r), std::memory_order_relaxed);
+        sent += static_cast<size_t>(r);
+    }
+#else
+    // Portable path: one send per packet
+    for (; sent < n; ++sent) {
+        const ssize_t r = ::send(sock_, buffers_.data() + sent * config_.max_datagram, lengths_[sent], 0);
+        send_calls_.fetch_add(1, std::memory_order_relaxed);
+        if (r < 0) {
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            packets_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+#endif
+    lengths_.clear();
+}
+
+MulticastPublisher::Stats MulticastPublisher::get_stats() const {
+    Stats stats;
+    stats.messages = messages_.load(std::memory_order_relaxed);
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.send_calls = send_calls_.load(std::memory_order_relaxed);
+    stats.send_errors = send_errors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace market_data
@@ -1,4 +1,6 @@
 #include "market_data/publisher.hpp"
+#include "perf/cpu.hpp"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -8,11 +10,19 @@ namespace market_data {
 // MarketDataPublisher Implementation
 
 MarketDataPublisher::MarketDataPublisher(SymbolManager& sym_mgr, MatchingEngine& engine)
-    : symbol_manager_(sym_mgr), matching_engine_(engine) {
+    : symbol_manager_(sym_mgr), matching_engine_(engine), message_queue_(config_.max_queue_size) {
+    // Depth updates are built from the book's own change records
+    matching_engine_.track_level_changes(true);
 }
 
 MarketDataPublisher::~MarketDataPublisher() {
     stop();
+    for (auto& slot : slots_) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+    for (auto& page : index_pages_) {
+        delete page.load(std::memory_order_relaxed);
+    }
 }
 
 bool MarketDataPublisher::start() {
@@ -21,6 +31,13 @@ bool MarketDataPublisher::start() {
     }
     
     publisher_thread_ = std::thread(&MarketDataPublisher::publisher_loop, this);
+    
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (auto& slot : slots_) {
+        if (SubscriberSlot* s = slot.load(std::memory_order_relaxed)) {
+            start_delivery(*s);
+        }
+    }
     return true;
 }
 
@@ -29,15 +46,20 @@ void MarketDataPublisher::stop() {
         return; // Already stopped
     }
     
-    // Wake up publisher thread
-    queue_cv_.notify_all();
-    
     if (publisher_thread_.joinable()) {
         publisher_thread_.join();
     }
+    
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (auto& slot : slots_) {
+        if (SubscriberSlot* s = slot.load(std::memory_order_relaxed)) {
+            stop_delivery(*s);
+        }
+    }
 }
 
-bool MarketDataPublisher::add_subscriber(std::shared_ptr<MarketDataSubscriber> subscriber) {
+bool MarketDataPublisher::add_subscriber(std::shared_ptr<MarketDataSubscriber> subscriber,
+                                         const SubscriberOptions& options) {
     if (!subscriber) return false;
     
     std::lock_guard<std::mutex> lock(subscribers_mutex_);
@@ -47,11 +69,20 @@ bool MarketDataPublisher::add_subscriber(std::shared_ptr<MarketDataSubscriber> s
         return false; // Subscriber already exists
     }
     
-    SubscriberInfo info;
-    info.subscriber = subscriber;
-    info.active = true;
+    uint32_t index = 0;
+    while (index < MAX_SUBSCRIBERS && slots_[index].load(std::memory_order_relaxed)) {
+        ++index;
+    }
+    if (index == MAX_SUBSCRIBERS) {
+        return false; // No free slot
+    }
     
-    subscribers_[id] = std::move(info);
+    auto* slot = new SubscriberSlot(std::move(subscriber), options, next_generation_++);
+    slots_[index].store(slot, std::memory_order_release);
+    subscribers_[id] = index;
+    if (running_.load()) {
+        start_delivery(*slot);
+    }
     
     std::lock_guard<std::mutex> stats_lock(stats_mutex_);
     stats_.subscribers = subscribers_.size();
@@ -67,6 +98,21 @@ bool MarketDataPublisher::remove_subscriber(const std::string& subscriber_id) {
         return false;
     }
     
+    const uint32_t index = it->second;
+    SubscriberSlot* slot = slots_[index].load(std::memory_order_relaxed);
+    const uint64_t bit = uint64_t(1) << index;
+    {
+        std::lock_guard<std::mutex> slot_lock(slot->mutex);
+        for (const auto& sub : slot->subscriptions) {
+            index_mask(sub.symbol, sub.message_type).fetch_and(~bit, std::memory_order_release);
+        }
+    }
+    slots_[index].store(nullptr, std::memory_order_release);
+    
+    // Once no fan-out can still reach the slot, it can go
+    wait_for_fanout();
+    stop_delivery(*slot);
+    delete slot;
     subscribers_.erase(it);
     
     std::lock_guard<std::mutex> stats_lock(stats_mutex_);
@@ -75,6 +121,23 @@ bool MarketDataPublisher::remove_subscriber(const std::string& subscriber_id) {
     return true;
 }
 
+std::optional<SubscriberStats> MarketDataPublisher::get_subscriber_stats(const std::string& subscriber_id) const {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    
+    auto it = subscribers_.find(subscriber_id);
+    if (it == subscribers_.end()) {
+        return std::nullopt;
+    }
+    
+    const SubscriberSlot& slot = *slots_[it->second].load(std::memory_order_relaxed);
+    SubscriberStats stats;
+    stats.delivered = slot.delivered.load(std::memory_order_relaxed);
+    stats.dropped = slot.dropped.load(std::memory_order_relaxed);
+    stats.conflated = slot.conflated_count.load(std::memory_order_relaxed);
+    stats.latency = slot.latency.get_stats();
+    return stats;
+}
+
 bool MarketDataPublisher::subscribe(const std::string& subscriber_id, SymbolId symbol, 
                                    MessageType type, uint32_t depth, 
                                    std::chrono::milliseconds throttle) {
@@ -85,29 +148,34 @@ bool MarketDataPublisher::subscribe(const std::string& subscriber_id, SymbolId s
         return false;
     }
     
-    // Check if subscription already exists
-    for (auto& sub : it->second.subscriptions) {
-        if (sub.symbol == symbol && sub.message_type == type) {
-            // Update existing subscription
-            sub.max_depth = depth;
-            sub.throttle_ms = throttle;
-            sub.enabled = true;
-            return true;
+    SubscriberSlot& slot = *slots_[it->second].load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> slot_lock(slot.mutex);
+        
+        // Check if subscription already exists
+        for (auto& sub : slot.subscriptions) {
+            if (sub.symbol == symbol && sub.message_type == type) {
+                // Update existing subscription
+                sub.max_depth = depth;
+                sub.throttle_ms = throttle;
+                sub.enabled = true;
+                return true;
+            }
         }
+        
+        // Create new subscription
+        Subscription subscription;
+        subscription.symbol = symbol;
+        subscription.message_type = type;
+        subscription.max_depth = depth;
+        subscription.throttle_ms = throttle;
+        subscription.enabled = true;
+        slot.subscriptions.push_back(subscription);
     }
-    
-    // Create new subscription
-    Subscription subscription;
-    subscription.symbol = symbol;
-    subscription.message_type = type;
-    subscription.max_depth = depth;
-    subscription.throttle_ms = throttle;
-    subscription.enabled = true;
-    
-    it->second.subscriptions.push_back(subscription);
+    index_mask(symbol, type).fetch_or(uint64_t(1) << it->second, std::memory_order_release);
     
     // Notify subscriber
-    it->second.subscriber->on_subscription_status(symbol, type, true);
+    slot.subscriber->on_subscription_status(symbol, type, true);
     
     return true;
 }
@@ -120,18 +188,24 @@ bool MarketDataPublisher::unsubscribe(const std::string& subscriber_id, SymbolId
         return false;
     }
     
-    auto& subscriptions = it->second.subscriptions;
-    for (auto sub_it = subscriptions.begin(); sub_it != subscriptions.end(); ++sub_it) {
-        if (sub_it->symbol == symbol && sub_it->message_type == type) {
-            subscriptions.erase(sub_it);
-            
-            // Notify subscriber
-            it->second.subscriber->on_subscription_status(symbol, type, false);
-            return true;
+    SubscriberSlot& slot = *slots_[it->second].load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> slot_lock(slot.mutex);
+        auto& subscriptions = slot.subscriptions;
+        auto sub_it = std::find_if(subscriptions.begin(), subscriptions.end(), [&](const Subscription& sub) {
+            return sub.symbol == symbol && sub.message_type == type;
+        });
+        if (sub_it == subscriptions.end()) {
+            return false;
         }
+        subscriptions.erase(sub_it);
     }
+    // Anything already queued is still checked against the subscriptions
+    index_mask(symbol, type).fetch_and(~(uint64_t(1) << it->second), std::memory_order_release);
     
-    return false;
+    // Notify subscriber
+    slot.subscriber->on_subscription_status(symbol, type, false);
+    return true;
 }
 
 bool MarketDataPublisher::subscribe_all_symbols(const std::string& subscriber_id, MessageType type) {
@@ -153,27 +227,59 @@ bool MarketDataPublisher::subscribe_symbol_list(const std::string& subscriber_id
 void MarketDataPublisher::publish_level1_update(SymbolId symbol) {
     if (!config_.enable_level1) return;
     
+    // Cached top of book; only a change is worth a message
+    const Level1Data top = matching_engine_.get_level1_data(symbol);
+    if (symbol >= last_level1_.size()) {
+        last_level1_.resize(size_t(symbol) + 1);
+    }
+    TopOfBook& last = last_level1_[symbol];
+    if (last.sent &&
+        top.best_bid_price == last.data.best_bid_price && top.best_bid_quantity == last.data.best_bid_quantity &&
+        top.best_ask_price == last.data.best_ask_price && top.best_ask_quantity == last.data.best_ask_quantity) {
+        return;
+    }
+    last.data = top;
+    last.sent = true;
+    
     MarketDataMessage message;
     message.type = MessageType::LEVEL1_UPDATE;
     message.sequence_number = next_sequence();
     message.timestamp = std::chrono::high_resolution_clock::now();
-    message.data.level1 = build_level1_update(symbol);
+    message.data.level1.symbol = symbol;
+    message.data.level1.best_bid_price = top.best_bid_price;
+    message.data.level1.best_bid_quantity = top.best_bid_quantity;
+    message.data.level1.best_ask_price = top.best_ask_price;
+    message.data.level1.best_ask_quantity = top.best_ask_quantity;
+    message.data.level1.sequence_number = message.sequence_number;
+    message.data.level1.timestamp = message.timestamp;
     
     enqueue_message(std::move(message));
 }
 
 void MarketDataPublisher::publish_level2_update(SymbolId symbol) {
-    if (!config_.enable_level2) return;
+    if (!config_.enable_level2) {
+        // Keep the change records from piling up
+        matching_engine_.drain_level_changes(symbol, [](const LevelChange&) {});
+        return;
+    }
+    
+    Level2Update changes = build_level2_changes(symbol);
+    if (changes.price_levels.empty()) return;
     
     MarketDataMessage message;
     message.type = MessageType::LEVEL2_UPDATE;
     message.sequence_number = next_sequence();
-    message.timestamp = std::chrono::high_resolution_clock::now();
-    message.data.level2 = build_level2_update(symbol, false);
+    message.timestamp = changes.timestamp;
+    message.data.level2 = std::move(changes);
     
     enqueue_message(std::move(message));
 }
 
+void MarketDataPublisher::publish_book_changes(SymbolId symbol) {
+    publish_level2_update(symbol);
+    publish_level1_update(symbol);
+}
+
 void MarketDataPublisher::publish_trade(const Fill& fill) {
     if (!config_.enable_trades) return;
     
@@ -206,12 +312,7 @@ void MarketDataPublisher::send_level1_snapshot(const std::string& subscriber_id,
     message.timestamp = std::chrono::high_resolution_clock::now();
     message.data.level1 = build_level1_update(symbol);
     
-    // Send directly to specific subscriber
-    std::lock_guard<std::mutex> lock(subscribers_mutex_);
-    auto it = subscribers_.find(subscriber_id);
-    if (it != subscribers_.end() && it->second.active) {
-        it->second.subscriber->on_market_data(message);
-    }
+    enqueue_snapshot(subscriber_id, std::move(message));
 }
 
 void MarketDataPublisher::send_level2_snapshot(const std::string& subscriber_id, SymbolId symbol, uint32_t depth) {
@@ -219,19 +320,9 @@ void MarketDataPublisher::send_level2_snapshot(const std::string& subscriber_id,
     message.type = MessageType::SNAPSHOT_L2;
     message.sequence_number = next_sequence();
     message.timestamp = std::chrono::high_resolution_clock::now();
-    message.data.level2 = build_level2_update(symbol, true);
-    
-    // Limit depth
-    if (message.data.level2.price_levels.size() > depth * 2) { // *2 for both sides
-        message.data.level2.price_levels.resize(depth * 2);
-    }
+    message.data.level2 = build_level2_snapshot(symbol, depth);
     
-    // Send directly to specific subscriber
-    std::lock_guard<std::mutex> lock(subscribers_mutex_);
-    auto it = subscribers_.find(subscriber_id);
-    if (it != subscribers_.end() && it->second.active) {
-        it->second.subscriber->on_market_data(message);
-    }
+    enqueue_snapshot(subscriber_id, std::move(message));
 }
 
 MarketDataPublisher::Stats MarketDataPublisher::get_stats() const {
@@ -240,7 +331,8 @@ MarketDataPublisher::Stats MarketDataPublisher::get_stats() const {
 }
 
 void MarketDataPublisher::reset_stats() {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
     stats_ = {};
     stats_.subscribers = subscribers_.size();
 }
@@ -262,7 +354,9 @@ std::vector<Subscription> MarketDataPublisher::get_subscriptions(const std::stri
     
     auto it = subscribers_.find(subscriber_id);
     if (it != subscribers_.end()) {
-        return it->second.subscriptions;
+        SubscriberSlot& slot = *slots_[it->second].load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> slot_lock(slot.mutex);
+        return slot.subscriptions;
     }
     
     return {};
@@ -270,96 +364,241 @@ std::vector<Subscription> MarketDataPublisher::get_subscriptions(const std::stri
 
 // Private methods
 
+namespace {
+
+// Spin briefly when a queue runs dry, then back off to short sleeps
+void idle_wait(uint32_t& idle_polls) {
+    constexpr uint32_t SPIN_POLLS = 1024;
+    if (++idle_polls < SPIN_POLLS) {
+        perf::cpu_relax();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+} // namespace
+
 void MarketDataPublisher::enqueue_message(MarketDataMessage&& message) {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    
-    if (message_queue_.size() >= config_.max_queue_size) {
-        // Drop oldest message
-        message_queue_.pop();
+    QueuedMessage queued;
+    queued.message = std::move(message);
+    if (!message_queue_.push(std::move(queued))) {
+        // Publisher thread is behind; the newest message is the one lost
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        stats_.dropped_messages++;
+    }
+}
+
+void MarketDataPublisher::enqueue_snapshot(const std::string& subscriber_id, MarketDataMessage&& message) {
+    QueuedMessage queued;
+    {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        auto it = subscribers_.find(subscriber_id);
+        if (it == subscribers_.end()) {
+            return;
+        }
+        queued.target = it->second;
+        queued.target_generation = slots_[it->second].load(std::memory_order_relaxed)->generation;
+    }
+    queued.message = std::move(message);
+    if (!message_queue_.push(std::move(queued))) {
         std::lock_guard<std::mutex> stats_lock(stats_mutex_);
         stats_.dropped_messages++;
     }
-    
-    message_queue_.push(std::move(message));
-    queue_cv_.notify_one();
 }
 
 void MarketDataPublisher::publisher_loop() {
-    while (running_.load()) {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        
-        queue_cv_.wait(lock, [this] {
-            return !message_queue_.empty() || !running_.load();
-        });
-        
-        while (!message_queue_.empty() && running_.load()) {
-            MarketDataMessage message = std::move(message_queue_.front());
-            message_queue_.pop();
-            lock.unlock();
-            
-            deliver_message(message);
-            update_stats(message.type);
-            
-            lock.lock();
+    publisher_active_.store(true, std::memory_order_release);
+    QueuedMessage queued;
+    uint32_t idle_polls = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        if (message_queue_.pop(queued)) {
+            idle_polls = 0;
+            if (queued.target == QueuedMessage::ALL) {
+                deliver_message(queued.message);
+                delivery_latency_.record(perf::elapsed_ns(queued.message.timestamp));
+                update_stats(queued.message.type);
+            } else {
+                // A snapshot: only for the subscriber that asked, if still there
+                SubscriberSlot* slot = slots_[queued.target].load(std::memory_order_acquire);
+                if (slot && slot->generation == queued.target_generation) {
+                    if (!push_to(*slot, queued.message)) {
+                        slot->lost++;
+                        slot->dropped.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        } else {
+            idle_wait(idle_polls);
         }
+        fanout_epoch_.fetch_add(1, std::memory_order_release);
     }
+    publisher_active_.store(false, std::memory_order_release);
 }
 
 void MarketDataPublisher::deliver_message(const MarketDataMessage& message) {
-    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    // Fan out to every subscribed slot's queue; delivery happens on the
+    // subscribers' own threads
+    uint64_t mask = subscriber_mask(message_symbol(message), message.type);
+    while (mask) {
+        const uint32_t index = static_cast<uint32_t>(__builtin_ctzll(mask));
+        mask &= mask - 1;
+        if (SubscriberSlot* slot = slots_[index].load(std::memory_order_acquire)) {
+            enqueue_for(*slot, message);
+        }
+    }
+}
+
+void MarketDataPublisher::enqueue_for(SubscriberSlot& slot, const MarketDataMessage& message) {
+    const bool conflatable = slot.options.overflow == OverflowPolicy::CONFLATE &&
+                             message.type == MessageType::LEVEL1_UPDATE;
     
-    for (auto& [id, sub_info] : subscribers_) {
-        if (!sub_info.active || !should_deliver(sub_info, message)) {
+    // Once a symbol's updates are being conflated, later ones join them
+    // there, so the subscriber never sees an older top after a newer one
+    if (!(conflatable && slot.conflating.load(std::memory_order_acquire)) && push_to(slot, message)) {
+        return;
+    }
+    
+    if (conflatable) {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.conflated[message.data.level1.symbol] = message;
+        slot.conflating.store(true, std::memory_order_release);
+        slot.conflated_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    slot.lost++;
+    slot.dropped.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    stats_.dropped_messages++;
+}
+
+bool MarketDataPublisher::push_to(SubscriberSlot& slot, const MarketDataMessage& message) {
+    if (slot.lost == 0) {
+        return slot.queue.push(message);
+    }
+    // The first message through after a drop tells the subscriber how many
+    // it missed
+    MarketDataMessage marked = message;
+    marked.gap = slot.lost;
+    if (!slot.queue.push(marked)) {
+        return false;
+    }
+    slot.lost = 0;
+    return true;
+}
+
+void MarketDataPublisher::start_delivery(SubscriberSlot& slot) {
+    if (slot.running.exchange(true)) {
+        return;
+    }
+    slot.thread = std::thread(&MarketDataPublisher::delivery_loop, this, std::ref(slot));
+}
+
+void MarketDataPublisher::stop_delivery(SubscriberSlot& slot) {
+    if (!slot.running.exchange(false)) {
+        return;
+    }
+    if (slot.thread.joinable()) {
+        slot.thread.join();
+    }
+}
+
+void MarketDataPublisher::delivery_loop(SubscriberSlot& slot) {
+    MarketDataMessage message;
+    std::unordered_map<SymbolId, MarketDataMessage> conflated;
+    uint64_t gap = 0;   // Lost messages not yet reported, as the filters may skip the marked one
+    uint32_t idle_polls = 0;
+    bool in_batch = false;
+    while (slot.running.load(std::memory_order_acquire)) {
+        if (slot.queue.pop(message)) {
+            idle_polls = 0;
+            in_batch = true;
+            // Snapshots are addressed to this subscriber and skip the filters
+            const bool snapshot = message.type == MessageType::SNAPSHOT_L1 ||
+                                  message.type == MessageType::SNAPSHOT_L2;
+            gap += message.gap;
+            message.gap = gap;
+            if (deliver_to(slot, message, !snapshot)) {
+                gap = 0;
+            }
             continue;
         }
         
-        try {
-            sub_info.subscriber->on_market_data(message);
+        // Queue drained: conflated updates are now the newest there are
+        if (slot.conflating.load(std::memory_order_acquire)) {
+            {
+                std::lock_guard<std::mutex> lock(slot.mutex);
+                conflated.swap(slot.conflated);
+                slot.conflating.store(false, std::memory_order_release);
+            }
+            for (auto& [symbol, update] : conflated) {
+                update.gap = gap;
+                if (deliver_to(slot, update, true)) {
+                    gap = 0;
+                }
+            }
+            in_batch = in_batch || !conflated.empty();
+            conflated.clear();
+            continue;
         }
-        catch (const std::exception& e) {
-            // Log error but continue with other subscribers
-            std::cerr << "Error delivering message to subscriber " << id << ": " << e.what() << std::endl;
+        
+        if (in_batch) {
+            in_batch = false;
+            slot.subscriber->on_batch_end();
+            continue;
         }
+        
+        idle_wait(idle_polls);
+    }
+    if (in_batch) {
+        slot.subscriber->on_batch_end();
     }
 }
 
-bool MarketDataPublisher::should_deliver(const SubscriberInfo& sub_info, const MarketDataMessage& message) {
-    for (auto& subscription : sub_info.subscriptions) {
+bool MarketDataPublisher::deliver_to(SubscriberSlot& slot, const MarketDataMessage& message, bool filter) {
+    if (filter && !should_deliver(slot, message)) {
+        return false;
+    }
+    
+    try {
+        slot.subscriber->on_market_data(message);
+    }
+    catch (const std::exception& e) {
+        // Log error and carry on with the next message
+        std::cerr << "Error delivering message to subscriber " << slot.subscriber->get_subscriber_id()
+                  << ": " << e.what() << std::endl;
+    }
+    slot.delivered.fetch_add(1, std::memory_order_relaxed);
+    slot.latency.record(perf::elapsed_ns(message.timestamp));
+    return true;
+}
+
+bool MarketDataPublisher::should_deliver(SubscriberSlot& slot, const MarketDataMessage& message) {
+    // The index already matched type and symbol at fan-out; this re-check
+    // sees subscriptions changed since, and applies throttling
+    const SymbolId msg_symbol = message_symbol(message);
+    // Level 2 updates carry only the levels that changed: skipping one
+    // would leave the subscriber's book wrong, so they are never throttled
+    const bool throttled = message.type != MessageType::LEVEL2_UPDATE;
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    for (auto& subscription : slot.subscriptions) {
         if (!subscription.enabled) continue;
         
         // Check message type
         if (subscription.message_type != message.type) continue;
         
         // Check symbol filter
-        SymbolId msg_symbol = 0;
-        switch (message.type) {
-            case MessageType::LEVEL1_UPDATE:
-            case MessageType::SNAPSHOT_L1:
-                msg_symbol = message.data.level1.symbol;
-                break;
-            case MessageType::LEVEL2_UPDATE:
-            case MessageType::SNAPSHOT_L2:
-                msg_symbol = message.data.level2.symbol;
-                break;
-            case MessageType::TRADE_REPORT:
-                msg_symbol = message.data.trade.symbol;
-                break;
-            case MessageType::SYMBOL_STATUS:
-                msg_symbol = message.data.status.symbol;
-                break;
-        }
-        
         if (subscription.symbol != 0 && subscription.symbol != msg_symbol) {
             continue; // Symbol doesn't match
         }
         
         // Check throttling
-        auto now = std::chrono::high_resolution_clock::now();
-        if (subscription.throttle_ms.count() > 0) {
+        if (throttled && subscription.throttle_ms.count() > 0) {
+            auto now = std::chrono::high_resolution_clock::now();
             if (now - subscription.last_sent < subscription.throttle_ms) {
                 continue; // Too soon since last message
             }
-            const_cast<Subscription&>(subscription).last_sent = now;
+            subscription.last_sent = now;
         }
         
         return true; // Found matching subscription
@@ -368,6 +607,56 @@ bool MarketDataPublisher::should_deliver(const SubscriberInfo& sub_info, const M
     return false; // No matching subscription
 }
 
+std::atomic<uint64_t>& MarketDataPublisher::index_mask(SymbolId symbol, MessageType type) {
+    // Under subscribers_mutex_, so pages have a single writer
+    const size_t t = static_cast<size_t>(type) % MESSAGE_TYPES;
+    if (symbol == 0) {
+        return all_symbols_masks_[t];
+    }
+    auto& page_ptr = index_pages_[symbol >> INDEX_PAGE_BITS];
+    IndexPage* page = page_ptr.load(std::memory_order_relaxed);
+    if (!page) {
+        page = new IndexPage;
+        page_ptr.store(page, std::memory_order_release);
+    }
+    return page->masks[symbol & ((size_t(1) << INDEX_PAGE_BITS) - 1)][t];
+}
+
+uint64_t MarketDataPublisher::subscriber_mask(SymbolId symbol, MessageType type) const {
+    const size_t t = static_cast<size_t>(type) % MESSAGE_TYPES;
+    uint64_t mask = all_symbols_masks_[t].load(std::memory_order_acquire);
+    if (const IndexPage* page = index_pages_[symbol >> INDEX_PAGE_BITS].load(std::memory_order_acquire)) {
+        mask |= page->masks[symbol & ((size_t(1) << INDEX_PAGE_BITS) - 1)][t].load(std::memory_order_acquire);
+    }
+    return mask;
+}
+
+void MarketDataPublisher::wait_for_fanout() {
+    // Any fan-out that began before the caller's index update ends with a
+    // bump of the epoch
+    const uint64_t epoch = fanout_epoch_.load(std::memory_order_acquire);
+    while (publisher_active_.load(std::memory_order_acquire) &&
+           fanout_epoch_.load(std::memory_order_acquire) == epoch) {
+        std::this_thread::yield();
+    }
+}
+
+SymbolId MarketDataPublisher::message_symbol(const MarketDataMessage& message) {
+    switch (message.type) {
+        case MessageType::LEVEL1_UPDATE:
+        case MessageType::SNAPSHOT_L1:
+            return message.data.level1.symbol;
+        case MessageType::LEVEL2_UPDATE:
+        case MessageType::SNAPSHOT_L2:
+            return message.data.level2.symbol;
+        case MessageType::TRADE_REPORT:
+            return message.data.trade.symbol;
+        case MessageType::SYMBOL_STATUS:
+            return message.data.status.symbol;
+    }
+    return 0;
+}
+
 Level1Update MarketDataPublisher::build_level1_update(SymbolId symbol) {
     Level1Update update;
     update.symbol = symbol;
@@ -384,42 +673,47 @@ Level1Update MarketDataPublisher::build_level1_update(SymbolId symbol) {
     return update;
 }
 
-Level2Update MarketDataPublisher::build_level2_update(SymbolId symbol, bool is_snapshot) {
+Level2Update MarketDataPublisher::build_level2_snapshot(SymbolId symbol, uint32_t depth) {
     Level2Update update;
     update.symbol = symbol;
     update.sequence_number = sequence_number_.load();
     update.timestamp = std::chrono::high_resolution_clock::now();
-    update.is_snapshot = is_snapshot;
+    update.is_snapshot = true;
     
-    // Get Level 2 data from matching engine
-    auto level2_data = matching_engine_.get_level2_data(symbol, config_.default_l2_depth);
+    // Top `depth` levels of each side from the matching engine
+    auto level2_data = matching_engine_.get_level2_data(symbol, depth);
+    update.price_levels.reserve(level2_data.bids.size() + level2_data.asks.size());
     
-    // Convert to our format
     // Add bids (sorted by price descending)
     for (const auto& bid_level : level2_data.bids) {
-        Level2PriceLevel level;
-        level.price = bid_level.price;
-        level.quantity = bid_level.quantity;
-        level.order_count = bid_level.order_count;
-        level.side = 'B';
-        level.action = is_snapshot ? 'A' : 'M';
-        update.price_levels.push_back(level);
+        update.price_levels.push_back({bid_level.price, bid_level.quantity, bid_level.order_count, 'B', 'A'});
     }
     
     // Add asks (sorted by price ascending)
     for (const auto& ask_level : level2_data.asks) {
-        Level2PriceLevel level;
-        level.price = ask_level.price;
-        level.quantity = ask_level.quantity;
-        level.order_count = ask_level.order_count;
-        level.side = 'A';
-        level.action = is_snapshot ? 'A' : 'M';
-        update.price_levels.push_back(level);
+        update.price_levels.push_back({ask_level.price, ask_level.quantity, ask_level.order_count, 'A', 'A'});
     }
     
     return update;
 }
 
+Level2Update MarketDataPublisher::build_level2_changes(SymbolId symbol) {
+    Level2Update update;
+    update.symbol = symbol;
+    update.sequence_number = sequence_number_.load();
+    update.timestamp = std::chrono::high_resolution_clock::now();
+    update.is_snapshot = false;
+    
+    // Every level touched since the last update, once, at its current size
+    matching_engine_.drain_level_changes(symbol, [&](const LevelChange& change) {
+        update.price_levels.push_back({change.price, change.quantity, change.order_count,
+                                       change.side == Side::BUY ? 'B' : 'A',
+                                       change.quantity > 0 ? 'A' : 'D'});
+    });
+    
+    return update;
+}
+
 TradeReport MarketDataPublisher::build_trade_report(const Fill& fill) {
     TradeReport report;
     report.symbol = fill.symbol;
@@ -1,10 +1,14 @@
+#include <atomic>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <random>
 #include <iomanip>
+#include <map>
+#include <mutex>
 
 #include "market_data/publisher.hpp"
+#include "market_data/multicast_publisher.hpp"
 #include "matching/matching_engine.hpp"
 #include "matching/symbol_manager.hpp"
 
@@ -96,6 +100,178 @@ public:
     }
 };
 
+// Rebuilds each side of one book from LEVEL2_UPDATE deltas
+class BookBuilder : public MarketDataSubscriber {
+public:
+    struct Level {
+        uint64_t quantity;
+        uint32_t order_count;
+        bool operator==(const Level& other) const {
+            return quantity == other.quantity && order_count == other.order_count;
+        }
+    };
+    using Levels = std::map<uint32_t, Level>;
+    
+    std::string get_subscriber_id() const override { return "book_builder"; }
+    
+    void on_market_data(const MarketDataMessage& message) override {
+        if (message.type != MessageType::LEVEL2_UPDATE) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& level : message.data.level2.price_levels) {
+            Levels& side = level.side == 'B' ? bids_ : asks_;
+            if (level.action == 'D') {
+                side.erase(level.price);
+            } else {
+                side[level.price] = {level.quantity, level.order_count};
+            }
+        }
+    }
+    
+    void on_subscription_status(SymbolId, MessageType, bool) override {}
+    
+    bool matches(const Level2Data& book) const {
+        Levels bids, asks;
+        for (const auto& level : book.bids) bids[level.price] = {level.quantity, level.order_count};
+        for (const auto& level : book.asks) asks[level.price] = {level.quantity, level.order_count};
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bids == bids_ && asks == asks_;
+    }
+    
+private:
+    mutable std::mutex mutex_;
+    Levels bids_;
+    Levels asks_;
+};
+
+// A burst of book changes well inside the default 1ms subscription
+// throttle: every delta must still arrive, or the rebuilt book drifts
+bool test_level2_burst() {
+    cout << "\n--- Level 2 burst ---" << endl;
+    
+    SymbolManager symbol_manager;
+    MatchingEngine engine;
+    MarketDataPublisher publisher(symbol_manager, engine);
+    const SymbolId symbol = symbol_manager.add_symbol("BURST");
+    auto builder = std::make_shared<BookBuilder>();
+    
+    if (!publisher.start()) {
+        cerr << "Failed to start publisher" << endl;
+        return false;
+    }
+    publisher.add_subscriber(builder);
+    publisher.subscribe_all_symbols("book_builder", MessageType::LEVEL2_UPDATE);
+    
+    // 200 orders over 100 levels a side, then every third one canceled,
+    // each change published on its own
+    constexpr int ORDERS = 200;
+    OrderId order_id = 0;
+    for (int i = 0; i < ORDERS; ++i) {
+        matching::Order order;
+        order.id = ++order_id;
+        order.symbol = symbol;
+        order.side = i % 2 ? Side::SELL : Side::BUY;
+        order.type = OrderType::LIMIT;
+        order.tif = TimeInForce::DAY;
+        order.price = order.side == Side::BUY ? 49000 - (i / 2) % 100 * 10 : 51000 + (i / 2) % 100 * 10;
+        order.quantity = 100 + i;
+        order.timestamp = std::chrono::high_resolution_clock::now();
+        engine.process_order(order);
+        publisher.publish_level2_update(symbol);
+    }
+    for (OrderId id = 1; id <= ORDERS; id += 3) {
+        engine.cancel_order(id);
+        publisher.publish_level2_update(symbol);
+    }
+    
+    const Level2Data book = engine.get_level2_data(symbol, ORDERS);
+    bool match = false;
+    for (int i = 0; i < 200 && !(match = builder->matches(book)); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    publisher.stop();
+    
+    cout << "Rebuilt book matches engine (" << book.bids.size() << " bid, " << book.asks.size()
+         << " ask levels): " << (match ? "YES" : "NO") << endl;
+    return match;
+}
+
+// Stalls on its first trade until released, so its small queue overflows
+class StalledSubscriber : public MarketDataSubscriber {
+public:
+    std::atomic<bool> released{false};
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> lost{0};       // Sum of the gaps reported
+    std::atomic<uint64_t> unexplained{0}; // Trade ids skipped without a gap to say so
+    
+    std::string get_subscriber_id() const override { return "stalled"; }
+    
+    void on_market_data(const MarketDataMessage& message) override {
+        if (message.type != MessageType::TRADE_REPORT) return;
+        while (!released.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (message.data.trade.trade_id != last_trade_id_ + message.gap + 1) {
+            unexplained++;
+        }
+        last_trade_id_ = message.data.trade.trade_id;
+        lost += message.gap;
+        received++;
+    }
+    
+private:
+    uint64_t last_trade_id_{0};
+};
+
+// Trades dropped for a subscriber whose queue is full under DROP must show
+// up as a gap on the next trade it gets
+bool test_drop_gap() {
+    cout << "\n--- DROP overflow gap ---" << endl;
+    
+    SymbolManager symbol_manager;
+    MatchingEngine engine;
+    MarketDataPublisher publisher(symbol_manager, engine);
+    const SymbolId symbol = symbol_manager.add_symbol("GAP");
+    auto stalled = std::make_shared<StalledSubscriber>();
+    
+    if (!publisher.start()) {
+        cerr << "Failed to start publisher" << endl;
+        return false;
+    }
+    publisher.add_subscriber(stalled, SubscriberOptions{4, OverflowPolicy::DROP});
+    publisher.subscribe("stalled", symbol, MessageType::TRADE_REPORT, 10, std::chrono::milliseconds(0));
+    
+    constexpr uint64_t TRADES = 64;
+    auto trade = [&](uint64_t trade_id) {
+        Fill fill;
+        fill.symbol = symbol;
+        fill.trade_id = trade_id;
+        fill.execution_price = 50000;
+        fill.execution_quantity = 100;
+        publisher.publish_trade(fill);
+    };
+    for (uint64_t id = 1; id <= TRADES; ++id) {
+        trade(id);
+    }
+    for (int i = 0; i < 200 && publisher.get_stats().trade_messages < TRADES; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    // The trailing drops are reported by whatever trade comes next
+    stalled->released = true;
+    trade(TRADES + 1);
+    for (int i = 0; i < 200 && stalled->received + stalled->lost < TRADES + 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const auto sub_stats = publisher.get_subscriber_stats("stalled");
+    publisher.stop();
+    
+    const bool ok = stalled->lost > 0 && stalled->unexplained == 0 && stalled->received + stalled->lost == TRADES + 1 &&
+                    sub_stats && sub_stats->dropped == stalled->lost;
+    cout << "Received " << stalled->received << ", gaps reported " << stalled->lost
+         << ", every drop reported: " << (ok ? "YES" : "NO") << endl;
+    return ok;
+}
+
 void simulate_trading(MatchingEngine& engine, MarketDataPublisher& publisher, SymbolId symbol) {
     std::mt19937 rng(std::random_device{}());
     std::uniform_int_distribution<int> action_dist(0, 3); // 0=buy, 1=sell, 2=market_buy, 3=market_sell
@@ -170,6 +346,10 @@ void simulate_trading(MatchingEngine& engine, MarketDataPublisher& publisher, Sy
 int main() {
     cout << "=== Market Data Publisher Test ===" << endl;
     
+    if (!test_level2_burst() || !test_drop_gap()) {
+        return 1;
+    }
+    
     // Initialize components
     SymbolManager symbol_manager;
     MatchingEngine matching_engine;
@@ -192,6 +372,14 @@ int main() {
     auto strategy2 = std::make_shared<TestStrategy>("strategy2", symbol_manager);
     auto file_recorder = std::make_shared<FileRecorder>("recorder", "market_data.csv");
     
+    // Binary feed for out-of-process consumers, looped back to this host
+    MulticastConfig mcast_config;
+    mcast_config.loopback = true;
+    auto multicast = std::make_shared<MulticastPublisher>("multicast", mcast_config);
+    if (!multicast->open()) {
+        cerr << "Multicast feed unavailable, continuing without it" << endl;
+    }
+    
     // Start publisher
     if (!publisher.start()) {
         cerr << "Failed to start publisher" << endl;
@@ -203,7 +391,10 @@ int main() {
     publisher.add_subscriber(console_sub);
     publisher.add_subscriber(strategy1);
     publisher.add_subscriber(strategy2);
-    publisher.add_subscriber(file_recorder);
+    // The recorder writes to disk; if it falls behind it gets the latest
+    // top of book per symbol rather than holding up the others
+    publisher.add_subscriber(file_recorder, SubscriberOptions{4096, OverflowPolicy::CONFLATE});
+    publisher.add_subscriber(multicast);
     cout << "Added " << publisher.get_subscriber_ids().size() << " subscribers" << endl;
     
     // Subscribe console to all messages for AAPL
@@ -222,6 +413,11 @@ int main() {
     publisher.subscribe_all_symbols("recorder", MessageType::LEVEL1_UPDATE);
     publisher.subscribe_all_symbols("recorder", MessageType::TRADE_REPORT);
     
+    // The multicast feed carries everything
+    publisher.subscribe_all_symbols("multicast", MessageType::LEVEL1_UPDATE);
+    publisher.subscribe_all_symbols("multicast", MessageType::LEVEL2_UPDATE);
+    publisher.subscribe_all_symbols("multicast", MessageType::TRADE_REPORT);
+    
     cout << "\\nSet up subscriptions. Starting simulation..." << endl;
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     
@@ -289,6 +485,14 @@ int main() {
     cout << "  Status Messages: " << stats.status_messages << endl;
     cout << "  Dropped Messages: " << stats.dropped_messages << endl;
     cout << "  Subscribers: " << stats.subscribers << endl;
+    for (const auto& id : publisher.get_subscriber_ids()) {
+        if (auto sub_stats = publisher.get_subscriber_stats(id)) {
+            cout << "  [" << id << "] delivered: " << sub_stats->delivered
+                 << ", dropped: " << sub_stats->dropped
+                 << ", conflated: " << sub_stats->conflated
+                 << ", p50 latency: " << sub_stats->latency.p50_ns << " ns" << endl;
+        }
+    }
     
     cout << "\\nFinal market state:" << endl;
     publisher.send_level1_snapshot("console", aapl_id);
@@ -300,6 +504,11 @@ int main() {
     publisher.stop();
     cout << "\\nMarket data publisher stopped" << endl;
     
+    auto mcast_stats = multicast->get_stats();
+    cout << "Multicast feed " << mcast_config.group << ":" << mcast_config.port << ": "
+         << mcast_stats.messages << " wire messages in " << mcast_stats.packets << " packets, "
+         << mcast_stats.send_calls << " sendmmsg calls, " << mcast_stats.send_errors << " errors" << endl;
+    
     cout << "\\nMarket data recorded to 'market_data.csv'" << endl;
     
     return 0;
@@ -0,0 +1,461 @@
+#include "matching/journal.hpp"
+#include "perf/cpu.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace matching {
+
+namespace {
+
+constexpr char MAGIC[8] = {'M', 'E', 'J', 'R', 'N', 'L', '\0', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t PAGE = 4096;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t created_ns;
+};
+
+uint64_t to_ns(Timestamp t) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+Timestamp from_ns(uint64_t ns) {
+    return Timestamp(std::chrono::duration_cast<Timestamp::duration>(std::chrono::nanoseconds(ns)));
+}
+
+constexpr uint8_t OWNS_ORDERS = 1;
+constexpr uint8_t TRACK_CHANGES = 2;
+
+} // namespace
+
+// =============================================================================
+// JournalRecord
+// =============================================================================
+
+JournalRecord JournalRecord::from_command(const EngineCommand& command, uint32_t shard, uint64_t sequence) {
+    JournalRecord r;
+    r.shard = shard;
+    r.sequence = sequence;
+    r.symbol = command.order.symbol;
+    r.order_id = command.order.id;
+
+    switch (command.kind) {
+        case EngineCommand::Kind::ADD_SYMBOL:
+            // The book config rides in the order fields
+            r.type = Type::ADD_SYMBOL;
+            r.quantity = command.config.tick_size;
+            r.price = command.config.min_price;
+            r.filled = command.config.max_price;
+            r.other_id = command.config.expected_orders;
+            r.flags = (command.config.owns_orders ? OWNS_ORDERS : 0) |
+                      (command.config.track_changes ? TRACK_CHANGES : 0);
+            return r;
+        case EngineCommand::Kind::CANCEL:
+            r.type = Type::CANCEL;
+            return r;
+        case EngineCommand::Kind::REPLACE:
+            r.type = Type::REPLACE;
+            r.other_id = command.target_id;
+            break;
+        case EngineCommand::Kind::NEW_ORDER:
+            r.type = Type::NEW_ORDER;
+            break;
+    }
+
+    r.side = static_cast<char>(command.order.side);
+    r.order_type = static_cast<char>(command.order.type);
+    r.tif = static_cast<char>(command.order.tif);
+    r.status = static_cast<char>(command.order.status);
+    r.quantity = command.order.quantity;
+    r.filled = command.order.filled_quantity;
+    r.price = command.order.price;
+    r.time_ns = to_ns(command.order.timestamp);
+    return r;
+}
+
+JournalRecord JournalRecord::from_event(const EngineEvent& event) {
+    JournalRecord r;
+    switch (event.kind) {
+        case EngineEvent::Kind::ACK: r.type = Type::ACK; break;
+        case EngineEvent::Kind::FILL: r.type = Type::FILL; break;
+        case EngineEvent::Kind::CANCELED: r.type = Type::CANCELED; break;
+        case EngineEvent::Kind::CANCEL_REJECT: r.type = Type::CANCEL_REJECT; break;
+    }
+    r.status = static_cast<char>(event.status);
+    r.shard = event.shard;
+    r.sequence = event.sequence;
+    r.order_id = event.order_id;
+    r.filled = event.filled;
+    if (event.kind == EngineEvent::Kind::FILL) {
+        r.symbol = event.fill.symbol;
+        r.other_id = event.fill.passive_order_id;
+        r.trade_id = event.fill.trade_id;
+        r.price = event.fill.execution_price;
+        r.quantity = event.fill.execution_quantity;
+        r.time_ns = to_ns(event.fill.execution_time);
+    }
+    return r;
+}
+
+EngineCommand JournalRecord::to_command() const {
+    EngineCommand command;
+    command.order.id = order_id;
+    command.order.symbol = symbol;
+
+    switch (type) {
+        case Type::ADD_SYMBOL:
+            command.kind = EngineCommand::Kind::ADD_SYMBOL;
+            command.config.tick_size = quantity;
+            command.config.min_price = price;
+            command.config.max_price = filled;
+            command.config.expected_orders = static_cast<uint32_t>(other_id);
+            command.config.owns_orders = flags & OWNS_ORDERS;
+            command.config.track_changes = flags & TRACK_CHANGES;
+            return command;
+        case Type::CANCEL:
+            command.kind = EngineCommand::Kind::CANCEL;
+            return command;
+        case Type::REPLACE:
+            command.kind = EngineCommand::Kind::REPLACE;
+            command.target_id = other_id;
+            break;
+        default:
+            command.kind = EngineCommand::Kind::NEW_ORDER;
+            break;
+    }
+
+    command.order.side = static_cast<Side>(side);
+    command.order.type = static_cast<OrderType>(order_type);
+    command.order.tif = static_cast<TimeInForce>(tif);
+    command.order.status = static_cast<OrderStatus>(status);
+    command.order.quantity = quantity;
+    command.order.filled_quantity = filled;
+    command.order.price = price;
+    command.order.timestamp = from_ns(time_ns);
+    return command;
+}
+
+EngineEvent JournalRecord::to_event() const {
+    EngineEvent event;
+    switch (type) {
+        case Type::FILL: event.kind = EngineEvent::Kind::FILL; break;
+        case Type::CANCELED: event.kind = EngineEvent::Kind::CANCELED; break;
+        case Type::CANCEL_REJECT: event.kind = EngineEvent::Kind::CANCEL_REJECT; break;
+        default: event.kind = EngineEvent::Kind::ACK; break;
+    }
+    event.status = static_cast<OrderStatus>(status);
+    event.shard = shard;
+    event.sequence = sequence;
+    event.order_id = order_id;
+    event.filled = filled;
+    if (type == Type::FILL) {
+        event.fill.aggressive_order_id = order_id;
+        event.fill.passive_order_id = other_id;
+        event.fill.symbol = symbol;
+        event.fill.execution_price = price;
+        event.fill.execution_quantity = quantity;
+        event.fill.execution_time = from_ns(time_ns);
+        event.fill.trade_id = trade_id;
+    }
+    return event;
+}
+
+// =============================================================================
+// Journal
+// =============================================================================
+
+Journal::Journal(const JournalConfig& config) : config_(config) {
+    // Whole pages per segment, so every mapping offset is page aligned
+    config_.segment_bytes = (std::max(config_.segment_bytes, PAGE) + PAGE - 1) / PAGE * PAGE;
+    const uint32_t count = config_.producers ? config_.producers : 1;
+    producers_.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        producers_.push_back(std::make_unique<Producer>(config_.ring_capacity));
+    }
+}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::open() {
+    if (running_.load(std::memory_order_acquire)) {
+        return false; // Already open
+    }
+
+    fd_ = ::open(config_.path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        perror("journal open");
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.record_size = sizeof(JournalRecord);
+    header.created_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    char page[HEADER_BYTES] = {};
+    std::memcpy(page, &header, sizeof(header));
+    if (::pwrite(fd_, page, sizeof(page), 0) != static_cast<ssize_t>(sizeof(page)) ||
+        !map_segment(HEADER_BYTES)) {
+        perror("journal header");
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    records_ = 0;
+    durable_.store(0, std::memory_order_relaxed);
+    for (auto& p : producers_) {
+        p->appended = 0;
+        p->written = 0;
+        p->durable.store(0, std::memory_order_relaxed);
+    }
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&Journal::run, this);
+    return true;
+}
+
+void Journal::close() {
+    if (!running_.exchange(false)) {
+        return; // Not open
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // Drop the preallocated tail, so the file ends at the last record. No
+    // segment means the one after a full segment could not be mapped.
+    const uint64_t end = segment_ ? segment_offset_ + written_ * sizeof(JournalRecord) : next_offset_;
+    unmap_segment();
+    if (::ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (config_.sync) {
+        ::fsync(fd_);
+    }
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void Journal::append(uint32_t producer, const JournalRecord& record) {
+    Producer& p = *producers_[producer];
+    ++p.appended;
+    if (p.ring.push(record)) {
+        return;
+    }
+    p.stalls.fetch_add(1, std::memory_order_relaxed);
+    while (!p.ring.push(record)) {
+        if (config_.spin) {
+            perf::cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+Journal::Stats Journal::get_stats() const {
+    Stats stats;
+    stats.records = durable_.load(std::memory_order_acquire);
+    stats.commits = commits_.load(std::memory_order_relaxed);
+    stats.max_batch = max_batch_.load(std::memory_order_relaxed);
+    stats.segments = segments_.load(std::memory_order_relaxed);
+    stats.errors = errors_.load(std::memory_order_relaxed);
+    for (const auto& p : producers_) {
+        stats.stalls += p->stalls.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void Journal::run() {
+    if (config_.cpu >= 0 && !perf::pin_current_thread(config_.cpu)) {
+        std::cerr << "[JOURNAL] Could not pin writer to CPU " << config_.cpu << std::endl;
+    }
+
+    // Once closed, commit what was appended before exiting
+    for (;;) {
+        const bool running = running_.load(std::memory_order_acquire);
+        if (drain() > 0) {
+            commit();
+            continue;
+        }
+        if (!running) {
+            break;
+        }
+        if (config_.spin) {
+            perf::cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t Journal::drain() {
+    // One pass over the rings; records go straight from a ring into the file
+    size_t total = 0;
+    for (auto& p : producers_) {
+        for (;;) {
+            if (written_ == segment_records_) {
+                commit();
+                if (!map_segment(next_offset_)) {
+                    return total; // Retried on the next pass
+                }
+            }
+            const size_t n = p->ring.pop_bulk(segment_ + written_, segment_records_ - written_);
+            if (n == 0) {
+                break;
+            }
+            written_ += n;
+            p->written += n;
+            total += n;
+        }
+    }
+    return total;
+}
+
+void Journal::commit() {
+    const size_t batch = written_ - synced_;
+    if (batch == 0) {
+        return;
+    }
+
+    if (config_.sync) {
+        // msync wants a page-aligned start; the partial page is simply written again
+        char* base = reinterpret_cast<char*>(segment_);
+        const size_t from = synced_ * sizeof(JournalRecord) / PAGE * PAGE;
+        const size_t to = written_ * sizeof(JournalRecord);
+        if (::msync(base + from, to - from, MS_SYNC) != 0) {
+            errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Everything popped so far is in the file, so each producer's whole
+    // written count is now committed
+    synced_ = written_;
+    records_ += batch;
+    durable_.store(records_, std::memory_order_release);
+    for (auto& p : producers_) {
+        p->durable.store(p->written, std::memory_order_release);
+    }
+    commits_.store(commits_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (batch > max_batch_.load(std::memory_order_relaxed)) {
+        max_batch_.store(batch, std::memory_order_relaxed);
+    }
+}
+
+bool Journal::map_segment(uint64_t offset) {
+    unmap_segment();
+
+    // Blocks are allocated up front, so a commit never waits on allocation,
+    // and the mapping is populated before the writer first touches it
+    const size_t bytes = config_.segment_bytes;
+    if (posix_fallocate(fd_, static_cast<off_t>(offset), static_cast<off_t>(bytes)) != 0) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                   static_cast<off_t>(offset));
+    if (p == MAP_FAILED) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    segment_ = static_cast<JournalRecord*>(p);
+    segment_offset_ = offset;
+    next_offset_ = offset + bytes;
+    segment_records_ = bytes / sizeof(JournalRecord);
+    written_ = 0;
+    synced_ = 0;
+    segments_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Journal::unmap_segment() {
+    if (segment_) {
+        munmap(segment_, config_.segment_bytes);
+        segment_ = nullptr;
+    }
+    segment_records_ = 0;
+    written_ = 0;
+    synced_ = 0;
+}
+
+// =============================================================================
+// JournalReader and replay
+// =============================================================================
+
+bool JournalReader::open(const std::string& path) {
+    records_ = nullptr;
+    count_ = 0;
+    if (!file_.open(path.c_str()) || file_.size() < Journal::HEADER_BYTES) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.record_size != sizeof(JournalRecord)) {
+        return false;
+    }
+
+    // A crash leaves preallocated zeroes behind the last committed record
+    records_ = reinterpret_cast<const JournalRecord*>(file_.data() + Journal::HEADER_BYTES);
+    const size_t capacity = (file_.size() - Journal::HEADER_BYTES) / sizeof(JournalRecord);
+    while (count_ < capacity && records_[count_].type != JournalRecord::Type::NONE) {
+        ++count_;
+    }
+    return true;
+}
+
+ReplayResult replay_journal(const JournalReader& journal, uint32_t shard, MatchingEngine& engine) {
+    ReplayResult result;
+    engine.set_next_trade_id(first_trade_id(shard));
+    const JournalRecord* next_event = journal.begin();
+    uint64_t sequence = 0;
+
+    auto compare = [&](const EngineEvent& event) {
+        ++sequence;
+        while (next_event != journal.end() && !(next_event->is_event() && next_event->shard == shard)) {
+            ++next_event;
+        }
+        if (next_event == journal.end()) {
+            return; // Never made it into the journal
+        }
+        const EngineEvent expected = next_event->to_event();
+        ++next_event;
+        ++result.events;
+
+        bool same = expected.kind == event.kind && expected.status == event.status &&
+                    expected.sequence == sequence && expected.order_id == event.order_id &&
+                    expected.filled == event.filled;
+        if (same && event.kind == EngineEvent::Kind::FILL) {
+            same = expected.fill.passive_order_id == event.fill.passive_order_id &&
+                   expected.fill.execution_price == event.fill.execution_price &&
+                   expected.fill.execution_quantity == event.fill.execution_quantity &&
+                   expected.fill.trade_id == event.fill.trade_id;
+        }
+        result.mismatches += same ? 0 : 1;
+    };
+
+    for (const JournalRecord& record : journal) {
+        if (record.shard != shard || !record.is_command()) {
+            continue;
+        }
+        execute_command(engine, record.to_command(), compare);
+        ++result.commands;
+    }
+    return result;
+}
+
+} // namespace matching
@@ -9,176 +9,25 @@ MatchingEngine::MatchingEngine(FillCallback callback)
 }
 
 MatchResult MatchingEngine::process_order(Order order) {
-    // Set timestamp and validate
-    order.timestamp = std::chrono::high_resolution_clock::now();
-    
-    if (order.quantity == 0) {
-        order.status = OrderStatus::REJECTED;
-        return {OrderStatus::REJECTED, {}, 0};
-    }
-    
-    // Store in active orders
-    active_orders_[order.id] = order;
-    
-    // Route to appropriate processing logic
+    // Collects fills and notifies the registered callback
     MatchResult result;
-    if (order.type == OrderType::MARKET) {
-        result = process_market_order(active_orders_[order.id]);
-    } else {
-        result = process_limit_order(active_orders_[order.id]);
-    }
-    
-    // Update order status
-    update_order_status(active_orders_[order.id]);
-    
-    // Remove if fully filled or canceled
-    if (active_orders_[order.id].is_fully_filled() || 
-        active_orders_[order.id].status == OrderStatus::CANCELED) {
-        active_orders_.erase(order.id);
-    }
-    
-    return result;
-}
-
-MatchResult MatchingEngine::process_market_order(Order& order) {
-    UltraOrderBook* book = get_or_create_book(order.symbol);
-    if (!book) {
-        order.status = OrderStatus::REJECTED;
-        return {OrderStatus::REJECTED, {}, 0};
-    }
-    
-    // Market orders execute immediately against best available prices
-    return attempt_cross(order, *book);
-}
-
-MatchResult MatchingEngine::process_limit_order(Order& order) {
-    UltraOrderBook* book = get_or_create_book(order.symbol);
-    if (!book) {
-        order.status = OrderStatus::REJECTED;
-        return {OrderStatus::REJECTED, {}, 0};
-    }
-    
-    // First try to cross with existing orders
-    MatchResult result = attempt_cross(order, *book);
-    
-    // If not fully filled and order allows resting, add to book
-    if (!order.is_fully_filled() && order.tif != TimeInForce::IOC && order.tif != TimeInForce::FOK) {
-        // Add remaining quantity to book
-        if (order.is_buy()) {
-            book->ultra_addOrder(order.id, 'B', order.remaining_quantity(), order.price);
-        } else {
-            book->ultra_addOrder(order.id, 'S', order.remaining_quantity(), order.price);
-        }
-        
-        if (result.total_filled == 0) {
-            result.final_status = OrderStatus::NEW;
-        } else {
-            result.final_status = OrderStatus::PARTIALLY_FILLED;
-        }
-    }
-    
-    // Handle FOK (Fill or Kill) - cancel if not fully filled
-    if (order.tif == TimeInForce::FOK && !order.is_fully_filled()) {
-        order.status = OrderStatus::CANCELED;
-        result.final_status = OrderStatus::CANCELED;
-        // Note: In real system, would need to reverse any partial fills
-    }
-    
-    return result;
-}
-
-MatchResult MatchingEngine::attempt_cross(Order& aggressive_order, UltraOrderBook& book) {
-    MatchResult result;
-    
-    while (!aggressive_order.is_fully_filled()) {
-        // Find best counter-side price
-        Price best_price = 0;
-        if (aggressive_order.is_buy()) {
-            best_price = book.ultra_getBestAsk();
-        } else {
-            best_price = book.ultra_getBestBid();
-        }
-        
-        if (best_price == 0) {
-            // No counter-side liquidity
-            break;
-        }
-        
-        // Check if prices cross
-        bool can_execute = false;
-        if (aggressive_order.type == OrderType::MARKET) {
-            can_execute = true;  // Market orders execute at any price
-        } else if (aggressive_order.is_buy() && aggressive_order.price >= best_price) {
-            can_execute = true;  // Buy limit crosses with lower ask
-        } else if (aggressive_order.is_sell() && aggressive_order.price <= best_price) {
-            can_execute = true;  // Sell limit crosses with higher bid
-        }
-        
-        if (!can_execute) {
-            break;
-        }
-        
-        // For this MVP, we'll simulate finding and executing against the best order
-        // In a real implementation, we'd need to access individual orders at the best price
-        
-        // Create a simulated passive order (this would come from the order book)
-        OrderId passive_order_id = next_trade_id_.fetch_add(1) + 1000000; // Simulate passive order ID
-        Quantity available_quantity = std::min(aggressive_order.remaining_quantity(), 
-                                             static_cast<Quantity>(100)); // Simulate available qty
-        
-        // Execute the trade
-        Price execution_price = best_price;
-        Quantity execution_quantity = std::min(aggressive_order.remaining_quantity(), available_quantity);
-        
-        // Create fill record
-        Fill fill = create_fill(aggressive_order, 
-                              Order{passive_order_id, aggressive_order.symbol}, // Simulated passive order
-                              execution_price, 
-                              execution_quantity);
-        
-        // Update aggressive order
-        aggressive_order.filled_quantity += execution_quantity;
-        
-        // Update book (simulate removing liquidity)
-        if (aggressive_order.is_buy()) {
-            // Would remove from ask side
-            book.ultra_executeOrder(passive_order_id, execution_quantity);
-        } else {
-            // Would remove from bid side  
-            book.ultra_executeOrder(passive_order_id, execution_quantity);
-        }
-        
-        // Record the fill
+    auto collect = [&](const Fill& fill) {
         result.fills.push_back(fill);
-        result.total_filled += execution_quantity;
-        
-        // Notify via callback
         if (fill_callback_) {
             fill_callback_(fill);
         }
-        
-        // For IOC orders, only one attempt
-        if (aggressive_order.tif == TimeInForce::IOC) {
-            break;
-        }
-    }
-    
-    // Set final status
-    if (aggressive_order.is_fully_filled()) {
-        result.final_status = OrderStatus::FILLED;
-    } else if (result.total_filled > 0) {
-        result.final_status = OrderStatus::PARTIALLY_FILLED;
-    } else {
-        result.final_status = OrderStatus::NEW;
-    }
+    };
     
+    MatchSummary summary = process_order(std::move(order), collect);
+    result.final_status = summary.final_status;
+    result.total_filled = summary.total_filled;
     return result;
 }
 
-Fill MatchingEngine::create_fill(const Order& aggressive, const Order& passive, Price price, Quantity qty) {
+Fill MatchingEngine::create_fill(const Order& aggressive, OrderId passive_id, Price price, Quantity qty) {
     Fill fill;
     fill.aggressive_order_id = aggressive.id;
-    fill.passive_order_id = passive.id;
+    fill.passive_order_id = passive_id;
     fill.symbol = aggressive.symbol;
     fill.execution_price = price;
     fill.execution_quantity = qty;
@@ -188,7 +37,54 @@ Fill MatchingEngine::create_fill(const Order& aggressive, const Order& passive,
     return fill;
 }
 
+void MatchingEngine::record_passive_fill(UltraOrder& passive, Quantity qty) {
+    // Every node in an engine book is an OrderRecord
+    OrderRecord* rec = OrderStore::from_node(&passive);
+    rec->filled += qty;
+    if (rec->filled >= rec->quantity) {
+        orders_.erase(rec); // The sweep has already taken it off the queue
+    } else {
+        rec->status = static_cast<char>(OrderStatus::PARTIALLY_FILLED);
+    }
+}
+
+void MatchingEngine::rest_order(const Order& order, UltraOrderBook& book) {
+    OrderRecord* rec = orders_.insert(order.id, order.symbol);
+    if (!rec) {
+        return; // Id already resting; the new order is dropped
+    }
+    
+    rec->node.set_id_side(order.id, order.is_buy() ? 'B' : 'S');
+    rec->node.quantity = order.remaining_quantity();
+    rec->node.price = order.price;
+    rec->timestamp = order.timestamp.time_since_epoch().count();
+    rec->quantity = order.quantity;
+    rec->filled = order.filled_quantity;
+    rec->status = static_cast<char>(order.status);
+    if (!book.ultra_addNode(&rec->node)) {
+        orders_.erase(rec); // Outside the symbol's price band
+    }
+}
+
+Order MatchingEngine::to_order(const OrderRecord& rec) {
+    Order order;
+    order.id = rec.node.get_id();
+    order.symbol = rec.symbol;
+    order.side = rec.node.get_side() == 'B' ? Side::BUY : Side::SELL;
+    order.type = OrderType::LIMIT;
+    order.tif = TimeInForce::DAY;
+    order.quantity = rec.quantity;
+    order.filled_quantity = rec.filled;
+    order.price = rec.node.price;
+    order.timestamp = Timestamp(Timestamp::duration(rec.timestamp));
+    order.status = static_cast<OrderStatus>(rec.status);
+    return order;
+}
+
 void MatchingEngine::update_order_status(Order& order) {
+    if (order.status == OrderStatus::CANCELED || order.status == OrderStatus::REJECTED) {
+        return; // Terminal
+    }
     if (order.is_fully_filled()) {
         order.status = OrderStatus::FILLED;
     } else if (order.filled_quantity > 0) {
@@ -204,30 +100,24 @@ UltraOrderBook* MatchingEngine::get_or_create_book(SymbolId symbol) {
     }
     
     // Create new order book for symbol
-    auto book = std::make_unique<UltraOrderBook>();
-    UltraOrderBook* book_ptr = book.get();
-    order_books_[symbol] = std::move(book);
-    
-    return book_ptr;
+    add_symbol(symbol);
+    return order_books_[symbol].get();
+}
+
+UltraOrderBook* MatchingEngine::find_book(SymbolId symbol) const {
+    auto it = order_books_.find(symbol);
+    return it != order_books_.end() ? it->second.get() : nullptr;
 }
 
 bool MatchingEngine::cancel_order(OrderId order_id) {
-    auto it = active_orders_.find(order_id);
-    if (it == active_orders_.end()) {
+    OrderRecord* rec = orders_.find(order_id);
+    if (!rec) {
         return false; // Order not found
     }
     
-    Order& order = it->second;
-    
-    // Remove from order book if it's resting there
-    UltraOrderBook* book = get_or_create_book(order.symbol);
-    if (book) {
-        book->ultra_deleteOrder(order_id);
-    }
-    
-    // Update status and remove from active orders
-    order.status = OrderStatus::CANCELED;
-    active_orders_.erase(it);
+    // Every live record rests in its symbol's book
+    find_book(rec->symbol)->ultra_removeNode(&rec->node);
+    orders_.erase(rec);
     
     return true;
 }
@@ -244,24 +134,32 @@ bool MatchingEngine::replace_order(OrderId old_id, Order new_order) {
     return result.final_status != OrderStatus::REJECTED;
 }
 
+void MatchingEngine::begin_auction(SymbolId symbol) {
+    if (symbol >= in_auction_.size()) {
+        in_auction_.resize(size_t(symbol) + 1, 0);
+    }
+    in_auction_[symbol] = 1;
+}
+
 void MatchingEngine::add_symbol(SymbolId symbol) {
+    add_symbol(symbol, UltraBookConfig{});
+}
+
+void MatchingEngine::add_symbol(SymbolId symbol, const UltraBookConfig& config) {
+    // Book price window is sized from the symbol's tick and price band; the
+    // engine owns the orders, the book only queues them
     if (order_books_.find(symbol) == order_books_.end()) {
-        order_books_[symbol] = std::make_unique<UltraOrderBook>();
+        UltraBookConfig book_config = config;
+        book_config.owns_orders = false;
+        book_config.track_changes = config.track_changes || track_level_changes_;
+        order_books_[symbol] = std::make_unique<UltraOrderBook>(book_config);
     }
 }
 
 void MatchingEngine::remove_symbol(SymbolId symbol) {
-    // Cancel all orders for this symbol first
-    std::vector<OrderId> orders_to_cancel;
-    for (const auto& [order_id, order] : active_orders_) {
-        if (order.symbol == symbol) {
-            orders_to_cancel.push_back(order_id);
-        }
-    }
-    
-    for (OrderId order_id : orders_to_cancel) {
-        cancel_order(order_id);
-    }
+    // Drop the symbol's orders; the book goes with them, so there is no
+    // point unlinking each one from its level
+    orders_.for_each_in_symbol(symbol, [&](OrderRecord& rec) { orders_.erase(&rec); });
     
     // Remove the order book
     order_books_.erase(symbol);
@@ -287,13 +185,11 @@ Level1Data MatchingEngine::get_level1_data(SymbolId symbol) const {
     if (it != order_books_.end()) {
         const UltraOrderBook* book = it->second.get();
         
-        // Get best bid/ask prices (methods would need to be added to UltraOrderBook)
+        // Cached top-of-book from the book's occupancy bitmaps
         data.best_bid_price = book->ultra_getBestBid();
         data.best_ask_price = book->ultra_getBestAsk();
-        
-        // For MVP, simulate quantities (real implementation would get from order book)
-        data.best_bid_quantity = (data.best_bid_price > 0) ? 100 : 0;
-        data.best_ask_quantity = (data.best_ask_price > 0) ? 100 : 0;
+        data.best_bid_quantity = book->ultra_getBestBidQuantity();
+        data.best_ask_quantity = book->ultra_getBestAskQuantity();
     }
     
     return data;
@@ -304,36 +200,35 @@ Level2Data MatchingEngine::get_level2_data(SymbolId symbol, uint32_t depth) cons
     data.symbol = symbol;
     data.update_time = std::chrono::high_resolution_clock::now();
     
-    // For MVP, return simplified level 2 data
-    // Real implementation would iterate through price levels in the order book
-    Level1Data l1 = get_level1_data(symbol);
-    
-    if (l1.best_bid_price > 0) {
-        data.bids.push_back({l1.best_bid_price, l1.best_bid_quantity, 1});
-        // Simulate additional levels
-        for (uint32_t i = 1; i < depth && i < 5; ++i) {
-            Price level_price = l1.best_bid_price - i;
-            if (level_price > 0) {
-                data.bids.push_back({level_price, 50 + i * 10, 1});
-            }
-        }
+    auto it = order_books_.find(symbol);
+    if (it == order_books_.end()) {
+        return data;
     }
     
-    if (l1.best_ask_price > 0) {
-        data.asks.push_back({l1.best_ask_price, l1.best_ask_quantity, 1});
-        // Simulate additional levels
-        for (uint32_t i = 1; i < depth && i < 5; ++i) {
-            data.asks.push_back({l1.best_ask_price + i, 50 + i * 10, 1});
-        }
-    }
+    // Walk non-empty levels outwards from the top of book
+    const UltraOrderBook* book = it->second.get();
+    data.bids.reserve(depth);
+    data.asks.reserve(depth);
+    book->ultra_walkBids(depth, [&](Price price, Quantity qty, uint32_t count) {
+        data.bids.push_back({price, qty, count});
+    });
+    book->ultra_walkAsks(depth, [&](Price price, Quantity qty, uint32_t count) {
+        data.asks.push_back({price, qty, count});
+    });
     
     return data;
 }
 
+void MatchingEngine::track_level_changes(bool on) {
+    track_level_changes_ = on;
+    for (auto& [symbol, book] : order_books_) {
+        book->ultra_trackChanges(on);
+    }
+}
+
 std::optional<Order> MatchingEngine::get_order(OrderId order_id) const {
-    auto it = active_orders_.find(order_id);
-    if (it != active_orders_.end()) {
-        return it->second;
+    if (const OrderRecord* rec = orders_.find(order_id)) {
+        return to_order(*rec);
     }
     return std::nullopt;
 }
@@ -341,11 +236,9 @@ std::optional<Order> MatchingEngine::get_order(OrderId order_id) const {
 std::vector<Order> MatchingEngine::get_orders_for_symbol(SymbolId symbol) const {
     std::vector<Order> orders;
     
-    for (const auto& [order_id, order] : active_orders_) {
-        if (order.symbol == symbol) {
-            orders.push_back(order);
-        }
-    }
+    orders_.for_each_in_symbol(symbol, [&](const OrderRecord& rec) {
+        orders.push_back(to_order(rec));
+    });
     
     return orders;
 }
@@ -353,7 +246,7 @@ std::vector<Order> MatchingEngine::get_orders_for_symbol(SymbolId symbol) const
 MatchingEngine::Stats MatchingEngine::get_stats() const {
     Stats stats;
     stats.active_symbols = static_cast<uint32_t>(order_books_.size());
-    stats.active_orders = static_cast<uint32_t>(active_orders_.size());
+    stats.active_orders = static_cast<uint32_t>(orders_.size());
     
     // Other stats would be tracked incrementally in a real implementation
     static uint64_t total_orders = 0;
@@ -0,0 +1,185 @@
+#include "matching/sharded_engine.hpp"
+#include "matching/journal.hpp"
+#include "perf/cpu.hpp"
+
+namespace matching {
+
+ShardedEngine::ShardedEngine(const ShardedEngineConfig& config)
+    : config_(config) {
+    const uint32_t count = config_.shards ? config_.shards : 1;
+    shards_.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        shards_.push_back(std::make_unique<Shard>(config_.inbound_capacity, config_.outbound_capacity));
+        shards_.back()->engine.set_next_trade_id(first_trade_id(i));
+    }
+}
+
+ShardedEngine::~ShardedEngine() {
+    stop();
+}
+
+bool ShardedEngine::start() {
+    if (config_.journal && (!config_.journal->is_open() || config_.journal->producers() < shard_count())) {
+        return false; // Needs a ring per shard
+    }
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+
+    for (uint32_t i = 0; i < shard_count(); ++i) {
+        shards_[i]->thread = std::thread(&ShardedEngine::run_shard, this, i);
+    }
+    return true;
+}
+
+void ShardedEngine::stop() {
+    if (!running_.exchange(false)) {
+        return; // Already stopped
+    }
+
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+bool ShardedEngine::add_symbol(SymbolId symbol, const UltraBookConfig& config) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::ADD_SYMBOL;
+    command.order.symbol = symbol;
+    command.config = config;
+    return enqueue(symbol, command);
+}
+
+bool ShardedEngine::submit(const Order& order) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::NEW_ORDER;
+    command.order = order;
+    return enqueue(order.symbol, command);
+}
+
+bool ShardedEngine::cancel(SymbolId symbol, OrderId order_id) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::CANCEL;
+    command.order.id = order_id;
+    command.order.symbol = symbol;
+    return enqueue(symbol, command);
+}
+
+bool ShardedEngine::replace(OrderId old_id, const Order& new_order) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::REPLACE;
+    command.order = new_order;
+    command.target_id = old_id;
+    return enqueue(new_order.symbol, command);
+}
+
+ShardedEngine::ShardStats ShardedEngine::get_shard_stats(uint32_t shard) const {
+    const Shard& s = *shards_[shard];
+    ShardStats stats;
+    stats.commands = s.commands.load(std::memory_order_relaxed);
+    stats.events = s.events.load(std::memory_order_relaxed);
+    stats.dropped_events = s.dropped_events.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ShardedEngine::enqueue(SymbolId symbol, const EngineCommand& command) {
+    return shards_[shard_of(symbol)]->inbound.push(command);
+}
+
+void ShardedEngine::run_shard(uint32_t index) {
+    Shard& shard = *shards_[index];
+    if (config_.first_cpu >= 0) {
+        perf::pin_current_thread(config_.first_cpu + static_cast<int>(index));
+    }
+
+    // Once stopped, drain what was submitted and deliver its events before exiting
+    EngineCommand command;
+    for (;;) {
+        const bool running = running_.load(std::memory_order_acquire);
+        if (shard.inbound.pop(command)) {
+            execute(index, shard, command);
+            continue;
+        }
+        if (shard.held_head != shard.held.size() && release_durable(shard, index) > 0) {
+            continue;
+        }
+        if (!running && shard.held_head == shard.held.size()) {
+            break;
+        }
+        if (config_.spin) {
+            perf::cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ShardedEngine::execute(uint32_t index, Shard& shard, EngineCommand& command) {
+    const uint64_t count = shard.commands.load(std::memory_order_relaxed) + 1;
+    shard.commands.store(count, std::memory_order_relaxed);
+
+    // Write-ahead: the command is journaled before it runs, and none of its
+    // events leave the shard before the journal has committed them
+    if (config_.journal) {
+        config_.journal->append(index, JournalRecord::from_command(command, index, count));
+    }
+    execute_command(shard.engine, command, [&](const EngineEvent& event) {
+        emit(shard, index, event);
+    });
+}
+
+void ShardedEngine::emit(Shard& shard, uint32_t index, EngineEvent event) {
+    event.shard = index;
+    event.sequence = shard.next_sequence++;
+    if (!config_.journal) {
+        push_outbound(shard, event);
+        return;
+    }
+
+    // Held until the group commit covering its record, so a client never
+    // sees an ACK or FILL the journal could still lose
+    config_.journal->append(index, JournalRecord::from_event(event));
+    shard.held.push_back(HeldEvent{config_.journal->appended(index), event});
+    release_durable(shard, index);
+}
+
+// Delivers held events, oldest first, up to the journal's commit point.
+// Returns how many went out.
+size_t ShardedEngine::release_durable(Shard& shard, uint32_t index) {
+    const uint64_t durable = config_.journal->durable_records(index);
+    size_t released = 0;
+    while (shard.held_head != shard.held.size() && shard.held[shard.held_head].durable_at <= durable) {
+        push_outbound(shard, shard.held[shard.held_head++].event);
+        ++released;
+    }
+    // Reuse the storage: reset once empty, compact once mostly consumed
+    if (shard.held_head == shard.held.size()) {
+        shard.held.clear();
+        shard.held_head = 0;
+    } else if (shard.held_head >= 1024 && shard.held_head * 2 >= shard.held.size()) {
+        shard.held.erase(shard.held.begin(), shard.held.begin() + static_cast<ptrdiff_t>(shard.held_head));
+        shard.held_head = 0;
+    }
+    return released;
+}
+
+void ShardedEngine::push_outbound(Shard& shard, const EngineEvent& event) {
+    // Back-pressure: wait for the consumer rather than lose an event, unless
+    // the engine is stopping and nobody may be polling any more
+    while (!shard.outbound.push(event)) {
+        if (!running_.load(std::memory_order_acquire)) {
+            shard.dropped_events.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (config_.spin) {
+            perf::cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    shard.events.store(shard.events.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+} // namespace matching
@@ -4,11 +4,36 @@
 #include <sstream>
 #include <cctype>
 #include <iomanip>
+#include <cstring>
+#include <type_traits>
 
 namespace matching {
 
 // SymbolManager Implementation
 
+namespace {
+
+SymbolRules rules_of(const SymbolInfo& info) {
+    SymbolRules rules;
+    rules.tick_size = info.tick_size;
+    rules.min_quantity = info.min_quantity;
+    rules.max_quantity = info.max_quantity;
+    rules.lot_size = info.lot_size;
+    rules.min_price = info.min_price;
+    rules.max_price = info.max_price;
+    rules.state = info.state;
+    rules.valid = true;
+    return rules;
+}
+
+} // namespace
+
+SymbolManager::~SymbolManager() {
+    for (auto& page : rules_pages_) {
+        delete[] page.load(std::memory_order_relaxed);
+    }
+}
+
 SymbolId SymbolManager::add_symbol(const std::string& symbol_name, 
                                   uint32_t tick_size, 
                                   uint32_t min_price,
@@ -37,6 +62,7 @@ SymbolId SymbolManager::add_symbol(const std::string& symbol_name,
     // Register symbol
     symbols_[new_id] = info;
     name_to_id_[symbol_name] = new_id;
+    publish_rules(info);
     
     update_stats();
     
@@ -56,6 +82,7 @@ bool SymbolManager::remove_symbol(const std::string& symbol_name) {
     // Remove from both maps
     symbols_.erase(symbol_id);
     name_to_id_.erase(name_it);
+    retract_rules(symbol_id);
     
     update_stats();
     return true;
@@ -74,6 +101,7 @@ bool SymbolManager::remove_symbol(SymbolId symbol_id) {
     // Remove from both maps
     name_to_id_.erase(symbol_name);
     symbols_.erase(symbol_it);
+    retract_rules(symbol_id);
     
     update_stats();
     return true;
@@ -87,10 +115,18 @@ bool SymbolManager::set_symbol_state(SymbolId symbol_id, SymbolState state) {
         return false;
     }
     
+    const SymbolState old_state = it->second.state;
     it->second.state = state;
     it->second.last_updated = std::chrono::system_clock::now();
+    publish_rules(it->second);
     
     update_stats();
+    
+    StateListener listener = state_listener_;
+    lock.unlock();
+    if (listener && old_state != state) {
+        listener(symbol_id, old_state, state);
+    }
     return true;
 }
 
@@ -158,8 +194,7 @@ std::optional<SymbolInfo> SymbolManager::get_symbol_info(const std::string& symb
 }
 
 bool SymbolManager::is_valid_symbol(SymbolId symbol_id) const {
-    std::shared_lock lock(mutex_);
-    return symbols_.find(symbol_id) != symbols_.end();
+    return get_rules(symbol_id).valid;
 }
 
 bool SymbolManager::is_valid_symbol(const std::string& symbol_name) const {
@@ -168,40 +203,79 @@ bool SymbolManager::is_valid_symbol(const std::string& symbol_name) const {
 }
 
 bool SymbolManager::can_trade_symbol(SymbolId symbol_id) const {
-    auto info = get_symbol_info(symbol_id);
-    return info && info->accepts_orders();
+    const SymbolRules rules = get_rules(symbol_id);
+    return rules.valid && rules.accepts_orders();
 }
 
 bool SymbolManager::validate_price(SymbolId symbol_id, uint32_t price) const {
-    auto info = get_symbol_info(symbol_id);
-    if (!info) return false;
+    const SymbolRules rules = get_rules(symbol_id);
+    if (!rules.valid) return false;
     
-    return price >= info->min_price && 
-           price <= info->max_price &&
-           (price % info->tick_size) == 0;
+    return price >= rules.min_price && 
+           price <= rules.max_price &&
+           (price % rules.tick_size) == 0;
 }
 
 bool SymbolManager::validate_quantity(SymbolId symbol_id, uint32_t quantity) const {
-    auto info = get_symbol_info(symbol_id);
-    if (!info) return false;
+    const SymbolRules rules = get_rules(symbol_id);
+    if (!rules.valid) return false;
     
-    return quantity >= info->min_quantity && quantity <= info->max_quantity;
+    return quantity >= rules.min_quantity && quantity <= rules.max_quantity;
 }
 
 uint32_t SymbolManager::round_to_tick(SymbolId symbol_id, uint32_t price) const {
-    auto info = get_symbol_info(symbol_id);
-    if (!info) return price;
+    const SymbolRules rules = get_rules(symbol_id);
+    if (!rules.valid) return price;
     
-    return (price / info->tick_size) * info->tick_size;
+    return (price / rules.tick_size) * rules.tick_size;
 }
 
 uint32_t SymbolManager::round_to_lot(SymbolId symbol_id, uint32_t quantity) const {
-    auto info = get_symbol_info(symbol_id);
-    if (!info) return quantity;
+    const SymbolRules rules = get_rules(symbol_id);
+    if (!rules.valid) return quantity;
     
-    return (quantity / info->lot_size) * info->lot_size;
+    return (quantity / rules.lot_size) * rules.lot_size;
 }
 
+RouteResult SymbolManager::validate_order(Order& order) const {
+    const SymbolRules rules = get_rules(order.symbol);
+    if (!rules.valid) {
+        return RouteResult::INVALID_SYMBOL;
+    }
+    if (!rules.accepts_orders()) {
+        return RouteResult::MARKET_CLOSED;
+    }
+    return rules.check_order(order);
+}
+
+SymbolRules SymbolManager::get_rules(SymbolId symbol_id) const {
+    const RulesSlot* page = rules_pages_[symbol_id >> RULES_PAGE_BITS].load(std::memory_order_acquire);
+    if (!page) {
+        return SymbolRules{};
+    }
+    
+    const RulesSlot& slot = page[symbol_id & (RULES_PAGE_SIZE - 1)];
+    uint64_t words[RulesSlot::WORDS];
+    for (;;) {
+        const uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue; // Write in progress
+        }
+        for (size_t i = 0; i < RulesSlot::WORDS; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+    
+    SymbolRules rules;
+    std::memcpy(&rules, words, sizeof(rules));
+    return rules;
+}
+
+
 std::vector<SymbolInfo> SymbolManager::get_all_symbols() const {
     std::shared_lock lock(mutex_);
     
@@ -246,6 +320,17 @@ void SymbolManager::update_symbol_stats(SymbolId symbol_id, uint32_t volume, boo
     }
 }
 
+void SymbolManager::add_symbol_trades(SymbolId symbol_id, uint64_t volume, uint32_t trades) {
+    std::unique_lock lock(mutex_);
+    
+    auto it = symbols_.find(symbol_id);
+    if (it != symbols_.end()) {
+        it->second.total_volume += volume;
+        it->second.total_trades += trades;
+        it->second.last_updated = std::chrono::system_clock::now();
+    }
+}
+
 SymbolManager::Stats SymbolManager::get_stats() const {
     std::shared_lock lock(mutex_);
     return stats_;
@@ -255,28 +340,58 @@ void SymbolManager::open_market() {
     std::unique_lock lock(mutex_);
     
     // Open all symbols that are in PRE_OPEN state
+    std::vector<std::pair<SymbolId, SymbolState>> changes;
     for (auto& [id, info] : symbols_) {
         if (info.state == SymbolState::PRE_OPEN) {
+            changes.emplace_back(id, info.state);
             info.state = SymbolState::OPEN;
             info.last_updated = std::chrono::system_clock::now();
+            publish_rules(info);
         }
     }
     
     update_stats();
+    lock.unlock();
+    notify_state_changes(changes, SymbolState::OPEN);
 }
 
 void SymbolManager::close_market() {
     std::unique_lock lock(mutex_);
     
     // Close all trading symbols
+    std::vector<std::pair<SymbolId, SymbolState>> changes;
     for (auto& [id, info] : symbols_) {
         if (info.state == SymbolState::OPEN || info.state == SymbolState::PRE_OPEN) {
+            changes.emplace_back(id, info.state);
             info.state = SymbolState::CLOSED;
             info.last_updated = std::chrono::system_clock::now();
+            publish_rules(info);
         }
     }
     
     update_stats();
+    lock.unlock();
+    notify_state_changes(changes, SymbolState::CLOSED);
+}
+
+void SymbolManager::set_state_listener(StateListener listener) {
+    std::unique_lock lock(mutex_);
+    state_listener_ = std::move(listener);
+}
+
+void SymbolManager::notify_state_changes(const std::vector<std::pair<SymbolId, SymbolState>>& changes,
+                                         SymbolState new_state) {
+    StateListener listener;
+    {
+        std::shared_lock lock(mutex_);
+        listener = state_listener_;
+    }
+    if (!listener) {
+        return;
+    }
+    for (const auto& [id, old_state] : changes) {
+        listener(id, old_state, new_state);
+    }
 }
 
 bool SymbolManager::is_market_open() const {
@@ -319,6 +434,37 @@ std::vector<SymbolManager::SymbolConfig> SymbolManager::export_symbol_configs()
     return configs;
 }
 
+void SymbolManager::publish_rules(const SymbolInfo& info) {
+    store_rules(info.id, rules_of(info));
+}
+
+void SymbolManager::retract_rules(SymbolId symbol_id) {
+    store_rules(symbol_id, SymbolRules{});
+}
+
+void SymbolManager::store_rules(SymbolId symbol_id, const SymbolRules& rules) {
+    // Called while holding unique lock, so there is one writer per slot
+    static_assert(std::is_trivially_copyable<SymbolRules>::value, "SymbolRules is copied as raw words");
+    auto& page_ptr = rules_pages_[symbol_id >> RULES_PAGE_BITS];
+    RulesSlot* page = page_ptr.load(std::memory_order_relaxed);
+    if (!page) {
+        page = new RulesSlot[RULES_PAGE_SIZE];
+        page_ptr.store(page, std::memory_order_release);
+    }
+    
+    uint64_t words[RulesSlot::WORDS] = {};
+    std::memcpy(words, &rules, sizeof(rules));
+    
+    RulesSlot& slot = page[symbol_id & (RULES_PAGE_SIZE - 1)];
+    const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < RulesSlot::WORDS; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
 void SymbolManager::update_stats() {
     // Called while holding unique lock
     stats_.total_symbols = symbols_.size();
@@ -341,54 +487,73 @@ void SymbolManager::update_stats() {
 
 // SymbolRouter Implementation
 
+SymbolRouter::SymbolRouter(SymbolManager& sym_mgr, MatchingEngine& engine)
+    : symbol_manager_(sym_mgr), matching_engine_(engine) {
+    symbol_manager_.set_state_listener([this](SymbolId symbol, SymbolState old_state, SymbolState new_state) {
+        on_symbol_state(symbol, old_state, new_state);
+    });
+}
+
+SymbolRouter::~SymbolRouter() {
+    symbol_manager_.set_state_listener(nullptr);
+}
+
+void SymbolRouter::on_symbol_state(SymbolId symbol, SymbolState /*old_state*/, SymbolState new_state) {
+    if (new_state == SymbolState::PRE_OPEN || new_state == SymbolState::HALTED) {
+        matching_engine_.begin_auction(symbol);
+        return;
+    }
+    if (new_state != SymbolState::OPEN || !matching_engine_.in_auction(symbol)) {
+        return;
+    }
+    
+    // Opening (or reopening) cross: one pass over the collected book
+    const FillCallback& on_fill = matching_engine_.get_fill_callback();
+    AuctionSummary summary = matching_engine_.uncross(symbol, [&](const Fill& fill) {
+        if (on_fill) {
+            on_fill(fill);
+        }
+    });
+    stats_.auction_uncrosses++;
+    stats_.auction_volume += summary.volume;
+    if (summary.fill_count > 0) {
+        symbol_manager_.add_symbol_trades(symbol, summary.volume, summary.fill_count);
+    }
+}
+
 SymbolRouter::RoutedOrder SymbolRouter::route_order(Order order) {
     RoutedOrder result;
     result.order = order;
-    result.result = RouteResult::SUCCESS;
     
     stats_.total_orders++;
     
-    // Validate symbol
-    if (!symbol_manager_.is_valid_symbol(order.symbol)) {
-        result.result = RouteResult::INVALID_SYMBOL;
-        result.error_message = "Invalid symbol ID: " + std::to_string(order.symbol);
-        stats_.invalid_symbol_orders++;
-        stats_.rejected_orders++;
-        return result;
-    }
-    
-    // Check if symbol accepts orders
-    if (!symbol_manager_.can_trade_symbol(order.symbol)) {
-        result.result = RouteResult::MARKET_CLOSED;
-        result.error_message = "Market closed for symbol";
-        stats_.market_closed_orders++;
-        stats_.rejected_orders++;
-        return result;
-    }
-    
-    // Validate price (for limit orders)
-    if (order.type == OrderType::LIMIT && 
-        !symbol_manager_.validate_price(order.symbol, order.price)) {
-        result.result = RouteResult::INVALID_PRICE;
-        result.error_message = "Invalid price for symbol";
-        stats_.rejected_orders++;
-        return result;
+    // One pass over the symbol's rules; also rounds price and quantity
+    result.result = symbol_manager_.validate_order(result.order);
+    switch (result.result) {
+        case RouteResult::SUCCESS:
+            break;
+        case RouteResult::INVALID_SYMBOL:
+            result.error_message = "Invalid symbol ID: " + std::to_string(order.symbol);
+            stats_.invalid_symbol_orders++;
+            break;
+        case RouteResult::MARKET_CLOSED:
+            result.error_message = "Market closed for symbol";
+            stats_.market_closed_orders++;
+            break;
+        case RouteResult::INVALID_PRICE:
+            result.error_message = "Invalid price for symbol";
+            break;
+        case RouteResult::INVALID_QUANTITY:
+            result.error_message = "Invalid quantity for symbol";
+            break;
+        case RouteResult::REJECTED:
+            break;
     }
-    
-    // Validate quantity
-    if (!symbol_manager_.validate_quantity(order.symbol, order.quantity)) {
-        result.result = RouteResult::INVALID_QUANTITY;
-        result.error_message = "Invalid quantity for symbol";
+    if (result.result != RouteResult::SUCCESS) {
         stats_.rejected_orders++;
         return result;
     }
     
-    // Round price and quantity to symbol specifications
-    if (order.type == OrderType::LIMIT) {
-        result.order.price = symbol_manager_.round_to_tick(order.symbol, order.price);
-    }
-    result.order.quantity = symbol_manager_.round_to_lot(order.symbol, result.order.quantity);
-    
     // Route to matching engine
     try {
         MatchResult match_result = matching_engine_.process_order(result.order);
@@ -454,6 +619,86 @@ std::vector<SymbolRouter::RoutedOrder> SymbolRouter::route_orders(const std::vec
     return results;
 }
 
+size_t SymbolRouter::route_orders(const Order* orders, size_t count, RouteResult* results) {
+    // Group by symbol; stable, so each symbol's orders keep their sequence
+    batch_order_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        batch_order_[i] = static_cast<uint32_t>(i);
+    }
+    bool grouped = true;
+    for (size_t i = 1; i < count && grouped; ++i) {
+        grouped = orders[i - 1].symbol <= orders[i].symbol;
+    }
+    if (!grouped) {
+        std::stable_sort(batch_order_.begin(), batch_order_.end(), [&](uint32_t a, uint32_t b) {
+            return orders[a].symbol < orders[b].symbol;
+        });
+    }
+    
+    stats_.total_orders += count;
+    size_t routed = 0;
+    const FillCallback& on_fill = matching_engine_.get_fill_callback();
+    
+    for (size_t run = 0; run < count;) {
+        const SymbolId symbol = orders[batch_order_[run]].symbol;
+        size_t run_end = run + 1;
+        while (run_end < count && orders[batch_order_[run_end]].symbol == symbol) {
+            ++run_end;
+        }
+        const size_t run_size = run_end - run;
+        
+        // Symbol and state are checked once for the whole run
+        const SymbolRules rules = symbol_manager_.get_rules(symbol);
+        RouteResult symbol_result = RouteResult::SUCCESS;
+        if (!rules.valid) {
+            symbol_result = RouteResult::INVALID_SYMBOL;
+            stats_.invalid_symbol_orders += run_size;
+        } else if (!rules.accepts_orders()) {
+            symbol_result = RouteResult::MARKET_CLOSED;
+            stats_.market_closed_orders += run_size;
+        }
+        if (symbol_result != RouteResult::SUCCESS) {
+            for (size_t i = run; i < run_end; ++i) {
+                results[batch_order_[i]] = symbol_result;
+            }
+            stats_.rejected_orders += run_size;
+            run = run_end;
+            continue;
+        }
+        
+        uint64_t volume = 0;
+        uint32_t trades = 0;
+        auto sink = [&](const Fill& fill) {
+            volume += fill.execution_quantity;
+            ++trades;
+            if (on_fill) {
+                on_fill(fill);
+            }
+        };
+        for (size_t i = run; i < run_end; ++i) {
+            const uint32_t index = batch_order_[i];
+            Order order = orders[index];
+            const RouteResult result = rules.check_order(order);
+            results[index] = result;
+            if (result != RouteResult::SUCCESS) {
+                stats_.rejected_orders++;
+                continue;
+            }
+            matching_engine_.process_order(order, sink);
+            ++routed;
+        }
+        
+        // One stats update per symbol instead of one per fill
+        if (trades > 0) {
+            symbol_manager_.add_symbol_trades(symbol, volume, trades);
+        }
+        run = run_end;
+    }
+    
+    stats_.routed_orders += routed;
+    return routed;
+}
+
 bool SymbolRouter::route_cancel(OrderId order_id) {
     // Simple passthrough to matching engine
     return matching_engine_.cancel_order(order_id);
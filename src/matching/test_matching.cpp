@@ -105,6 +105,14 @@ int main() {
     auto result7 = engine.process_order(ioc_buy);
     print_order_result(ioc_buy, result7);
     
+    std::cout << "\n6. Testing FOK order (Fill or Kill)..." << std::endl;
+    
+    // FOK order larger than the liquidity at its price - killed without any fills
+    matching::Order fok_sell{4002, test_symbol, Side::SELL, OrderType::LIMIT, TimeInForce::FOK, 500, 0, 49800};
+    auto result8 = engine.process_order(fok_sell);
+    print_order_result(fok_sell, result8);
+    print_market_data(engine, test_symbol);
+    
     // Show engine statistics
     std::cout << "\n=== ENGINE STATISTICS ===" << std::endl;
     auto stats = engine.get_stats();
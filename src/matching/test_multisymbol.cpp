@@ -1,5 +1,10 @@
 #include "matching/symbol_manager.hpp"
 #include "matching/matching_engine.hpp"
+#include "matching/sharded_engine.hpp"
+#include "matching/journal.hpp"
+#include <chrono>
+#include <thread>
+#include <unordered_set>
 #include <iostream>
 #include <iomanip>
 
@@ -72,8 +77,8 @@ int main() {
         SymbolId id = symbol_manager.add_symbol(symbol_name, 1, 1000, 5000000); // $0.10 - $500.00
         std::cout << "Added symbol " << symbol_name << " with ID " << id << std::endl;
         
-        // Add to matching engine
-        engine.add_symbol(id);
+        // Add to matching engine with the symbol's tick size and price band
+        engine.add_symbol(id, symbol_manager.get_symbol_info(id)->book_config());
         
         // Set to PRE_OPEN state initially
         symbol_manager.set_symbol_state(id, SymbolState::PRE_OPEN);
@@ -200,11 +205,320 @@ int main() {
         
         auto symbol_id = symbol_manager.get_symbol_id(symbol_name);
         if (symbol_id) {
-            engine.add_symbol(*symbol_id);
+            engine.add_symbol(*symbol_id, symbol_manager.get_symbol_info(*symbol_id)->book_config());
             symbol_manager.set_symbol_state(*symbol_id, SymbolState::OPEN);
         }
     }
     
+    std::cout << "\n11. Sharded engine runtime..." << std::endl;
+    
+    // The same order stream through one engine and through four shards must
+    // give the same fills and the same books
+    constexpr SymbolId SHARD_SYMBOLS = 16;
+    constexpr size_t SHARD_ORDERS = 200000;
+    std::vector<matching::Order> stream;
+    stream.reserve(SHARD_ORDERS);
+    uint64_t rng = 88172645463325252ull;
+    for (size_t i = 0; i < SHARD_ORDERS; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        matching::Order order;
+        order.id = 1000000 + i;
+        order.symbol = static_cast<SymbolId>(1 + rng % SHARD_SYMBOLS);
+        order.side = (rng >> 8) & 1 ? Side::BUY : Side::SELL;
+        order.type = ((rng >> 9) & 15) == 0 ? OrderType::MARKET : OrderType::LIMIT;
+        order.quantity = static_cast<Quantity>(100 * (1 + (rng >> 16) % 5));
+        order.price = static_cast<Price>(1000000 + ((rng >> 24) % 40) * 100);
+        stream.push_back(order);
+    }
+    
+    MatchingEngine single_engine;
+    uint64_t single_fills = 0, single_volume = 0;
+    FillSpan no_store(nullptr, 0);
+    auto single_start = std::chrono::steady_clock::now();
+    for (const auto& order : stream) {
+        auto summary = single_engine.process_order(order, no_store);
+        single_fills += summary.fill_count;
+        single_volume += summary.total_filled;
+    }
+    auto single_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - single_start).count();
+    
+    ShardedEngineConfig shard_config;
+    shard_config.shards = 4;
+    shard_config.spin = false; // Demo may share cores with the submitting thread
+    ShardedEngine sharded(shard_config);
+    sharded.start();
+    for (SymbolId sym = 1; sym <= SHARD_SYMBOLS; ++sym) {
+        while (!sharded.add_symbol(sym)) std::this_thread::yield();
+    }
+    
+    uint64_t sharded_fills = 0, sharded_volume = 0, acks = 0;
+    std::vector<uint64_t> last_sequence(sharded.shard_count(), 0);
+    std::unordered_set<uint64_t> trade_ids;
+    bool in_sequence = true, unique_trade_ids = true;
+    auto on_event = [&](const EngineEvent& event) {
+        in_sequence = in_sequence && event.sequence == last_sequence[event.shard] + 1;
+        last_sequence[event.shard] = event.sequence;
+        if (event.kind == EngineEvent::Kind::FILL) {
+            ++sharded_fills;
+            sharded_volume += event.filled;
+            unique_trade_ids = trade_ids.insert(event.fill.trade_id).second && unique_trade_ids;
+        } else if (event.kind == EngineEvent::Kind::ACK) {
+            ++acks;
+        }
+    };
+    auto sharded_start = std::chrono::steady_clock::now();
+    for (const auto& order : stream) {
+        while (!sharded.submit(order)) {
+            sharded.poll(on_event);
+        }
+    }
+    while (acks < SHARD_ORDERS) {
+        if (sharded.poll(on_event) == 0) std::this_thread::yield();
+    }
+    auto sharded_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - sharded_start).count();
+    sharded.stop();
+    
+    bool books_match = true;
+    for (SymbolId sym = 1; sym <= SHARD_SYMBOLS; ++sym) {
+        auto expected = single_engine.get_level1_data(sym);
+        auto actual = sharded.engine(sharded.shard_of(sym)).get_level1_data(sym);
+        books_match = books_match &&
+            expected.best_bid_price == actual.best_bid_price &&
+            expected.best_bid_quantity == actual.best_bid_quantity &&
+            expected.best_ask_price == actual.best_ask_price &&
+            expected.best_ask_quantity == actual.best_ask_quantity;
+    }
+    
+    std::cout << "Single engine: " << single_fills << " fills, volume " << single_volume
+              << " in " << single_us << " us" << std::endl;
+    std::cout << "4 shards:      " << sharded_fills << " fills, volume " << sharded_volume
+              << " in " << sharded_us << " us" << std::endl;
+    for (uint32_t i = 0; i < sharded.shard_count(); ++i) {
+        auto shard_stats = sharded.get_shard_stats(i);
+        auto latency = sharded.engine(i).order_latency().get_stats();
+        std::cout << "  Shard " << i << ": " << shard_stats.commands << " commands, "
+                  << shard_stats.events << " events, process_order p50 " << latency.p50_ns
+                  << " ns / p99 " << latency.p99_ns << " ns" << std::endl;
+    }
+    std::cout << "Fills match: " << (single_fills == sharded_fills && single_volume == sharded_volume ? "YES" : "NO")
+              << " | Books match: " << (books_match ? "YES" : "NO")
+              << " | Sequences gap-free: " << (in_sequence ? "YES" : "NO")
+              << " | Trade ids unique: " << (unique_trade_ids ? "YES" : "NO") << std::endl;
+    
+    std::cout << "\n12. Batch routing vs per-order loop..." << std::endl;
+    
+    // Two identical systems: one routed through route_orders(vector), which
+    // loops over route_order, the other through the batch API
+    constexpr size_t BATCH_SYMBOLS = 50;
+    constexpr size_t BATCH_ORDERS = 200000;
+    struct System {
+        SymbolManager symbols;
+        MatchingEngine engine;
+        SymbolRouter router{symbols, engine};
+        System() {
+            symbols.load_symbols(symbol_utils::create_test_symbols(BATCH_SYMBOLS));
+            for (SymbolId id = 1; id <= BATCH_SYMBOLS; ++id) {
+                engine.add_symbol(id, symbols.get_symbol_info(id)->book_config());
+                symbols.set_symbol_state(id, id % 10 == 0 ? SymbolState::HALTED : SymbolState::OPEN);
+            }
+        }
+    };
+    auto loop_system = std::make_unique<System>();
+    auto batch_system = std::make_unique<System>();
+    
+    std::vector<matching::Order> batch;
+    batch.reserve(BATCH_ORDERS);
+    for (size_t i = 0; i < BATCH_ORDERS; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        matching::Order order;
+        order.id = 5000000 + i;
+        order.symbol = static_cast<SymbolId>(1 + rng % (BATCH_SYMBOLS + 2)); // Two unknown ids
+        order.side = (rng >> 8) & 1 ? Side::BUY : Side::SELL;
+        order.quantity = static_cast<Quantity>(100 * (1 + (rng >> 16) % 5));
+        order.price = static_cast<Price>(500000 + ((rng >> 24) % 40) * 100);
+        if (((rng >> 32) & 255) == 0) order.price = 2000000; // Above the $100 band
+        batch.push_back(order);
+    }
+    
+    auto loop_start = std::chrono::steady_clock::now();
+    auto loop_results = loop_system->router.route_orders(batch);
+    auto loop_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - loop_start).count();
+    
+    std::vector<SymbolRouter::RouteResult> batch_results(batch.size());
+    auto batch_start = std::chrono::steady_clock::now();
+    size_t batch_routed = batch_system->router.route_orders(batch.data(), batch.size(), batch_results.data());
+    auto batch_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - batch_start).count();
+    
+    bool results_match = true;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        results_match = results_match && loop_results[i].result == batch_results[i];
+    }
+    bool batch_books_match = true;
+    for (SymbolId id = 1; id <= BATCH_SYMBOLS; ++id) {
+        auto expected = loop_system->engine.get_level1_data(id);
+        auto actual = batch_system->engine.get_level1_data(id);
+        batch_books_match = batch_books_match &&
+            expected.best_bid_price == actual.best_bid_price &&
+            expected.best_bid_quantity == actual.best_bid_quantity &&
+            expected.best_ask_price == actual.best_ask_price &&
+            expected.best_ask_quantity == actual.best_ask_quantity;
+    }
+    auto loop_symbol_stats = loop_system->symbols.get_all_symbols();
+    uint64_t loop_trades = 0, batch_trades = 0;
+    for (const auto& info : loop_symbol_stats) loop_trades += info.total_trades;
+    for (const auto& info : batch_system->symbols.get_all_symbols()) batch_trades += info.total_trades;
+    
+    std::cout << "Per-order loop: " << loop_system->router.get_routing_stats().routed_orders << " routed in "
+              << loop_us << " us (" << std::setprecision(1) << (loop_us * 1000.0 / BATCH_ORDERS) << " ns/order)" << std::endl;
+    std::cout << "Batch:          " << batch_routed << " routed in "
+              << batch_us << " us (" << (batch_us * 1000.0 / BATCH_ORDERS) << " ns/order)" << std::endl;
+    std::cout << "Results match: " << (results_match ? "YES" : "NO")
+              << " | Books match: " << (batch_books_match ? "YES" : "NO")
+              << " | Trades " << loop_trades << " / " << batch_trades << std::endl;
+    
+    std::cout << "\n13. Opening cross..." << std::endl;
+    
+    // The same burst through an auction (collect, then one uncross at the
+    // open) and through continuous matching
+    constexpr size_t CROSS_ORDERS = 20000;
+    std::vector<matching::Order> burst;
+    burst.reserve(CROSS_ORDERS);
+    for (size_t i = 0; i < CROSS_ORDERS; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        matching::Order order;
+        order.id = 9000000 + i;
+        order.symbol = 1;
+        order.side = (rng >> 8) & 1 ? Side::BUY : Side::SELL;
+        order.quantity = static_cast<Quantity>(100 * (1 + (rng >> 16) % 10));
+        order.price = static_cast<Price>(490000 + ((rng >> 24) % 201) * 100); // $49.00 - $51.00
+        burst.push_back(order);
+    }
+    
+    int64_t uncross_us = 0;
+    auto run_burst = [&](bool auction, std::unique_ptr<System>& sys, int64_t& elapsed_us) {
+        sys = std::make_unique<System>();
+        sys->symbols.set_symbol_state(1, auction ? SymbolState::PRE_OPEN : SymbolState::OPEN);
+        std::vector<SymbolRouter::RouteResult> results(burst.size());
+        auto start = std::chrono::steady_clock::now();
+        sys->router.route_orders(burst.data(), burst.size(), results.data());
+        if (auction) {
+            auto open_start = std::chrono::steady_clock::now();
+            sys->symbols.open_trading(1);
+            uncross_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - open_start).count();
+        }
+        elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+    std::unique_ptr<System> auction_system, continuous_system;
+    int64_t auction_us = 0, continuous_us = 0;
+    run_burst(true, auction_system, auction_us);
+    run_burst(false, continuous_system, continuous_us);
+    
+    const auto& auction_stats = auction_system->router.get_routing_stats();
+    auto cross_l1 = auction_system->engine.get_level1_data(1);
+    auto auction_info = auction_system->symbols.get_symbol_info(1);
+    std::cout << "Auction:    " << auction_stats.auction_uncrosses << " uncross, volume "
+              << auction_stats.auction_volume << " in " << auction_info->total_trades << " fills, "
+              << auction_us << " us (uncross " << uncross_us << " us)" << std::endl;
+    std::cout << "            after the open: bid $" << std::setprecision(2) << (cross_l1.best_bid_price / 10000.0)
+              << " / ask $" << (cross_l1.best_ask_price / 10000.0)
+              << (cross_l1.best_bid_price < cross_l1.best_ask_price ? " (uncrossed)" : " (STILL CROSSED)") << std::endl;
+    std::cout << "Continuous: volume " << continuous_system->symbols.get_symbol_info(1)->total_volume
+              << " in " << continuous_system->symbols.get_symbol_info(1)->total_trades << " fills, "
+              << continuous_us << " us" << std::endl;
+    
+    std::cout << "\n14. Journaled shards and replay..." << std::endl;
+    
+    // Section 11's stream again, with a cancel after every tenth order, through
+    // journaled shards; each shard is then rebuilt from the journal alone
+    const std::string journal_path = "engine_journal.bin";
+    JournalConfig journal_config;
+    journal_config.path = journal_path;
+    journal_config.producers = 4;
+    journal_config.spin = false;
+    Journal journal(journal_config);
+    
+    shard_config.journal = &journal;
+    ShardedEngine journaled(shard_config);
+    const bool journal_started = journal.open() && journaled.start();
+    for (SymbolId sym = 1; journal_started && sym <= SHARD_SYMBOLS; ++sym) {
+        while (!journaled.add_symbol(sym)) std::this_thread::yield();
+    }
+    
+    // A shard's journal holds its commands and events, so every event polled
+    // so far must already be among its durable records
+    size_t journaled_acks = 0, expected_acks = 0;
+    std::vector<uint64_t> polled_events(journaled.shard_count(), 0);
+    bool durable_first = true;
+    auto count_acks = [&](const EngineEvent& event) {
+        journaled_acks += event.kind != EngineEvent::Kind::FILL;
+        durable_first = durable_first && journal.durable_records(event.shard) >= ++polled_events[event.shard];
+    };
+    auto journal_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; journal_started && i < stream.size(); ++i) {
+        while (!journaled.submit(stream[i])) journaled.poll(count_acks);
+        ++expected_acks;
+        if (i % 10 == 9) {
+            while (!journaled.cancel(stream[i - 5].symbol, stream[i - 5].id)) journaled.poll(count_acks);
+            ++expected_acks;
+        }
+    }
+    while (journaled_acks < expected_acks) {
+        if (journaled.poll(count_acks) == 0) std::this_thread::yield();
+    }
+    auto journal_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - journal_start).count();
+    journaled.stop();
+    journal.close();
+    auto journal_stats = journal.get_stats();
+    
+    JournalReader reader;
+    const bool journal_read = reader.open(journal_path);
+    ReplayResult replayed;
+    bool replay_books_match = journal_read;
+    auto replay_start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; journal_read && i < journaled.shard_count(); ++i) {
+        MatchingEngine rebuilt;
+        ReplayResult r = replay_journal(reader, i, rebuilt);
+        replayed.commands += r.commands;
+        replayed.events += r.events;
+        replayed.mismatches += r.mismatches;
+        for (SymbolId sym = 1; sym <= SHARD_SYMBOLS; ++sym) {
+            if (journaled.shard_of(sym) != i) continue;
+            auto expected = journaled.engine(i).get_level1_data(sym);
+            auto actual = rebuilt.get_level1_data(sym);
+            replay_books_match = replay_books_match &&
+                expected.best_bid_price == actual.best_bid_price &&
+                expected.best_bid_quantity == actual.best_bid_quantity &&
+                expected.best_ask_price == actual.best_ask_price &&
+                expected.best_ask_quantity == actual.best_ask_quantity;
+        }
+    }
+    auto replay_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - replay_start).count();
+    std::remove(journal_path.c_str());
+    
+    std::cout << "Journaled run: " << expected_acks << " commands in " << journal_us << " us, "
+              << journal_stats.records << " records in " << journal_stats.commits << " commits (largest "
+              << journal_stats.max_batch << "), " << journal_stats.stalls << " stalls" << std::endl;
+    std::cout << "Replay:        " << replayed.commands << " commands, " << replayed.events
+              << " events checked in " << replay_us << " us" << std::endl;
+    std::cout << "Journal read: " << (journal_read && reader.size() == journal_stats.records ? "YES" : "NO")
+              << " | Events match: " << (journal_read && replayed.mismatches == 0 ? "YES" : "NO")
+              << " | Books match: " << (replay_books_match ? "YES" : "NO")
+              << " | Events durable first: " << (durable_first ? "YES" : "NO") << std::endl;
+    
     std::cout << "\\nFinal system state:" << std::endl;
     auto final_stats = symbol_manager.get_stats();
     std::cout << "Total symbols in system: " << final_stats.total_symbols << std::endl;
@@ -0,0 +1,221 @@
+#include "net/rx_backend.hpp"
+
+#ifdef NASDAQ_AF_XDP
+
+#include <xdp/xsk.h>
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <linux/ip.h>
+#include <linux/udp.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+#include <vector>
+
+namespace net {
+
+namespace {
+
+// AF_XDP socket bound to one NIC queue. Frames are busy-polled from the RX
+// ring and handed out as views straight into UMEM; they go back to the fill
+// ring on the next receive(), so the UMEM working set stays small.
+class AfXdpBackend : public RxBackend {
+public:
+  ~AfXdpBackend() override { close(); }
+
+  bool open(const RxConfig& cfg) override {
+    group_ = inet_addr(cfg.mcast_group.c_str());
+    port_ = htons(static_cast<uint16_t>(cfg.port));
+
+    const size_t bytes = size_t(FRAMES) * FRAME_SIZE;
+    umem_area_ = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (umem_area_ == MAP_FAILED)
+      umem_area_ = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (umem_area_ == MAP_FAILED) { umem_area_ = nullptr; perror("mmap umem"); return false; }
+    umem_bytes_ = bytes;
+
+    xsk_umem_config ucfg{};
+    ucfg.fill_size = FILL_SIZE;
+    ucfg.comp_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+    ucfg.frame_size = FRAME_SIZE;
+    ucfg.frame_headroom = 0;
+    if (int err = xsk_umem__create(&umem_, umem_area_, bytes, &fill_, &comp_, &ucfg)) {
+      fprintf(stderr, "xsk_umem__create: %s\n", strerror(-err));
+      close();
+      return false;
+    }
+
+    xsk_socket_config scfg{};
+    scfg.rx_size = RX_SIZE;
+    scfg.tx_size = 0;
+    scfg.bind_flags = XDP_USE_NEED_WAKEUP;
+    if (int err = xsk_socket__create(&xsk_, cfg.ifname.c_str(), cfg.queue_id, umem_, &rx_,
+                                     nullptr, &scfg)) {
+      fprintf(stderr, "xsk_socket__create(%s, queue %u): %s\n", cfg.ifname.c_str(),
+              cfg.queue_id, strerror(-err));
+      close();
+      return false;
+    }
+
+    // Frames start out either with the kernel (fill ring) or on the free list
+    held_.clear();
+    held_.reserve(RX_SIZE);
+    free_.clear();
+    free_.reserve(FRAMES);
+    uint32_t idx = 0;
+    if (xsk_ring_prod__reserve(&fill_, FILL_SIZE, &idx) != FILL_SIZE) { close(); return false; }
+    for (uint32_t i = 0; i < FILL_SIZE; ++i)
+      *xsk_ring_prod__fill_addr(&fill_, idx + i) = uint64_t(i) * FRAME_SIZE;
+    xsk_ring_prod__submit(&fill_, FILL_SIZE);
+    for (uint32_t i = FILL_SIZE; i < FRAMES; ++i) free_.push_back(uint64_t(i) * FRAME_SIZE);
+
+    // The NIC still needs an IGMP membership to deliver the group
+    mcast_sock_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ip_mreq mreq{};
+    mreq.imr_multiaddr.s_addr = group_;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (mcast_sock_ < 0 ||
+        setsockopt(mcast_sock_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+      perror("IP_ADD_MEMBERSHIP");
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  size_t receive(core::PacketView* out, size_t max) override {
+    // The caller is done with the previous batch
+    free_.insert(free_.end(), held_.begin(), held_.end());
+    held_.clear();
+    refill();
+
+    uint32_t idx = 0;
+    const uint32_t n = xsk_ring_cons__peek(&rx_, static_cast<uint32_t>(max), &idx);
+    if (n == 0) {
+      // Busy poll; only kick the driver when it asked for it
+      if (xsk_ring_prod__needs_wakeup(&fill_))
+        recvfrom(xsk_socket__fd(xsk_), nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+      return 0;
+    }
+
+    // No per-frame metadata from the driver here: stamp the batch on arrival
+    // in the RX ring, which is as close to the wire as this path gets
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const uint64_t rx_ns = uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+
+    size_t got = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      const xdp_desc* desc = xsk_ring_cons__rx_desc(&rx_, idx + i);
+      const uint64_t frame = xsk_umem__extract_addr(desc->addr);
+      const char* pkt = static_cast<const char*>(xsk_umem__get_data(umem_area_, desc->addr));
+      core::PacketView payload;
+      if (udp_payload(pkt, desc->len, payload)) {
+        payload.rx_ns = rx_ns;
+        out[got++] = payload;
+        held_.push_back(frame);
+      } else {
+        free_.push_back(frame); // not our feed: reusable right away
+      }
+    }
+    xsk_ring_cons__release(&rx_, n);
+    refill();
+    return got;
+  }
+
+  void close() override {
+    if (xsk_) xsk_socket__delete(xsk_);
+    if (umem_) xsk_umem__delete(umem_);
+    if (umem_area_) munmap(umem_area_, umem_bytes_);
+    if (mcast_sock_ >= 0) ::close(mcast_sock_);
+    xsk_ = nullptr;
+    umem_ = nullptr;
+    umem_area_ = nullptr;
+    mcast_sock_ = -1;
+  }
+
+  const char* name() const override { return "af_xdp"; }
+
+private:
+  static constexpr uint32_t FRAME_SIZE = XSK_UMEM__DEFAULT_FRAME_SIZE;
+  static constexpr uint32_t FILL_SIZE = 4096;
+  static constexpr uint32_t RX_SIZE = 4096;
+  static constexpr uint32_t FRAMES = FILL_SIZE * 2;
+
+  // Ethernet (optionally 802.1Q) / IPv4 / UDP to our group and port
+  bool udp_payload(const char* pkt, uint32_t len, core::PacketView& out) const {
+    size_t off = sizeof(ethhdr);
+    if (len < off) return false;
+    uint16_t proto;
+    std::memcpy(&proto, pkt + 12, sizeof(proto));
+    if (proto == htons(ETH_P_8021Q)) {
+      if (len < off + 4) return false;
+      std::memcpy(&proto, pkt + 16, sizeof(proto));
+      off += 4;
+    }
+    if (proto != htons(ETH_P_IP) || len < off + sizeof(iphdr)) return false;
+    iphdr ip;
+    std::memcpy(&ip, pkt + off, sizeof(ip));
+    if (ip.protocol != IPPROTO_UDP || ip.daddr != group_) return false;
+    off += ip.ihl * 4u;
+    if (len < off + sizeof(udphdr)) return false;
+    udphdr udp;
+    std::memcpy(&udp, pkt + off, sizeof(udp));
+    if (udp.dest != port_) return false;
+    const uint32_t udp_len = ntohs(udp.len);
+    off += sizeof(udphdr);
+    if (udp_len < sizeof(udphdr) || off + udp_len - sizeof(udphdr) > len) return false;
+    out = core::PacketView{pkt + off, static_cast<uint32_t>(udp_len - sizeof(udphdr))};
+    return true;
+  }
+
+  // Hand every free frame the fill ring has room for back to the kernel
+  void refill() {
+    if (free_.empty()) return;
+    uint32_t want = xsk_prod_nb_free(&fill_, static_cast<uint32_t>(free_.size()));
+    if (want > free_.size()) want = static_cast<uint32_t>(free_.size());
+    uint32_t idx = 0;
+    want = xsk_ring_prod__reserve(&fill_, want, &idx);
+    for (uint32_t i = 0; i < want; ++i) {
+      *xsk_ring_prod__fill_addr(&fill_, idx + i) = free_.back();
+      free_.pop_back();
+    }
+    xsk_ring_prod__submit(&fill_, want);
+  }
+
+  uint32_t group_{0};
+  uint16_t port_{0};
+  void* umem_area_{nullptr};
+  size_t umem_bytes_{0};
+  xsk_umem* umem_{nullptr};
+  xsk_socket* xsk_{nullptr};
+  xsk_ring_prod fill_{};
+  xsk_ring_cons comp_{};
+  xsk_ring_cons rx_{};
+  int mcast_sock_{-1};
+  std::vector<uint64_t> held_; // frames of the batch last handed out
+  std::vector<uint64_t> free_;
+};
+
+} // namespace
+
+std::unique_ptr<RxBackend> make_af_xdp_backend() {
+  return std::make_unique<AfXdpBackend>();
+}
+
+} // namespace net
+
+#else
+
+namespace net {
+
+std::unique_ptr<RxBackend> make_af_xdp_backend() { return nullptr; }
+
+} // namespace net
+
+#endif // NASDAQ_AF_XDP
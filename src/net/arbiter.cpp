@@ -1,99 +1,250 @@
 #include "net/arbiter.hpp"
-#include "itch/messages.hpp"
-#include <arpa/inet.h>
+#include "itch/views.hpp"
+#include "net/moldudp64.hpp"
 #include <cstring>
 
 namespace net {
 
 static inline uint16_t tracking_number_from(const core::PacketView& pkt) {
   if (pkt.len < sizeof(CommonHeader)) return 0;
-  CommonHeader hdr; std::memcpy(&hdr, pkt.data, sizeof(hdr));
-  return ntohs(hdr.trackingNumber);
+  return itch::MessageView(pkt.data).tracking_number();
 }
 
-static inline uint32_t message_size_from(const core::PacketView& pkt) {
-  if (pkt.len == 0) return 0;
-  return itch_message_size(pkt.data[0]);
+Arbiter::Arbiter(PopFn popA, PopFn popB, size_t gap_capacity, std::chrono::milliseconds ttl,
+                 Framing framing)
+    : ttl_(ttl), framing_(framing) {
+  size_t cap = 64; // at least one occupancy word
+  while (cap < gap_capacity) cap <<= 1;
+  gap_.resize(cap);
+  occ_.resize(cap / 64);
+  mask_ = cap - 1;
+  feedA_.pop = std::move(popA);
+  feedB_.pop = std::move(popB);
 }
 
-void Arbiter::load_feed_messages(PopFn& pop, std::deque<core::PacketView>& buf) {
-  core::PacketView pkt;
-  while (pop(pkt)) {
-    const char* cur = pkt.data;
-    const char* end = cur + pkt.len;
-    while (cur < end) {
-      uint32_t msz = itch_message_size(*cur);
-      if (msz == 0 || cur + msz > end) break;
-      core::PacketView msg{cur, msz};
-      buf.push_back(msg);
-      cur += msz;
+void Arbiter::set_release(ReleaseFn releaseA, ReleaseFn releaseB) {
+  feedA_.release = std::move(releaseA);
+  feedB_.release = std::move(releaseB);
+}
+
+// Moves a feed on to its next packet. The finished one goes back right away
+// unless the gap ring may still point into it.
+bool Arbiter::pull(FeedCursor& feed) {
+  core::PacketView next;
+  if (!feed.pop(next)) return false;
+  if (feed.release && feed.pkt.data) {
+    if (buffered_) {
+      feed.done = feed.pkt;
+    } else {
+      feed.release(feed.pkt);
+      feed.done.data = nullptr;
+    }
+  }
+  feed.pkt = next;
+  return true;
+}
+
+// Called with the gap ring empty: nothing references finished packets anymore
+void Arbiter::release_done() {
+  if (feedA_.done.data) { feedA_.release(feedA_.done); feedA_.done.data = nullptr; }
+  if (feedB_.done.data) { feedB_.release(feedB_.done); feedB_.done.data = nullptr; }
+}
+
+bool Arbiter::peek(FeedCursor& feed, core::PacketView& msg, uint64_t& seq) {
+  return framing_ == Framing::MoldUDP64 ? peek_mold(feed, msg, seq) : peek_itch(feed, msg, seq);
+}
+
+// Current message of a feed, pulling the next packet once the last is used up
+bool Arbiter::peek_itch(FeedCursor& feed, core::PacketView& msg, uint64_t& seq) {
+  while (true) {
+    if (feed.off < feed.pkt.len) {
+      const char* cur = feed.pkt.data + feed.off;
+      const uint32_t msz = itch_message_size(*cur);
+      if (msz != 0 && feed.off + msz <= feed.pkt.len) {
+        msg = core::PacketView{cur, msz, feed.pkt.rx_ns};
+        seq = sequence_of(msg);
+        return true;
+      }
+      feed.off = feed.pkt.len; // unknown or truncated: drop the rest of the packet
+      continue;
+    }
+    if (!pull(feed)) return false;
+    feed.off = 0;
+  }
+}
+
+// As peek_itch, but packets already delivered by the other feed are dropped
+// from the header alone and partially new ones start at the first new message
+bool Arbiter::peek_mold(FeedCursor& feed, core::PacketView& msg, uint64_t& seq) {
+  while (true) {
+    if (feed.left) {
+      if (feed.off + 2 <= feed.pkt.len) {
+        const uint16_t mlen = mold::load_be16(feed.pkt.data + feed.off);
+        if (mlen != 0 && feed.off + 2 + mlen <= feed.pkt.len) {
+          msg = core::PacketView{feed.pkt.data + feed.off + 2, mlen, feed.pkt.rx_ns};
+          seq = feed.seq;
+          if (seq >= expected_) return true;
+          consume(feed, msg); // delivered from the other feed already
+          ++metrics_.dup_dropped;
+          continue;
+        }
+      }
+      feed.left = 0; // truncated packet: drop the rest
+      continue;
+    }
+
+    if (!pull(feed)) return false;
+    mold::Header hdr;
+    if (!mold::parse_header(feed.pkt, hdr)) continue;
+    if (!has_session_) {
+      std::memcpy(session_, hdr.session, sizeof(session_));
+      has_session_ = true;
+    } else if (std::memcmp(session_, hdr.session, sizeof(session_)) != 0) {
+      ++metrics_.session_mismatch;
+      continue;
+    }
+    if (hdr.is_end_of_session()) { ++metrics_.end_of_session; continue; }
+    if (hdr.is_heartbeat()) continue;
+    if (hdr.sequence + hdr.count <= expected_) {
+      ++metrics_.dup_packets;
+      metrics_.dup_dropped += hdr.count;
+      continue;
     }
+    feed.off = mold::HEADER_SIZE;
+    feed.seq = hdr.sequence;
+    feed.left = hdr.count;
   }
 }
 
-void Arbiter::prune_expired() {
-  const auto now = Clock::now();
-  while (!gap_.empty()) {
-    auto it = gap_.begin();
-    if (now - it->second.ts > ttl_) {
-      gap_.erase(it);
-      ++metrics_.gap_dropped_ttl;
-    } else { break; }
+void Arbiter::consume(FeedCursor& feed, const core::PacketView& msg) {
+  feed.off = static_cast<uint32_t>(msg.data + msg.len - feed.pkt.data);
+  if (framing_ == Framing::MoldUDP64) {
+    --feed.left;
+    ++feed.seq;
   }
 }
 
-/* removed legacy next() */
+// Widens the 16-bit tracking number to the 64-bit sequence nearest expected_.
+// Returns UNSEQUENCED for untracked messages and 0 for anything that would
+// precede the first message.
+uint64_t Arbiter::sequence_of(const core::PacketView& msg) const {
+  const uint16_t tn = tracking_number_from(msg);
+  if (tn == 0) return UNSEQUENCED;
+  const int16_t delta = static_cast<int16_t>(tn - static_cast<uint16_t>(expected_));
+  if (delta < 0 && static_cast<uint64_t>(-delta) >= expected_) return 0;
+  return expected_ + delta;
+}
+
+// Pops the buffered message at expected_, if it has arrived
+bool Arbiter::take_ready(core::PacketView& msg) {
+  if (!occupied(expected_)) return false;
+  msg = gap_[expected_ & mask_];
+  clear_occupied(expected_);
+  --buffered_;
+  ++metrics_.gap_filled;
+  ++expected_;
+  if (buffered_ && !occupied(expected_)) gap_opened_ = Clock::now(); // next hole starts now
+  return true;
+}
+
+// Gives up on the missing run and resumes at the next buffered message;
+// returns how many sequence numbers were skipped
+uint64_t Arbiter::skip_hole() {
+  uint64_t seq = expected_;
+  while (true) {
+    const uint64_t bits = occ_[(seq & mask_) >> 6] >> (seq & 63);
+    if (bits) { seq += __builtin_ctzll(bits); break; }
+    seq += 64 - (seq & 63);
+  }
+  const uint64_t skipped = seq - expected_;
+  expected_ = seq;
+  return skipped;
+}
 
 std::optional<core::PacketView> Arbiter::next_message() {
-  prune_expired();
+  core::PacketView msg;
+  uint64_t seq;
 
-  // If we have ready (gap-drained) messages, serve them first
-  if (!ready_.empty()) {
-    staging_ = ready_.front();
-    ready_.pop_front();
-    return core::PacketView{ staging_.bytes, staging_.len };
+  // Clock and ring are only consulted while a gap is open
+  if (buffered_) {
+    if (take_ready(msg)) return msg;
+    if (Clock::now() - gap_opened_ > ttl_) {
+      metrics_.gap_dropped_ttl += skip_hole();
+      take_ready(msg);
+      return msg;
+    }
+  } else {
+    if (feedA_.done.data || feedB_.done.data) release_done();
+    if (fast_) {
+      // In-sequence MoldUDP64 packet: keep draining it
+      if (fast_->left && fast_->seq == expected_ && peek(*fast_, msg, seq) && seq == expected_) {
+        consume(*fast_, msg);
+        ++expected_;
+        return msg;
+      }
+      fast_ = nullptr;
+    }
   }
 
-  // Fill per-feed message buffers from new packets
-  load_feed_messages(popA_, bufA_);
-  load_feed_messages(popB_, bufB_);
-
-  // Choose next message across feeds by tracking number ordering
-  auto pick_next = [&](std::deque<core::PacketView>& a, std::deque<core::PacketView>& b) -> std::optional<core::PacketView> {
-    if (a.empty() && b.empty()) return std::nullopt;
-    bool chooseA = false;
-    if (!a.empty() && !b.empty()) {
-      chooseA = tracking_number_from(a.front()) <= tracking_number_from(b.front());
-    } else if (!a.empty()) chooseA = true;
-    auto& src = chooseA ? a : b;
-    if (src.empty()) return std::nullopt;
-    core::PacketView msg = src.front(); src.pop_front();
-
-    const uint16_t tn = tracking_number_from(msg);
-    if (tn == 0) return msg;
-    if (tn < expected_) { ++metrics_.dup_dropped; return std::nullopt; }
-    if (tn > expected_) {
-      if (gap_.size() >= gap_capacity_) { ++metrics_.gap_dropped_capacity; gap_.erase(gap_.begin()); }
-      GapItem gi; gi.pkt.len = msg.len; std::memcpy(gi.pkt.bytes, msg.data, msg.len > sizeof(gi.pkt.bytes) ? sizeof(gi.pkt.bytes) : msg.len);
-      gap_.emplace(tn, GapItem{gi.pkt, Clock::now()}); ++metrics_.gap_detected; return std::nullopt;
+  // Next message across feeds by sequence; duplicates and early arrivals are
+  // absorbed here so the caller only ever sees deliverable messages
+  core::PacketView a, b;
+  uint64_t seqA = 0, seqB = 0;
+  bool hasA = peek(feedA_, a, seqA);
+  bool hasB = peek(feedB_, b, seqB);
+  while (hasA || hasB) {
+    // Untracked messages go first so they cannot be starved by the other feed
+    const uint64_t keyA = seqA == UNSEQUENCED ? 0 : seqA;
+    const uint64_t keyB = seqB == UNSEQUENCED ? 0 : seqB;
+    const bool chooseA = hasA && (!hasB || keyA <= keyB);
+    FeedCursor& src = chooseA ? feedA_ : feedB_;
+    msg = chooseA ? a : b;
+    seq = chooseA ? seqA : seqB;
+
+    if (seq != UNSEQUENCED && seq > expected_ && seq - expected_ > mask_) {
+      // Ring full: stop waiting for the hole now and serve what is buffered;
+      // this message stays in its feed until the window has moved up to it
+      if (buffered_) {
+        metrics_.gap_dropped_capacity += skip_hole();
+        take_ready(msg);
+        return msg;
+      }
+      metrics_.gap_dropped_capacity += seq - expected_;
+      expected_ = seq;
     }
-    // In-order message: advance expected and drain any consecutive gaps
-    ++expected_;
-    while (true) {
-      auto it = gap_.find(expected_);
-      if (it == gap_.end()) break;
-      ready_.push_back(it->second.pkt);
-      gap_.erase(it);
-      ++metrics_.gap_filled;
+    consume(src, msg);
+
+    if (seq == UNSEQUENCED) return msg; // untracked: pass through
+    if (seq == expected_) {
       ++expected_;
+      if (buffered_) {
+        // The hole closes; if the next message is missing too, a new one opens
+        const Clock::time_point now = Clock::now();
+        const uint64_t waited =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - gap_opened_).count());
+        ++metrics_.holes_recovered;
+        metrics_.hole_wait_ns += waited;
+        if (waited > metrics_.hole_wait_max_ns) metrics_.hole_wait_max_ns = waited;
+        if (!occupied(expected_)) gap_opened_ = now;
+      } else if (framing_ == Framing::MoldUDP64) {
+        fast_ = &src;
+      }
+      return msg;
+    }
+    if (seq < expected_ || occupied(seq)) {
+      ++metrics_.dup_dropped;
+    } else {
+      gap_[seq & mask_] = msg;
+      set_occupied(seq);
+      if (buffered_++ == 0) {
+        gap_opened_ = Clock::now();
+        ++metrics_.gap_detected;
+      }
     }
-    return msg;
-  };
 
-  if (auto m = pick_next(bufA_, bufB_)) return m;
-  if (auto m = pick_next(bufB_, bufA_)) return m;
+    if (chooseA) hasA = peek(feedA_, a, seqA); else hasB = peek(feedB_, b, seqB);
+  }
   return std::nullopt;
 }
 
 } // namespace net
-
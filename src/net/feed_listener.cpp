@@ -1,13 +1,7 @@
 #include "net/feed_listener.hpp"
-#include <arpa/inet.h>
-#include <netinet/in.h>
-#include <sys/socket.h>
-#include <unistd.h>
-#include <cstring>
 #include <iostream>
-#include <vector>
-#include <array>
-#include <time.h>
+#include <memory>
+#include "perf/cpu.hpp"
 
 namespace net {
 
@@ -23,87 +17,50 @@ void FeedListener::stop() {
 }
 
 void FeedListener::run() {
-  int sock = ::socket(AF_INET, SOCK_DGRAM, 0);
-  if (sock < 0) { perror("socket"); running_.store(false); return; }
+  if (cfg_.cpu >= 0 && !perf::pin_current_thread(cfg_.cpu))
+    std::cerr << "feed " << cfg_.port << ": cannot pin to cpu " << cfg_.cpu << std::endl;
 
-  int reuse = 1;
-  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
-
-  sockaddr_in local{};
-  local.sin_family = AF_INET;
-  local.sin_addr.s_addr = INADDR_ANY;
-  local.sin_port = htons(port_);
-  if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
-    perror("bind");
-    ::close(sock);
-    running_.store(false);
-    return;
+  std::unique_ptr<RxBackend> backend;
+  if (cfg_.kind == RxBackendKind::AfXdp) {
+    backend = make_af_xdp_backend();
+    if (!backend) {
+      std::cerr << "feed " << cfg_.port << ": built without AF_XDP, using sockets" << std::endl;
+    } else if (!backend->open(cfg_)) {
+      std::cerr << "feed " << cfg_.port << ": AF_XDP open failed on " << cfg_.ifname
+                << " queue " << cfg_.queue_id << ", using sockets" << std::endl;
+      backend.reset();
+    }
   }
-
-  ip_mreq mreq{};
-  mreq.imr_multiaddr.s_addr = inet_addr(mcast_group_.c_str());
-  mreq.imr_interface.s_addr = htonl(INADDR_ANY);
-  if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
-    perror("IP_ADD_MEMBERSHIP");
-    ::close(sock);
-    running_.store(false);
-    return;
+  if (!backend) {
+    backend = make_socket_backend();
+    if (!backend->open(cfg_)) { running_.store(false); return; }
   }
 
-  // Set a small recv timeout to ensure thread can stop promptly
-  timeval tv{0, 50 * 1000}; // 50ms
-  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-  constexpr size_t BUF_SZ = 4096;
-#ifdef __linux__
-  // Use recvmmsg for batched receive mapping directly into ring slots
-  const int BATCH = 16;
-  std::vector<mmsghdr> msgs(BATCH);
-  std::vector<sockaddr_in> addrs(BATCH);
-  std::vector<iovec> iovs(BATCH);
-
-  timespec timeout{0, 50 * 1000 * 1000}; // 50ms
-
-  while (running_.load()) {
-    // Prepare iovecs mapped to ring slots
-    for (int i = 0; i < BATCH; ++i) {
-      std::memset(&msgs[i], 0, sizeof(mmsghdr));
-      std::memset(&addrs[i], 0, sizeof(sockaddr_in));
-      iovs[i].iov_base = ring_[(ring_idx_ + i) % ring_.size()].data();
-      iovs[i].iov_len = BUF_SZ;
-      msgs[i].msg_hdr.msg_name = &addrs[i];
-      msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
-      msgs[i].msg_hdr.msg_iov = &iovs[i];
-      msgs[i].msg_hdr.msg_iovlen = 1;
+  constexpr size_t BATCH = 16;
+  // Worst case for one batch plus the filler at the wrap; below this, leave
+  // traffic queued in the kernel/NIC until the consumer releases packets
+  constexpr size_t BATCH_BYTES = (BATCH + 1) * (PacketRing::HEADER_SIZE + 4096);
+  core::PacketView batch[BATCH];
+  while (running_.load(std::memory_order_relaxed)) {
+    if (ring_.free_bytes() < BATCH_BYTES) {
+      stalls_.fetch_add(1, std::memory_order_relaxed);
+      if (cfg_.busy_poll) perf::cpu_relax(); else std::this_thread::yield();
+      continue;
     }
-
-    int n = ::recvmmsg(sock, msgs.data(), BATCH, 0, &timeout);
-    if (n <= 0) continue; // timeout or error; re-check running_
-
-    for (int i = 0; i < n; ++i) {
-      size_t slot = (ring_idx_ + i) % ring_.size();
-      core::PacketView view;
-      view.data = ring_[slot].data();
-      view.len = static_cast<uint32_t>(msgs[i].msg_len);
-      (void)queue_.push(view); // drop if full
-      msgs[i].msg_len = 0;
+    const size_t n = backend->receive(batch, BATCH);
+    if (n == 0) {
+      if (cfg_.busy_poll) perf::cpu_relax();
+      continue;
     }
-    ring_idx_ = (ring_idx_ + n) % ring_.size();
+    // The whole recvmmsg batch becomes visible to the consumer at once
+    const size_t kept = ring_.push_bulk(batch, n);
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < kept; ++i) bytes += batch[i].len;
+    packets_.fetch_add(kept, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    if (kept < n) dropped_.fetch_add(n - kept, std::memory_order_relaxed);
   }
-#else
-  // Portable path: recvfrom with SO_RCVTIMEO mapped to ring slots
-  while (running_.load()) {
-    size_t slot = ring_idx_ % ring_.size();
-    ssize_t r = ::recvfrom(sock, ring_[slot].data(), BUF_SZ, 0, nullptr, nullptr);
-    if (r > 0) {
-      core::PacketView view{ ring_[slot].data(), static_cast<uint32_t>(r) };
-      (void)queue_.push(view);
-      ring_idx_ = (ring_idx_ + 1) % ring_.size();
-    }
-  }
-#endif
-  ::close(sock);
+  backend->close();
 }
 
 } // namespace net
-
@@ -0,0 +1,340 @@
+// feed_replay: publishes an ITCH capture as MoldUDP64 on two multicast feeds
+// (A and B), with per-feed loss, duplication, reordering and delay, to load
+// the arbiter and FeedListener without a live feed. With --inproc the two
+// feeds go straight into a net::Arbiter instead, to measure gap recovery
+// and TTL settings without sockets.
+#include "core/mapped_file.hpp"
+#include "itch/decoder.hpp"
+#include "itch/messages.hpp"
+#include "net/arbiter.hpp"
+#include "net/feed_generator.hpp"
+#include "perf/cpu.hpp"
+#include "perf/latency_tracker.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ReplayOptions {
+  std::string framing{"auto"};
+  std::string group_a{"239.0.0.1"};
+  std::string group_b;               // Empty: same group as A
+  uint16_t port_a{5007};
+  uint16_t port_b{5008};
+  std::string interface{"0.0.0.0"};
+  int mcast_ttl{1};
+  bool loopback{true};
+  std::string session{"REPLAY0001"};
+  size_t max_datagram{1400};
+  uint64_t rate{0};                  // Messages per second; 0: line rate
+  uint32_t burst{1};                 // Packets sent back to back per tick
+  uint64_t limit{0};                 // Messages taken from the file; 0: all
+  uint64_t seed{1};
+  net::FeedImpairment imp[2];
+  bool inproc{false};
+  uint64_t arb_ttl_ms{50};
+  size_t gap_capacity{65536};
+};
+
+// One transmission, both feeds merged in send order
+struct TimedSend {
+  uint64_t at_ns;   // Since the start of the replay
+  uint32_t packet;
+  uint8_t feed;     // 0: A, 1: B
+};
+
+// Nominal send time of each packet: bursts of `burst` packets leave together,
+// spaced so the average is `rate` messages per second
+std::vector<uint64_t> nominal_times(const net::MoldFeedBuilder& feed, uint64_t rate, uint32_t burst) {
+  const auto& packets = feed.packets();
+  std::vector<uint64_t> at(packets.size(), 0);
+  if (rate == 0) return at;
+  uint64_t burst_start = 0;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    if (i % burst == 0) burst_start = (packets[i].sequence - 1) * 1000000000ull / rate;
+    at[i] = burst_start;
+  }
+  return at;
+}
+
+std::vector<TimedSend> build_timeline(const net::MoldFeedBuilder& feed, const ReplayOptions& opts,
+                                      net::ImpairmentStats (&stats)[2]) {
+  const std::vector<uint64_t> nominal = nominal_times(feed, opts.rate, opts.burst);
+  std::vector<TimedSend> timeline;
+  for (uint8_t f = 0; f < 2; ++f) {
+    // Different seeds per feed so the two do not lose the same packets
+    const auto sends = net::schedule_feed(feed.packets().size(), opts.imp[f], opts.seed * 2 + f, stats[f]);
+    for (const auto& s : sends) timeline.push_back({nominal[s.slot] + s.lag_ns, s.packet, f});
+  }
+  // Stable: sends due together keep their slot order within a feed
+  std::stable_sort(timeline.begin(), timeline.end(),
+                   [](const TimedSend& a, const TimedSend& b) { return a.at_ns < b.at_ns; });
+  return timeline;
+}
+
+// Waits until `at_ns` into the replay: sleeps while far off, spins the rest
+void wait_until(Clock::time_point start, uint64_t at_ns) {
+  const auto due = start + std::chrono::nanoseconds(at_ns);
+  auto now = Clock::now();
+  if (due - now > std::chrono::microseconds(200)) {
+    std::this_thread::sleep_for(due - now - std::chrono::microseconds(100));
+  }
+  while (Clock::now() < due) perf::cpu_relax();
+}
+
+int open_sender(const ReplayOptions& opts, const std::string& group, uint16_t port) {
+  const int sock = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0) { perror("socket"); return -1; }
+  in_addr iface{};
+  iface.s_addr = inet_addr(opts.interface.c_str());
+  const unsigned char ttl = static_cast<unsigned char>(opts.mcast_ttl);
+  const unsigned char loop = opts.loopback ? 1 : 0;
+  const int sndbuf = 8 << 20; // Line-rate bursts outrun the default
+  setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  sockaddr_in dest{};
+  dest.sin_family = AF_INET;
+  dest.sin_addr.s_addr = inet_addr(group.c_str());
+  dest.sin_port = htons(port);
+  if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0 ||
+      setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+      setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0 ||
+      ::connect(sock, reinterpret_cast<sockaddr*>(&dest), sizeof(dest)) < 0) {
+    perror("multicast socket");
+    ::close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+// Sends everything due, batching consecutive packets of a feed into one sendmmsg
+int run_multicast(const net::MoldFeedBuilder& feed, const std::vector<TimedSend>& timeline,
+                  const ReplayOptions& opts) {
+  const int socks[2] = {open_sender(opts, opts.group_a, opts.port_a),
+                        open_sender(opts, opts.group_b.empty() ? opts.group_a : opts.group_b, opts.port_b)};
+  if (socks[0] < 0 || socks[1] < 0) {
+    for (const int s : socks) if (s >= 0) ::close(s);
+    return 1;
+  }
+
+  constexpr size_t BATCH = 64;
+  mmsghdr msgs[BATCH];
+  iovec iovs[BATCH];
+  uint64_t send_calls = 0, send_errors = 0, bytes = 0;
+  const auto start = Clock::now();
+  size_t i = 0;
+  while (i < timeline.size()) {
+    wait_until(start, timeline[i].at_ns);
+    const uint64_t now_ns =
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    const uint8_t f = timeline[i].feed;
+    size_t n = 0;
+    while (n < BATCH && i + n < timeline.size() && timeline[i + n].feed == f && timeline[i + n].at_ns <= now_ns) {
+      const core::PacketView pkt = feed.view(feed.packets()[timeline[i + n].packet]);
+      iovs[n].iov_base = const_cast<char*>(pkt.data);
+      iovs[n].iov_len = pkt.len;
+      msgs[n] = mmsghdr{};
+      msgs[n].msg_hdr.msg_iov = &iovs[n];
+      msgs[n].msg_hdr.msg_iovlen = 1;
+      bytes += pkt.len;
+      ++n;
+    }
+    size_t done = 0;
+    while (done < n) {
+      const int rc = sendmmsg(socks[f], msgs + done, static_cast<unsigned>(n - done), 0);
+      ++send_calls;
+      if (rc <= 0) { ++send_errors; ++done; continue; } // Skip the refused packet
+      done += static_cast<size_t>(rc);
+    }
+    i += n;
+  }
+  const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+  for (const int s : socks) ::close(s);
+  std::cout << "Sent " << timeline.size() << " packets (" << bytes << " bytes) in " << secs << " s, "
+            << send_calls << " sendmmsg calls, " << send_errors << " errors";
+  if (secs > 0) std::cout << ", " << static_cast<uint64_t>(feed.messages() / secs) << " msg/s per feed";
+  std::cout << std::endl;
+  return send_errors ? 1 : 0;
+}
+
+// Both feeds into an arbiter in this process: a packet becomes visible to
+// its feed once its send time has come, in timeline order across feeds
+int run_inproc(const net::MoldFeedBuilder& feed, const std::vector<TimedSend>& timeline,
+               const ReplayOptions& opts) {
+  Clock::time_point start; // Set once everything is built
+  size_t head = 0;
+  auto pop = [&](uint8_t f, core::PacketView& out) {
+    if (head == timeline.size() || timeline[head].feed != f) return false;
+    if (opts.rate != 0 &&
+        Clock::now() - start < std::chrono::nanoseconds(timeline[head].at_ns)) return false;
+    out = feed.view(feed.packets()[timeline[head++].packet]);
+    return true;
+  };
+  net::Arbiter arb([&](core::PacketView& p) { return pop(0, p); },
+                   [&](core::PacketView& p) { return pop(1, p); },
+                   opts.gap_capacity, std::chrono::milliseconds(opts.arb_ttl_ms), net::Framing::MoldUDP64);
+
+  // Scheduled send time of each message, for send-to-delivery latency
+  std::vector<uint64_t> sent_at(feed.messages() + 1, 0);
+  const std::vector<uint64_t> nominal = nominal_times(feed, opts.rate, opts.burst);
+  for (size_t p = 0; p < feed.packets().size(); ++p) {
+    const auto& pkt = feed.packets()[p];
+    if (pkt.count == net::mold::END_OF_SESSION) continue;
+    for (uint16_t m = 0; m < pkt.count; ++m) sent_at[pkt.sequence + m] = nominal[p];
+  }
+
+  perf::LatencyTracker delivery;
+  uint64_t delivered = 0;
+  start = Clock::now();
+  while (true) {
+    auto msg = arb.next_message();
+    if (msg) {
+      ++delivered;
+      const uint64_t seq = arb.expected_sequence() - 1;
+      if (opts.rate != 0 && seq < sent_at.size()) {
+        const uint64_t now_ns =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        delivery.record(now_ns > sent_at[seq] ? now_ns - sent_at[seq] : 0);
+      }
+      continue;
+    }
+    // Done once both feeds are drained and no hole is left waiting on the TTL
+    if (head == timeline.size() && arb.buffered() == 0) break;
+    perf::cpu_relax();
+  }
+  const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+  const auto& m = arb.metrics();
+  const uint64_t missing = feed.messages() - delivered;
+  std::cout << "Arbiter: delivered=" << delivered << " of " << feed.messages() << " (missing " << missing
+            << ") in " << secs << " s";
+  if (secs > 0) std::cout << ", " << static_cast<uint64_t>(delivered / secs) << " msg/s";
+  std::cout << "\n  gaps: detected=" << m.gap_detected << ", filled=" << m.gap_filled
+            << ", dropped_ttl=" << m.gap_dropped_ttl << ", dropped_capacity=" << m.gap_dropped_capacity
+            << "\n  duplicates: messages=" << m.dup_dropped << ", packets=" << m.dup_packets
+            << ", end_of_session=" << m.end_of_session
+            << "\n  holes recovered=" << m.holes_recovered << ", wait avg="
+            << (m.holes_recovered ? m.hole_wait_ns / m.holes_recovered : 0) << " ns, max=" << m.hole_wait_max_ns
+            << " ns" << std::endl;
+  if (opts.rate != 0) delivery.print_stats("Send to Arbiter");
+  // Everything not lost on both feeds must come out
+  return missing == m.gap_dropped_ttl + m.gap_dropped_capacity ? 0 : 1;
+}
+
+// --loss-a=0.01 style flags: sets feed A or B's field from the suffix
+bool parse_impairment(const std::string& a, ReplayOptions& opts) {
+  const auto eq = a.find('=');
+  if (eq == std::string::npos || eq < 3 || a[eq - 2] != '-') return false;
+  const char side = a[eq - 1];
+  if (side != 'a' && side != 'b') return false;
+  net::FeedImpairment& imp = opts.imp[side == 'b'];
+  const std::string name = a.substr(0, eq - 2);
+  const std::string value = a.substr(eq + 1);
+  if (name == "--loss") imp.loss = std::stod(value);
+  else if (name == "--dup") imp.duplicate = std::stod(value);
+  else if (name == "--reorder") imp.reorder = std::stod(value);
+  else if (name == "--reorder-depth") imp.reorder_depth = static_cast<uint32_t>(std::stoul(value));
+  else if (name == "--delay-us") imp.delay_ns = std::stoull(value) * 1000;
+  else if (name == "--jitter-us") imp.jitter_ns = std::stoull(value) * 1000;
+  else return false;
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  // CLI: feed_replay <itch file> [--framing=auto|bare|prefixed] [--limit=MESSAGES]
+  //        [--group-a=239.0.0.1 --group-b=GROUP --port-a=5007 --port-b=5008 --iface=ADDR --mcast-ttl=N --no-loop]
+  //        [--session=NAME --max-datagram=BYTES] [--rate=MSGS_PER_SEC --burst=PACKETS] [--seed=N]
+  //        [--loss-a=P --dup-a=P --reorder-a=P --reorder-depth-a=N --delay-us-a=US --jitter-us-a=US] (and -b)
+  //        [--inproc --arb-ttl-ms=MS --gap-capacity=N]
+  if (argc < 2 || argv[1][0] == '-') {
+    std::cerr << "Usage: " << argv[0] << " <itch file> [--framing=auto|bare|prefixed --limit=MESSAGES]\n"
+              << "        [--group-a=239.0.0.1 --group-b=GROUP --port-a=5007 --port-b=5008 --iface=ADDR"
+              << " --mcast-ttl=N --no-loop]\n"
+              << "        [--session=NAME --max-datagram=BYTES] [--rate=MSGS_PER_SEC (0: line rate)"
+              << " --burst=PACKETS --seed=N]\n"
+              << "        [--loss-a=P --dup-a=P --reorder-a=P --reorder-depth-a=N --delay-us-a=US"
+              << " --jitter-us-a=US] (and -b)\n"
+              << "        [--inproc --arb-ttl-ms=MS --gap-capacity=N]" << std::endl;
+    return 1;
+  }
+
+  ReplayOptions opts;
+  for (int i = 2; i < argc; i++) {
+    const std::string a = argv[i];
+    const auto eq = a.find('=');
+    if (a.rfind("--framing=", 0) == 0) opts.framing = a.substr(eq + 1);
+    else if (a.rfind("--limit=", 0) == 0) opts.limit = std::stoull(a.substr(eq + 1));
+    else if (a.rfind("--group-a=", 0) == 0) opts.group_a = a.substr(eq + 1);
+    else if (a.rfind("--group-b=", 0) == 0) opts.group_b = a.substr(eq + 1);
+    else if (a.rfind("--port-a=", 0) == 0) opts.port_a = static_cast<uint16_t>(std::stoi(a.substr(eq + 1)));
+    else if (a.rfind("--port-b=", 0) == 0) opts.port_b = static_cast<uint16_t>(std::stoi(a.substr(eq + 1)));
+    else if (a.rfind("--iface=", 0) == 0) opts.interface = a.substr(eq + 1);
+    else if (a.rfind("--mcast-ttl=", 0) == 0) opts.mcast_ttl = std::stoi(a.substr(eq + 1));
+    else if (a == "--no-loop") opts.loopback = false;
+    else if (a.rfind("--session=", 0) == 0) opts.session = a.substr(eq + 1);
+    else if (a.rfind("--max-datagram=", 0) == 0) opts.max_datagram = std::stoul(a.substr(eq + 1));
+    else if (a.rfind("--rate=", 0) == 0) opts.rate = std::stoull(a.substr(eq + 1));
+    else if (a.rfind("--burst=", 0) == 0) opts.burst = std::max<uint32_t>(1, std::stoul(a.substr(eq + 1)));
+    else if (a.rfind("--seed=", 0) == 0) opts.seed = std::stoull(a.substr(eq + 1));
+    else if (a == "--inproc") opts.inproc = true;
+    else if (a.rfind("--arb-ttl-ms=", 0) == 0) opts.arb_ttl_ms = std::stoull(a.substr(eq + 1));
+    else if (a.rfind("--gap-capacity=", 0) == 0) opts.gap_capacity = std::stoul(a.substr(eq + 1));
+    else if (!parse_impairment(a, opts)) std::cerr << "Ignoring unknown option " << a << std::endl;
+  }
+
+  core::MappedFile file;
+  if (!file.open(argv[1])) {
+    std::cerr << "Error: Could not open file " << argv[1] << std::endl;
+    return 1;
+  }
+  const itch::Framing framing =
+      opts.framing == "bare"       ? itch::Framing::Bare
+      : opts.framing == "prefixed" ? itch::Framing::LengthPrefixed
+                                   : itch::detect_framing(file.data(), file.size());
+
+  // Packs the capture once; both feeds send the same packets
+  opts.max_datagram = std::max(opts.max_datagram, net::mold::HEADER_SIZE + 2 + 64);
+  net::MoldFeedBuilder feed(opts.session, opts.max_datagram);
+  const char* cur = file.data();
+  const char* end = cur + file.size();
+  while (cur < end && (opts.limit == 0 || feed.messages() < opts.limit)) {
+    uint32_t len;
+    if (framing == itch::Framing::Bare) {
+      len = itch_message_size(*cur);
+    } else {
+      if (end - cur < 2) break;
+      len = net::mold::load_be16(cur);
+      cur += 2;
+    }
+    if (len == 0 || len > static_cast<size_t>(end - cur)) break;
+    feed.add(cur, static_cast<uint16_t>(len));
+    cur += len;
+  }
+  if (cur < end && opts.limit == 0)
+    std::cerr << "Stopped at byte " << (cur - file.data()) << ": undecodable message" << std::endl;
+  feed.finish();
+
+  net::ImpairmentStats stats[2];
+  const std::vector<TimedSend> timeline = build_timeline(feed, opts, stats);
+  std::cout << "Packed " << feed.messages() << " messages into " << feed.packets().size()
+            << " MoldUDP64 packets (session " << opts.session << ", seed " << opts.seed << ")" << std::endl;
+  for (int f = 0; f < 2; ++f) {
+    std::cout << "Feed " << (f ? 'B' : 'A') << ": sends=" << stats[f].sent << ", lost=" << stats[f].lost
+              << ", duplicated=" << stats[f].duplicated << ", reordered=" << stats[f].reordered << std::endl;
+  }
+
+  return opts.inproc ? run_inproc(feed, timeline, opts) : run_multicast(feed, timeline, opts);
+}
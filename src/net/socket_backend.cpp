@@ -0,0 +1,179 @@
+#include "net/rx_backend.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <array>
+#include <time.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace net {
+
+namespace {
+
+// Kernel UDP socket joined to the multicast group; a batch lands in a few
+// fixed-size staging slots that stay cache-resident. Each packet carries its SO_TIMESTAMPING receive
+// stamp: the NIC's when cfg.ifname has hardware stamping, else the kernel's.
+class SocketBackend : public RxBackend {
+public:
+  ~SocketBackend() override { close(); }
+
+  bool open(const RxConfig& cfg) override {
+    sock_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock_ < 0) { perror("socket"); return false; }
+
+    int reuse = 1;
+    setsockopt(sock_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = INADDR_ANY;
+    local.sin_port = htons(cfg.port);
+    if (bind(sock_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+      perror("bind");
+      close();
+      return false;
+    }
+
+    ip_mreq mreq{};
+    mreq.imr_multiaddr.s_addr = inet_addr(cfg.mcast_group.c_str());
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(sock_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+      perror("IP_ADD_MEMBERSHIP");
+      close();
+      return false;
+    }
+
+    // Set a small recv timeout to ensure thread can stop promptly
+    timeval tv{0, 50 * 1000}; // 50ms
+    setsockopt(sock_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+#ifdef __linux__
+    enable_timestamps(cfg);
+    busy_poll_ = cfg.busy_poll;
+#ifdef SO_BUSY_POLL
+    if (busy_poll_) {
+      // Let the kernel poll the NIC queue from our receive call; raising it
+      // above net.core.busy_read needs CAP_NET_ADMIN, so failure is fine
+      int usecs = 50;
+      setsockopt(sock_, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs));
+    }
+#endif
+#endif
+
+    return true;
+  }
+
+  size_t receive(core::PacketView* out, size_t max) override {
+#ifdef __linux__
+    // recvmmsg maps each datagram into its own staging slot
+    const size_t batch = max < BATCH ? max : BATCH;
+    for (size_t i = 0; i < batch; ++i) {
+      std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+      iovs_[i].iov_base = slots_[i].data();
+      iovs_[i].iov_len = BUF_SZ;
+      msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+      msgs_[i].msg_hdr.msg_iovlen = 1;
+      msgs_[i].msg_hdr.msg_control = ctrl_[i].data();
+      msgs_[i].msg_hdr.msg_controllen = CTRL_SZ;
+    }
+
+    timespec timeout{0, 50 * 1000 * 1000}; // 50ms
+    int n = busy_poll_ ? ::recvmmsg(sock_, msgs_.data(), static_cast<unsigned>(batch), MSG_DONTWAIT, nullptr)
+                       : ::recvmmsg(sock_, msgs_.data(), static_cast<unsigned>(batch), 0, &timeout);
+    if (n <= 0) return 0; // timeout or error
+
+    for (int i = 0; i < n; ++i) {
+      out[i].data = slots_[i].data();
+      out[i].len = static_cast<uint32_t>(msgs_[i].msg_len);
+      out[i].rx_ns = rx_timestamp(msgs_[i].msg_hdr);
+    }
+    return static_cast<size_t>(n);
+#else
+    // Portable path: recvfrom with SO_RCVTIMEO, one datagram per call
+    if (max == 0) return 0;
+    char* slot = slots_[0].data();
+    ssize_t r = ::recvfrom(sock_, slot, BUF_SZ, 0, nullptr, nullptr);
+    if (r <= 0) return 0;
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    out[0] = core::PacketView{slot, static_cast<uint32_t>(r),
+                              uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec)};
+    return 1;
+#endif
+  }
+
+  void close() override {
+    if (sock_ >= 0) ::close(sock_);
+    sock_ = -1;
+  }
+
+  const char* name() const override { return "socket"; }
+
+private:
+  static constexpr size_t BUF_SZ = 4096;
+  static constexpr size_t BATCH = 16;
+
+#ifdef __linux__
+  static constexpr size_t CTRL_SZ = 256;
+
+  void enable_timestamps(const RxConfig& cfg) {
+    // Ask the NIC to stamp every received packet; needs CAP_NET_ADMIN and a
+    // driver that supports it, otherwise the kernel's stamp is used
+    if (!cfg.ifname.empty()) {
+      hwtstamp_config hw{};
+      hw.tx_type = HWTSTAMP_TX_OFF;
+      hw.rx_filter = HWTSTAMP_FILTER_ALL;
+      ifreq ifr{};
+      std::strncpy(ifr.ifr_name, cfg.ifname.c_str(), IFNAMSIZ - 1);
+      ifr.ifr_data = reinterpret_cast<char*>(&hw);
+      hw_ = ioctl(sock_, SIOCSHWTSTAMP, &ifr) == 0 && hw.rx_filter != HWTSTAMP_FILTER_NONE;
+    }
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (hw_) flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    if (setsockopt(sock_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+      perror("SO_TIMESTAMPING");
+      hw_ = false;
+    }
+    fprintf(stderr, "feed %d: %s rx timestamps\n", cfg.port, hw_ ? "hardware" : "software");
+  }
+
+  // ts[2] is the raw NIC stamp, ts[0] the kernel's; 0 when neither is present
+  uint64_t rx_timestamp(const msghdr& hdr) const {
+    for (cmsghdr* c = CMSG_FIRSTHDR(&hdr); c; c = CMSG_NXTHDR(const_cast<msghdr*>(&hdr), c)) {
+      if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SO_TIMESTAMPING) continue;
+      scm_timestamping ts;
+      std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+      const timespec& t = (hw_ && (ts.ts[2].tv_sec | ts.ts[2].tv_nsec)) ? ts.ts[2] : ts.ts[0];
+      return uint64_t(t.tv_sec) * 1000000000ull + uint64_t(t.tv_nsec);
+    }
+    return 0;
+  }
+#endif
+
+  int sock_{-1};
+  std::array<std::array<char, BUF_SZ>, BATCH> slots_{};
+#ifdef __linux__
+  std::array<mmsghdr, BATCH> msgs_{};
+  std::array<iovec, BATCH> iovs_{};
+  std::array<std::array<char, CTRL_SZ>, BATCH> ctrl_{};
+  bool hw_{false};
+  bool busy_poll_{false};
+#endif
+};
+
+} // namespace
+
+std::unique_ptr<RxBackend> make_socket_backend() {
+  return std::make_unique<SocketBackend>();
+}
+
+} // namespace net